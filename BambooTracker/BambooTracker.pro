@@ -52,6 +52,7 @@ SOURCES += \
     chip/mame/ymdeltat.c \
     chip/nuked/nuked_2608.cpp \
     chip/register_write_logger.cpp \
+    chip/register_write_queue.cpp \
     chip/ymfm/ymfm_2608.cpp \
     chip/ymfm/ymfm_adpcm.cpp \
     chip/ymfm/ymfm_opn.cpp \
@@ -96,6 +97,7 @@ SOURCES += \
     gui/transpose_song_dialog.cpp \
     gui/wheel_spin_box.cpp \
     instrument/sample_adpcm.cpp \
+    instrument/sample_adpcm_pool.cpp \
     instrument/sequence_property.cpp \
     io/btb_io.cpp \
     io/bti_io.cpp \
@@ -117,20 +119,24 @@ SOURCES += \
     io/tfi_io.cpp \
     io/vgi_io.cpp \
     io/wav_container.cpp \
+    io/wav_stream_writer.cpp \
     io/wopn_io.cpp \
     io/y12_io.cpp \
     jamming.cpp \
     main.cpp \
     gui/mainwindow.cpp \
     chip/chip.cpp \
+    chip/mix_kernels.cpp \
     chip/opna.cpp \
     chip/resampler.cpp \
     chip/nuked/ym3438.c \
+    adpcm_memory_allocator.cpp \
     bamboo_tracker.cpp \
     module/effect.cpp \
     note.cpp \
     playback.cpp \
-    song_length_calculator.cpp \
+    song_timeline.cpp \
+    rt_alloc_check.cpp \
     audio/audio_stream.cpp \
     instrument/instruments_manager.cpp \
     command/command_manager.cpp \
@@ -153,6 +159,7 @@ SOURCES += \
     module/module.cpp \
     module/song.cpp \
     module/pattern.cpp \
+    module/pattern_cell_block.cpp \
     module/track.cpp \
     module/step.cpp \
     gui/order_list_editor/order_list_panel.cpp \
@@ -231,12 +238,14 @@ HEADERS += \
     chip/codec/ymb_codec.hpp \
     chip/mame/fmopn.h \
     chip/mame/fmopn_2608rom.h \
+    chip/mame/fmopn_tables.h \
     chip/mame/mame_2608.hpp \
     chip/mame/mamedefs.h \
     chip/mame/ymdeltat.h \
     chip/nuked/nuked_2608.hpp \
     chip/real_chip_interface.hpp \
     chip/register_write_logger.hpp \
+    chip/register_write_queue.hpp \
     chip/ymfm/ymfm.h \
     chip/ymfm/ymfm_2608.hpp \
     chip/ymfm/ymfm_adpcm.h \
@@ -252,6 +261,7 @@ HEADERS += \
     command/pattern/set_key_cut_to_step_command.hpp \
     command/pattern/transpose_note_in_pattern_command.hpp \
     echo_buffer.hpp \
+    fixed_block_pool.hpp \
     enum_hash.hpp \
     gui/bookmark_manager_form.hpp \
     gui/command/instrument/instrument_command_qt_utils.hpp \
@@ -289,8 +299,10 @@ HEADERS += \
     gui/mainwindow.hpp \
     chip/nuked/ym3438.h \
     chip/chip.hpp \
+    chip/mix_kernels.hpp \
     chip/opna.hpp \
     chip/resampler.hpp \
+    adpcm_memory_allocator.hpp \
     bamboo_tracker.hpp \
     gui/note_name_manager.hpp \
     gui/swap_tracks_dialog.hpp \
@@ -298,6 +310,7 @@ HEADERS += \
     gui/wheel_spin_box.hpp \
     instrument/instrument_property_defs.hpp \
     instrument/sample_adpcm.hpp \
+    instrument/sample_adpcm_pool.hpp \
     instrument/sample_repeat.hpp \
     instrument/sequence_property.hpp \
     io/btb_io.hpp \
@@ -321,13 +334,14 @@ HEADERS += \
     io/tfi_io.hpp \
     io/vgi_io.hpp \
     io/wav_container.hpp \
+    io/wav_stream_writer.hpp \
     io/wopn_io.hpp \
     io/y12_io.hpp \
     jamming.hpp \
     module/effect.hpp \
     note.hpp \
     playback.hpp \
-    song_length_calculator.hpp \
+    song_timeline.hpp \
     audio/audio_stream.hpp \
     instrument/instruments_manager.hpp \
     command/command_manager.hpp \
@@ -351,6 +365,7 @@ HEADERS += \
     module/module.hpp \
     module/song.hpp \
     module/pattern.hpp \
+    module/pattern_cell_block.hpp \
     module/track.hpp \
     module/step.hpp \
     gui/order_list_editor/order_list_panel.hpp \
@@ -419,6 +434,7 @@ HEADERS += \
     gui/instrument_selection_dialog.hpp \
     gui/s98_export_settings_dialog.hpp \
     precise_timer.hpp \
+    rt_alloc_check.hpp \
     io/module_io.hpp \
     io/instrument_io.hpp \
     io/bank_io.hpp \
@@ -502,6 +518,11 @@ else {
   else:CONFIG(release, debug|release):LIBS += -lrtmidi
 }
 
+# Count heap allocations made on the audio thread (debugging aid)
+rt_alloc_check {
+  DEFINES += BT_RT_ALLOC_CHECK
+}
+
 win32:CONFIG += real_chip
 real_chip {
   DEFINES += USE_REAL_CHIP
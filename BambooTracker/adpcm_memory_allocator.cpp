@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "adpcm_memory_allocator.hpp"
+#include <algorithm>
+
+ADPCMMemoryAllocator::ADPCMMemoryAllocator(size_t nBlocks) : nBlocks_(nBlocks) {}
+
+bool ADPCMMemoryAllocator::allocate(size_t nBlocks, size_t& start)
+{
+	if (!nBlocks) return false;
+
+	size_t pos = 0;
+	for (const auto& range : ranges_) {
+		if (range.first - pos >= nBlocks) break;
+		pos = range.second + 1;
+	}
+	if (pos > nBlocks_ || nBlocks_ - pos < nBlocks) return false;
+
+	ranges_.emplace(pos, pos + nBlocks - 1);
+	start = pos;
+	return true;
+}
+
+bool ADPCMMemoryAllocator::allocateTail(size_t nBlocks, size_t& start, size_t& stop)
+{
+	size_t pos = getUsedEnd();
+	if (!nBlocks || pos >= nBlocks_) return false;
+
+	start = pos;
+	stop = std::min(pos + nBlocks, nBlocks_) - 1;
+	ranges_.emplace(start, stop);
+	return true;
+}
+
+void ADPCMMemoryAllocator::release(size_t start)
+{
+	ranges_.erase(start);
+}
+
+void ADPCMMemoryAllocator::clear() noexcept
+{
+	ranges_.clear();
+}
+
+size_t ADPCMMemoryAllocator::getUsedEnd() const noexcept
+{
+	return ranges_.empty() ? 0 : ranges_.rbegin()->second + 1;
+}
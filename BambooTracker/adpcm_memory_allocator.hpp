@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2020-2021 Rerrah
+ * Copyright (C) 2023 Rerrah
  *
  * Permission is hereby granted, free of charge, to any person
  * obtaining a copy of this software and associated documentation
@@ -26,17 +26,28 @@
 #pragma once
 
 #include <cstddef>
+#include <map>
 
-class Module;
-
-class SongLengthCalculator
+/// First-fit allocator of the ADPCM DRAM in units of 32-byte blocks.
+class ADPCMMemoryAllocator
 {
 public:
-	SongLengthCalculator(Module& mod, int songNum);
-	double approximateLengthBySecond() const;
-	void totalStepCount(size_t& introSize, size_t& loopSize) const;
+	explicit ADPCMMemoryAllocator(size_t nBlocks);
+
+	/// Take the lowest free range which holds the blocks.
+	/// [Return] false if there is no such range
+	bool allocate(size_t nBlocks, size_t& start);
+	/// Take the blocks after the last used range, and cut the ones beyond the end of the memory.
+	/// [Return] false if the memory is used up to the end
+	bool allocateTail(size_t nBlocks, size_t& start, size_t& stop);
+	void release(size_t start);
+	void clear() noexcept;
+
+	/// Get the block next to the last used one.
+	size_t getUsedEnd() const noexcept;
+	size_t getBlockCount() const noexcept { return nBlocks_; }
 
 private:
-	Module& mod_;
-	const int songNum_;
+	size_t nBlocks_;
+	std::map<size_t, size_t> ranges_;	///< Start and stop blocks of the used ranges
 };
@@ -25,6 +25,7 @@
 
 #include "audio_stream.hpp"
 #include <algorithm>
+#include "rt_alloc_check.hpp"
 
 const std::string AudioStream::AUDIO_OUT_CLIENT_NAME = "BambooTracker";
 
@@ -104,6 +105,8 @@ void AudioStream::stop()
 
 bool AudioStream::generate(int16_t* container, uint32_t nSamples)
 {
+	rt_alloc_check::RealTimeScope rtScope;
+
 	GenerateCallback* gcb = nullptr;
 	void* gcbPtr = nullptr;
 	TickUpdateCallback* tucb = nullptr;
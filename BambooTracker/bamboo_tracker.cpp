@@ -25,11 +25,11 @@
 
 #include "bamboo_tracker.hpp"
 #include <algorithm>
+#include <cstdint>
 #include <utility>
 #include <exception>
 #include <iterator>
 #include <unordered_map>
-#include <unordered_set>
 #include "configuration.hpp"
 #include "opna_controller.hpp"
 #include "playback.hpp"
@@ -41,12 +41,19 @@
 #include "io/bank_io.hpp"
 #include "bank.hpp"
 #include "note.hpp"
-#include "song_length_calculator.hpp"
+#include "rt_alloc_check.hpp"
 #include "utils.hpp"
 
 namespace
 {
 const uint32_t CHIP_CLOCK = 3993600 * 2;
+
+/// Converts the undo history limit in MiB to bytes, saturating where size_t is 32-bit.
+size_t undoHistoryLimitBytes(size_t mib)
+{
+	uint64_t bytes = std::min<uint64_t>(mib, UINT64_MAX >> 20) << 20;
+	return static_cast<size_t>(std::min<uint64_t>(bytes, SIZE_MAX));
+}
 }
 
 BambooTracker::BambooTracker(std::weak_ptr<Configuration> config)
@@ -63,15 +70,19 @@ BambooTracker::BambooTracker(std::weak_ptr<Configuration> config)
 	  curVolume_(127),
 	  mkOrder_(-1),
 	  mkStep_(-1),
-	  isFollowPlay_(true)
+	  isFollowPlay_(true),
+	  isStreamProfiling_(false),
+	  sequencingTime_(0)
 {
 	opnaCtrl_ = std::make_shared<OPNAController>(
 					static_cast<chip::OpnaEmulator>(config.lock()->getEmulator()),
+					config.lock()->getYmfmFidelity(),
 					CHIP_CLOCK,
 					config.lock()->getSampleRate(),
 					config.lock()->getBufferLength(),
 					config.lock()->getResamplerType());
 	opnaCtrl_->setImmediateWriteMode(config.lock()->getImmediateWriteModeEnabled());
+	opnaCtrl_->setSilenceSkipEnabled(true);	// Idle the chip while the stream is silent
 	setMasterVolume(config.lock()->getMixerVolumeMaster());
 	setMasterVolumeFM(config.lock()->getMixerVolumeFM());
 	setMasterVolumeSSG(config.lock()->getMixerVolumeSSG());
@@ -83,6 +94,11 @@ BambooTracker::BambooTracker(std::weak_ptr<Configuration> config)
 
 	storeOnlyUsedSamples_ = config.lock()->getWriteOnlyUsedSamples();
 	volFMReversed_ = config.lock()->getReverseFMVolumeOrder();
+	comMan_.setMemoryLimit(undoHistoryLimitBytes(config.lock()->getUndoHistoryLimit()));
+	comMan_.setSongEditHandler([this](const CommandScope& scope) {
+		if (scope.beginTrack < 0) invalidatePlaybackStates(scope.song, scope.order);
+		else invalidatePlaybackStates(scope.song, scope.beginTrack, scope.endTrack, scope.order);
+	});
 
 	makeNewModule();
 }
@@ -105,6 +121,7 @@ void BambooTracker::changeConfiguration(std::weak_ptr<Configuration> config)
 	instMan_->setPropertyFindMode(config.lock()->getOverwriteUnusedUneditedPropety());
 	storeOnlyUsedSamples_ = config.lock()->getWriteOnlyUsedSamples();
 	volFMReversed_ = config.lock()->getReverseFMVolumeOrder();
+	comMan_.setMemoryLimit(undoHistoryLimitBytes(config.lock()->getUndoHistoryLimit()));
 }
 
 /********** Current octave **********/
@@ -154,12 +171,12 @@ int BambooTracker::getCurrentInstrumentNumber() const
 /********** Instrument edit **********/
 void BambooTracker::addInstrument(int num, InstrumentType type, const std::string& name)
 {
-	comMan_.invoke(std::make_unique<AddInstrumentCommand>(instMan_, num, type, name));
+	comMan_.invoke(std::make_unique<AddInstrumentCommand>(instMan_, num, type, name), CommandScope(curSongNum_));
 }
 
 void BambooTracker::removeInstrument(int num)
 {
-	comMan_.invoke(std::make_unique<RemoveInstrumentCommand>(instMan_, num));
+	comMan_.invoke(std::make_unique<RemoveInstrumentCommand>(instMan_, num), CommandScope(curSongNum_));
 }
 
 std::unique_ptr<AbstractInstrument> BambooTracker::getInstrument(int num)
@@ -171,23 +188,23 @@ std::unique_ptr<AbstractInstrument> BambooTracker::getInstrument(int num)
 
 void BambooTracker::cloneInstrument(int num, int refNum)
 {
-	comMan_.invoke(std::make_unique<cloneInstrumentCommand>(instMan_, num, refNum));
+	comMan_.invoke(std::make_unique<cloneInstrumentCommand>(instMan_, num, refNum), CommandScope(curSongNum_));
 }
 
 void BambooTracker::deepCloneInstrument(int num, int refNum)
 {
-	comMan_.invoke(std::make_unique<DeepCloneInstrumentCommand>(instMan_, num, refNum));
+	comMan_.invoke(std::make_unique<DeepCloneInstrumentCommand>(instMan_, num, refNum), CommandScope(curSongNum_));
 }
 
 void BambooTracker::swapInstruments(int a, int b, bool patternChange)
 {
-	comMan_.invoke(std::make_unique<SwapInstrumentsCommand>(instMan_, mod_, a, b, curSongNum_, patternChange));
+	comMan_.invoke(std::make_unique<SwapInstrumentsCommand>(instMan_, mod_, a, b, curSongNum_, patternChange), CommandScope(curSongNum_));
 }
 
 void BambooTracker::loadInstrument(io::BinaryContainer& container, const std::string& path, int instNum)
 {
 	AbstractInstrument* inst = io::InstrumentIO::getInstance().loadInstrument(container, path, instMan_, instNum);
-	comMan_.invoke(std::make_unique<AddInstrumentCommand>(instMan_, std::unique_ptr<AbstractInstrument>(inst)));
+	comMan_.invoke(std::make_unique<AddInstrumentCommand>(instMan_, std::unique_ptr<AbstractInstrument>(inst)), CommandScope(curSongNum_));
 }
 
 void BambooTracker::saveInstrument(io::BinaryContainer& container, int instNum)
@@ -199,7 +216,8 @@ void BambooTracker::importInstrument(const AbstractBank &bank, size_t index, int
 {
 	AbstractInstrument* inst = bank.loadInstrument(index, instMan_, instNum);
 	comMan_.invoke(std::make_unique<AddInstrumentCommand>(
-					   instMan_, std::unique_ptr<AbstractInstrument>(inst)));
+					   instMan_, std::unique_ptr<AbstractInstrument>(inst)),
+				   CommandScope(curSongNum_));
 }
 
 void BambooTracker::exportInstruments(io::BinaryContainer& container, const std::vector<int>& instNums)
@@ -220,6 +238,7 @@ void BambooTracker::setInstrumentName(int num, const std::string& name)
 void BambooTracker::clearAllInstrument()
 {
 	instMan_->clearAll();
+	invalidatePlaybackStates(curSongNum_);
 }
 
 std::vector<int> BambooTracker::getInstrumentIndices() const
@@ -911,18 +930,20 @@ void BambooTracker::clearSampleADPCMRawSample(int sampNum)
 
 bool BambooTracker::assignSampleADPCMRawSamples()
 {
-	opnaCtrl_->clearSamplesADPCM();
 	std::vector<int> idcs = storeOnlyUsedSamples_ ? instMan_->getSampleADPCMValidIndices()
 												  : instMan_->getSampleADPCMEntriedIndices();
-	bool storedAll = true;
-	for (auto sampNum : idcs) {
-		size_t startAddr, stopAddr;
-		if (opnaCtrl_->storeSampleADPCM(instMan_->getSampleADPCMRawSample(sampNum), startAddr, stopAddr)) {
-			instMan_->setSampleADPCMStartAddress(sampNum, startAddr);
-			instMan_->setSampleADPCMStopAddress(sampNum, stopAddr);
-		}
-		else {
-			storedAll = false;
+	std::vector<SampleADPCMBuffer> samples;
+	samples.reserve(idcs.size());
+	for (auto sampNum : idcs) samples.push_back(instMan_->getSampleADPCMRawSampleBuffer(sampNum));
+
+	// Only samples changed since the last assignment are uploaded
+	std::unordered_map<const std::vector<uint8_t>*, std::array<size_t, 2>> addrs;
+	bool storedAll = opnaCtrl_->storeSamplesADPCM(samples, addrs);
+	for (size_t i = 0; i < idcs.size(); ++i) {
+		auto&& it = addrs.find(samples[i].get());
+		if (it != addrs.end()) {
+			instMan_->setSampleADPCMStartAddress(idcs[i], it->second[0]);
+			instMan_->setSampleADPCMStopAddress(idcs[i], it->second[1]);
 		}
 	}
 	return storedAll;
@@ -1294,6 +1315,21 @@ void BambooTracker::clearCommandHistory()
 	comMan_.clear();
 }
 
+bool BambooTracker::canUndo() const
+{
+	return comMan_.canUndo();
+}
+
+size_t BambooTracker::getUndoCount() const
+{
+	return comMan_.getUndoCount();
+}
+
+size_t BambooTracker::getCommandHistoryMemoryUsage() const
+{
+	return comMan_.getMemoryUsage();
+}
+
 /********** Jam mode **********/
 void BambooTracker::toggleJamMode()
 {
@@ -1543,33 +1579,34 @@ void BambooTracker::jamkeyOffAll()
 bool BambooTracker::assignADPCMBeforeForcedJamKeyOn(
 		std::shared_ptr<AbstractInstrument> inst, std::unordered_map<int, std::array<size_t, 2>>& sampAddrs)
 {
-	size_t start, stop;
+	std::unordered_map<const std::vector<uint8_t>*, std::array<size_t, 2>> addrs;
 	bool isAssignedAll = false;
 	switch (inst->getType()) {
 	case InstrumentType::ADPCM:
 	{
-		opnaCtrl_->clearSamplesADPCM();
-		if (opnaCtrl_->storeSampleADPCM(
-					std::dynamic_pointer_cast<InstrumentADPCM>(inst)->getRawSample(), start, stop)) {
-			sampAddrs[0] = {{ start, stop }};
-			isAssignedAll = true;
-		}
+		SampleADPCMBuffer sample = std::dynamic_pointer_cast<InstrumentADPCM>(inst)->getRawSampleBuffer();
+		isAssignedAll = opnaCtrl_->storeSamplesADPCM({ sample }, addrs);
+		if (isAssignedAll) sampAddrs[0] = addrs.at(sample.get());
 		break;
 	}
 	case InstrumentType::Drumkit:
 	{
-		opnaCtrl_->clearSamplesADPCM();
-		std::vector<std::vector<size_t>> addrs;
-
 		auto kit = std::dynamic_pointer_cast<InstrumentDrumkit>(inst);
+		std::unordered_map<int, SampleADPCMBuffer> kitSamps;
+		std::vector<SampleADPCMBuffer> samples;
 		for (const int& key : kit->getAssignedKeys()) {
 			int n = kit->getSampleNumber(key);
-			if (!sampAddrs.count(n)) {
-				bool assigned = opnaCtrl_->storeSampleADPCM(kit->getRawSample(key), start, stop);
-				if (assigned) sampAddrs[n] = {{ start, stop }};
-				isAssignedAll &= assigned;
+			if (!kitSamps.count(n)) {
+				SampleADPCMBuffer sample = kit->getRawSampleBuffer(key);
+				kitSamps.emplace(n, sample);
+				samples.push_back(std::move(sample));
 			}
 		}
+		isAssignedAll = opnaCtrl_->storeSamplesADPCM(samples, addrs);
+		for (const auto& pair : kitSamps) {
+			auto&& it = addrs.find(pair.second.get());
+			if (it != addrs.end()) sampAddrs[pair.first] = it->second;
+		}
 		break;
 	}
 	default:
@@ -1725,71 +1762,19 @@ int BambooTracker::getMarkerStep() const
 }
 
 /********** Export **********/
-namespace
-{
-void checkNextPositionOfLastStepAndStepSize(Song& song, int& endOrder, int& endStep)
-{
-	endOrder = 0;
-	endStep = 0;
-
-	std::vector<TrackAttribute> attribs = song.getTrackAttributes();
-	std::unordered_set<int> orderStepMap;
-	int lastOrder = static_cast<int>(song.getOrderSize()) - 1;
-
-	for (int curOrder = 0; !orderStepMap.count(curOrder); curOrder = endOrder) {
-		orderStepMap.insert(curOrder);	// Arrived flag
-		// Default next order
-		endOrder = (endOrder + 1) % (lastOrder + 1);
-		endStep = 0;
-
-		// Check jump effect
-		for (auto attrib : attribs) {
-			Step& step = song.getTrack(attrib.number).getPatternFromOrderNumber(curOrder)
-						 .getStep(static_cast<int>(song.getPatternSizeFromOrderNumber(curOrder)) - 1);
-			for (int i = 0; i < Step::N_EFFECT; ++i) {
-				Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
-				switch (eff.type) {
-				case EffectType::PositionJump:
-					if (eff.value <= lastOrder) {
-						endOrder = eff.value;
-						endStep = 0;
-					}
-					break;
-				case EffectType::SongEnd:
-					endOrder = -1;
-					endStep = -1;
-					return;
-				case EffectType::PatternBreak:
-					if (curOrder == lastOrder
-							&& eff.value < static_cast<int>(song.getPatternSizeFromOrderNumber(0))) {
-						endOrder = 0;
-						endStep = eff.value;
-					}
-					else if (eff.value < static_cast<int>(song.getPatternSizeFromOrderNumber(curOrder + 1))) {
-						endOrder = curOrder + 1;
-						endStep = eff.value;
-					}
-					break;
-				default:
-					break;
-				}
-			}
-		}
-	}
-}
-}
-
-bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, ExportCancellCallback checkFunc)
+bool BambooTracker::exportToWav(io::WavStreamWriter& writer, int loopCnt, ExportCancellCallback checkFunc)
 {
 	int tmpRate = opnaCtrl_->getRate();
-	opnaCtrl_->setRate(static_cast<int>(container.getSampleRate()));
+	opnaCtrl_->setRate(static_cast<int>(writer.getSampleRate()));
+	bool tmpSilenceSkip = opnaCtrl_->isSilenceSkipEnabled();
+	opnaCtrl_->setSilenceSkipEnabled(false);	// Keep the exported samples exact
 	size_t sampCnt = static_cast<size_t>(opnaCtrl_->getRate() * opnaCtrl_->getDuration() / 1000);
 	size_t intrCnt = static_cast<size_t>(opnaCtrl_->getRate()) / mod_->getTickFrequency();
 	size_t intrCntRest = 0;
 	std::vector<int16_t> buf(sampCnt << 1);
 
 	int endOrder, endStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), endOrder, endStep);
+	timelines_[curSongNum_].loopPosition(*mod_, curSongNum_, endOrder, endStep);
 	bool endFlag = false;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
 	startPlayFromStart();
@@ -1800,11 +1785,17 @@ bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, Export
 			if (!intrCntRest) {	// Interruption
 				intrCntRest = intrCnt;    // Set counts to next interruption
 
-				if (!streamCountUp()) {
+				int state;
+				{
+					rt_alloc_check::RealTimeScope rtScope;
+					state = streamCountUp();
+				}
+				if (!state) {
 					if (checkFunc()) {	// Update lambda function
 						stopPlaySong();
 						isFollowPlay_ = tmpFollow;
 						opnaCtrl_->setRate(tmpRate);
+						opnaCtrl_->setSilenceSkipEnabled(tmpSilenceSkip);
 						return false;
 					}
 
@@ -1822,14 +1813,28 @@ bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, Export
 			sampCntRest -= count;
 			intrCntRest -= count;
 
-			bool result = opnaCtrl_->getStreamSamples(buf.data(), count);
+			bool result;
+			{
+				rt_alloc_check::RealTimeScope rtScope;
+				result = opnaCtrl_->getStreamSamples(buf.data(), count);
+			}
 			if (!result) {
 				stopPlaySong();
 				isFollowPlay_ = tmpFollow;
 				opnaCtrl_->setRate(tmpRate);
+				opnaCtrl_->setSilenceSkipEnabled(tmpSilenceSkip);
 				return false;
 			}
-			container.appendSample(buf.data(), count);
+			try {
+				writer.appendSample(buf.data(), count);
+			}
+			catch (...) {
+				stopPlaySong();
+				isFollowPlay_ = tmpFollow;
+				opnaCtrl_->setRate(tmpRate);
+				opnaCtrl_->setSilenceSkipEnabled(tmpSilenceSkip);
+				throw;
+			}
 		}
 
 		if (endFlag) break;
@@ -1838,6 +1843,8 @@ bool BambooTracker::exportToWav(io::WavContainer& container, int loopCnt, Export
 	stopPlaySong();
 	isFollowPlay_ = tmpFollow;
 	opnaCtrl_->setRate(tmpRate);
+	opnaCtrl_->setSilenceSkipEnabled(tmpSilenceSkip);
+	writer.finish();
 
 	return true;
 }
@@ -1854,7 +1861,7 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 	double intrCntRest = 0;
 
 	int loopOrder, loopStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), loopOrder, loopStep);
+	timelines_[curSongNum_].loopPosition(*mod_, curSongNum_, loopOrder, loopStep);
 	bool loopFlag = (loopOrder != -1);
 	int endCnt = (loopOrder == -1) ? 0 : 1;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
@@ -1864,17 +1871,25 @@ bool BambooTracker::exportToVgm(io::BinaryContainer& container, int target, bool
 	auto exCntr = std::make_shared<chip::VgmLogger>(target, mod_->getTickFrequency());
 
 	// Set ADPCM
+	// Pack samples from the top of the DRAM to keep the data block small
 	opnaCtrl_->clearSamplesADPCM();
+	std::vector<int> idcs = instMan_->getSampleADPCMValidIndices();
+	std::vector<SampleADPCMBuffer> samples;
+	samples.reserve(idcs.size());
+	for (auto sampNum : idcs) samples.push_back(instMan_->getSampleADPCMRawSampleBuffer(sampNum));
+	std::unordered_map<const std::vector<uint8_t>*, std::array<size_t, 2>> addrs;
+	opnaCtrl_->storeSamplesADPCM(samples, addrs);
+
 	std::vector<uint8_t> rom;
-	for (auto sampNum : instMan_->getSampleADPCMValidIndices()) {
-		std::vector<uint8_t>&& sample = instMan_->getSampleADPCMRawSample(sampNum);
-		size_t startAddr, stopAddr;
-		if (opnaCtrl_->storeSampleADPCM(sample, startAddr, stopAddr)) {
-			instMan_->setSampleADPCMStartAddress(sampNum, startAddr);
-			instMan_->setSampleADPCMStopAddress(sampNum, stopAddr);
-			rom.resize((stopAddr + 1) << 5);
-			std::copy(sample.begin(), sample.end(), rom.begin() + static_cast<int>(startAddr << 5));
-		}
+	for (size_t i = 0; i < idcs.size(); ++i) {
+		auto&& it = addrs.find(samples[i].get());
+		if (it == addrs.end()) continue;
+		size_t startAddr = it->second[0], stopAddr = it->second[1];
+		instMan_->setSampleADPCMStartAddress(idcs[i], startAddr);
+		instMan_->setSampleADPCMStopAddress(idcs[i], stopAddr);
+		size_t begin = startAddr << 5, end = (stopAddr + 1) << 5;
+		if (rom.size() < end) rom.resize(end);
+		std::copy_n(samples[i]->begin(), std::min(samples[i]->size(), end - begin), rom.begin() + static_cast<int>(begin));
 	}
 	exCntr->setDataBlock(std::move(rom));
 
@@ -1941,7 +1956,7 @@ bool BambooTracker::exportToS98(io::BinaryContainer& container, int target, bool
 	double intrCntRest = 0;
 
 	int loopOrder, loopStep;
-	checkNextPositionOfLastStepAndStepSize(mod_->getSong(curSongNum_), loopOrder, loopStep);
+	timelines_[curSongNum_].loopPosition(*mod_, curSongNum_, loopOrder, loopStep);
 	bool loopFlag = (loopOrder != -1);
 	int endCnt = (loopOrder == -1) ? 0 : 1;
 	bool tmpFollow = std::exchange(isFollowPlay_, false);
@@ -2010,7 +2025,9 @@ bool BambooTracker::hasConnectedToRealChip() const
 /********** Stream events **********/
 int BambooTracker::streamCountUp()
 {
+	auto begin = isStreamProfiling_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
 	int state = playback_->streamCountUp();
+	if (isStreamProfiling_) sequencingTime_ += std::chrono::steady_clock::now() - begin;
 	if (!state && isFollowPlay_ && !playback_->isPlayingStep()) {	// Step
 		int odr = playback_->getPlayingOrderNumber();
 		if (odr >= 0) {
@@ -2083,6 +2100,25 @@ void BambooTracker::setMasterVolumeSSG(double dB)
 	opnaCtrl_->setMasterVolumeSSG(dB);
 }
 
+/********** Profiling **********/
+void BambooTracker::setStreamProfilingEnabled(bool enabled)
+{
+	isStreamProfiling_ = enabled;
+	opnaCtrl_->setStageProfilingEnabled(enabled);
+}
+
+StreamProfile BambooTracker::getStreamProfile() const
+{
+	return { sequencingTime_, opnaCtrl_->getMixStageProfile(), opnaCtrl_->getRegisterWriteStatistics() };
+}
+
+void BambooTracker::resetStreamProfile()
+{
+	sequencingTime_ = std::chrono::nanoseconds::zero();
+	opnaCtrl_->resetMixStageProfile();
+	opnaCtrl_->resetRegisterWriteStatistics();
+}
+
 /********** Module details **********/
 /*----- Module -----*/
 void BambooTracker::makeNewModule()
@@ -2099,6 +2135,7 @@ void BambooTracker::makeNewModule(bool withInstrument)
 	opnaCtrl_->reset();
 
 	mod_ = std::make_shared<Module>();
+	timelines_.clear();
 
 	tickCounter_->setInterruptRate(mod_->getTickFrequency());
 
@@ -2115,7 +2152,7 @@ void BambooTracker::makeNewModule(bool withInstrument)
 	clearCommandHistory();
 }
 
-void BambooTracker::loadModule(io::BinaryContainer& container)
+void BambooTracker::loadModule(const io::BinaryContainer& container)
 {
 	makeNewModule(false);
 
@@ -2126,6 +2163,7 @@ void BambooTracker::loadModule(io::BinaryContainer& container)
 	catch (...) {
 		ep = std::current_exception();
 	}
+	timelines_.clear();
 
 	tickCounter_->setInterruptRate(mod_->getTickFrequency());
 	setCurrentSongNumber(0);
@@ -2193,6 +2231,7 @@ void BambooTracker::setModuleTickFrequency(unsigned int freq)
 {
 	mod_->setTickFrequency(freq);
 	tickCounter_->setInterruptRate(freq);
+	invalidateTimelineResults();
 }
 
 unsigned int BambooTracker::getModuleTickFrequency() const
@@ -2258,11 +2297,15 @@ size_t BambooTracker::getGrooveCount() const
 void BambooTracker::setGroove(int num, const std::vector<int>& seq)
 {
 	mod_->setGroove(num, seq);
+	invalidatePlaybackStates(curSongNum_);
+	invalidateTimelineResults();
 }
 
 void BambooTracker::setGrooves(const std::vector<std::vector<int>>& seqs)
 {
 	mod_->setGrooves(seqs);
+	invalidatePlaybackStates(curSongNum_);
+	invalidateTimelineResults();
 }
 
 std::vector<int> BambooTracker::getGroove(int num) const
@@ -2279,6 +2322,7 @@ std::unordered_map<int, int> BambooTracker::replaceDuplicateInstrumentsInPattern
 {
 	std::unordered_map<int, int> map = instMan_->getDuplicateInstrumentMap();
 	mod_->replaceDuplicateInstrumentsInPatterns(map);
+	invalidatePlaybackStates(curSongNum_);
 	return map;
 }
 
@@ -2301,6 +2345,7 @@ std::string BambooTracker::getSongTitle(int songNum) const
 void BambooTracker::setSongTempo(int songNum, int tempo)
 {
 	mod_->getSong(songNum).setTempo(tempo);
+	invalidateTimelineResults();
 	if (curSongNum_ == songNum) tickCounter_->setTempo(tempo);
 }
 
@@ -2312,6 +2357,7 @@ int BambooTracker::getSongTempo(int songNum) const
 void BambooTracker::setSongGroove(int songNum, int groove)
 {
 	mod_->getSong(songNum).setGroove(groove);
+	invalidateTimelineResults();
 	tickCounter_->setGroove(mod_->getGroove(groove));
 }
 
@@ -2323,6 +2369,7 @@ int BambooTracker::getSongGroove(int songNum) const
 void BambooTracker::toggleTempoOrGrooveInSong(int songNum, bool isTempo)
 {
 	mod_->getSong(songNum).toggleTempoOrGroove(isTempo);
+	invalidateTimelineResults();
 	tickCounter_->setGrooveState(isTempo ? GrooveState::Invalid
 										 : GrooveState::ValidByGlobal);
 }
@@ -2340,11 +2387,13 @@ SongStyle BambooTracker::getSongStyle(int songNum) const
 void BambooTracker::changeSongType(int songNum, SongType type)
 {
 	mod_->getSong(songNum).changeType(type);
+	invalidatePlaybackStates(songNum);
 }
 
 void BambooTracker::setSongSpeed(int songNum, int speed)
 {
 	mod_->getSong(songNum).setSpeed(speed);
+	invalidateTimelineResults();
 	if (curSongNum_ == songNum) tickCounter_->setSpeed(speed);
 }
 
@@ -2366,29 +2415,31 @@ void BambooTracker::addSong(SongType songType, const std::string& title)
 void BambooTracker::sortSongs(const std::vector<int>& numbers)
 {
 	mod_->sortSongs(std::move(numbers));
+	timelines_.clear();
+	invalidatePlaybackStates(curSongNum_);
 }
 
 void BambooTracker::transposeSong(int songNum, int semitones, const std::vector<int>& excludeInsts)
 {
 	mod_->getSong(songNum).transpose(semitones, excludeInsts);
+	invalidatePlaybackStates(songNum);
 }
 
 void BambooTracker::swapTracks(int songNum, int track1, int track2)
 {
 	mod_->getSong(songNum).swapTracks(track1, track2);
+	invalidatePlaybackStates(songNum);
 }
 
 double BambooTracker::estimateSongLength(int songNum) const
 {
-	SongLengthCalculator calc(*mod_.get(), songNum);
-	return calc.approximateLengthBySecond();
+	return timelines_[songNum].approximateLengthBySecond(*mod_, songNum);
 }
 
 size_t BambooTracker::getTotalStepCount(int songNum, size_t loopCnt) const
 {
 	size_t introSize, loopSize;
-	SongLengthCalculator calc(*mod_.get(), songNum);
-	calc.totalStepCount(introSize, loopSize);
+	timelines_[songNum].totalStepCount(*mod_, songNum, introSize, loopSize);
 	return introSize + loopSize * loopCnt;
 }
 
@@ -2517,17 +2568,17 @@ std::vector<OrderInfo> BambooTracker::getOrderData(int songNum, int orderNum) co
 
 void BambooTracker::setOrderPatternDigit(int songNum, int trackNum, int orderNum, int patternNum, bool secondEntry)
 {
-	comMan_.invoke(std::make_unique<SetPatternToOrderCommand>(mod_, songNum, trackNum, orderNum, patternNum, secondEntry));
+	comMan_.invoke(std::make_unique<SetPatternToOrderCommand>(mod_, songNum, trackNum, orderNum, patternNum, secondEntry), CommandScope(songNum, orderNum));
 }
 
 void BambooTracker::insertOrderBelow(int songNum, int orderNum)
 {
-	comMan_.invoke(std::make_unique<InsertOrderBelowCommand>(mod_, songNum, orderNum));
+	comMan_.invoke(std::make_unique<InsertOrderBelowCommand>(mod_, songNum, orderNum), CommandScope(songNum, orderNum));
 }
 
 void BambooTracker::deleteOrder(int songNum, int orderNum)
 {
-	comMan_.invoke(std::make_unique<DeleteOrderCommand>(mod_, songNum, orderNum));
+	comMan_.invoke(std::make_unique<DeleteOrderCommand>(mod_, songNum, orderNum), CommandScope(songNum, orderNum));
 }
 
 void BambooTracker::pasteOrderCells(int songNum, int beginTrack, int beginOrder,
@@ -2540,27 +2591,27 @@ void BambooTracker::pasteOrderCells(int songNum, int beginTrack, int beginOrder,
 	std::vector<std::vector<std::string>> d(h);
 	for (size_t i = 0; i < h; ++i) d[i].assign(cells[i].begin(), cells[i].begin() + w);
 
-	comMan_.invoke(std::make_unique<PasteCopiedDataToOrderCommand>(mod_, songNum, beginTrack, beginOrder, std::move(d)));
+	comMan_.invoke(std::make_unique<PasteCopiedDataToOrderCommand>(mod_, songNum, beginTrack, beginOrder, std::move(d)), CommandScope(songNum, beginOrder));
 }
 
 void BambooTracker::duplicateOrder(int songNum, int orderNum)
 {
-	comMan_.invoke(std::make_unique<DuplicateOrderCommand>(mod_, songNum, orderNum));
+	comMan_.invoke(std::make_unique<DuplicateOrderCommand>(mod_, songNum, orderNum), CommandScope(songNum, orderNum));
 }
 
 void BambooTracker::MoveOrder(int songNum, int orderNum, bool isUp)
 {
-	comMan_.invoke(std::make_unique<MoveOrderCommand>(mod_, songNum, orderNum, isUp));
+	comMan_.invoke(std::make_unique<MoveOrderCommand>(mod_, songNum, orderNum, isUp), CommandScope(songNum, isUp ? orderNum - 1 : orderNum));
 }
 
 void BambooTracker::clonePatterns(int songNum, int beginOrder, int beginTrack, int endOrder, int endTrack)
 {
-	comMan_.invoke(std::make_unique<ClonePatternsCommand>(mod_, songNum, beginOrder, beginTrack, endOrder, endTrack));
+	comMan_.invoke(std::make_unique<ClonePatternsCommand>(mod_, songNum, beginOrder, beginTrack, endOrder, endTrack), CommandScope(songNum, beginOrder));
 }
 
 void BambooTracker::cloneOrder(int songNum, int orderNum)
 {
-	comMan_.invoke(std::make_unique<CloneOrderCommand>(mod_, songNum, orderNum));
+	comMan_.invoke(std::make_unique<CloneOrderCommand>(mod_, songNum, orderNum), CommandScope(songNum, orderNum));
 }
 
 size_t BambooTracker::getOrderSize(int songNum) const
@@ -2592,27 +2643,27 @@ void BambooTracker::setStepNote(int songNum, int trackNum, int orderNum, int ste
 	}
 	bool fmReversed = (volFMReversed_ && src == SoundSource::FM);
 
-	comMan_.invoke(std::make_unique<SetKeyOnToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, nn, instMask, in, volMask, curVolume_, fmReversed));
+	comMan_.invoke(std::make_unique<SetKeyOnToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, nn, instMask, in, volMask, curVolume_, fmReversed), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::setStepKeyOff(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<SetKeyOffToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<SetKeyOffToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::setStepKeyCut(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<SetKeyCutToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<SetKeyCutToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::setEchoBufferAccess(int songNum, int trackNum, int orderNum, int stepNum, int bufNum)
 {
-	comMan_.invoke(std::make_unique<SetEchoBufferAccessCommand>(mod_, songNum, trackNum, orderNum, stepNum, bufNum));
+	comMan_.invoke(std::make_unique<SetEchoBufferAccessCommand>(mod_, songNum, trackNum, orderNum, stepNum, bufNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::eraseStepNote(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<EraseStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<EraseStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 int BambooTracker::getStepInstrument(int songNum, int trackNum, int orderNum, int stepNum) const
@@ -2623,12 +2674,12 @@ int BambooTracker::getStepInstrument(int songNum, int trackNum, int orderNum, in
 
 void BambooTracker::setStepInstrumentDigit(int songNum, int trackNum, int orderNum, int stepNum, int instNum, bool secondEntry)
 {
-	comMan_.invoke(std::make_unique<SetInstrumentToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, instNum, secondEntry));
+	comMan_.invoke(std::make_unique<SetInstrumentToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, instNum, secondEntry), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::eraseStepInstrument(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<EraseInstrumentInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<EraseInstrumentInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 int BambooTracker::getStepVolume(int songNum, int trackNum, int orderNum, int stepNum) const
@@ -2641,7 +2692,7 @@ int BambooTracker::setStepVolumeDigit(int songNum, int trackNum, int orderNum, i
 {	
 	bool fmReversed = (volFMReversed_
 					   && songStyle_.trackAttribs.at(static_cast<size_t>(trackNum)).source == SoundSource::FM);
-	comMan_.invoke(std::make_unique<SetVolumeToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, volume, fmReversed, secondEntry));
+	comMan_.invoke(std::make_unique<SetVolumeToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, volume, fmReversed, secondEntry), CommandScope(songNum, trackNum, trackNum, orderNum));
 	curVolume_ = mod_->getSong(songNum).getTrack(trackNum).getPatternFromOrderNumber(orderNum).getStep(stepNum).getVolume();
 	if (fmReversed) curVolume_ = effect_utils::reverseFmVolume(curVolume_);
 	return curVolume_;
@@ -2649,7 +2700,7 @@ int BambooTracker::setStepVolumeDigit(int songNum, int trackNum, int orderNum, i
 
 void BambooTracker::eraseStepVolume(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<EraseVolumeInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<EraseVolumeInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 std::string BambooTracker::getStepEffectID(int songNum, int trackNum, int orderNum, int stepNum, int n) const
@@ -2660,7 +2711,7 @@ std::string BambooTracker::getStepEffectID(int songNum, int trackNum, int orderN
 
 void BambooTracker::setStepEffectIDCharacter(int songNum, int trackNum, int orderNum, int stepNum, int n, const std::string& id, bool fillValue00, bool secondEntry)
 {
-	comMan_.invoke(std::make_unique<SetEffectIDToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n, id, fillValue00, secondEntry));
+	comMan_.invoke(std::make_unique<SetEffectIDToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n, id, fillValue00, secondEntry), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 int BambooTracker::getStepEffectValue(int songNum, int trackNum, int orderNum, int stepNum, int n) const
@@ -2671,98 +2722,115 @@ int BambooTracker::getStepEffectValue(int songNum, int trackNum, int orderNum, i
 
 void BambooTracker::setStepEffectValueDigit(int songNum, int trackNum, int orderNum, int stepNum, int n, int value, EffectDisplayControl ctrl, bool secondEntry)
 {
-	comMan_.invoke(std::make_unique<SetEffectValueToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n, value, ctrl, secondEntry));
+	comMan_.invoke(std::make_unique<SetEffectValueToStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n, value, ctrl, secondEntry), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::eraseStepEffect(int songNum, int trackNum, int orderNum, int stepNum, int n)
 {
-	comMan_.invoke(std::make_unique<EraseEffectInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n));
+	comMan_.invoke(std::make_unique<EraseEffectInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::eraseStepEffectValue(int songNum, int trackNum, int orderNum, int stepNum, int n)
 {
-	comMan_.invoke(std::make_unique<EraseEffectValueInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n));
+	comMan_.invoke(std::make_unique<EraseEffectValueInStepCommand>(mod_, songNum, trackNum, orderNum, stepNum, n), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::insertStep(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<InsertStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<InsertStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 void BambooTracker::deletePreviousStep(int songNum, int trackNum, int orderNum, int stepNum)
 {
-	comMan_.invoke(std::make_unique<DeletePreviousStepCommand>(mod_, songNum, trackNum, orderNum, stepNum));
+	comMan_.invoke(std::make_unique<DeletePreviousStepCommand>(mod_, songNum, trackNum, orderNum, stepNum), CommandScope(songNum, trackNum, trackNum, orderNum));
 }
 
 namespace
 {
-std::vector<std::vector<std::string>> arrangePatternDataCells(
-		size_t trackCnt, size_t ptnSize, int beginTrack, int beginColmn, int beginStep,
-		const std::vector<std::vector<std::string>>& cells)
+PatternCellBlock arrangePatternDataCells(size_t trackCnt, size_t ptnSize, int beginTrack, int beginColmn,
+										 int beginStep, const PatternCellBlock& cells)
 {
-	size_t w = (trackCnt - static_cast<size_t>(beginTrack) - 1) * 11
-			   + (11 - static_cast<size_t>(beginColmn));
+	size_t w = (trackCnt - static_cast<size_t>(beginTrack) - 1) * Step::N_COLUMN
+			   + (Step::N_COLUMN - static_cast<size_t>(beginColmn));
 	size_t h = ptnSize - static_cast<size_t>(beginStep);
+	return cells.cropped(w, h);
+}
+}
 
-	size_t width = std::min(cells.at(0).size(), w);
-	size_t height = std::min(cells.size(), h);
-
-	std::vector<std::vector<std::string>> d(height);
+PatternCellBlock BambooTracker::getPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder,
+												int beginStep, size_t width, size_t height) const
+{
+	Song& song = mod_->getSong(songNum);
+	PatternCellBlock cells(width, height);
 	for (size_t i = 0; i < height; ++i) {
-		d[i].assign(cells[i].begin(), cells[i].begin() + width);
+		int t = beginTrack;
+		int c = beginColmn;
+		int s = beginStep + static_cast<int>(i);
+		for (size_t j = 0; j < width; ++j) {
+			const Step& step = song.getTrack(t).getPatternFromOrderNumber(beginOrder).getStep(s);
+			cells.at(i, j) = PatternCellBlock::readCell(step, c);
+
+			t += (++c / Step::N_COLUMN);
+			c %= Step::N_COLUMN;
+		}
 	}
-	return d;
-}
+	return cells;
 }
 
 void BambooTracker::pastePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
-									  const std::vector<std::vector<std::string>>& cells)
+									  const PatternCellBlock& cells)
 {
 	auto d = arrangePatternDataCells(songStyle_.trackAttribs.size(), getPatternSizeFromOrderNumber(songNum, beginOrder),
 									 beginTrack, beginColmn, beginStep, cells);
 	comMan_.invoke(std::make_unique<PasteCopiedDataToPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)),
+				   CommandScope(songNum, beginTrack, static_cast<int>(songStyle_.trackAttribs.size()) - 1, beginOrder));
 }
 
 void BambooTracker::pasteMixPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
-										 const std::vector<std::vector<std::string> >& cells)
+										 const PatternCellBlock& cells)
 {
 	auto d = arrangePatternDataCells(songStyle_.trackAttribs.size(), getPatternSizeFromOrderNumber(songNum, beginOrder),
 									 beginTrack, beginColmn, beginStep, cells);
 	comMan_.invoke(std::make_unique<PasteMixCopiedDataToPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)),
+				   CommandScope(songNum, beginTrack, static_cast<int>(songStyle_.trackAttribs.size()) - 1, beginOrder));
 }
 
 void BambooTracker::pasteOverwritePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder,
-											   int beginStep, const std::vector<std::vector<std::string> >& cells)
+											   int beginStep, const PatternCellBlock& cells)
 {
 	auto d = arrangePatternDataCells(songStyle_.trackAttribs.size(), getPatternSizeFromOrderNumber(songNum, beginOrder),
 									 beginTrack, beginColmn, beginStep, cells);
 	comMan_.invoke(std::make_unique<PasteOverwriteCopiedDataToPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)),
+				   CommandScope(songNum, beginTrack, static_cast<int>(songStyle_.trackAttribs.size()) - 1, beginOrder));
 }
 
 void BambooTracker::pasteInsertPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder,
-											int beginStep, const std::vector<std::vector<std::string> >& cells)
+											int beginStep, const PatternCellBlock& cells)
 {
 	auto d = arrangePatternDataCells(songStyle_.trackAttribs.size(), getPatternSizeFromOrderNumber(songNum, beginOrder),
 									 beginTrack, beginColmn, beginStep, cells);
 	comMan_.invoke(std::make_unique<PasteInsertCopiedDataToPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, std::move(d)),
+				   CommandScope(songNum, beginTrack, static_cast<int>(songStyle_.trackAttribs.size()) - 1, beginOrder));
 }
 
 void BambooTracker::erasePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 									  int endTrack, int endColmn, int endStep)
 {
 	comMan_.invoke(std::make_unique<EraseCellsInPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::transposeNoteInPattern(int songNum, int beginTrack, int beginOrder, int beginStep,
 										   int endTrack, int endStep, int semitone)
 {
 	comMan_.invoke(std::make_unique<TransposeNoteInPatternCommand>(
-					   mod_, songNum, beginTrack, beginOrder, beginStep, endTrack, endStep, semitone));
+					   mod_, songNum, beginTrack, beginOrder, beginStep, endTrack, endStep, semitone),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::changeValuesInPattern(int songNum, int beginTrack, int beginColumn, int beginOrder,
@@ -2770,42 +2838,48 @@ void BambooTracker::changeValuesInPattern(int songNum, int beginTrack, int begin
 {
 	comMan_.invoke(std::make_unique<ChangeValuesInPatternCommand>(
 					   mod_, songNum, beginTrack, beginColumn, beginOrder, beginStep,
-					   endTrack, endColumn, endStep, value, volFMReversed_));
+					   endTrack, endColumn, endStep, value, volFMReversed_),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::expandPattern(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 								  int endTrack, int endColmn, int endStep)
 {
 	comMan_.invoke(std::make_unique<ExpandPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::shrinkPattern(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 								  int endTrack, int endColmn, int endStep)
 {
 	comMan_.invoke(std::make_unique<ShrinkPatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::interpolatePattern(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 									   int endTrack, int endColmn, int endStep)
 {
 	comMan_.invoke(std::make_unique<InterpolatePatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::reversePattern(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 								   int endTrack, int endColmn, int endStep)
 {
 	comMan_.invoke(std::make_unique<ReversePatternCommand>(
-					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep));
+					   mod_, songNum, beginTrack, beginColmn, beginOrder, beginStep, endTrack, endColmn, endStep),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 void BambooTracker::replaceInstrumentInPattern(int songNum, int beginTrack, int beginOrder, int beginStep,
 											   int endTrack, int endStep, int newInstNum)
 {
 	comMan_.invoke(std::make_unique<ReplaceInstrumentInPatternCommand>(
-					   mod_, songNum, beginTrack, beginOrder, beginStep, endTrack, endStep, newInstNum));
+					   mod_, songNum, beginTrack, beginOrder, beginStep, endTrack, endStep, newInstNum),
+				   CommandScope(songNum, beginTrack, endTrack, beginOrder));
 }
 
 size_t BambooTracker::getPatternSizeFromOrderNumber(int songNum, int orderNum) const
@@ -2816,6 +2890,7 @@ size_t BambooTracker::getPatternSizeFromOrderNumber(int songNum, int orderNum) c
 void BambooTracker::setDefaultPatternSize(int songNum, size_t size)
 {
 	mod_->getSong(songNum).setDefaultPatternSize(size);
+	invalidatePlaybackStates(songNum);
 	playback_->checkPlayPosition(static_cast<int>(size));
 }
 
@@ -2828,3 +2903,33 @@ void BambooTracker::getOutputHistory(int16_t* container)
 {
 	opnaCtrl_->getOutputHistory(container);
 }
+
+void BambooTracker::invalidatePlaybackStates(int songNum, int orderNum)
+{
+	playback_->invalidateChannelStates(songNum, orderNum);
+	auto it = timelines_.find(songNum);
+	if (it != timelines_.end()) it->second.invalidate(orderNum);
+}
+
+void BambooTracker::invalidatePlaybackStates(int songNum, int beginTrack, int endTrack, int orderNum)
+{
+	// Patterns may be shared by earlier orders
+	Song& song = mod_->getSong(songNum);
+	int first = orderNum;
+	for (int t = beginTrack; t <= endTrack; ++t) {
+		Track& track = song.getTrack(t);
+		int ptn = track.getOrderInfo(orderNum).patten;
+		for (int o = 0; o < first; ++o) {
+			if (track.getOrderInfo(o).patten == ptn) {
+				first = o;
+				break;
+			}
+		}
+	}
+	invalidatePlaybackStates(songNum, first);
+}
+
+void BambooTracker::invalidateTimelineResults()
+{
+	for (auto& pair : timelines_) pair.second.invalidateResults();
+}
@@ -33,15 +33,20 @@
 #include <unordered_map>
 #include <set>
 #include <array>
+#include <chrono>
 #include "jamming.hpp"
 #include "instrument.hpp"
 #include "instrument/sample_repeat.hpp"
 #include "module.hpp"
+#include "pattern_cell_block.hpp"
+#include "song_timeline.hpp"
 #include "command/command_manager.hpp"
 #include "chip/real_chip_interface.hpp"
+#include "chip/opna.hpp"
 #include "io/binary_container.hpp"
 #include "io/export_io.hpp"
 #include "io/wav_container.hpp"
+#include "io/wav_stream_writer.hpp"
 #include "bamboo_tracker_defs.hpp"
 #include "enum_hash.hpp"
 
@@ -53,6 +58,14 @@ class PlaybackManager;
 class TickCounter;
 class SampleRepeatRange;
 
+/// Time spent in each stage of the stream since profiling was enabled.
+struct StreamProfile
+{
+	std::chrono::nanoseconds sequencing;	///< Tick processing in streamCountUp
+	chip::MixStageProfile mix;
+	chip::RegisterWriteStatistics registerWrites;
+};
+
 class BambooTracker
 {
 public:
@@ -317,6 +330,10 @@ public:
 	void undo();
 	void redo();
 	void clearCommandHistory();
+	/// False when the history is empty or its older commands were discarded by the memory limit.
+	bool canUndo() const;
+	size_t getUndoCount() const;
+	size_t getCommandHistoryMemoryUsage() const;
 
 	// Jam mode
 	void toggleJamMode();
@@ -354,7 +371,7 @@ public:
 
 	// Export
 	using ExportCancellCallback = std::function<bool()>;
-	bool exportToWav(io::WavContainer& container, int loopCnt, ExportCancellCallback checkFunc);
+	bool exportToWav(io::WavStreamWriter& writer, int loopCnt, ExportCancellCallback checkFunc);
 	bool exportToVgm(io::BinaryContainer& container, int target, bool gd3TagEnabled,
 					 const io::GD3Tag& tag, bool shouldSetMix, double gain, ExportCancellCallback checkFunc);
 	bool exportToS98(io::BinaryContainer& container, int target, bool tagEnabled,
@@ -391,10 +408,15 @@ public:
 	void setMasterVolumeFM(double dB);
 	void setMasterVolumeSSG(double dB);
 
+	// Profiling
+	void setStreamProfilingEnabled(bool enabled);
+	StreamProfile getStreamProfile() const;
+	void resetStreamProfile();
+
 	// Module details
 	/*----- Module -----*/
 	void makeNewModule();
-	void loadModule(io::BinaryContainer& container);
+	void loadModule(const io::BinaryContainer& container);
 	void saveModule(io::BinaryContainer& container);
 	void setModulePath(const std::string& path);
 	std::string getModulePath() const;
@@ -511,14 +533,16 @@ public:
 	///		2: volume
 	///		3: effect ID
 	///		4: effect value
+	PatternCellBlock getPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
+									 size_t width, size_t height) const;
 	void pastePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
-						   const std::vector<std::vector<std::string>>& cells);
+						   const PatternCellBlock& cells);
 	void pasteMixPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
-							  const std::vector<std::vector<std::string>>& cells);
+							  const PatternCellBlock& cells);
 	void pasteOverwritePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder,
-									int beginStep, const std::vector<std::vector<std::string>>& cells);
+									int beginStep, const PatternCellBlock& cells);
 	void pasteInsertPatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder,
-								 int beginStep, const std::vector<std::vector<std::string>>& cells);
+								 int beginStep, const PatternCellBlock& cells);
 	void erasePatternCells(int songNum, int beginTrack, int beginColmn, int beginOrder, int beginStep,
 						   int endTrack, int endColmn, int endStep);
 	void transposeNoteInPattern(int songNum, int beginTrack, int beginOrder, int beginStep,
@@ -566,6 +590,11 @@ private:
 	bool isFollowPlay_;
 	bool storeOnlyUsedSamples_;
 
+	mutable std::unordered_map<int, SongTimeline> timelines_;
+
+	bool isStreamProfiling_;
+	std::chrono::nanoseconds sequencingTime_;
+
 	// Module details
 	void makeNewModule(bool withInstrument);
 
@@ -576,4 +605,12 @@ private:
 
 	// Play song
 	void startPlay();
+
+	// Song edit
+	/// Discard the playback caches built from the edited order and later ones.
+	void invalidatePlaybackStates(int songNum, int orderNum = 0);
+	/// Same as above, but also covers earlier orders sharing the edited patterns.
+	void invalidatePlaybackStates(int songNum, int beginTrack, int endTrack, int orderNum);
+	/// Discard the song lengths and step counts after changes of the speed settings.
+	void invalidateTimelineResults();
 };
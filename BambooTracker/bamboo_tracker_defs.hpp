@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 enum class SoundSource : int
 {
 	FM = 1,
@@ -33,6 +35,20 @@ enum class SoundSource : int
 	ADPCM = 8
 };
 
+/// Containers for each sound source are indexed by soundSourceIndex().
+constexpr size_t N_SOUND_SOURCE = 4;
+
+constexpr size_t soundSourceIndex(SoundSource src) noexcept
+{
+	switch (src) {
+	default:
+	case SoundSource::FM:		return 0;
+	case SoundSource::SSG:		return 1;
+	case SoundSource::RHYTHM:	return 2;
+	case SoundSource::ADPCM:	return 3;
+	}
+}
+
 namespace bt_defs
 {
 constexpr int OUTPUT_HISTORY_SIZE = 1024;
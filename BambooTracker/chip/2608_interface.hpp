@@ -17,7 +17,10 @@ public:
 	virtual void writeDataToPortA(uint8_t data) = 0;
 	virtual void writeDataToPortB(uint8_t data) = 0;
 	virtual uint8_t readData() = 0;
+	/// Load data into the ADPCM DRAM directly, bypassing the memory write registers.
+	virtual void writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length) = 0;
 	virtual void updateStream(sample** outputs, int nSamples) = 0;
-	virtual void updateSsgStream(sample** outputs, int nSamples) = 0;
+	/// SSG output is mono.
+	virtual void updateSsgStream(sample* output, int nSamples) = 0;
 };
 }
@@ -103,7 +103,7 @@ void Chip::updateVolumeRatio()
 
 void Chip::updateVolumeRatio(int i)
 {
-	volumeRatio_[i] = busVolumeRatio_[i] * masterVolumeRatio_;
+	volumeRatio_[i].store(busVolumeRatio_[i] * masterVolumeRatio_, std::memory_order_relaxed);
 }
 
 void Chip::setMaxDuration(size_t maxDuration)
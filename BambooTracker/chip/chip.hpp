@@ -29,6 +29,7 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 namespace chip
 {
@@ -74,7 +75,7 @@ protected:
 
 	double masterVolumeRatio_;
 	double busVolumeRatio_[2];
-	double volumeRatio_[2];
+	std::atomic<double> volumeRatio_[2];	// Read by the mixer without locking
 
 	sample* buffer_[2][2];
 	std::unique_ptr<AbstractResampler> resampler_[2];
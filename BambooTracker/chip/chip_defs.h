@@ -32,3 +32,7 @@ typedef int32_t	sample;
 enum { CHIP_SMPL_BUF_SIZE_ = 0x10000 };
 
 enum Stereo { STEREO_LEFT, STEREO_RIGHT };
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHIP_USE_SSE2
+#endif
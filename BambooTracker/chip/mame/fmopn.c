@@ -204,12 +204,12 @@
 *   TL_RES_LEN - sinus resolution (X axis)
 */
 #define TL_TAB_LEN (13*2*TL_RES_LEN)
-static signed int tl_tab[TL_TAB_LEN];
 
-#define ENV_QUIET       (TL_TAB_LEN>>3)
+/* tl_tab, sin_tab, lfo_pm_table and jedi_table are read-only data generated
+   by scripts/gen_fmopn_tables.py, so every chip instance can share them */
+#include "fmopn_tables.h"
 
-/* sin waveform table in 'decibel' scale */
-static unsigned int sin_tab[SIN_LEN];
+#define ENV_QUIET       (TL_TAB_LEN>>3)
 
 /* sustain level table (3dB per step) */
 /* bit0, bit1, bit2, bit3, bit4, bit5, bit6 */
@@ -414,11 +414,11 @@ static const UINT8 lfo_ams_depth_shift[4] = {8, 3, 1, 0};
   Modulation level at each depth depends on F-NUMBER bits: 4,5,6,7,8,9,10
   (bits 8,9,10 = FNUM MSB from OCT/FNUM register)
 
-  Here we store only first quarter (positive one) of full waveform.
-  Full table (lfo_pm_table) containing all 128 waveforms is build
-  at run (init) time.
+  The first quarter (positive one) of full waveform is stored in
+  "lfo_pm_output" of scripts/gen_fmopn_tables.py, which generates
+  the full table (lfo_pm_table) containing all 128 waveforms.
 
-  One value in table below represents 4 (four) basic LFO steps
+  One value in lfo_pm_output represents 4 (four) basic LFO steps
   (1 PM step = 4 AM steps).
 
   For example:
@@ -426,84 +426,8 @@ static const UINT8 lfo_ams_depth_shift[4] = {8, 3, 1, 0};
    one value from "lfo_pm_output" table lasts for 432 consecutive
    samples (4*108=432) and one full LFO waveform cycle lasts for 13824
    samples (32*432=13824; 32 because we store only a quarter of whole
-            waveform in the table below)
+            waveform in lfo_pm_output)
 */
-static const UINT8 lfo_pm_output[7*8][8]={
-/* 7 bits meaningful (of F-NUMBER), 8 LFO output levels per one depth (out of 32), 8 LFO depths */
-/* FNUM BIT 4: 000 0001xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 2 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 3 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 4 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 5 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 6 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 7 */ {0,   0,   0,   0,   1,   1,   1,   1},
-
-/* FNUM BIT 5: 000 0010xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 2 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 3 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 4 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 5 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 6 */ {0,   0,   0,   0,   1,   1,   1,   1},
-/* DEPTH 7 */ {0,   0,   1,   1,   2,   2,   2,   3},
-
-/* FNUM BIT 6: 000 0100xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 2 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 3 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 4 */ {0,   0,   0,   0,   0,   0,   0,   1},
-/* DEPTH 5 */ {0,   0,   0,   0,   1,   1,   1,   1},
-/* DEPTH 6 */ {0,   0,   1,   1,   2,   2,   2,   3},
-/* DEPTH 7 */ {0,   0,   2,   3,   4,   4,   5,   6},
-
-/* FNUM BIT 7: 000 1000xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 2 */ {0,   0,   0,   0,   0,   0,   1,   1},
-/* DEPTH 3 */ {0,   0,   0,   0,   1,   1,   1,   1},
-/* DEPTH 4 */ {0,   0,   0,   1,   1,   1,   1,   2},
-/* DEPTH 5 */ {0,   0,   1,   1,   2,   2,   2,   3},
-/* DEPTH 6 */ {0,   0,   2,   3,   4,   4,   5,   6},
-/* DEPTH 7 */ {0,   0,   4,   6,   8,   8, 0xa, 0xc},
-
-/* FNUM BIT 8: 001 0000xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   1,   1,   1,   1},
-/* DEPTH 2 */ {0,   0,   0,   1,   1,   1,   2,   2},
-/* DEPTH 3 */ {0,   0,   1,   1,   2,   2,   3,   3},
-/* DEPTH 4 */ {0,   0,   1,   2,   2,   2,   3,   4},
-/* DEPTH 5 */ {0,   0,   2,   3,   4,   4,   5,   6},
-/* DEPTH 6 */ {0,   0,   4,   6,   8,   8, 0xa, 0xc},
-/* DEPTH 7 */ {0,   0,   8, 0xc,0x10,0x10,0x14,0x18},
-
-/* FNUM BIT 9: 010 0000xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   2,   2,   2,   2},
-/* DEPTH 2 */ {0,   0,   0,   2,   2,   2,   4,   4},
-/* DEPTH 3 */ {0,   0,   2,   2,   4,   4,   6,   6},
-/* DEPTH 4 */ {0,   0,   2,   4,   4,   4,   6,   8},
-/* DEPTH 5 */ {0,   0,   4,   6,   8,   8, 0xa, 0xc},
-/* DEPTH 6 */ {0,   0,   8, 0xc,0x10,0x10,0x14,0x18},
-/* DEPTH 7 */ {0,   0,0x10,0x18,0x20,0x20,0x28,0x30},
-
-/* FNUM BIT10: 100 0000xxxx */
-/* DEPTH 0 */ {0,   0,   0,   0,   0,   0,   0,   0},
-/* DEPTH 1 */ {0,   0,   0,   0,   4,   4,   4,   4},
-/* DEPTH 2 */ {0,   0,   0,   4,   4,   4,   8,   8},
-/* DEPTH 3 */ {0,   0,   4,   4,   8,   8, 0xc, 0xc},
-/* DEPTH 4 */ {0,   0,   4,   8,   8,   8, 0xc,0x10},
-/* DEPTH 5 */ {0,   0,   8, 0xc,0x10,0x10,0x14,0x18},
-/* DEPTH 6 */ {0,   0,0x10,0x18,0x20,0x20,0x28,0x30},
-/* DEPTH 7 */ {0,   0,0x20,0x30,0x40,0x40,0x50,0x60},
-
-};
-
-/* all 128 LFO PM waveforms */
-static INT32 lfo_pm_table[128*8*32]; /* 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */
 
 /* register number to channel number , slot offset */
 #define OPN_CHAN(N) (N&3)
@@ -698,8 +622,6 @@ typedef struct
 }
 
 
-static UINT8 tablesInit = 0;
-
 /* status set and IRQ handling */
 INLINE void FM_STATUS_SET(FM_ST *ST,int flag)
 {
@@ -2075,128 +1997,6 @@ static void reset_channels( FM_ST *ST , FM_CH *CH , int num )
 	}
 }
 
-/* initialize generic tables */
-static void init_tables(void)
-{
-	signed int i,x;
-	signed int n;
-	double o,m;
-
-	if (tablesInit)
-		return;
-	tablesInit = 1;
-
-	/* build Linear Power Table */
-	for (x=0; x<TL_RES_LEN; x++)
-	{
-		m = (1<<16) / pow(2, (x+1) * (ENV_STEP/4.0) / 8.0);
-		m = floor(m);
-
-		/* we never reach (1<<16) here due to the (x+1) */
-		/* result fits within 16 bits at maximum */
-
-		n = (int)m;     /* 16 bits here */
-		n >>= 4;        /* 12 bits here */
-		if (n&1)        /* round to nearest */
-			n = (n>>1)+1;
-		else
-			n = n>>1;
-						/* 11 bits here (rounded) */
-		n <<= 2;        /* 13 bits here (as in real chip) */
-
-
-		/* 14 bits (with sign bit) */
-		tl_tab[ x*2 + 0 ] = n;
-		tl_tab[ x*2 + 1 ] = -tl_tab[ x*2 + 0 ];
-
-		/* one entry in the 'Power' table use the following format, xxxxxyyyyyyyys with:            */
-		/*        s = sign bit                                                                      */
-		/* yyyyyyyy = 8-bits decimal part (0-TL_RES_LEN)                                            */
-		/* xxxxx    = 5-bits integer 'shift' value (0-31) but, since Power table output is 13 bits, */
-		/*            any value above 13 (included) would be discarded.                             */
-		for (i=1; i<13; i++)
-		{
-			tl_tab[ x*2+0 + i*2*TL_RES_LEN ] =  tl_tab[ x*2+0 ]>>i;
-			tl_tab[ x*2+1 + i*2*TL_RES_LEN ] = -tl_tab[ x*2+0 + i*2*TL_RES_LEN ];
-		}
-#if 0
-		logerror("tl %04i", x);
-		for (i=0; i<13; i++)
-			logerror(", [%02i] %4x", i*2, tl_tab[ x*2 /*+1*/ + i*2*TL_RES_LEN ]);
-		logerror("\n");
-#endif
-	}
-	/*logerror("FM.C: TL_TAB_LEN = %i elements (%i bytes)\n",TL_TAB_LEN, (int)sizeof(tl_tab));*/
-
-
-	/* build Logarithmic Sinus table */
-	for (i=0; i<SIN_LEN; i++)
-	{
-		/* non-standard sinus */
-		m = sin( ((i*2)+1) * M_PI / SIN_LEN ); /* checked against the real chip */
-		/* we never reach zero here due to ((i*2)+1) */
-
-		if (m>0.0)
-			o = 8*log(1.0/m)/log(2.0);  /* convert to 'decibels' */
-		else
-			o = 8*log(-1.0/m)/log(2.0); /* convert to 'decibels' */
-
-		o = o / (ENV_STEP/4);
-
-		n = (int)(2.0*o);
-		if (n&1)            /* round to nearest */
-			n = (n>>1)+1;
-		else
-			n = n>>1;
-
-		/* 13-bits (8.5) value is formatted for above 'Power' table */
-		sin_tab[ i ] = n*2 + (m>=0.0? 0: 1 );
-		/*logerror("FM.C: sin [%4i]= %4i (tl_tab value=%5i)\n", i, sin_tab[i],tl_tab[sin_tab[i]]);*/
-	}
-
-	/*logerror("FM.C: ENV_QUIET= %08x\n",ENV_QUIET );*/
-
-
-	/* build LFO PM modulation table */
-	for(i = 0; i < 8; i++) /* 8 PM depths */
-	{
-		UINT8 fnum;
-		for (fnum=0; fnum<128; fnum++) /* 7 bits meaningful of F-NUMBER */
-		{
-			UINT8 value;
-			UINT8 step;
-			UINT32 offset_depth = i;
-			UINT32 offset_fnum_bit;
-			UINT32 bit_tmp;
-
-			for (step=0; step<8; step++)
-			{
-				value = 0;
-				for (bit_tmp=0; bit_tmp<7; bit_tmp++) /* 7 bits */
-				{
-					if (fnum & (1<<bit_tmp)) /* only if bit "bit_tmp" is set */
-					{
-						offset_fnum_bit = bit_tmp * 8;
-						value += lfo_pm_output[offset_fnum_bit + offset_depth][step];
-					}
-				}
-				/* 32 steps for LFO PM (sinus) */
-				lfo_pm_table[(fnum*32*8) + (i*32) + step   + 0] = value;
-				lfo_pm_table[(fnum*32*8) + (i*32) +(step^7)+ 8] = value;
-				lfo_pm_table[(fnum*32*8) + (i*32) + step   +16] = -value;
-				lfo_pm_table[(fnum*32*8) + (i*32) +(step^7)+24] = -value;
-			}
-#if 0
-			logerror("LFO depth=%1x FNUM=%04x (<<4=%4x): ", i, fnum, fnum<<4);
-			for (step=0; step<16; step++) /* dump only positive part of waveforms */
-				logerror("%02x ", lfo_pm_table[(fnum*32*8) + (i*32) + step] );
-			logerror("\n");
-#endif
-
-		}
-	}
-}
-
 #endif /* BUILD_OPN */
 
 
@@ -2511,9 +2311,6 @@ void * ym2203_init(void *param, UINT32 clock, UINT32 rate,
 	if( F2203==NULL)
 		return NULL;
 
-	/* allocate total level table (128kb space) */
-	init_tables();
-
 	F2203->OPN.ST.param = param;
 	F2203->OPN.type = TYPE_YM2203;
 	F2203->OPN.P_CH = F2203->CH;
@@ -2711,40 +2508,9 @@ typedef YM2610 YM2608;
 
 /* Algorithm and tables verified on real YM2608 and YM2610 */
 
-/* usual ADPCM table (16 * 1.1^N) */
-static const int steps[49] =
-{
-	 16,  17,   19,   21,   23,   25,   28,
-	 31,  34,   37,   41,   45,   50,   55,
-	 60,  66,   73,   80,   88,   97,  107,
-	118, 130,  143,  157,  173,  190,  209,
-	230, 253,  279,  307,  337,  371,  408,
-	449, 494,  544,  598,  658,  724,  796,
-	876, 963, 1060, 1166, 1282, 1411, 1552
-};
-
 /* different from the usual ADPCM table */
 static const int step_inc[8] = { -1*16, -1*16, -1*16, -1*16, 2*16, 5*16, 7*16, 9*16 };
 
-/* speedup purposes only */
-static int jedi_table[ 49*16 ];
-
-
-static void Init_ADPCMATable(void)
-{
-	int step, nib;
-
-	for (step = 0; step < 49; step++)
-	{
-		/* loop over all nibbles and compute the difference */
-		for (nib = 0; nib < 16; nib++)
-		{
-			int value = (2*(nib & 0x07) + 1) * steps[step] / 8;
-			jedi_table[step*16 + nib] = (nib&0x08) ? -value : value;
-		}
-	}
-}
-
 /* ADPCM A (Non control type) : calculate one channel output */
 INLINE void ADPCMA_calc_chan( YM2610 *F2610, ADPCM_CH *ch )
 {
@@ -3186,9 +2952,6 @@ void * ym2608_init(void *param, UINT32 clock, UINT32 rate,
 	if( F2608==NULL)
 		return NULL;
 
-	/* allocate total level table (128kb space) */
-	init_tables();
-
 	F2608->OPN.ST.param = param;
 	F2608->OPN.type = TYPE_YM2608;
 	F2608->OPN.P_CH = F2608->CH;
@@ -3223,8 +2986,6 @@ void * ym2608_init(void *param, UINT32 clock, UINT32 rate,
 	F2608->pcmbuf   = (UINT8*)YM2608_ADPCM_ROM;
 	F2608->pcm_size = 0x2000;
 
-	Init_ADPCMATable();
-
 	ym2608_set_mutemask(F2608, 0x00);
 
 	return F2608;
@@ -3939,9 +3700,6 @@ void *ym2610_init(void *param, UINT32 clock, UINT32 rate,
 	if( F2610==NULL)
 		return NULL;
 
-	/* allocate total level table (128kb space) */
-	init_tables();
-
 	/* FM */
 	F2610->OPN.ST.param = param;
 	F2610->OPN.type = TYPE_YM2610;
@@ -3969,8 +3727,6 @@ void *ym2610_init(void *param, UINT32 clock, UINT32 rate,
 
 	YM_DELTAT_ADPCM_Init(&F2610->deltaT,YM_DELTAT_EMULATION_MODE_YM2610,8,F2610->OPN.out_delta,1<<23);
 
-	Init_ADPCMATable();
-
 	ym2610_set_mutemask(F2610, 0x00);
 
 	return F2610;
@@ -4539,9 +4295,6 @@ void * ym2612_init(void *param, UINT32 clock, UINT32 rate,
 	if (F2612 == NULL)
 		return NULL;
 
-	/* allocate total level table (128kb space) */
-	init_tables();
-
 	/* FM */
 	F2612->OPN.ST.param = param;
 	F2612->OPN.type = TYPE_YM2612;
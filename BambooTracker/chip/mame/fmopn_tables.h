@@ -0,0 +1,1571 @@
+/* Generated by scripts/gen_fmopn_tables.py. Do not edit. */
+
+/* Linear Power Table */
+static const signed int tl_tab[6656] = {
+	8168,-8168,8148,-8148,8124,-8124,8104,-8104,8080,-8080,8060,-8060,8040,-8040,8016,-8016,
+	7996,-7996,7972,-7972,7952,-7952,7932,-7932,7908,-7908,7888,-7888,7864,-7864,7844,-7844,
+	7824,-7824,7804,-7804,7780,-7780,7760,-7760,7740,-7740,7720,-7720,7696,-7696,7676,-7676,
+	7656,-7656,7636,-7636,7616,-7616,7592,-7592,7572,-7572,7552,-7552,7532,-7532,7512,-7512,
+	7492,-7492,7472,-7472,7452,-7452,7432,-7432,7412,-7412,7392,-7392,7372,-7372,7352,-7352,
+	7332,-7332,7312,-7312,7292,-7292,7272,-7272,7252,-7252,7232,-7232,7212,-7212,7192,-7192,
+	7176,-7176,7156,-7156,7136,-7136,7116,-7116,7096,-7096,7076,-7076,7060,-7060,7040,-7040,
+	7020,-7020,7000,-7000,6984,-6984,6964,-6964,6944,-6944,6928,-6928,6908,-6908,6888,-6888,
+	6868,-6868,6852,-6852,6832,-6832,6816,-6816,6796,-6796,6776,-6776,6760,-6760,6740,-6740,
+	6724,-6724,6704,-6704,6688,-6688,6668,-6668,6652,-6652,6632,-6632,6616,-6616,6596,-6596,
+	6580,-6580,6560,-6560,6544,-6544,6524,-6524,6508,-6508,6492,-6492,6472,-6472,6456,-6456,
+	6436,-6436,6420,-6420,6404,-6404,6384,-6384,6368,-6368,6352,-6352,6336,-6336,6316,-6316,
+	6300,-6300,6284,-6284,6264,-6264,6248,-6248,6232,-6232,6216,-6216,6200,-6200,6180,-6180,
+	6164,-6164,6148,-6148,6132,-6132,6116,-6116,6100,-6100,6080,-6080,6064,-6064,6048,-6048,
+	6032,-6032,6016,-6016,6000,-6000,5984,-5984,5968,-5968,5952,-5952,5936,-5936,5920,-5920,
+	5904,-5904,5888,-5888,5872,-5872,5856,-5856,5840,-5840,5824,-5824,5808,-5808,5792,-5792,
+	5776,-5776,5760,-5760,5744,-5744,5732,-5732,5716,-5716,5700,-5700,5684,-5684,5668,-5668,
+	5652,-5652,5636,-5636,5624,-5624,5608,-5608,5592,-5592,5576,-5576,5564,-5564,5548,-5548,
+	5532,-5532,5516,-5516,5504,-5504,5488,-5488,5472,-5472,5456,-5456,5444,-5444,5428,-5428,
+	5412,-5412,5400,-5400,5384,-5384,5368,-5368,5356,-5356,5340,-5340,5328,-5328,5312,-5312,
+	5296,-5296,5284,-5284,5268,-5268,5256,-5256,5240,-5240,5228,-5228,5212,-5212,5200,-5200,
+	5184,-5184,5168,-5168,5156,-5156,5144,-5144,5128,-5128,5116,-5116,5100,-5100,5088,-5088,
+	5072,-5072,5060,-5060,5044,-5044,5032,-5032,5020,-5020,5004,-5004,4992,-4992,4976,-4976,
+	4964,-4964,4952,-4952,4936,-4936,4924,-4924,4912,-4912,4896,-4896,4884,-4884,4872,-4872,
+	4856,-4856,4844,-4844,4832,-4832,4820,-4820,4804,-4804,4792,-4792,4780,-4780,4768,-4768,
+	4752,-4752,4740,-4740,4728,-4728,4716,-4716,4704,-4704,4688,-4688,4676,-4676,4664,-4664,
+	4652,-4652,4640,-4640,4628,-4628,4616,-4616,4600,-4600,4588,-4588,4576,-4576,4564,-4564,
+	4552,-4552,4540,-4540,4528,-4528,4516,-4516,4504,-4504,4492,-4492,4480,-4480,4468,-4468,
+	4456,-4456,4444,-4444,4432,-4432,4420,-4420,4408,-4408,4396,-4396,4384,-4384,4372,-4372,
+	4360,-4360,4348,-4348,4336,-4336,4324,-4324,4312,-4312,4300,-4300,4288,-4288,4276,-4276,
+	4264,-4264,4256,-4256,4244,-4244,4232,-4232,4220,-4220,4208,-4208,4196,-4196,4184,-4184,
+	4176,-4176,4164,-4164,4152,-4152,4140,-4140,4128,-4128,4120,-4120,4108,-4108,4096,-4096,
+	4084,-4084,4074,-4074,4062,-4062,4052,-4052,4040,-4040,4030,-4030,4020,-4020,4008,-4008,
+	3998,-3998,3986,-3986,3976,-3976,3966,-3966,3954,-3954,3944,-3944,3932,-3932,3922,-3922,
+	3912,-3912,3902,-3902,3890,-3890,3880,-3880,3870,-3870,3860,-3860,3848,-3848,3838,-3838,
+	3828,-3828,3818,-3818,3808,-3808,3796,-3796,3786,-3786,3776,-3776,3766,-3766,3756,-3756,
+	3746,-3746,3736,-3736,3726,-3726,3716,-3716,3706,-3706,3696,-3696,3686,-3686,3676,-3676,
+	3666,-3666,3656,-3656,3646,-3646,3636,-3636,3626,-3626,3616,-3616,3606,-3606,3596,-3596,
+	3588,-3588,3578,-3578,3568,-3568,3558,-3558,3548,-3548,3538,-3538,3530,-3530,3520,-3520,
+	3510,-3510,3500,-3500,3492,-3492,3482,-3482,3472,-3472,3464,-3464,3454,-3454,3444,-3444,
+	3434,-3434,3426,-3426,3416,-3416,3408,-3408,3398,-3398,3388,-3388,3380,-3380,3370,-3370,
+	3362,-3362,3352,-3352,3344,-3344,3334,-3334,3326,-3326,3316,-3316,3308,-3308,3298,-3298,
+	3290,-3290,3280,-3280,3272,-3272,3262,-3262,3254,-3254,3246,-3246,3236,-3236,3228,-3228,
+	3218,-3218,3210,-3210,3202,-3202,3192,-3192,3184,-3184,3176,-3176,3168,-3168,3158,-3158,
+	3150,-3150,3142,-3142,3132,-3132,3124,-3124,3116,-3116,3108,-3108,3100,-3100,3090,-3090,
+	3082,-3082,3074,-3074,3066,-3066,3058,-3058,3050,-3050,3040,-3040,3032,-3032,3024,-3024,
+	3016,-3016,3008,-3008,3000,-3000,2992,-2992,2984,-2984,2976,-2976,2968,-2968,2960,-2960,
+	2952,-2952,2944,-2944,2936,-2936,2928,-2928,2920,-2920,2912,-2912,2904,-2904,2896,-2896,
+	2888,-2888,2880,-2880,2872,-2872,2866,-2866,2858,-2858,2850,-2850,2842,-2842,2834,-2834,
+	2826,-2826,2818,-2818,2812,-2812,2804,-2804,2796,-2796,2788,-2788,2782,-2782,2774,-2774,
+	2766,-2766,2758,-2758,2752,-2752,2744,-2744,2736,-2736,2728,-2728,2722,-2722,2714,-2714,
+	2706,-2706,2700,-2700,2692,-2692,2684,-2684,2678,-2678,2670,-2670,2664,-2664,2656,-2656,
+	2648,-2648,2642,-2642,2634,-2634,2628,-2628,2620,-2620,2614,-2614,2606,-2606,2600,-2600,
+	2592,-2592,2584,-2584,2578,-2578,2572,-2572,2564,-2564,2558,-2558,2550,-2550,2544,-2544,
+	2536,-2536,2530,-2530,2522,-2522,2516,-2516,2510,-2510,2502,-2502,2496,-2496,2488,-2488,
+	2482,-2482,2476,-2476,2468,-2468,2462,-2462,2456,-2456,2448,-2448,2442,-2442,2436,-2436,
+	2428,-2428,2422,-2422,2416,-2416,2410,-2410,2402,-2402,2396,-2396,2390,-2390,2384,-2384,
+	2376,-2376,2370,-2370,2364,-2364,2358,-2358,2352,-2352,2344,-2344,2338,-2338,2332,-2332,
+	2326,-2326,2320,-2320,2314,-2314,2308,-2308,2300,-2300,2294,-2294,2288,-2288,2282,-2282,
+	2276,-2276,2270,-2270,2264,-2264,2258,-2258,2252,-2252,2246,-2246,2240,-2240,2234,-2234,
+	2228,-2228,2222,-2222,2216,-2216,2210,-2210,2204,-2204,2198,-2198,2192,-2192,2186,-2186,
+	2180,-2180,2174,-2174,2168,-2168,2162,-2162,2156,-2156,2150,-2150,2144,-2144,2138,-2138,
+	2132,-2132,2128,-2128,2122,-2122,2116,-2116,2110,-2110,2104,-2104,2098,-2098,2092,-2092,
+	2088,-2088,2082,-2082,2076,-2076,2070,-2070,2064,-2064,2060,-2060,2054,-2054,2048,-2048,
+	2042,-2042,2037,-2037,2031,-2031,2026,-2026,2020,-2020,2015,-2015,2010,-2010,2004,-2004,
+	1999,-1999,1993,-1993,1988,-1988,1983,-1983,1977,-1977,1972,-1972,1966,-1966,1961,-1961,
+	1956,-1956,1951,-1951,1945,-1945,1940,-1940,1935,-1935,1930,-1930,1924,-1924,1919,-1919,
+	1914,-1914,1909,-1909,1904,-1904,1898,-1898,1893,-1893,1888,-1888,1883,-1883,1878,-1878,
+	1873,-1873,1868,-1868,1863,-1863,1858,-1858,1853,-1853,1848,-1848,1843,-1843,1838,-1838,
+	1833,-1833,1828,-1828,1823,-1823,1818,-1818,1813,-1813,1808,-1808,1803,-1803,1798,-1798,
+	1794,-1794,1789,-1789,1784,-1784,1779,-1779,1774,-1774,1769,-1769,1765,-1765,1760,-1760,
+	1755,-1755,1750,-1750,1746,-1746,1741,-1741,1736,-1736,1732,-1732,1727,-1727,1722,-1722,
+	1717,-1717,1713,-1713,1708,-1708,1704,-1704,1699,-1699,1694,-1694,1690,-1690,1685,-1685,
+	1681,-1681,1676,-1676,1672,-1672,1667,-1667,1663,-1663,1658,-1658,1654,-1654,1649,-1649,
+	1645,-1645,1640,-1640,1636,-1636,1631,-1631,1627,-1627,1623,-1623,1618,-1618,1614,-1614,
+	1609,-1609,1605,-1605,1601,-1601,1596,-1596,1592,-1592,1588,-1588,1584,-1584,1579,-1579,
+	1575,-1575,1571,-1571,1566,-1566,1562,-1562,1558,-1558,1554,-1554,1550,-1550,1545,-1545,
+	1541,-1541,1537,-1537,1533,-1533,1529,-1529,1525,-1525,1520,-1520,1516,-1516,1512,-1512,
+	1508,-1508,1504,-1504,1500,-1500,1496,-1496,1492,-1492,1488,-1488,1484,-1484,1480,-1480,
+	1476,-1476,1472,-1472,1468,-1468,1464,-1464,1460,-1460,1456,-1456,1452,-1452,1448,-1448,
+	1444,-1444,1440,-1440,1436,-1436,1433,-1433,1429,-1429,1425,-1425,1421,-1421,1417,-1417,
+	1413,-1413,1409,-1409,1406,-1406,1402,-1402,1398,-1398,1394,-1394,1391,-1391,1387,-1387,
+	1383,-1383,1379,-1379,1376,-1376,1372,-1372,1368,-1368,1364,-1364,1361,-1361,1357,-1357,
+	1353,-1353,1350,-1350,1346,-1346,1342,-1342,1339,-1339,1335,-1335,1332,-1332,1328,-1328,
+	1324,-1324,1321,-1321,1317,-1317,1314,-1314,1310,-1310,1307,-1307,1303,-1303,1300,-1300,
+	1296,-1296,1292,-1292,1289,-1289,1286,-1286,1282,-1282,1279,-1279,1275,-1275,1272,-1272,
+	1268,-1268,1265,-1265,1261,-1261,1258,-1258,1255,-1255,1251,-1251,1248,-1248,1244,-1244,
+	1241,-1241,1238,-1238,1234,-1234,1231,-1231,1228,-1228,1224,-1224,1221,-1221,1218,-1218,
+	1214,-1214,1211,-1211,1208,-1208,1205,-1205,1201,-1201,1198,-1198,1195,-1195,1192,-1192,
+	1188,-1188,1185,-1185,1182,-1182,1179,-1179,1176,-1176,1172,-1172,1169,-1169,1166,-1166,
+	1163,-1163,1160,-1160,1157,-1157,1154,-1154,1150,-1150,1147,-1147,1144,-1144,1141,-1141,
+	1138,-1138,1135,-1135,1132,-1132,1129,-1129,1126,-1126,1123,-1123,1120,-1120,1117,-1117,
+	1114,-1114,1111,-1111,1108,-1108,1105,-1105,1102,-1102,1099,-1099,1096,-1096,1093,-1093,
+	1090,-1090,1087,-1087,1084,-1084,1081,-1081,1078,-1078,1075,-1075,1072,-1072,1069,-1069,
+	1066,-1066,1064,-1064,1061,-1061,1058,-1058,1055,-1055,1052,-1052,1049,-1049,1046,-1046,
+	1044,-1044,1041,-1041,1038,-1038,1035,-1035,1032,-1032,1030,-1030,1027,-1027,1024,-1024,
+	1021,-1021,1018,-1018,1015,-1015,1013,-1013,1010,-1010,1007,-1007,1005,-1005,1002,-1002,
+	999,-999,996,-996,994,-994,991,-991,988,-988,986,-986,983,-983,980,-980,
+	978,-978,975,-975,972,-972,970,-970,967,-967,965,-965,962,-962,959,-959,
+	957,-957,954,-954,952,-952,949,-949,946,-946,944,-944,941,-941,939,-939,
+	936,-936,934,-934,931,-931,929,-929,926,-926,924,-924,921,-921,919,-919,
+	916,-916,914,-914,911,-911,909,-909,906,-906,904,-904,901,-901,899,-899,
+	897,-897,894,-894,892,-892,889,-889,887,-887,884,-884,882,-882,880,-880,
+	877,-877,875,-875,873,-873,870,-870,868,-868,866,-866,863,-863,861,-861,
+	858,-858,856,-856,854,-854,852,-852,849,-849,847,-847,845,-845,842,-842,
+	840,-840,838,-838,836,-836,833,-833,831,-831,829,-829,827,-827,824,-824,
+	822,-822,820,-820,818,-818,815,-815,813,-813,811,-811,809,-809,807,-807,
+	804,-804,802,-802,800,-800,798,-798,796,-796,794,-794,792,-792,789,-789,
+	787,-787,785,-785,783,-783,781,-781,779,-779,777,-777,775,-775,772,-772,
+	770,-770,768,-768,766,-766,764,-764,762,-762,760,-760,758,-758,756,-756,
+	754,-754,752,-752,750,-750,748,-748,746,-746,744,-744,742,-742,740,-740,
+	738,-738,736,-736,734,-734,732,-732,730,-730,728,-728,726,-726,724,-724,
+	722,-722,720,-720,718,-718,716,-716,714,-714,712,-712,710,-710,708,-708,
+	706,-706,704,-704,703,-703,701,-701,699,-699,697,-697,695,-695,693,-693,
+	691,-691,689,-689,688,-688,686,-686,684,-684,682,-682,680,-680,678,-678,
+	676,-676,675,-675,673,-673,671,-671,669,-669,667,-667,666,-666,664,-664,
+	662,-662,660,-660,658,-658,657,-657,655,-655,653,-653,651,-651,650,-650,
+	648,-648,646,-646,644,-644,643,-643,641,-641,639,-639,637,-637,636,-636,
+	634,-634,632,-632,630,-630,629,-629,627,-627,625,-625,624,-624,622,-622,
+	620,-620,619,-619,617,-617,615,-615,614,-614,612,-612,610,-610,609,-609,
+	607,-607,605,-605,604,-604,602,-602,600,-600,599,-599,597,-597,596,-596,
+	594,-594,592,-592,591,-591,589,-589,588,-588,586,-586,584,-584,583,-583,
+	581,-581,580,-580,578,-578,577,-577,575,-575,573,-573,572,-572,570,-570,
+	569,-569,567,-567,566,-566,564,-564,563,-563,561,-561,560,-560,558,-558,
+	557,-557,555,-555,554,-554,552,-552,551,-551,549,-549,548,-548,546,-546,
+	545,-545,543,-543,542,-542,540,-540,539,-539,537,-537,536,-536,534,-534,
+	533,-533,532,-532,530,-530,529,-529,527,-527,526,-526,524,-524,523,-523,
+	522,-522,520,-520,519,-519,517,-517,516,-516,515,-515,513,-513,512,-512,
+	510,-510,509,-509,507,-507,506,-506,505,-505,503,-503,502,-502,501,-501,
+	499,-499,498,-498,497,-497,495,-495,494,-494,493,-493,491,-491,490,-490,
+	489,-489,487,-487,486,-486,485,-485,483,-483,482,-482,481,-481,479,-479,
+	478,-478,477,-477,476,-476,474,-474,473,-473,472,-472,470,-470,469,-469,
+	468,-468,467,-467,465,-465,464,-464,463,-463,462,-462,460,-460,459,-459,
+	458,-458,457,-457,455,-455,454,-454,453,-453,452,-452,450,-450,449,-449,
+	448,-448,447,-447,446,-446,444,-444,443,-443,442,-442,441,-441,440,-440,
+	438,-438,437,-437,436,-436,435,-435,434,-434,433,-433,431,-431,430,-430,
+	429,-429,428,-428,427,-427,426,-426,424,-424,423,-423,422,-422,421,-421,
+	420,-420,419,-419,418,-418,416,-416,415,-415,414,-414,413,-413,412,-412,
+	411,-411,410,-410,409,-409,407,-407,406,-406,405,-405,404,-404,403,-403,
+	402,-402,401,-401,400,-400,399,-399,398,-398,397,-397,396,-396,394,-394,
+	393,-393,392,-392,391,-391,390,-390,389,-389,388,-388,387,-387,386,-386,
+	385,-385,384,-384,383,-383,382,-382,381,-381,380,-380,379,-379,378,-378,
+	377,-377,376,-376,375,-375,374,-374,373,-373,372,-372,371,-371,370,-370,
+	369,-369,368,-368,367,-367,366,-366,365,-365,364,-364,363,-363,362,-362,
+	361,-361,360,-360,359,-359,358,-358,357,-357,356,-356,355,-355,354,-354,
+	353,-353,352,-352,351,-351,350,-350,349,-349,348,-348,347,-347,346,-346,
+	345,-345,344,-344,344,-344,343,-343,342,-342,341,-341,340,-340,339,-339,
+	338,-338,337,-337,336,-336,335,-335,334,-334,333,-333,333,-333,332,-332,
+	331,-331,330,-330,329,-329,328,-328,327,-327,326,-326,325,-325,325,-325,
+	324,-324,323,-323,322,-322,321,-321,320,-320,319,-319,318,-318,318,-318,
+	317,-317,316,-316,315,-315,314,-314,313,-313,312,-312,312,-312,311,-311,
+	310,-310,309,-309,308,-308,307,-307,307,-307,306,-306,305,-305,304,-304,
+	303,-303,302,-302,302,-302,301,-301,300,-300,299,-299,298,-298,298,-298,
+	297,-297,296,-296,295,-295,294,-294,294,-294,293,-293,292,-292,291,-291,
+	290,-290,290,-290,289,-289,288,-288,287,-287,286,-286,286,-286,285,-285,
+	284,-284,283,-283,283,-283,282,-282,281,-281,280,-280,280,-280,279,-279,
+	278,-278,277,-277,277,-277,276,-276,275,-275,274,-274,274,-274,273,-273,
+	272,-272,271,-271,271,-271,270,-270,269,-269,268,-268,268,-268,267,-267,
+	266,-266,266,-266,265,-265,264,-264,263,-263,263,-263,262,-262,261,-261,
+	261,-261,260,-260,259,-259,258,-258,258,-258,257,-257,256,-256,256,-256,
+	255,-255,254,-254,253,-253,253,-253,252,-252,251,-251,251,-251,250,-250,
+	249,-249,249,-249,248,-248,247,-247,247,-247,246,-246,245,-245,245,-245,
+	244,-244,243,-243,243,-243,242,-242,241,-241,241,-241,240,-240,239,-239,
+	239,-239,238,-238,238,-238,237,-237,236,-236,236,-236,235,-235,234,-234,
+	234,-234,233,-233,232,-232,232,-232,231,-231,231,-231,230,-230,229,-229,
+	229,-229,228,-228,227,-227,227,-227,226,-226,226,-226,225,-225,224,-224,
+	224,-224,223,-223,223,-223,222,-222,221,-221,221,-221,220,-220,220,-220,
+	219,-219,218,-218,218,-218,217,-217,217,-217,216,-216,215,-215,215,-215,
+	214,-214,214,-214,213,-213,213,-213,212,-212,211,-211,211,-211,210,-210,
+	210,-210,209,-209,209,-209,208,-208,207,-207,207,-207,206,-206,206,-206,
+	205,-205,205,-205,204,-204,203,-203,203,-203,202,-202,202,-202,201,-201,
+	201,-201,200,-200,200,-200,199,-199,199,-199,198,-198,198,-198,197,-197,
+	196,-196,196,-196,195,-195,195,-195,194,-194,194,-194,193,-193,193,-193,
+	192,-192,192,-192,191,-191,191,-191,190,-190,190,-190,189,-189,189,-189,
+	188,-188,188,-188,187,-187,187,-187,186,-186,186,-186,185,-185,185,-185,
+	184,-184,184,-184,183,-183,183,-183,182,-182,182,-182,181,-181,181,-181,
+	180,-180,180,-180,179,-179,179,-179,178,-178,178,-178,177,-177,177,-177,
+	176,-176,176,-176,175,-175,175,-175,174,-174,174,-174,173,-173,173,-173,
+	172,-172,172,-172,172,-172,171,-171,171,-171,170,-170,170,-170,169,-169,
+	169,-169,168,-168,168,-168,167,-167,167,-167,166,-166,166,-166,166,-166,
+	165,-165,165,-165,164,-164,164,-164,163,-163,163,-163,162,-162,162,-162,
+	162,-162,161,-161,161,-161,160,-160,160,-160,159,-159,159,-159,159,-159,
+	158,-158,158,-158,157,-157,157,-157,156,-156,156,-156,156,-156,155,-155,
+	155,-155,154,-154,154,-154,153,-153,153,-153,153,-153,152,-152,152,-152,
+	151,-151,151,-151,151,-151,150,-150,150,-150,149,-149,149,-149,149,-149,
+	148,-148,148,-148,147,-147,147,-147,147,-147,146,-146,146,-146,145,-145,
+	145,-145,145,-145,144,-144,144,-144,143,-143,143,-143,143,-143,142,-142,
+	142,-142,141,-141,141,-141,141,-141,140,-140,140,-140,140,-140,139,-139,
+	139,-139,138,-138,138,-138,138,-138,137,-137,137,-137,137,-137,136,-136,
+	136,-136,135,-135,135,-135,135,-135,134,-134,134,-134,134,-134,133,-133,
+	133,-133,133,-133,132,-132,132,-132,131,-131,131,-131,131,-131,130,-130,
+	130,-130,130,-130,129,-129,129,-129,129,-129,128,-128,128,-128,128,-128,
+	127,-127,127,-127,126,-126,126,-126,126,-126,125,-125,125,-125,125,-125,
+	124,-124,124,-124,124,-124,123,-123,123,-123,123,-123,122,-122,122,-122,
+	122,-122,121,-121,121,-121,121,-121,120,-120,120,-120,120,-120,119,-119,
+	119,-119,119,-119,119,-119,118,-118,118,-118,118,-118,117,-117,117,-117,
+	117,-117,116,-116,116,-116,116,-116,115,-115,115,-115,115,-115,114,-114,
+	114,-114,114,-114,113,-113,113,-113,113,-113,113,-113,112,-112,112,-112,
+	112,-112,111,-111,111,-111,111,-111,110,-110,110,-110,110,-110,110,-110,
+	109,-109,109,-109,109,-109,108,-108,108,-108,108,-108,107,-107,107,-107,
+	107,-107,107,-107,106,-106,106,-106,106,-106,105,-105,105,-105,105,-105,
+	105,-105,104,-104,104,-104,104,-104,103,-103,103,-103,103,-103,103,-103,
+	102,-102,102,-102,102,-102,101,-101,101,-101,101,-101,101,-101,100,-100,
+	100,-100,100,-100,100,-100,99,-99,99,-99,99,-99,99,-99,98,-98,
+	98,-98,98,-98,97,-97,97,-97,97,-97,97,-97,96,-96,96,-96,
+	96,-96,96,-96,95,-95,95,-95,95,-95,95,-95,94,-94,94,-94,
+	94,-94,94,-94,93,-93,93,-93,93,-93,93,-93,92,-92,92,-92,
+	92,-92,92,-92,91,-91,91,-91,91,-91,91,-91,90,-90,90,-90,
+	90,-90,90,-90,89,-89,89,-89,89,-89,89,-89,88,-88,88,-88,
+	88,-88,88,-88,87,-87,87,-87,87,-87,87,-87,86,-86,86,-86,
+	86,-86,86,-86,86,-86,85,-85,85,-85,85,-85,85,-85,84,-84,
+	84,-84,84,-84,84,-84,83,-83,83,-83,83,-83,83,-83,83,-83,
+	82,-82,82,-82,82,-82,82,-82,81,-81,81,-81,81,-81,81,-81,
+	81,-81,80,-80,80,-80,80,-80,80,-80,79,-79,79,-79,79,-79,
+	79,-79,79,-79,78,-78,78,-78,78,-78,78,-78,78,-78,77,-77,
+	77,-77,77,-77,77,-77,76,-76,76,-76,76,-76,76,-76,76,-76,
+	75,-75,75,-75,75,-75,75,-75,75,-75,74,-74,74,-74,74,-74,
+	74,-74,74,-74,73,-73,73,-73,73,-73,73,-73,73,-73,72,-72,
+	72,-72,72,-72,72,-72,72,-72,71,-71,71,-71,71,-71,71,-71,
+	71,-71,70,-70,70,-70,70,-70,70,-70,70,-70,70,-70,69,-69,
+	69,-69,69,-69,69,-69,69,-69,68,-68,68,-68,68,-68,68,-68,
+	68,-68,67,-67,67,-67,67,-67,67,-67,67,-67,67,-67,66,-66,
+	66,-66,66,-66,66,-66,66,-66,65,-65,65,-65,65,-65,65,-65,
+	65,-65,65,-65,64,-64,64,-64,64,-64,64,-64,64,-64,64,-64,
+	63,-63,63,-63,63,-63,63,-63,63,-63,62,-62,62,-62,62,-62,
+	62,-62,62,-62,62,-62,61,-61,61,-61,61,-61,61,-61,61,-61,
+	61,-61,60,-60,60,-60,60,-60,60,-60,60,-60,60,-60,59,-59,
+	59,-59,59,-59,59,-59,59,-59,59,-59,59,-59,58,-58,58,-58,
+	58,-58,58,-58,58,-58,58,-58,57,-57,57,-57,57,-57,57,-57,
+	57,-57,57,-57,56,-56,56,-56,56,-56,56,-56,56,-56,56,-56,
+	56,-56,55,-55,55,-55,55,-55,55,-55,55,-55,55,-55,55,-55,
+	54,-54,54,-54,54,-54,54,-54,54,-54,54,-54,53,-53,53,-53,
+	53,-53,53,-53,53,-53,53,-53,53,-53,52,-52,52,-52,52,-52,
+	52,-52,52,-52,52,-52,52,-52,51,-51,51,-51,51,-51,51,-51,
+	51,-51,51,-51,51,-51,50,-50,50,-50,50,-50,50,-50,50,-50,
+	50,-50,50,-50,50,-50,49,-49,49,-49,49,-49,49,-49,49,-49,
+	49,-49,49,-49,48,-48,48,-48,48,-48,48,-48,48,-48,48,-48,
+	48,-48,48,-48,47,-47,47,-47,47,-47,47,-47,47,-47,47,-47,
+	47,-47,47,-47,46,-46,46,-46,46,-46,46,-46,46,-46,46,-46,
+	46,-46,46,-46,45,-45,45,-45,45,-45,45,-45,45,-45,45,-45,
+	45,-45,45,-45,44,-44,44,-44,44,-44,44,-44,44,-44,44,-44,
+	44,-44,44,-44,43,-43,43,-43,43,-43,43,-43,43,-43,43,-43,
+	43,-43,43,-43,43,-43,42,-42,42,-42,42,-42,42,-42,42,-42,
+	42,-42,42,-42,42,-42,41,-41,41,-41,41,-41,41,-41,41,-41,
+	41,-41,41,-41,41,-41,41,-41,40,-40,40,-40,40,-40,40,-40,
+	40,-40,40,-40,40,-40,40,-40,40,-40,39,-39,39,-39,39,-39,
+	39,-39,39,-39,39,-39,39,-39,39,-39,39,-39,39,-39,38,-38,
+	38,-38,38,-38,38,-38,38,-38,38,-38,38,-38,38,-38,38,-38,
+	37,-37,37,-37,37,-37,37,-37,37,-37,37,-37,37,-37,37,-37,
+	37,-37,37,-37,36,-36,36,-36,36,-36,36,-36,36,-36,36,-36,
+	36,-36,36,-36,36,-36,36,-36,35,-35,35,-35,35,-35,35,-35,
+	35,-35,35,-35,35,-35,35,-35,35,-35,35,-35,35,-35,34,-34,
+	34,-34,34,-34,34,-34,34,-34,34,-34,34,-34,34,-34,34,-34,
+	34,-34,33,-33,33,-33,33,-33,33,-33,33,-33,33,-33,33,-33,
+	33,-33,33,-33,33,-33,33,-33,32,-32,32,-32,32,-32,32,-32,
+	32,-32,32,-32,32,-32,32,-32,32,-32,32,-32,32,-32,32,-32,
+	31,-31,31,-31,31,-31,31,-31,31,-31,31,-31,31,-31,31,-31,
+	31,-31,31,-31,31,-31,30,-30,30,-30,30,-30,30,-30,30,-30,
+	30,-30,30,-30,30,-30,30,-30,30,-30,30,-30,30,-30,29,-29,
+	29,-29,29,-29,29,-29,29,-29,29,-29,29,-29,29,-29,29,-29,
+	29,-29,29,-29,29,-29,29,-29,28,-28,28,-28,28,-28,28,-28,
+	28,-28,28,-28,28,-28,28,-28,28,-28,28,-28,28,-28,28,-28,
+	28,-28,27,-27,27,-27,27,-27,27,-27,27,-27,27,-27,27,-27,
+	27,-27,27,-27,27,-27,27,-27,27,-27,27,-27,26,-26,26,-26,
+	26,-26,26,-26,26,-26,26,-26,26,-26,26,-26,26,-26,26,-26,
+	26,-26,26,-26,26,-26,26,-26,25,-25,25,-25,25,-25,25,-25,
+	25,-25,25,-25,25,-25,25,-25,25,-25,25,-25,25,-25,25,-25,
+	25,-25,25,-25,25,-25,24,-24,24,-24,24,-24,24,-24,24,-24,
+	24,-24,24,-24,24,-24,24,-24,24,-24,24,-24,24,-24,24,-24,
+	24,-24,24,-24,23,-23,23,-23,23,-23,23,-23,23,-23,23,-23,
+	23,-23,23,-23,23,-23,23,-23,23,-23,23,-23,23,-23,23,-23,
+	23,-23,23,-23,22,-22,22,-22,22,-22,22,-22,22,-22,22,-22,
+	22,-22,22,-22,22,-22,22,-22,22,-22,22,-22,22,-22,22,-22,
+	22,-22,22,-22,21,-21,21,-21,21,-21,21,-21,21,-21,21,-21,
+	21,-21,21,-21,21,-21,21,-21,21,-21,21,-21,21,-21,21,-21,
+	21,-21,21,-21,21,-21,20,-20,20,-20,20,-20,20,-20,20,-20,
+	20,-20,20,-20,20,-20,20,-20,20,-20,20,-20,20,-20,20,-20,
+	20,-20,20,-20,20,-20,20,-20,20,-20,19,-19,19,-19,19,-19,
+	19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,
+	19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,19,-19,
+	18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,
+	18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,18,-18,
+	18,-18,18,-18,18,-18,18,-18,17,-17,17,-17,17,-17,17,-17,
+	17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,
+	17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,17,-17,
+	17,-17,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,
+	16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,
+	16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,16,-16,
+	15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,
+	15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,
+	15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,15,-15,14,-14,
+	14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,
+	14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,
+	14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,14,-14,
+	14,-14,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,
+	13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,
+	13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,13,-13,
+	13,-13,13,-13,13,-13,13,-13,12,-12,12,-12,12,-12,12,-12,
+	12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,
+	12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,
+	12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,12,-12,
+	12,-12,12,-12,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,
+	11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,
+	11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,
+	11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,11,-11,
+	11,-11,11,-11,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,
+	10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,
+	10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,
+	10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,10,-10,
+	10,-10,10,-10,10,-10,10,-10,10,-10,9,-9,9,-9,9,-9,
+	9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,
+	9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,
+	9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,
+	9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,9,-9,
+	9,-9,9,-9,9,-9,9,-9,8,-8,8,-8,8,-8,8,-8,
+	8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,
+	8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,
+	8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,
+	8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,
+	8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,8,-8,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,7,-7,
+	7,-7,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,6,-6,
+	6,-6,6,-6,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,5,-5,
+	5,-5,5,-5,5,-5,5,-5,5,-5,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,4,-4,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,3,-3,
+	3,-3,3,-3,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,2,-2,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+	1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,1,-1,
+};
+
+/* Logarithmic Sinus table */
+static const unsigned int sin_tab[1024] = {
+	4274,3462,3086,2838,2652,2504,2380,2274,2182,2100,2026,1958,1898,1840,1788,1738,
+	1692,1650,1608,1570,1534,1498,1464,1434,1402,1374,1344,1318,1292,1266,1242,1218,
+	1196,1174,1152,1132,1112,1092,1072,1054,1036,1018,1002,984,968,952,936,922,
+	906,892,878,864,850,836,822,810,798,784,772,760,750,738,726,716,
+	704,694,682,672,662,652,642,632,622,614,604,594,586,578,568,560,
+	552,542,534,526,518,510,502,496,488,480,472,466,458,452,444,438,
+	430,424,418,410,404,398,392,386,380,374,368,362,356,350,344,338,
+	334,328,322,318,312,306,302,296,292,286,282,276,272,268,262,258,
+	254,250,244,240,236,232,228,224,220,216,212,208,204,200,196,192,
+	188,184,182,178,174,170,166,164,160,156,154,150,148,144,140,138,
+	134,132,128,126,124,120,118,114,112,110,106,104,102,98,96,94,
+	92,90,86,84,82,80,78,76,74,72,70,68,66,64,62,60,
+	58,56,54,52,50,48,46,46,44,42,40,40,38,36,34,34,
+	32,30,30,28,26,26,24,24,22,20,20,18,18,16,16,14,
+	14,14,12,12,10,10,10,8,8,8,6,6,6,4,4,4,
+	4,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,2,2,2,2,2,2,2,4,
+	4,4,4,6,6,6,8,8,8,10,10,10,12,12,14,14,
+	14,16,16,18,18,20,20,22,24,24,26,26,28,30,30,32,
+	34,34,36,38,40,40,42,44,46,46,48,50,52,54,56,58,
+	60,62,64,66,68,70,72,74,76,78,80,82,84,86,90,92,
+	94,96,98,102,104,106,110,112,114,118,120,124,126,128,132,134,
+	138,140,144,148,150,154,156,160,164,166,170,174,178,182,184,188,
+	192,196,200,204,208,212,216,220,224,228,232,236,240,244,250,254,
+	258,262,268,272,276,282,286,292,296,302,306,312,318,322,328,334,
+	338,344,350,356,362,368,374,380,386,392,398,404,410,418,424,430,
+	438,444,452,458,466,472,480,488,496,502,510,518,526,534,542,552,
+	560,568,578,586,594,604,614,622,632,642,652,662,672,682,694,704,
+	716,726,738,750,760,772,784,798,810,822,836,850,864,878,892,906,
+	922,936,952,968,984,1002,1018,1036,1054,1072,1092,1112,1132,1152,1174,1196,
+	1218,1242,1266,1292,1318,1344,1374,1402,1434,1464,1498,1534,1570,1608,1650,1692,
+	1738,1788,1840,1898,1958,2026,2100,2182,2274,2380,2504,2652,2838,3086,3462,4274,
+	4275,3463,3087,2839,2653,2505,2381,2275,2183,2101,2027,1959,1899,1841,1789,1739,
+	1693,1651,1609,1571,1535,1499,1465,1435,1403,1375,1345,1319,1293,1267,1243,1219,
+	1197,1175,1153,1133,1113,1093,1073,1055,1037,1019,1003,985,969,953,937,923,
+	907,893,879,865,851,837,823,811,799,785,773,761,751,739,727,717,
+	705,695,683,673,663,653,643,633,623,615,605,595,587,579,569,561,
+	553,543,535,527,519,511,503,497,489,481,473,467,459,453,445,439,
+	431,425,419,411,405,399,393,387,381,375,369,363,357,351,345,339,
+	335,329,323,319,313,307,303,297,293,287,283,277,273,269,263,259,
+	255,251,245,241,237,233,229,225,221,217,213,209,205,201,197,193,
+	189,185,183,179,175,171,167,165,161,157,155,151,149,145,141,139,
+	135,133,129,127,125,121,119,115,113,111,107,105,103,99,97,95,
+	93,91,87,85,83,81,79,77,75,73,71,69,67,65,63,61,
+	59,57,55,53,51,49,47,47,45,43,41,41,39,37,35,35,
+	33,31,31,29,27,27,25,25,23,21,21,19,19,17,17,15,
+	15,15,13,13,11,11,11,9,9,9,7,7,7,5,5,5,
+	5,3,3,3,3,3,3,3,1,1,1,1,1,1,1,1,
+	1,1,1,1,1,1,1,1,3,3,3,3,3,3,3,5,
+	5,5,5,7,7,7,9,9,9,11,11,11,13,13,15,15,
+	15,17,17,19,19,21,21,23,25,25,27,27,29,31,31,33,
+	35,35,37,39,41,41,43,45,47,47,49,51,53,55,57,59,
+	61,63,65,67,69,71,73,75,77,79,81,83,85,87,91,93,
+	95,97,99,103,105,107,111,113,115,119,121,125,127,129,133,135,
+	139,141,145,149,151,155,157,161,165,167,171,175,179,183,185,189,
+	193,197,201,205,209,213,217,221,225,229,233,237,241,245,251,255,
+	259,263,269,273,277,283,287,293,297,303,307,313,319,323,329,335,
+	339,345,351,357,363,369,375,381,387,393,399,405,411,419,425,431,
+	439,445,453,459,467,473,481,489,497,503,511,519,527,535,543,553,
+	561,569,579,587,595,605,615,623,633,643,653,663,673,683,695,705,
+	717,727,739,751,761,773,785,799,811,823,837,851,865,879,893,907,
+	923,937,953,969,985,1003,1019,1037,1055,1073,1093,1113,1133,1153,1175,1197,
+	1219,1243,1267,1293,1319,1345,1375,1403,1435,1465,1499,1535,1571,1609,1651,1693,
+	1739,1789,1841,1899,1959,2027,2101,2183,2275,2381,2505,2653,2839,3087,3463,4275,
+};
+
+/* all 128 LFO PM waveforms: 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */
+static const INT32 lfo_pm_table[128*8*32] = {
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,2,2,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,2,2,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,2,2,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,2,2,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,2,3,3,2,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-2,-3,-3,-2,-2,-2,-1,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,3,3,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-3,-3,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,3,3,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-3,-3,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,3,3,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-3,-3,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,-1,-1,-1,-1,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,1,3,3,1,1,1,1,0,0,0,0,0,0,-1,-1,-1,-1,-3,-3,-1,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,3,4,4,3,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-3,-4,-4,-3,-3,-3,-1,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,4,4,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-4,-4,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,4,4,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-4,-4,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,4,4,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-4,-4,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,4,4,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-4,-4,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,4,4,5,6,6,5,4,4,3,2,0,0,0,0,-2,-3,-4,-4,-5,-6,-6,-5,-4,-4,-3,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,5,5,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-5,-5,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,5,5,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-5,-5,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,5,5,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-5,-5,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,2,2,2,2,1,1,1,0,0,0,0,0,0,-1,-1,-1,-2,-2,-2,-2,-1,-1,-1,0,0,0,
+	0,0,1,1,2,2,3,3,3,3,2,2,1,1,0,0,0,0,-1,-1,-2,-2,-3,-3,-3,-3,-2,-2,-1,-1,0,0,
+	0,0,1,2,2,2,3,5,5,3,2,2,2,1,0,0,0,0,-1,-2,-2,-2,-3,-5,-5,-3,-2,-2,-2,-1,0,0,
+	0,0,2,3,5,5,6,7,7,6,5,5,3,2,0,0,0,0,-2,-3,-5,-5,-6,-7,-7,-6,-5,-5,-3,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,6,6,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-6,-6,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,6,6,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-6,-6,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,6,6,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-6,-6,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,6,6,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-6,-6,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,6,6,7,9,9,7,6,6,4,3,0,0,0,0,-3,-4,-6,-6,-7,-9,-9,-7,-6,-6,-4,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,7,7,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-7,-7,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,7,7,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-7,-7,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,7,7,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-7,-7,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,0,0,0,0,
+	0,0,0,1,1,1,3,3,3,3,1,1,1,0,0,0,0,0,0,-1,-1,-1,-3,-3,-3,-3,-1,-1,-1,0,0,0,
+	0,0,1,1,3,3,4,4,4,4,3,3,1,1,0,0,0,0,-1,-1,-3,-3,-4,-4,-4,-4,-3,-3,-1,-1,0,0,
+	0,0,1,3,3,3,4,7,7,4,3,3,3,1,0,0,0,0,-1,-3,-3,-3,-4,-7,-7,-4,-3,-3,-3,-1,0,0,
+	0,0,3,4,7,7,8,10,10,8,7,7,4,3,0,0,0,0,-3,-4,-7,-7,-8,-10,-10,-8,-7,-7,-4,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,8,8,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-8,-8,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,32,32,40,48,48,40,32,32,24,16,0,0,0,0,-16,-24,-32,-32,-40,-48,-48,-40,-32,-32,-24,-16,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,8,8,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-8,-8,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,33,33,41,49,49,41,33,33,24,16,0,0,0,0,-16,-24,-33,-33,-41,-49,-49,-41,-33,-33,-24,-16,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,8,8,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-8,-8,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,34,34,42,51,51,42,34,34,25,17,0,0,0,0,-17,-25,-34,-34,-42,-51,-51,-42,-34,-34,-25,-17,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,8,8,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-8,-8,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,8,8,10,12,12,10,8,8,6,4,0,0,0,0,-4,-6,-8,-8,-10,-12,-12,-10,-8,-8,-6,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,35,35,43,52,52,43,35,35,25,17,0,0,0,0,-17,-25,-35,-35,-43,-52,-52,-43,-35,-35,-25,-17,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,9,9,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-9,-9,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,36,36,45,54,54,45,36,36,27,18,0,0,0,0,-18,-27,-36,-36,-45,-54,-54,-45,-36,-36,-27,-18,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,9,9,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-9,-9,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,37,37,46,55,55,46,37,37,27,18,0,0,0,0,-18,-27,-37,-37,-46,-55,-55,-46,-37,-37,-27,-18,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,9,9,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-9,-9,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,38,38,47,57,57,47,38,38,28,19,0,0,0,0,-19,-28,-38,-38,-47,-57,-57,-47,-38,-38,-28,-19,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,4,4,4,4,2,2,2,0,0,0,0,0,0,-2,-2,-2,-4,-4,-4,-4,-2,-2,-2,0,0,0,
+	0,0,2,2,4,4,6,6,6,6,4,4,2,2,0,0,0,0,-2,-2,-4,-4,-6,-6,-6,-6,-4,-4,-2,-2,0,0,
+	0,0,2,4,4,4,6,9,9,6,4,4,4,2,0,0,0,0,-2,-4,-4,-4,-6,-9,-9,-6,-4,-4,-4,-2,0,0,
+	0,0,4,6,9,9,11,13,13,11,9,9,6,4,0,0,0,0,-4,-6,-9,-9,-11,-13,-13,-11,-9,-9,-6,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,39,39,48,58,58,48,39,39,28,19,0,0,0,0,-19,-28,-39,-39,-48,-58,-58,-48,-39,-39,-28,-19,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,10,10,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-10,-10,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,40,40,50,60,60,50,40,40,30,20,0,0,0,0,-20,-30,-40,-40,-50,-60,-60,-50,-40,-40,-30,-20,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,10,10,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-10,-10,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,41,41,51,61,61,51,41,41,30,20,0,0,0,0,-20,-30,-41,-41,-51,-61,-61,-51,-41,-41,-30,-20,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,10,10,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-10,-10,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,42,42,52,63,63,52,42,42,31,21,0,0,0,0,-21,-31,-42,-42,-52,-63,-63,-52,-42,-42,-31,-21,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,10,10,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-10,-10,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,10,10,12,15,15,12,10,10,7,5,0,0,0,0,-5,-7,-10,-10,-12,-15,-15,-12,-10,-10,-7,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,43,43,53,64,64,53,43,43,31,21,0,0,0,0,-21,-31,-43,-43,-53,-64,-64,-53,-43,-43,-31,-21,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,11,11,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-11,-11,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,44,44,55,66,66,55,44,44,33,22,0,0,0,0,-22,-33,-44,-44,-55,-66,-66,-55,-44,-44,-33,-22,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,11,11,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-11,-11,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,45,45,56,67,67,56,45,45,33,22,0,0,0,0,-22,-33,-45,-45,-56,-67,-67,-56,-45,-45,-33,-22,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,11,11,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-11,-11,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,46,46,57,69,69,57,46,46,34,23,0,0,0,0,-23,-34,-46,-46,-57,-69,-69,-57,-46,-46,-34,-23,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,-2,-2,-2,-2,-2,-2,-2,-2,0,0,0,0,
+	0,0,0,2,2,2,5,5,5,5,2,2,2,0,0,0,0,0,0,-2,-2,-2,-5,-5,-5,-5,-2,-2,-2,0,0,0,
+	0,0,2,2,5,5,7,7,7,7,5,5,2,2,0,0,0,0,-2,-2,-5,-5,-7,-7,-7,-7,-5,-5,-2,-2,0,0,
+	0,0,2,5,5,5,7,11,11,7,5,5,5,2,0,0,0,0,-2,-5,-5,-5,-7,-11,-11,-7,-5,-5,-5,-2,0,0,
+	0,0,5,7,11,11,13,16,16,13,11,11,7,5,0,0,0,0,-5,-7,-11,-11,-13,-16,-16,-13,-11,-11,-7,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,47,47,58,70,70,58,47,47,34,23,0,0,0,0,-23,-34,-47,-47,-58,-70,-70,-58,-47,-47,-34,-23,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,12,12,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-12,-12,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,48,48,60,72,72,60,48,48,36,24,0,0,0,0,-24,-36,-48,-48,-60,-72,-72,-60,-48,-48,-36,-24,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,12,12,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-12,-12,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,49,49,61,73,73,61,49,49,36,24,0,0,0,0,-24,-36,-49,-49,-61,-73,-73,-61,-49,-49,-36,-24,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,12,12,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-12,-12,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,50,50,62,75,75,62,50,50,37,25,0,0,0,0,-25,-37,-50,-50,-62,-75,-75,-62,-50,-50,-37,-25,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,12,12,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-12,-12,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,12,12,15,18,18,15,12,12,9,6,0,0,0,0,-6,-9,-12,-12,-15,-18,-18,-15,-12,-12,-9,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,51,51,63,76,76,63,51,51,37,25,0,0,0,0,-25,-37,-51,-51,-63,-76,-76,-63,-51,-51,-37,-25,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,13,13,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-13,-13,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,52,52,65,78,78,65,52,52,39,26,0,0,0,0,-26,-39,-52,-52,-65,-78,-78,-65,-52,-52,-39,-26,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,13,13,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-13,-13,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,53,53,66,79,79,66,53,53,39,26,0,0,0,0,-26,-39,-53,-53,-66,-79,-79,-66,-53,-53,-39,-26,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,13,13,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-13,-13,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,54,54,67,81,81,67,54,54,40,27,0,0,0,0,-27,-40,-54,-54,-67,-81,-81,-67,-54,-54,-40,-27,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,6,6,6,6,3,3,3,0,0,0,0,0,0,-3,-3,-3,-6,-6,-6,-6,-3,-3,-3,0,0,0,
+	0,0,3,3,6,6,9,9,9,9,6,6,3,3,0,0,0,0,-3,-3,-6,-6,-9,-9,-9,-9,-6,-6,-3,-3,0,0,
+	0,0,3,6,6,6,9,13,13,9,6,6,6,3,0,0,0,0,-3,-6,-6,-6,-9,-13,-13,-9,-6,-6,-6,-3,0,0,
+	0,0,6,9,13,13,16,19,19,16,13,13,9,6,0,0,0,0,-6,-9,-13,-13,-16,-19,-19,-16,-13,-13,-9,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,55,55,68,82,82,68,55,55,40,27,0,0,0,0,-27,-40,-55,-55,-68,-82,-82,-68,-55,-55,-40,-27,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,14,14,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-14,-14,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,56,56,70,84,84,70,56,56,42,28,0,0,0,0,-28,-42,-56,-56,-70,-84,-84,-70,-56,-56,-42,-28,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,14,14,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-14,-14,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,57,57,71,85,85,71,57,57,42,28,0,0,0,0,-28,-42,-57,-57,-71,-85,-85,-71,-57,-57,-42,-28,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,14,14,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-14,-14,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,58,58,72,87,87,72,58,58,43,29,0,0,0,0,-29,-43,-58,-58,-72,-87,-87,-72,-58,-58,-43,-29,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,14,14,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-14,-14,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,14,14,17,21,21,17,14,14,10,7,0,0,0,0,-7,-10,-14,-14,-17,-21,-21,-17,-14,-14,-10,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,59,59,73,88,88,73,59,59,43,29,0,0,0,0,-29,-43,-59,-59,-73,-88,-88,-73,-59,-59,-43,-29,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,15,15,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-15,-15,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,60,60,75,90,90,75,60,60,45,30,0,0,0,0,-30,-45,-60,-60,-75,-90,-90,-75,-60,-60,-45,-30,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,15,15,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-15,-15,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,61,61,76,91,91,76,61,61,45,30,0,0,0,0,-30,-45,-61,-61,-76,-91,-91,-76,-61,-61,-45,-30,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,15,15,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-15,-15,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,62,62,77,93,93,77,62,62,46,31,0,0,0,0,-31,-46,-62,-62,-77,-93,-93,-77,-62,-62,-46,-31,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,3,3,3,3,3,3,3,3,0,0,0,0,0,0,0,0,-3,-3,-3,-3,-3,-3,-3,-3,0,0,0,0,
+	0,0,0,3,3,3,7,7,7,7,3,3,3,0,0,0,0,0,0,-3,-3,-3,-7,-7,-7,-7,-3,-3,-3,0,0,0,
+	0,0,3,3,7,7,10,10,10,10,7,7,3,3,0,0,0,0,-3,-3,-7,-7,-10,-10,-10,-10,-7,-7,-3,-3,0,0,
+	0,0,3,7,7,7,10,15,15,10,7,7,7,3,0,0,0,0,-3,-7,-7,-7,-10,-15,-15,-10,-7,-7,-7,-3,0,0,
+	0,0,7,10,15,15,18,22,22,18,15,15,10,7,0,0,0,0,-7,-10,-15,-15,-18,-22,-22,-18,-15,-15,-10,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,63,63,78,94,94,78,63,63,46,31,0,0,0,0,-31,-46,-63,-63,-78,-94,-94,-78,-63,-63,-46,-31,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,16,16,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-16,-16,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,32,32,40,48,48,40,32,32,24,16,0,0,0,0,-16,-24,-32,-32,-40,-48,-48,-40,-32,-32,-24,-16,0,0,
+	0,0,32,48,64,64,80,96,96,80,64,64,48,32,0,0,0,0,-32,-48,-64,-64,-80,-96,-96,-80,-64,-64,-48,-32,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,16,16,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-16,-16,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,32,32,40,48,48,40,32,32,24,16,0,0,0,0,-16,-24,-32,-32,-40,-48,-48,-40,-32,-32,-24,-16,0,0,
+	0,0,32,48,65,65,81,97,97,81,65,65,48,32,0,0,0,0,-32,-48,-65,-65,-81,-97,-97,-81,-65,-65,-48,-32,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,16,16,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-16,-16,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,33,33,41,49,49,41,33,33,24,16,0,0,0,0,-16,-24,-33,-33,-41,-49,-49,-41,-33,-33,-24,-16,0,0,
+	0,0,33,49,66,66,82,99,99,82,66,66,49,33,0,0,0,0,-33,-49,-66,-66,-82,-99,-99,-82,-66,-66,-49,-33,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,16,16,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-16,-16,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,16,16,20,24,24,20,16,16,12,8,0,0,0,0,-8,-12,-16,-16,-20,-24,-24,-20,-16,-16,-12,-8,0,0,
+	0,0,16,24,33,33,41,49,49,41,33,33,24,16,0,0,0,0,-16,-24,-33,-33,-41,-49,-49,-41,-33,-33,-24,-16,0,0,
+	0,0,33,49,67,67,83,100,100,83,67,67,49,33,0,0,0,0,-33,-49,-67,-67,-83,-100,-100,-83,-67,-67,-49,-33,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,17,17,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-17,-17,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,34,34,42,51,51,42,34,34,25,17,0,0,0,0,-17,-25,-34,-34,-42,-51,-51,-42,-34,-34,-25,-17,0,0,
+	0,0,34,51,68,68,85,102,102,85,68,68,51,34,0,0,0,0,-34,-51,-68,-68,-85,-102,-102,-85,-68,-68,-51,-34,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,17,17,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-17,-17,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,34,34,42,51,51,42,34,34,25,17,0,0,0,0,-17,-25,-34,-34,-42,-51,-51,-42,-34,-34,-25,-17,0,0,
+	0,0,34,51,69,69,86,103,103,86,69,69,51,34,0,0,0,0,-34,-51,-69,-69,-86,-103,-103,-86,-69,-69,-51,-34,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,17,17,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-17,-17,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,35,35,43,52,52,43,35,35,25,17,0,0,0,0,-17,-25,-35,-35,-43,-52,-52,-43,-35,-35,-25,-17,0,0,
+	0,0,35,52,70,70,87,105,105,87,70,70,52,35,0,0,0,0,-35,-52,-70,-70,-87,-105,-105,-87,-70,-70,-52,-35,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,8,8,8,8,4,4,4,0,0,0,0,0,0,-4,-4,-4,-8,-8,-8,-8,-4,-4,-4,0,0,0,
+	0,0,4,4,8,8,12,12,12,12,8,8,4,4,0,0,0,0,-4,-4,-8,-8,-12,-12,-12,-12,-8,-8,-4,-4,0,0,
+	0,0,4,8,8,8,12,17,17,12,8,8,8,4,0,0,0,0,-4,-8,-8,-8,-12,-17,-17,-12,-8,-8,-8,-4,0,0,
+	0,0,8,12,17,17,21,25,25,21,17,17,12,8,0,0,0,0,-8,-12,-17,-17,-21,-25,-25,-21,-17,-17,-12,-8,0,0,
+	0,0,17,25,35,35,43,52,52,43,35,35,25,17,0,0,0,0,-17,-25,-35,-35,-43,-52,-52,-43,-35,-35,-25,-17,0,0,
+	0,0,35,52,71,71,88,106,106,88,71,71,52,35,0,0,0,0,-35,-52,-71,-71,-88,-106,-106,-88,-71,-71,-52,-35,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,18,18,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-18,-18,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,36,36,45,54,54,45,36,36,27,18,0,0,0,0,-18,-27,-36,-36,-45,-54,-54,-45,-36,-36,-27,-18,0,0,
+	0,0,36,54,72,72,90,108,108,90,72,72,54,36,0,0,0,0,-36,-54,-72,-72,-90,-108,-108,-90,-72,-72,-54,-36,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,18,18,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-18,-18,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,36,36,45,54,54,45,36,36,27,18,0,0,0,0,-18,-27,-36,-36,-45,-54,-54,-45,-36,-36,-27,-18,0,0,
+	0,0,36,54,73,73,91,109,109,91,73,73,54,36,0,0,0,0,-36,-54,-73,-73,-91,-109,-109,-91,-73,-73,-54,-36,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,18,18,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-18,-18,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,37,37,46,55,55,46,37,37,27,18,0,0,0,0,-18,-27,-37,-37,-46,-55,-55,-46,-37,-37,-27,-18,0,0,
+	0,0,37,55,74,74,92,111,111,92,74,74,55,37,0,0,0,0,-37,-55,-74,-74,-92,-111,-111,-92,-74,-74,-55,-37,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,18,18,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-18,-18,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,18,18,22,27,27,22,18,18,13,9,0,0,0,0,-9,-13,-18,-18,-22,-27,-27,-22,-18,-18,-13,-9,0,0,
+	0,0,18,27,37,37,46,55,55,46,37,37,27,18,0,0,0,0,-18,-27,-37,-37,-46,-55,-55,-46,-37,-37,-27,-18,0,0,
+	0,0,37,55,75,75,93,112,112,93,75,75,55,37,0,0,0,0,-37,-55,-75,-75,-93,-112,-112,-93,-75,-75,-55,-37,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,19,19,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-19,-19,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,38,38,47,57,57,47,38,38,28,19,0,0,0,0,-19,-28,-38,-38,-47,-57,-57,-47,-38,-38,-28,-19,0,0,
+	0,0,38,57,76,76,95,114,114,95,76,76,57,38,0,0,0,0,-38,-57,-76,-76,-95,-114,-114,-95,-76,-76,-57,-38,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,19,19,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-19,-19,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,38,38,47,57,57,47,38,38,28,19,0,0,0,0,-19,-28,-38,-38,-47,-57,-57,-47,-38,-38,-28,-19,0,0,
+	0,0,38,57,77,77,96,115,115,96,77,77,57,38,0,0,0,0,-38,-57,-77,-77,-96,-115,-115,-96,-77,-77,-57,-38,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,19,19,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-19,-19,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,39,39,48,58,58,48,39,39,28,19,0,0,0,0,-19,-28,-39,-39,-48,-58,-58,-48,-39,-39,-28,-19,0,0,
+	0,0,39,58,78,78,97,117,117,97,78,78,58,39,0,0,0,0,-39,-58,-78,-78,-97,-117,-117,-97,-78,-78,-58,-39,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,4,4,4,4,4,4,4,4,0,0,0,0,0,0,0,0,-4,-4,-4,-4,-4,-4,-4,-4,0,0,0,0,
+	0,0,0,4,4,4,9,9,9,9,4,4,4,0,0,0,0,0,0,-4,-4,-4,-9,-9,-9,-9,-4,-4,-4,0,0,0,
+	0,0,4,4,9,9,13,13,13,13,9,9,4,4,0,0,0,0,-4,-4,-9,-9,-13,-13,-13,-13,-9,-9,-4,-4,0,0,
+	0,0,4,9,9,9,13,19,19,13,9,9,9,4,0,0,0,0,-4,-9,-9,-9,-13,-19,-19,-13,-9,-9,-9,-4,0,0,
+	0,0,9,13,19,19,23,28,28,23,19,19,13,9,0,0,0,0,-9,-13,-19,-19,-23,-28,-28,-23,-19,-19,-13,-9,0,0,
+	0,0,19,28,39,39,48,58,58,48,39,39,28,19,0,0,0,0,-19,-28,-39,-39,-48,-58,-58,-48,-39,-39,-28,-19,0,0,
+	0,0,39,58,79,79,98,118,118,98,79,79,58,39,0,0,0,0,-39,-58,-79,-79,-98,-118,-118,-98,-79,-79,-58,-39,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,20,20,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-20,-20,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,40,40,50,60,60,50,40,40,30,20,0,0,0,0,-20,-30,-40,-40,-50,-60,-60,-50,-40,-40,-30,-20,0,0,
+	0,0,40,60,80,80,100,120,120,100,80,80,60,40,0,0,0,0,-40,-60,-80,-80,-100,-120,-120,-100,-80,-80,-60,-40,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,20,20,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-20,-20,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,40,40,50,60,60,50,40,40,30,20,0,0,0,0,-20,-30,-40,-40,-50,-60,-60,-50,-40,-40,-30,-20,0,0,
+	0,0,40,60,81,81,101,121,121,101,81,81,60,40,0,0,0,0,-40,-60,-81,-81,-101,-121,-121,-101,-81,-81,-60,-40,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,20,20,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-20,-20,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,41,41,51,61,61,51,41,41,30,20,0,0,0,0,-20,-30,-41,-41,-51,-61,-61,-51,-41,-41,-30,-20,0,0,
+	0,0,41,61,82,82,102,123,123,102,82,82,61,41,0,0,0,0,-41,-61,-82,-82,-102,-123,-123,-102,-82,-82,-61,-41,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,20,20,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-20,-20,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,20,20,25,30,30,25,20,20,15,10,0,0,0,0,-10,-15,-20,-20,-25,-30,-30,-25,-20,-20,-15,-10,0,0,
+	0,0,20,30,41,41,51,61,61,51,41,41,30,20,0,0,0,0,-20,-30,-41,-41,-51,-61,-61,-51,-41,-41,-30,-20,0,0,
+	0,0,41,61,83,83,103,124,124,103,83,83,61,41,0,0,0,0,-41,-61,-83,-83,-103,-124,-124,-103,-83,-83,-61,-41,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,21,21,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-21,-21,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,42,42,52,63,63,52,42,42,31,21,0,0,0,0,-21,-31,-42,-42,-52,-63,-63,-52,-42,-42,-31,-21,0,0,
+	0,0,42,63,84,84,105,126,126,105,84,84,63,42,0,0,0,0,-42,-63,-84,-84,-105,-126,-126,-105,-84,-84,-63,-42,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,21,21,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-21,-21,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,42,42,52,63,63,52,42,42,31,21,0,0,0,0,-21,-31,-42,-42,-52,-63,-63,-52,-42,-42,-31,-21,0,0,
+	0,0,42,63,85,85,106,127,127,106,85,85,63,42,0,0,0,0,-42,-63,-85,-85,-106,-127,-127,-106,-85,-85,-63,-42,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,21,21,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-21,-21,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,43,43,53,64,64,53,43,43,31,21,0,0,0,0,-21,-31,-43,-43,-53,-64,-64,-53,-43,-43,-31,-21,0,0,
+	0,0,43,64,86,86,107,129,129,107,86,86,64,43,0,0,0,0,-43,-64,-86,-86,-107,-129,-129,-107,-86,-86,-64,-43,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,10,10,10,10,5,5,5,0,0,0,0,0,0,-5,-5,-5,-10,-10,-10,-10,-5,-5,-5,0,0,0,
+	0,0,5,5,10,10,15,15,15,15,10,10,5,5,0,0,0,0,-5,-5,-10,-10,-15,-15,-15,-15,-10,-10,-5,-5,0,0,
+	0,0,5,10,10,10,15,21,21,15,10,10,10,5,0,0,0,0,-5,-10,-10,-10,-15,-21,-21,-15,-10,-10,-10,-5,0,0,
+	0,0,10,15,21,21,26,31,31,26,21,21,15,10,0,0,0,0,-10,-15,-21,-21,-26,-31,-31,-26,-21,-21,-15,-10,0,0,
+	0,0,21,31,43,43,53,64,64,53,43,43,31,21,0,0,0,0,-21,-31,-43,-43,-53,-64,-64,-53,-43,-43,-31,-21,0,0,
+	0,0,43,64,87,87,108,130,130,108,87,87,64,43,0,0,0,0,-43,-64,-87,-87,-108,-130,-130,-108,-87,-87,-64,-43,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,22,22,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-22,-22,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,44,44,55,66,66,55,44,44,33,22,0,0,0,0,-22,-33,-44,-44,-55,-66,-66,-55,-44,-44,-33,-22,0,0,
+	0,0,44,66,88,88,110,132,132,110,88,88,66,44,0,0,0,0,-44,-66,-88,-88,-110,-132,-132,-110,-88,-88,-66,-44,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,22,22,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-22,-22,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,44,44,55,66,66,55,44,44,33,22,0,0,0,0,-22,-33,-44,-44,-55,-66,-66,-55,-44,-44,-33,-22,0,0,
+	0,0,44,66,89,89,111,133,133,111,89,89,66,44,0,0,0,0,-44,-66,-89,-89,-111,-133,-133,-111,-89,-89,-66,-44,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,22,22,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-22,-22,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,45,45,56,67,67,56,45,45,33,22,0,0,0,0,-22,-33,-45,-45,-56,-67,-67,-56,-45,-45,-33,-22,0,0,
+	0,0,45,67,90,90,112,135,135,112,90,90,67,45,0,0,0,0,-45,-67,-90,-90,-112,-135,-135,-112,-90,-90,-67,-45,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,22,22,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-22,-22,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,22,22,27,33,33,27,22,22,16,11,0,0,0,0,-11,-16,-22,-22,-27,-33,-33,-27,-22,-22,-16,-11,0,0,
+	0,0,22,33,45,45,56,67,67,56,45,45,33,22,0,0,0,0,-22,-33,-45,-45,-56,-67,-67,-56,-45,-45,-33,-22,0,0,
+	0,0,45,67,91,91,113,136,136,113,91,91,67,45,0,0,0,0,-45,-67,-91,-91,-113,-136,-136,-113,-91,-91,-67,-45,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,23,23,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-23,-23,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,46,46,57,69,69,57,46,46,34,23,0,0,0,0,-23,-34,-46,-46,-57,-69,-69,-57,-46,-46,-34,-23,0,0,
+	0,0,46,69,92,92,115,138,138,115,92,92,69,46,0,0,0,0,-46,-69,-92,-92,-115,-138,-138,-115,-92,-92,-69,-46,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,23,23,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-23,-23,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,46,46,57,69,69,57,46,46,34,23,0,0,0,0,-23,-34,-46,-46,-57,-69,-69,-57,-46,-46,-34,-23,0,0,
+	0,0,46,69,93,93,116,139,139,116,93,93,69,46,0,0,0,0,-46,-69,-93,-93,-116,-139,-139,-116,-93,-93,-69,-46,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,23,23,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-23,-23,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,47,47,58,70,70,58,47,47,34,23,0,0,0,0,-23,-34,-47,-47,-58,-70,-70,-58,-47,-47,-34,-23,0,0,
+	0,0,47,70,94,94,117,141,141,117,94,94,70,47,0,0,0,0,-47,-70,-94,-94,-117,-141,-141,-117,-94,-94,-70,-47,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,5,5,5,5,5,5,5,5,0,0,0,0,0,0,0,0,-5,-5,-5,-5,-5,-5,-5,-5,0,0,0,0,
+	0,0,0,5,5,5,11,11,11,11,5,5,5,0,0,0,0,0,0,-5,-5,-5,-11,-11,-11,-11,-5,-5,-5,0,0,0,
+	0,0,5,5,11,11,16,16,16,16,11,11,5,5,0,0,0,0,-5,-5,-11,-11,-16,-16,-16,-16,-11,-11,-5,-5,0,0,
+	0,0,5,11,11,11,16,23,23,16,11,11,11,5,0,0,0,0,-5,-11,-11,-11,-16,-23,-23,-16,-11,-11,-11,-5,0,0,
+	0,0,11,16,23,23,28,34,34,28,23,23,16,11,0,0,0,0,-11,-16,-23,-23,-28,-34,-34,-28,-23,-23,-16,-11,0,0,
+	0,0,23,34,47,47,58,70,70,58,47,47,34,23,0,0,0,0,-23,-34,-47,-47,-58,-70,-70,-58,-47,-47,-34,-23,0,0,
+	0,0,47,70,95,95,118,142,142,118,95,95,70,47,0,0,0,0,-47,-70,-95,-95,-118,-142,-142,-118,-95,-95,-70,-47,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,24,24,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-24,-24,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,48,48,60,72,72,60,48,48,36,24,0,0,0,0,-24,-36,-48,-48,-60,-72,-72,-60,-48,-48,-36,-24,0,0,
+	0,0,48,72,96,96,120,144,144,120,96,96,72,48,0,0,0,0,-48,-72,-96,-96,-120,-144,-144,-120,-96,-96,-72,-48,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,24,24,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-24,-24,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,48,48,60,72,72,60,48,48,36,24,0,0,0,0,-24,-36,-48,-48,-60,-72,-72,-60,-48,-48,-36,-24,0,0,
+	0,0,48,72,97,97,121,145,145,121,97,97,72,48,0,0,0,0,-48,-72,-97,-97,-121,-145,-145,-121,-97,-97,-72,-48,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,24,24,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-24,-24,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,49,49,61,73,73,61,49,49,36,24,0,0,0,0,-24,-36,-49,-49,-61,-73,-73,-61,-49,-49,-36,-24,0,0,
+	0,0,49,73,98,98,122,147,147,122,98,98,73,49,0,0,0,0,-49,-73,-98,-98,-122,-147,-147,-122,-98,-98,-73,-49,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,24,24,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-24,-24,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,24,24,30,36,36,30,24,24,18,12,0,0,0,0,-12,-18,-24,-24,-30,-36,-36,-30,-24,-24,-18,-12,0,0,
+	0,0,24,36,49,49,61,73,73,61,49,49,36,24,0,0,0,0,-24,-36,-49,-49,-61,-73,-73,-61,-49,-49,-36,-24,0,0,
+	0,0,49,73,99,99,123,148,148,123,99,99,73,49,0,0,0,0,-49,-73,-99,-99,-123,-148,-148,-123,-99,-99,-73,-49,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,25,25,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-25,-25,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,50,50,62,75,75,62,50,50,37,25,0,0,0,0,-25,-37,-50,-50,-62,-75,-75,-62,-50,-50,-37,-25,0,0,
+	0,0,50,75,100,100,125,150,150,125,100,100,75,50,0,0,0,0,-50,-75,-100,-100,-125,-150,-150,-125,-100,-100,-75,-50,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,25,25,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-25,-25,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,50,50,62,75,75,62,50,50,37,25,0,0,0,0,-25,-37,-50,-50,-62,-75,-75,-62,-50,-50,-37,-25,0,0,
+	0,0,50,75,101,101,126,151,151,126,101,101,75,50,0,0,0,0,-50,-75,-101,-101,-126,-151,-151,-126,-101,-101,-75,-50,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,25,25,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-25,-25,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,51,51,63,76,76,63,51,51,37,25,0,0,0,0,-25,-37,-51,-51,-63,-76,-76,-63,-51,-51,-37,-25,0,0,
+	0,0,51,76,102,102,127,153,153,127,102,102,76,51,0,0,0,0,-51,-76,-102,-102,-127,-153,-153,-127,-102,-102,-76,-51,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,12,12,12,12,6,6,6,0,0,0,0,0,0,-6,-6,-6,-12,-12,-12,-12,-6,-6,-6,0,0,0,
+	0,0,6,6,12,12,18,18,18,18,12,12,6,6,0,0,0,0,-6,-6,-12,-12,-18,-18,-18,-18,-12,-12,-6,-6,0,0,
+	0,0,6,12,12,12,18,25,25,18,12,12,12,6,0,0,0,0,-6,-12,-12,-12,-18,-25,-25,-18,-12,-12,-12,-6,0,0,
+	0,0,12,18,25,25,31,37,37,31,25,25,18,12,0,0,0,0,-12,-18,-25,-25,-31,-37,-37,-31,-25,-25,-18,-12,0,0,
+	0,0,25,37,51,51,63,76,76,63,51,51,37,25,0,0,0,0,-25,-37,-51,-51,-63,-76,-76,-63,-51,-51,-37,-25,0,0,
+	0,0,51,76,103,103,128,154,154,128,103,103,76,51,0,0,0,0,-51,-76,-103,-103,-128,-154,-154,-128,-103,-103,-76,-51,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,26,26,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-26,-26,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,52,52,65,78,78,65,52,52,39,26,0,0,0,0,-26,-39,-52,-52,-65,-78,-78,-65,-52,-52,-39,-26,0,0,
+	0,0,52,78,104,104,130,156,156,130,104,104,78,52,0,0,0,0,-52,-78,-104,-104,-130,-156,-156,-130,-104,-104,-78,-52,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,26,26,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-26,-26,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,52,52,65,78,78,65,52,52,39,26,0,0,0,0,-26,-39,-52,-52,-65,-78,-78,-65,-52,-52,-39,-26,0,0,
+	0,0,52,78,105,105,131,157,157,131,105,105,78,52,0,0,0,0,-52,-78,-105,-105,-131,-157,-157,-131,-105,-105,-78,-52,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,26,26,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-26,-26,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,53,53,66,79,79,66,53,53,39,26,0,0,0,0,-26,-39,-53,-53,-66,-79,-79,-66,-53,-53,-39,-26,0,0,
+	0,0,53,79,106,106,132,159,159,132,106,106,79,53,0,0,0,0,-53,-79,-106,-106,-132,-159,-159,-132,-106,-106,-79,-53,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,26,26,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-26,-26,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,26,26,32,39,39,32,26,26,19,13,0,0,0,0,-13,-19,-26,-26,-32,-39,-39,-32,-26,-26,-19,-13,0,0,
+	0,0,26,39,53,53,66,79,79,66,53,53,39,26,0,0,0,0,-26,-39,-53,-53,-66,-79,-79,-66,-53,-53,-39,-26,0,0,
+	0,0,53,79,107,107,133,160,160,133,107,107,79,53,0,0,0,0,-53,-79,-107,-107,-133,-160,-160,-133,-107,-107,-79,-53,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,27,27,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-27,-27,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,54,54,67,81,81,67,54,54,40,27,0,0,0,0,-27,-40,-54,-54,-67,-81,-81,-67,-54,-54,-40,-27,0,0,
+	0,0,54,81,108,108,135,162,162,135,108,108,81,54,0,0,0,0,-54,-81,-108,-108,-135,-162,-162,-135,-108,-108,-81,-54,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,27,27,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-27,-27,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,54,54,67,81,81,67,54,54,40,27,0,0,0,0,-27,-40,-54,-54,-67,-81,-81,-67,-54,-54,-40,-27,0,0,
+	0,0,54,81,109,109,136,163,163,136,109,109,81,54,0,0,0,0,-54,-81,-109,-109,-136,-163,-163,-136,-109,-109,-81,-54,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,27,27,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-27,-27,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,55,55,68,82,82,68,55,55,40,27,0,0,0,0,-27,-40,-55,-55,-68,-82,-82,-68,-55,-55,-40,-27,0,0,
+	0,0,55,82,110,110,137,165,165,137,110,110,82,55,0,0,0,0,-55,-82,-110,-110,-137,-165,-165,-137,-110,-110,-82,-55,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,6,6,6,6,6,6,6,6,0,0,0,0,0,0,0,0,-6,-6,-6,-6,-6,-6,-6,-6,0,0,0,0,
+	0,0,0,6,6,6,13,13,13,13,6,6,6,0,0,0,0,0,0,-6,-6,-6,-13,-13,-13,-13,-6,-6,-6,0,0,0,
+	0,0,6,6,13,13,19,19,19,19,13,13,6,6,0,0,0,0,-6,-6,-13,-13,-19,-19,-19,-19,-13,-13,-6,-6,0,0,
+	0,0,6,13,13,13,19,27,27,19,13,13,13,6,0,0,0,0,-6,-13,-13,-13,-19,-27,-27,-19,-13,-13,-13,-6,0,0,
+	0,0,13,19,27,27,33,40,40,33,27,27,19,13,0,0,0,0,-13,-19,-27,-27,-33,-40,-40,-33,-27,-27,-19,-13,0,0,
+	0,0,27,40,55,55,68,82,82,68,55,55,40,27,0,0,0,0,-27,-40,-55,-55,-68,-82,-82,-68,-55,-55,-40,-27,0,0,
+	0,0,55,82,111,111,138,166,166,138,111,111,82,55,0,0,0,0,-55,-82,-111,-111,-138,-166,-166,-138,-111,-111,-82,-55,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,28,28,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-28,-28,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,56,56,70,84,84,70,56,56,42,28,0,0,0,0,-28,-42,-56,-56,-70,-84,-84,-70,-56,-56,-42,-28,0,0,
+	0,0,56,84,112,112,140,168,168,140,112,112,84,56,0,0,0,0,-56,-84,-112,-112,-140,-168,-168,-140,-112,-112,-84,-56,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,28,28,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-28,-28,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,56,56,70,84,84,70,56,56,42,28,0,0,0,0,-28,-42,-56,-56,-70,-84,-84,-70,-56,-56,-42,-28,0,0,
+	0,0,56,84,113,113,141,169,169,141,113,113,84,56,0,0,0,0,-56,-84,-113,-113,-141,-169,-169,-141,-113,-113,-84,-56,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,28,28,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-28,-28,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,57,57,71,85,85,71,57,57,42,28,0,0,0,0,-28,-42,-57,-57,-71,-85,-85,-71,-57,-57,-42,-28,0,0,
+	0,0,57,85,114,114,142,171,171,142,114,114,85,57,0,0,0,0,-57,-85,-114,-114,-142,-171,-171,-142,-114,-114,-85,-57,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,28,28,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-28,-28,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,28,28,35,42,42,35,28,28,21,14,0,0,0,0,-14,-21,-28,-28,-35,-42,-42,-35,-28,-28,-21,-14,0,0,
+	0,0,28,42,57,57,71,85,85,71,57,57,42,28,0,0,0,0,-28,-42,-57,-57,-71,-85,-85,-71,-57,-57,-42,-28,0,0,
+	0,0,57,85,115,115,143,172,172,143,115,115,85,57,0,0,0,0,-57,-85,-115,-115,-143,-172,-172,-143,-115,-115,-85,-57,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,29,29,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-29,-29,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,58,58,72,87,87,72,58,58,43,29,0,0,0,0,-29,-43,-58,-58,-72,-87,-87,-72,-58,-58,-43,-29,0,0,
+	0,0,58,87,116,116,145,174,174,145,116,116,87,58,0,0,0,0,-58,-87,-116,-116,-145,-174,-174,-145,-116,-116,-87,-58,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,29,29,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-29,-29,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,58,58,72,87,87,72,58,58,43,29,0,0,0,0,-29,-43,-58,-58,-72,-87,-87,-72,-58,-58,-43,-29,0,0,
+	0,0,58,87,117,117,146,175,175,146,117,117,87,58,0,0,0,0,-58,-87,-117,-117,-146,-175,-175,-146,-117,-117,-87,-58,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,29,29,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-29,-29,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,59,59,73,88,88,73,59,59,43,29,0,0,0,0,-29,-43,-59,-59,-73,-88,-88,-73,-59,-59,-43,-29,0,0,
+	0,0,59,88,118,118,147,177,177,147,118,118,88,59,0,0,0,0,-59,-88,-118,-118,-147,-177,-177,-147,-118,-118,-88,-59,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,14,14,14,14,7,7,7,0,0,0,0,0,0,-7,-7,-7,-14,-14,-14,-14,-7,-7,-7,0,0,0,
+	0,0,7,7,14,14,21,21,21,21,14,14,7,7,0,0,0,0,-7,-7,-14,-14,-21,-21,-21,-21,-14,-14,-7,-7,0,0,
+	0,0,7,14,14,14,21,29,29,21,14,14,14,7,0,0,0,0,-7,-14,-14,-14,-21,-29,-29,-21,-14,-14,-14,-7,0,0,
+	0,0,14,21,29,29,36,43,43,36,29,29,21,14,0,0,0,0,-14,-21,-29,-29,-36,-43,-43,-36,-29,-29,-21,-14,0,0,
+	0,0,29,43,59,59,73,88,88,73,59,59,43,29,0,0,0,0,-29,-43,-59,-59,-73,-88,-88,-73,-59,-59,-43,-29,0,0,
+	0,0,59,88,119,119,148,178,178,148,119,119,88,59,0,0,0,0,-59,-88,-119,-119,-148,-178,-178,-148,-119,-119,-88,-59,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,30,30,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-30,-30,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,60,60,75,90,90,75,60,60,45,30,0,0,0,0,-30,-45,-60,-60,-75,-90,-90,-75,-60,-60,-45,-30,0,0,
+	0,0,60,90,120,120,150,180,180,150,120,120,90,60,0,0,0,0,-60,-90,-120,-120,-150,-180,-180,-150,-120,-120,-90,-60,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,30,30,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-30,-30,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,60,60,75,90,90,75,60,60,45,30,0,0,0,0,-30,-45,-60,-60,-75,-90,-90,-75,-60,-60,-45,-30,0,0,
+	0,0,60,90,121,121,151,181,181,151,121,121,90,60,0,0,0,0,-60,-90,-121,-121,-151,-181,-181,-151,-121,-121,-90,-60,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,30,30,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-30,-30,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,61,61,76,91,91,76,61,61,45,30,0,0,0,0,-30,-45,-61,-61,-76,-91,-91,-76,-61,-61,-45,-30,0,0,
+	0,0,61,91,122,122,152,183,183,152,122,122,91,61,0,0,0,0,-61,-91,-122,-122,-152,-183,-183,-152,-122,-122,-91,-61,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,30,30,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-30,-30,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,30,30,37,45,45,37,30,30,22,15,0,0,0,0,-15,-22,-30,-30,-37,-45,-45,-37,-30,-30,-22,-15,0,0,
+	0,0,30,45,61,61,76,91,91,76,61,61,45,30,0,0,0,0,-30,-45,-61,-61,-76,-91,-91,-76,-61,-61,-45,-30,0,0,
+	0,0,61,91,123,123,153,184,184,153,123,123,91,61,0,0,0,0,-61,-91,-123,-123,-153,-184,-184,-153,-123,-123,-91,-61,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,31,31,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-31,-31,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,62,62,77,93,93,77,62,62,46,31,0,0,0,0,-31,-46,-62,-62,-77,-93,-93,-77,-62,-62,-46,-31,0,0,
+	0,0,62,93,124,124,155,186,186,155,124,124,93,62,0,0,0,0,-62,-93,-124,-124,-155,-186,-186,-155,-124,-124,-93,-62,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,31,31,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-31,-31,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,62,62,77,93,93,77,62,62,46,31,0,0,0,0,-31,-46,-62,-62,-77,-93,-93,-77,-62,-62,-46,-31,0,0,
+	0,0,62,93,125,125,156,187,187,156,125,125,93,62,0,0,0,0,-62,-93,-125,-125,-156,-187,-187,-156,-125,-125,-93,-62,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,31,31,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-31,-31,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,63,63,78,94,94,78,63,63,46,31,0,0,0,0,-31,-46,-63,-63,-78,-94,-94,-78,-63,-63,-46,-31,0,0,
+	0,0,63,94,126,126,157,189,189,157,126,126,94,63,0,0,0,0,-63,-94,-126,-126,-157,-189,-189,-157,-126,-126,-94,-63,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,7,7,7,7,7,7,7,7,0,0,0,0,0,0,0,0,-7,-7,-7,-7,-7,-7,-7,-7,0,0,0,0,
+	0,0,0,7,7,7,15,15,15,15,7,7,7,0,0,0,0,0,0,-7,-7,-7,-15,-15,-15,-15,-7,-7,-7,0,0,0,
+	0,0,7,7,15,15,22,22,22,22,15,15,7,7,0,0,0,0,-7,-7,-15,-15,-22,-22,-22,-22,-15,-15,-7,-7,0,0,
+	0,0,7,15,15,15,22,31,31,22,15,15,15,7,0,0,0,0,-7,-15,-15,-15,-22,-31,-31,-22,-15,-15,-15,-7,0,0,
+	0,0,15,22,31,31,38,46,46,38,31,31,22,15,0,0,0,0,-15,-22,-31,-31,-38,-46,-46,-38,-31,-31,-22,-15,0,0,
+	0,0,31,46,63,63,78,94,94,78,63,63,46,31,0,0,0,0,-31,-46,-63,-63,-78,-94,-94,-78,-63,-63,-46,-31,0,0,
+	0,0,63,94,127,127,158,190,190,158,127,127,94,63,0,0,0,0,-63,-94,-127,-127,-158,-190,-190,-158,-127,-127,-94,-63,0,0,
+};
+
+/* ADPCM-A difference for each step and nibble */
+static const int jedi_table[49*16] = {
+	2,6,10,14,18,22,26,30,-2,-6,-10,-14,-18,-22,-26,-30,
+	2,6,10,14,19,23,27,31,-2,-6,-10,-14,-19,-23,-27,-31,
+	2,7,11,16,21,26,30,35,-2,-7,-11,-16,-21,-26,-30,-35,
+	2,7,13,18,23,28,34,39,-2,-7,-13,-18,-23,-28,-34,-39,
+	2,8,14,20,25,31,37,43,-2,-8,-14,-20,-25,-31,-37,-43,
+	3,9,15,21,28,34,40,46,-3,-9,-15,-21,-28,-34,-40,-46,
+	3,10,17,24,31,38,45,52,-3,-10,-17,-24,-31,-38,-45,-52,
+	3,11,19,27,34,42,50,58,-3,-11,-19,-27,-34,-42,-50,-58,
+	4,12,21,29,38,46,55,63,-4,-12,-21,-29,-38,-46,-55,-63,
+	4,13,23,32,41,50,60,69,-4,-13,-23,-32,-41,-50,-60,-69,
+	5,15,25,35,46,56,66,76,-5,-15,-25,-35,-46,-56,-66,-76,
+	5,16,28,39,50,61,73,84,-5,-16,-28,-39,-50,-61,-73,-84,
+	6,18,31,43,56,68,81,93,-6,-18,-31,-43,-56,-68,-81,-93,
+	6,20,34,48,61,75,89,103,-6,-20,-34,-48,-61,-75,-89,-103,
+	7,22,37,52,67,82,97,112,-7,-22,-37,-52,-67,-82,-97,-112,
+	8,24,41,57,74,90,107,123,-8,-24,-41,-57,-74,-90,-107,-123,
+	9,27,45,63,82,100,118,136,-9,-27,-45,-63,-82,-100,-118,-136,
+	10,30,50,70,90,110,130,150,-10,-30,-50,-70,-90,-110,-130,-150,
+	11,33,55,77,99,121,143,165,-11,-33,-55,-77,-99,-121,-143,-165,
+	12,36,60,84,109,133,157,181,-12,-36,-60,-84,-109,-133,-157,-181,
+	13,40,66,93,120,147,173,200,-13,-40,-66,-93,-120,-147,-173,-200,
+	14,44,73,103,132,162,191,221,-14,-44,-73,-103,-132,-162,-191,-221,
+	16,48,81,113,146,178,211,243,-16,-48,-81,-113,-146,-178,-211,-243,
+	17,53,89,125,160,196,232,268,-17,-53,-89,-125,-160,-196,-232,-268,
+	19,58,98,137,176,215,255,294,-19,-58,-98,-137,-176,-215,-255,-294,
+	21,64,108,151,194,237,281,324,-21,-64,-108,-151,-194,-237,-281,-324,
+	23,71,118,166,213,261,308,356,-23,-71,-118,-166,-213,-261,-308,-356,
+	26,78,130,182,235,287,339,391,-26,-78,-130,-182,-235,-287,-339,-391,
+	28,86,143,201,258,316,373,431,-28,-86,-143,-201,-258,-316,-373,-431,
+	31,94,158,221,284,347,411,474,-31,-94,-158,-221,-284,-347,-411,-474,
+	34,104,174,244,313,383,453,523,-34,-104,-174,-244,-313,-383,-453,-523,
+	38,115,191,268,345,422,498,575,-38,-115,-191,-268,-345,-422,-498,-575,
+	42,126,210,294,379,463,547,631,-42,-126,-210,-294,-379,-463,-547,-631,
+	46,139,231,324,417,510,602,695,-46,-139,-231,-324,-417,-510,-602,-695,
+	51,153,255,357,459,561,663,765,-51,-153,-255,-357,-459,-561,-663,-765,
+	56,168,280,392,505,617,729,841,-56,-168,-280,-392,-505,-617,-729,-841,
+	61,185,308,432,555,679,802,926,-61,-185,-308,-432,-555,-679,-802,-926,
+	68,204,340,476,612,748,884,1020,-68,-204,-340,-476,-612,-748,-884,-1020,
+	74,224,373,523,672,822,971,1121,-74,-224,-373,-523,-672,-822,-971,-1121,
+	82,246,411,575,740,904,1069,1233,-82,-246,-411,-575,-740,-904,-1069,-1233,
+	90,271,452,633,814,995,1176,1357,-90,-271,-452,-633,-814,-995,-1176,-1357,
+	99,298,497,696,895,1094,1293,1492,-99,-298,-497,-696,-895,-1094,-1293,-1492,
+	109,328,547,766,985,1204,1423,1642,-109,-328,-547,-766,-985,-1204,-1423,-1642,
+	120,361,601,842,1083,1324,1564,1805,-120,-361,-601,-842,-1083,-1324,-1564,-1805,
+	132,397,662,927,1192,1457,1722,1987,-132,-397,-662,-927,-1192,-1457,-1722,-1987,
+	145,437,728,1020,1311,1603,1894,2186,-145,-437,-728,-1020,-1311,-1603,-1894,-2186,
+	160,480,801,1121,1442,1762,2083,2403,-160,-480,-801,-1121,-1442,-1762,-2083,-2403,
+	176,529,881,1234,1587,1940,2292,2645,-176,-529,-881,-1234,-1587,-1940,-2292,-2645,
+	194,582,970,1358,1746,2134,2522,2910,-194,-582,-970,-1358,-1746,-2134,-2522,-2910,
+};
+
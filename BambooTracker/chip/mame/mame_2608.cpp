@@ -133,25 +133,25 @@ uint8_t Mame2608::readData()
 	return ym2608_read(state_.chip, 1);
 }
 
+void Mame2608::writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	ym2608_write_pcmromb(state_.chip, offset, length, data);
+}
+
 void Mame2608::updateStream(sample** outputs, int nSamples)
 {
 	ym2608_update_one(state_.chip, nSamples, outputs);
 }
 
-void Mame2608::updateSsgStream(sample** outputs, int nSamples)
+void Mame2608::updateSsgStream(sample* output, int nSamples)
 {
 	if (state_.ssg) {
-		sample* bufl = outputs[STEREO_LEFT];
-		sample* bufr = outputs[STEREO_RIGHT];
 		for (int i = 0; i < nSamples; ++i) {
-			int16_t s = PSG_calc(state_.ssg) << 1;
-			*bufl++ = s;
-			*bufr++ = s;
+			*output++ = static_cast<int16_t>(PSG_calc(state_.ssg) << 1);
 		}
 	}
 	else {
-		std::fill_n(outputs[STEREO_LEFT], nSamples, 0);
-		std::fill_n(outputs[STEREO_RIGHT], nSamples, 0);
+		std::fill_n(output, nSamples, 0);
 	}
 }
 }
@@ -48,8 +48,9 @@ public:
 	void writeDataToPortA(uint8_t data) override;
 	void writeDataToPortB(uint8_t data) override;
 	uint8_t readData() override;
+	void writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length) override;
 	void updateStream(sample** outputs, int nSamples) override;
-	void updateSsgStream(sample** outputs, int nSamples) override;
+	void updateSsgStream(sample* output, int nSamples) override;
 
 private:
 	Mame2608State state_;
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mix_kernels.hpp"
+#include <algorithm>
+
+#ifdef CHIP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace chip
+{
+namespace
+{
+inline int16_t saturate(sample value)
+{
+	return static_cast<int16_t>(std::min<sample>(std::max<sample>(value, -32768), 32767));
+}
+
+inline void gainTail(sample* p, size_t i, size_t nSamples, double gain)
+{
+	for (; i < nSamples; ++i) p[i] = static_cast<sample>(p[i] * gain);
+}
+
+inline void mixTail(int16_t* stream, sample** bufFM, const sample* bufSSG, size_t i, size_t nSamples)
+{
+	int16_t* p = stream + (i << 1);
+	for (; i < nSamples; ++i) {
+		*p++ = saturate((bufFM[STEREO_LEFT][i] + bufSSG[i]) * 2);
+		*p++ = saturate((bufFM[STEREO_RIGHT][i] + bufSSG[i]) * 2);
+	}
+}
+}
+
+// SSE2 paths give the same results as the scalar loops
+void gainSamples(sample** samples, int nCh, size_t nSamples, double gain)
+{
+	for (int pan = STEREO_LEFT; pan < nCh; ++pan) {
+		sample* p = samples[pan];
+		size_t i = 0;
+#ifdef CHIP_USE_SSE2
+		const __m128d g = _mm_set1_pd(gain);
+		for (; i + 4 <= nSamples; i += 4) {
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			__m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(s), g));
+			__m128i hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(s, 8)), g));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), _mm_unpacklo_epi64(lo, hi));
+		}
+#endif
+		gainTail(p, i, nSamples, gain);
+	}
+}
+
+void mixSamples(int16_t* stream, sample** bufFM, const sample* bufSSG, size_t nSamples)
+{
+	size_t i = 0;
+#ifdef CHIP_USE_SSE2
+	// sat16(2 * x) equals sat16(2 * sat16(x))
+	for (; i + 4 <= nSamples; i += 4) {
+		__m128i ssg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bufSSG + i));
+		__m128i l = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bufFM[STEREO_LEFT] + i)), ssg);
+		__m128i r = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bufFM[STEREO_RIGHT] + i)), ssg);
+		__m128i lr = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(stream + (i << 1)), _mm_adds_epi16(lr, lr));
+	}
+#endif
+	mixTail(stream, bufFM, bufSSG, i, nSamples);
+}
+
+void gainSamplesScalar(sample** samples, int nCh, size_t nSamples, double gain)
+{
+	for (int pan = STEREO_LEFT; pan < nCh; ++pan) gainTail(samples[pan], 0, nSamples, gain);
+}
+
+void mixSamplesScalar(int16_t* stream, sample** bufFM, const sample* bufSSG, size_t nSamples)
+{
+	mixTail(stream, bufFM, bufSSG, 0, nSamples);
+}
+
+bool hasSimdMixKernels() noexcept
+{
+#ifdef CHIP_USE_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+}
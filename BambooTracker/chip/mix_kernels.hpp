@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "chip_defs.h"
+
+namespace chip
+{
+/// Multiplies the first nCh channels by gain, truncating toward zero. Uses SSE2 when available.
+void gainSamples(sample** samples, int nCh, size_t nSamples, double gain);
+
+/// Sums stereo FM and mono SSG buses, doubles them and saturates to interleaved 16-bit samples.
+/// Uses SSE2 when available.
+void mixSamples(int16_t* stream, sample** bufFM, const sample* bufSSG, size_t nSamples);
+
+/// Scalar reference of gainSamples, kept for benchmarks.
+void gainSamplesScalar(sample** samples, int nCh, size_t nSamples, double gain);
+
+/// Scalar reference of mixSamples, kept for benchmarks.
+void mixSamplesScalar(int16_t* stream, sample** bufFM, const sample* bufSSG, size_t nSamples);
+
+/// Whether gainSamples and mixSamples are built with SIMD paths.
+bool hasSimdMixKernels() noexcept;
+}
@@ -25,6 +25,7 @@
 
 #include "nuked_2608.hpp"
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 
 namespace chip
@@ -135,33 +136,27 @@ uint8_t Nuked2608::readData()
 	return OPN2_Read(state_.chip, 1);
 }
 
-void Nuked2608::updateStream(sample** outputs, int nSamples)
+void Nuked2608::writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length)
 {
-	sample* bufl = outputs[STEREO_LEFT];
-	sample* bufr = outputs[STEREO_RIGHT];
+	YM_DELTAT& deltaT = state_.chip->deltaT;
+	if (offset >= deltaT.memory_size) return;
+	std::memcpy(deltaT.memory + offset, data, std::min(length, deltaT.memory_size - offset));
+}
 
-	for (int i = 0; i < nSamples; ++i) {
-		sample lr[2];
-		OPN2_Generate(state_.chip, lr);
-		*bufl++ = lr[0];
-		*bufr++ = lr[1];
-	}
+void Nuked2608::updateStream(sample** outputs, int nSamples)
+{
+	OPN2_GenerateStream(state_.chip, outputs[STEREO_LEFT], outputs[STEREO_RIGHT], static_cast<Bit32u>(nSamples));
 }
 
-void Nuked2608::updateSsgStream(sample** outputs, int nSamples)
+void Nuked2608::updateSsgStream(sample* output, int nSamples)
 {
 	if (state_.ssg) {
-		sample* bufl = outputs[STEREO_LEFT];
-		sample* bufr = outputs[STEREO_RIGHT];
 		for (int i = 0; i < nSamples; ++i) {
-			int16_t s = PSG_calc(state_.ssg) << 1;
-			*bufl++ = s;
-			*bufr++ = s;
+			*output++ = static_cast<int16_t>(PSG_calc(state_.ssg) << 1);
 		}
 	}
 	else {
-		std::fill_n(outputs[STEREO_LEFT], nSamples, 0);
-		std::fill_n(outputs[STEREO_RIGHT], nSamples, 0);
+		std::fill_n(output, nSamples, 0);
 	}
 }
 }
@@ -293,7 +293,7 @@ static const int adpcm_step_inc[8] = { -1*16, -1*16, -1*16, -1*16, 2*16, 5*16, 7
 static Bit32u chip_type = ym3438_mode_readmode;
 
 /*OPN-MOD: update ADPCM volume*/
-void OPNmod_RhythmUpdateVolume(ym3438_t *chip, Bit32u channel)
+static void OPNmod_RhythmUpdateVolume(ym3438_t *chip, Bit32u channel)
 {
     Bit8u volume = chip->rhythm_tl + chip->rhythm_level[channel];
 
@@ -311,7 +311,7 @@ void OPNmod_RhythmUpdateVolume(ym3438_t *chip, Bit32u channel)
     }
 }
 
-void OPN2_DoIO(ym3438_t *chip)
+static void OPN2_DoIO(ym3438_t *chip)
 {
     /* Write signal check */
     chip->write_a_en = (chip->write_a & 0x03) == 0x01;
@@ -325,7 +325,7 @@ void OPN2_DoIO(ym3438_t *chip)
     chip->write_busy_cnt &= 0x1f;
 }
 
-void OPN2_DoRegWrite(ym3438_t *chip)
+static void OPN2_DoRegWrite(ym3438_t *chip)
 {
     Bit32u i;
     Bit32u slot = chip->cycles % 12;
@@ -625,7 +625,7 @@ void OPN2_DoRegWrite(ym3438_t *chip)
     }
 }
 
-void OPN2_PhaseCalcIncrement(ym3438_t *chip)
+static void OPN2_PhaseCalcIncrement(ym3438_t *chip)
 {
     Bit32u chan = chip->channel;
     Bit32u slot = chip->cycles;
@@ -694,7 +694,7 @@ void OPN2_PhaseCalcIncrement(ym3438_t *chip)
     chip->pg_inc[slot] &= 0xfffff;
 }
 
-void OPN2_PhaseGenerate(ym3438_t *chip)
+static void OPN2_PhaseGenerate(ym3438_t *chip)
 {
     Bit32u slot;
     /* Mask increment */
@@ -713,7 +713,7 @@ void OPN2_PhaseGenerate(ym3438_t *chip)
     }
 }
 
-void OPN2_EnvelopeSSGEG(ym3438_t *chip)
+static void OPN2_EnvelopeSSGEG(ym3438_t *chip)
 {
     Bit32u slot = chip->cycles;
     Bit8u direction = 0;
@@ -760,7 +760,7 @@ void OPN2_EnvelopeSSGEG(ym3438_t *chip)
     chip->eg_ssg_enable[slot] = (chip->ssg_eg[slot] >> 3) & 0x01;
 }
 
-void OPN2_EnvelopeADSR(ym3438_t *chip)
+static void OPN2_EnvelopeADSR(ym3438_t *chip)
 {
     Bit32u slot = (chip->cycles + 22) % 24;
 
@@ -884,7 +884,7 @@ void OPN2_EnvelopeADSR(ym3438_t *chip)
     chip->eg_state[slot] = nextstate;
 }
 
-void OPN2_EnvelopePrepare(ym3438_t *chip)
+static void OPN2_EnvelopePrepare(ym3438_t *chip)
 {
     Bit8u rate;
     Bit8u sum;
@@ -972,7 +972,7 @@ void OPN2_EnvelopePrepare(ym3438_t *chip)
     chip->eg_sl[0] = chip->sl[slot];
 }
 
-void OPN2_EnvelopeGenerate(ym3438_t *chip)
+static void OPN2_EnvelopeGenerate(ym3438_t *chip)
 {
     Bit32u slot = (chip->cycles + 23) % 24;
     Bit16u level;
@@ -1005,7 +1005,7 @@ void OPN2_EnvelopeGenerate(ym3438_t *chip)
     chip->eg_out[slot] = level;
 }
 
-void OPN2_UpdateLFO(ym3438_t *chip)
+static void OPN2_UpdateLFO(ym3438_t *chip)
 {
     if ((chip->lfo_quotient & lfo_cycles[chip->lfo_freq]) == lfo_cycles[chip->lfo_freq])
     {
@@ -1019,7 +1019,7 @@ void OPN2_UpdateLFO(ym3438_t *chip)
     chip->lfo_cnt &= chip->lfo_en;
 }
 
-void OPN2_FMPrepare(ym3438_t *chip)
+static void OPN2_FMPrepare(ym3438_t *chip)
 {
     Bit32u slot = (chip->cycles + 6) % 24;
     Bit32u channel = chip->channel;
@@ -1081,7 +1081,7 @@ void OPN2_FMPrepare(ym3438_t *chip)
     }
 }
 
-void OPN2_ChGenerate(ym3438_t *chip)
+static void OPN2_ChGenerate(ym3438_t *chip)
 {
     Bit32u slot = (chip->cycles + 18) % 24;
     Bit32u channel = chip->channel;
@@ -1123,7 +1123,7 @@ void OPN2_ChGenerate(ym3438_t *chip)
     chip->ch_acc[channel] = sum;
 }
 
-void OPN2_ChOutput(ym3438_t *chip)
+static void OPN2_ChOutput(ym3438_t *chip)
 {
     Bit32u cycles = chip->cycles;
     Bit32u slot = chip->cycles;
@@ -1206,7 +1206,7 @@ void OPN2_ChOutput(ym3438_t *chip)
     }
 }
 
-void OPN2_FMGenerate(ym3438_t *chip)
+static void OPN2_FMGenerate(ym3438_t *chip)
 {
     Bit32u slot = (chip->cycles + 19) % 24;
     /* Calculate phase */
@@ -1245,7 +1245,7 @@ void OPN2_FMGenerate(ym3438_t *chip)
 }
 
 /*OPN-MOD: generate ADPCM rhythm*/
-void OPNmod_RhythmGenerate(ym3438_t *chip)
+static void OPNmod_RhythmGenerate(ym3438_t *chip)
 {
     Bit32u channel = chip->channel;
     Bit32s out = 0;
@@ -1329,7 +1329,7 @@ void OPNmod_RhythmGenerate(ym3438_t *chip)
 }
 
 /*OPN-MOD: generate ADPCM DeltaT*/
-void OPNmod_DeltaTGenerate(ym3438_t *chip)
+static void OPNmod_DeltaTGenerate(ym3438_t *chip)
 {
     Bit32u channel = chip->channel;
 
@@ -1354,7 +1354,7 @@ void OPNmod_DeltaTGenerate(ym3438_t *chip)
     }
 }
 
-void OPN2_DoTimerA(ym3438_t *chip)
+static void OPN2_DoTimerA(ym3438_t *chip)
 {
     Bit16u time;
     Bit8u load;
@@ -1403,7 +1403,7 @@ void OPN2_DoTimerA(ym3438_t *chip)
     chip->timer_a_cnt = time & 0x3ff;
 }
 
-void OPN2_DoTimerB(ym3438_t *chip)
+static void OPN2_DoTimerB(ym3438_t *chip)
 {
     Bit16u time;
     Bit8u load;
@@ -1448,7 +1448,7 @@ void OPN2_DoTimerB(ym3438_t *chip)
     chip->timer_b_cnt = time & 0xff;
 }
 
-void OPN2_KeyOn(ym3438_t*chip)
+static void OPN2_KeyOn(ym3438_t*chip)
 {
     Bit32u slot = chip->cycles;
     Bit32u chan = chip->channel;
@@ -1559,13 +1559,11 @@ void OPN2_SetChipType(Bit32u type)
     chip_type = type;
 }
 
-void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
+/*OPN-MOD: clock without output, the outputs of the channel at the start of
+  the cycle are read from chip after the call*/
+static void OPN2_DoClock(ym3438_t *chip)
 {
     Bit32u slot = chip->cycles;
-    Bit16s *rhythml = &chip->rhythml[chip->channel];
-    Bit16s *rhythmr = &chip->rhythmr[chip->channel];
-    Bit16s *deltaTl = &chip->deltaTl[chip->channel];
-    Bit16s *deltaTr = &chip->deltaTr[chip->channel];
     chip->lfo_inc = chip->mode_test_21[1];
     chip->pg_read >>= 1;
     chip->eg_read[1] >>= 1;
@@ -1696,17 +1694,24 @@ void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
     chip->cycles = (chip->cycles + 1) % 24;
     chip->channel = chip->cycles % 6;
 
+    if (chip->status_time)
+        chip->status_time--;
+}
+
+void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
+{
+    Bit32u channel = chip->channel;
+
+    OPN2_DoClock(chip);
+
     buffer[0] = chip->mol;
     buffer[1] = chip->mor;
     /*OPN-MOD: Rhythm output*/
-    buffer[2] = *rhythml;
-    buffer[3] = *rhythmr;
+    buffer[2] = chip->rhythml[channel];
+    buffer[3] = chip->rhythmr[channel];
     /*OPN-MOD: DeltaT output*/
-    buffer[4] = *deltaTl;
-    buffer[5] = *deltaTr;
-
-    if (chip->status_time)
-        chip->status_time--;
+    buffer[4] = chip->deltaTl[channel];
+    buffer[5] = chip->deltaTr[channel];
 }
 
 void OPN2_Write(ym3438_t *chip, Bit32u port, Bit8u data)
@@ -1881,39 +1886,65 @@ void OPN2_FlushBuffer(ym3438_t *chip)
 
 void OPN2_Generate(ym3438_t *chip, sample *samples)
 {
-    Bit32u i;
-    Bit16s buffer[6];
+    OPN2_GenerateStream(chip, &samples[0], &samples[1], 1);
+}
+
+/*OPN-MOD: render a block of samples, same as calling OPN2_Generate for each sample*/
+void OPN2_GenerateStream(ym3438_t *chip, sample *bufl, sample *bufr, Bit32u numsamples)
+{
+    Bit32u i, channel;
+    Bit64u samplecnt = chip->writebuf_samplecnt;
+    Bit64u nexttime;
+    sample outl, outr;
 
-    samples[0] = 0;
-    samples[1] = 0;
+    /* Time of the next buffered write, writes are not added while rendering */
+    nexttime = (chip->writebuf[chip->writebuf_cur].port & 0x04)
+             ? chip->writebuf[chip->writebuf_cur].time : UINT64_MAX;
 
-    for (i = 0; i < 24; i++)
+    while (numsamples--)
     {
-        OPN2_Clock(chip, buffer);
+        outl = 0;
+        outr = 0;
 
-        /*OPN-MOD: adjust FM output to mix*/
-        samples[0] += (buffer[0] * 11) >> 4;
-        samples[1] += (buffer[1] * 11) >> 4;
+        for (i = 0; i < 24; i++)
+        {
+            channel = chip->channel;
+            OPN2_DoClock(chip);
 
-        /*OPN-MOD: mix rhythm samples*/
-        samples[0] += buffer[2];
-        samples[1] += buffer[3];
+            /*OPN-MOD: adjust FM output to mix*/
+            outl += (chip->mol * 11) >> 4;
+            outr += (chip->mor * 11) >> 4;
 
-        /*OPN-MOD: mix deltaT samples*/
-        samples[0] += buffer[4];
-        samples[1] += buffer[5];
+            /*OPN-MOD: mix rhythm samples*/
+            outl += chip->rhythml[channel];
+            outr += chip->rhythmr[channel];
 
-        while (chip->writebuf[chip->writebuf_cur].time <= chip->writebuf_samplecnt)
-        {
-            if (!(chip->writebuf[chip->writebuf_cur].port & 0x04))
+            /*OPN-MOD: mix deltaT samples*/
+            outl += chip->deltaTl[channel];
+            outr += chip->deltaTr[channel];
+
+            if (nexttime <= samplecnt)
             {
-                break;
+                while (chip->writebuf[chip->writebuf_cur].time <= samplecnt)
+                {
+                    if (!(chip->writebuf[chip->writebuf_cur].port & 0x04))
+                    {
+                        break;
+                    }
+                    chip->writebuf[chip->writebuf_cur].port &= 0x03;
+                    OPN2_Write(chip, chip->writebuf[chip->writebuf_cur].port,
+                               chip->writebuf[chip->writebuf_cur].data);
+                    chip->writebuf_cur = (chip->writebuf_cur + 1) % OPN_WRITEBUF_SIZE;
+                }
+                nexttime = (chip->writebuf[chip->writebuf_cur].port & 0x04)
+                         ? chip->writebuf[chip->writebuf_cur].time : UINT64_MAX;
             }
-            chip->writebuf[chip->writebuf_cur].port &= 0x03;
-            OPN2_Write(chip, chip->writebuf[chip->writebuf_cur].port,
-                       chip->writebuf[chip->writebuf_cur].data);
-            chip->writebuf_cur = (chip->writebuf_cur + 1) % OPN_WRITEBUF_SIZE;
+            samplecnt++;
         }
-        chip->writebuf_samplecnt++;
+
+        *bufl++ = outl;
+        *bufr++ = outr;
     }
+
+    chip->writebuf_samplecnt = samplecnt;
 }
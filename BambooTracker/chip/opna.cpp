@@ -27,7 +27,9 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <initializer_list>
 #include "register_write_logger.hpp"
+#include "mix_kernels.hpp"
 #include "mame/mame_2608.hpp"
 #include "nuked/nuked_2608.hpp"
 #include "ymfm/ymfm_2608.hpp"
@@ -50,23 +52,44 @@ enum SoundSourceIndex : int { FM = 0, SSG = 1 };
 
 enum WriteMode : int { WAIT_MODE = 0, IMMEDIATE_MODE = 1 };
 
-inline double clamp(double value, double low, double high)
-{
-	return std::min<double>(std::max<double>(value, low), high);
-}
+// Several ticks of register writes on all channels
+constexpr size_t REG_WRITE_QUEUE_SIZE = 0x4000;
+
+// Output must stay silent this long before the chip idles, which covers resampler latency
+constexpr size_t SILENCE_HOLD_MS = 100;
 
-void gainSamples(sample** samples, size_t nSamples, double gain)
+/// Adds the time since the previous lap to a stage counter when enabled.
+class StageTimer
 {
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::transform(samples[pan], samples[pan] + nSamples, samples[pan],
-					   [gain](sample s) { return static_cast<sample>(s * gain); });
+public:
+	explicit StageTimer(bool enabled)
+		: enabled_(enabled),
+		  last_(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+	{
+	}
+
+	void lap(std::chrono::nanoseconds& stage)
+	{
+		if (!enabled_) return;
+		auto now = std::chrono::steady_clock::now();
+		stage += now - last_;
+		last_ = now;
 	}
+
+private:
+	bool enabled_;
+	std::chrono::steady_clock::time_point last_;
+};
+
+inline bool isSilentBuffer(const sample* buf, size_t nSamples)
+{
+	return std::all_of(buf, buf + nSamples, [](sample s) { return !s; });
 }
 }
 
-size_t OPNA::count_ = 0;
+std::atomic<size_t> OPNA::count_(0);
 
-OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dramSize,
+OPNA::OPNA(OpnaEmulator emu, YmfmFidelity ymfmFidelity, int clock, int rate, size_t maxDuration, size_t dramSize,
 		   std::unique_ptr<AbstractResampler> fmResampler, std::unique_ptr<AbstractResampler> ssgResampler,
 		   std::shared_ptr<AbstractRegisterWriteLogger> logger)
 	: Chip(count_++, clock, rate, DEFAULT_AUTO_RATE, maxDuration,
@@ -77,13 +100,29 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 	  dramSize_(dramSize),
 	  rcIntf_(std::make_unique<SimpleRealChipInterface>()),
 	  isForcedRegWrite_(false),
+	  regWrites_(REG_WRITE_QUEUE_SIZE),
+	  forcedRegWrites_(REG_WRITE_QUEUE_SIZE),
+	  immediateRegWrites_(REG_WRITE_QUEUE_SIZE),
+	  hasPendingDram_(false),
+	  nWrites_(0),
+	  nWriteContentions_(0),
+	  nMixContentions_(0),
+	  nOverruns_(0),
+	  peakQueueSize_(0),
+	  isStageProfiling_(false),
+	  stageProfile_(),
+	  isSilenceSkipEnabled_(false),
+	  isIdle_(false),
+	  hasActiveChannels_(false),
+	  hasWrittenSinceProbe_(false),
+	  silentFmSamples_(0),
 	  waitRestFm_(0),
 	  waitRestSsg2_(0),
 	  writeFuncs {
 		  // Wait mode
-{ &OPNA::enqueueData, &OPNA::storeBufferForWait },
+{ &OPNA::storeBufferForWait },
 		  // Immediate mode
-{ &OPNA::writeDataImmediately, &OPNA::storeBufferForImmediate }
+{ &OPNA::storeBufferForImmediate }
 },
 	  writeFunc(&writeFuncs[WAIT_MODE])
 {
@@ -105,7 +144,7 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 		break;
 	case OpnaEmulator::Ymfm:
 		fprintf(stderr, "Using emulator: ymfm\n");
-		intf_ = std::make_unique<Ymfm2608>();
+		intf_ = std::make_unique<Ymfm2608>(ymfmFidelity);
 		break;
 	}
 
@@ -114,6 +153,7 @@ OPNA::OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dra
 	internalRate_[FM] = intf_->startDevice(clock, internalRate_[SSG], dramSize);
 	rate2_ = static_cast<size_t>((internalRate_[SSG] << 1) / internalRate_[FM]);	// Should be "9"
 
+	resampler_[SSG]->setChannelCount(1);	// SSG is rendered in mono and panned to center at mixing
 	initResampler();
 
 	setVolumeFM(0);
@@ -137,10 +177,15 @@ void OPNA::resetSpecific()
 	isForcedRegWrite_ = false;
 	regWrites_.clear();
 	forcedRegWrites_.clear();
+	immediateRegWrites_.clear();
 	waitRestFm_ = 0;
 	waitRestSsg2_ = 0;
+	isIdle_ = false;
+	silentFmSamples_ = 0;
 
 	intf_->resetDevice();
+
+	std::lock_guard<std::mutex> rcLock(rcMutex_);
 	rcIntf_->reset();
 }
 
@@ -156,40 +201,85 @@ bool OPNA::isImmediateWriteMode() const noexcept
 
 void OPNA::setRegister(uint32_t offset, uint8_t value)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::unique_lock<std::mutex> lock(writeMutex_, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		++nWriteContentions_;
+		lock.lock();
+	}
+	++nWrites_;
+	hasWrittenSinceProbe_.store(true, std::memory_order_release);
 
 	if (logger_) {
 		logger_->recordRegisterChange(offset, value);
 	}
 	else {
-		(this->*writeFunc->setRegister)(offset, value);
+		enqueueData(offset, value);
 	}
 
+	std::lock_guard<std::mutex> rcLock(rcMutex_);
 	rcIntf_->setRegister(offset, value);
 }
 
 void OPNA::enqueueData(uint32_t offset, uint8_t value)
 {
-	if (isForcedRegWrite_) {
-		forcedRegWrites_.push_back({ offset & 0x0ff, value, !(offset & 0x100) });
+	RegisterWriteQueue& queue = isImmediateWriteMode() ? immediateRegWrites_
+													   : isForcedRegWrite_ ? forcedRegWrites_ : regWrites_;
+	const RegisterWrite write = { offset & 0x0ff, value, !(offset & 0x100) };
+	if (!queue.push(write)) {
+		// The mixer has fallen behind, so drain the queue here without waits
+		++nOverruns_;
+		std::lock_guard<std::mutex> lg(mutex_);
+		while (const RegisterWrite* unit = queue.front()) {
+			writeData(*unit);
+			queue.pop();
+		}
+		queue.push(write);
 	}
-	else {
-		regWrites_.push_back({ offset & 0x0ff, value, !(offset & 0x100) });
+
+	size_t size = queue.size();
+	if (peakQueueSize_.load(std::memory_order_relaxed) < size) {
+		peakQueueSize_.store(size, std::memory_order_relaxed);
 	}
 }
 
-void OPNA::writeDataImmediately(uint32_t offset, uint8_t value)
+void OPNA::writeData(const RegisterWrite& write)
 {
-	if (offset & 0x100) {
-		intf_->writeAddressToPortB(offset & 0xff);
-		intf_->writeDataToPortB(value & 0xff);
+	if (write.isPortA_) {
+		intf_->writeAddressToPortA(write.address);
+		intf_->writeDataToPortA(write.data);
 	}
 	else {
-		intf_->writeAddressToPortA(offset & 0xff);
-		intf_->writeDataToPortA(value & 0xff);
+		intf_->writeAddressToPortB(write.address);
+		intf_->writeDataToPortB(write.data);
 	}
 }
 
+void OPNA::writeImmediateData()
+{
+	while (const RegisterWrite* unit = immediateRegWrites_.front()) {
+		writeData(*unit);
+		immediateRegWrites_.pop();
+	}
+}
+
+void OPNA::writePendingDRAM()
+{
+	if (!hasPendingDram_.load(std::memory_order_acquire)) return;
+
+	// Retry on the next mix rather than wait for the writer
+	std::unique_lock<std::mutex> lock(dramMutex_, std::try_to_lock);
+	if (!lock.owns_lock()) return;
+
+	const uint8_t* data = pendingDram_.data();
+	for (const PendingDRAMBlock& block : pendingDramBlocks_) {
+		intf_->writeDRAM(static_cast<uint32_t>(block.offset), data, static_cast<uint32_t>(block.length));
+		data += block.length;
+	}
+	pendingDram_.clear();
+	pendingDramBlocks_.clear();
+	hasPendingDram_.store(false, std::memory_order_release);
+}
+
 uint8_t OPNA::getRegister(uint32_t offset) const
 {
 	if (offset & 0x100) intf_->writeAddressToPortB(offset & 0xff);
@@ -199,7 +289,7 @@ uint8_t OPNA::getRegister(uint32_t offset) const
 
 void OPNA::setVolumeFM(double dB)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::lock_guard<std::mutex> lg(writeMutex_);
 	volumeFm_ = dB;
 	busVolumeRatio_[FM] = std::pow(10.0, (dB - VOL_REDUC_) / 20.0) / VOLUME_RATIO_MOD_;
 	updateVolumeRatio(FM);
@@ -207,11 +297,12 @@ void OPNA::setVolumeFM(double dB)
 
 void OPNA::setVolumeSSG(double dB)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	std::lock_guard<std::mutex> lg(writeMutex_);
 	volumeSsg_ = dB;
 	busVolumeRatio_[SSG] = std::pow(10.0, (dB - VOL_REDUC_) / 20.0) / VOLUME_RATIO_MOD_;
 	updateVolumeRatio(SSG);
 
+	std::lock_guard<std::mutex> rcLock(rcMutex_);
 	rcIntf_->setSSGVolume(dB);
 }
 
@@ -220,33 +311,111 @@ size_t OPNA::getDRAMSize() const noexcept
 	return dramSize_;
 }
 
+void OPNA::writeDRAM(size_t offset, const uint8_t* data, size_t length)
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	hasWrittenSinceProbe_.store(true, std::memory_order_release);
+
+	if (logger_) logger_->recordRegisterChanges(0x108, data, length);
+
+	// Unlike register writes, the emulator memory is updated while logging
+	// so that it does not go out of sync with the logged one
+	{
+		std::lock_guard<std::mutex> lg(dramMutex_);
+		pendingDram_.insert(pendingDram_.end(), data, data + length);
+		pendingDramBlocks_.push_back({ offset, length });
+		hasPendingDram_.store(true, std::memory_order_release);
+	}
+
+	std::lock_guard<std::mutex> rcLock(rcMutex_);
+	if (rcIntf_->hasConnected()) {
+		for (size_t i = 0; i < length; ++i) rcIntf_->setRegister(0x108, data[i]);
+	}
+}
+
 bool OPNA::mix(int16_t* stream, size_t nSamples)
 {
-	std::lock_guard<std::mutex> lg(mutex_);
+	// Only reset and reconfiguration hold mutex_ for long,
+	// so drop this block rather than wait for them
+	std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		++nMixContentions_;
+		std::fill_n(stream, nSamples << 1, 0);
+		return true;
+	}
+
+	writeImmediateData();
+	writePendingDRAM();
 
 	size_t pointFm = 0;
 	size_t pointSsg = 0;
+	StageTimer timer(isStageProfiling_);
+
+	if (canIdle()) {
+		std::fill_n(stream, nSamples << 1, 0);
+		timer.lap(stageProfile_.mixing);
+		if (isStageProfiling_) stageProfile_.samples += nSamples;
+		return true;
+	}
 
 	// Store samples to internal buffer
-	bool result = (this->*writeFunc->storeBuffer)(nSamples, pointFm, pointSsg);
+	bool result = (this->*writeFunc.load()->storeBuffer)(nSamples, pointFm, pointSsg);
 	if (!result) return false;
+	if (isSilenceSkipEnabled_) probeSilence(pointFm, pointSsg);
+	timer.lap(stageProfile_.synthesis);
 
 	// Gain volume
-	gainSamples(buffer_[FM], pointFm, volumeRatio_[FM]);
-	gainSamples(buffer_[SSG], pointSsg, volumeRatio_[SSG]);
+	gainSamples(buffer_[FM], 2, pointFm, volumeRatio_[FM].load(std::memory_order_relaxed));
+	gainSamples(buffer_[SSG], 1, pointSsg, volumeRatio_[SSG].load(std::memory_order_relaxed));
+	timer.lap(stageProfile_.mixing);
 
 	// Resampling
 	sample** bufFM = resampler_[FM]->interpolate(buffer_[FM], nSamples, pointFm);
 	sample** bufSSG = resampler_[SSG]->interpolate(buffer_[SSG], nSamples, pointSsg);
+	timer.lap(stageProfile_.resampling);
 
 	// Mix
-	int16_t* p = stream;
-	for (size_t i = 0; i < nSamples; ++i) {
-		for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-			*p++ = static_cast<int16_t>(clamp((bufFM[pan][i] + bufSSG[pan][i]) * VOLUME_RATIO_MOD_, -32768, 32767));
-		}
+	static_assert(VOLUME_RATIO_MOD_ == 2, "Mixing kernel doubles summed samples");
+	mixSamples(stream, bufFM, bufSSG[STEREO_LEFT], nSamples);
+	timer.lap(stageProfile_.mixing);
+	if (isStageProfiling_) stageProfile_.samples += nSamples;
+
+	return true;
+}
+
+void OPNA::probeSilence(size_t nFm, size_t nSsg)
+{
+	if (hasWrittenSinceProbe_.exchange(false, std::memory_order_acquire)
+			|| !isSilentBuffer(buffer_[FM][STEREO_LEFT], nFm)
+			|| !isSilentBuffer(buffer_[FM][STEREO_RIGHT], nFm)
+			|| !isSilentBuffer(buffer_[SSG][STEREO_LEFT], nSsg)) {
+		silentFmSamples_ = 0;
 	}
+	else {
+		silentFmSamples_ += nFm;
+	}
+}
 
+/**
+ * @brief OPNA::canIdle
+ * @return true if the chip keeps silent without synthesis.
+ */
+bool OPNA::canIdle()
+{
+	// Wake up on the next register write
+	if (!isSilenceSkipEnabled_ || hasActiveChannels_.load(std::memory_order_acquire)
+			|| hasWrittenSinceProbe_.load(std::memory_order_acquire)
+			|| !regWrites_.empty() || !forcedRegWrites_.empty() || waitRestFm_ || waitRestSsg2_
+			|| silentFmSamples_ < internalRate_[FM] * SILENCE_HOLD_MS / 1000) {
+		isIdle_ = false;
+		return false;
+	}
+
+	if (!isIdle_) {
+		// Drop the decayed tails so that interpolation restarts from silence on wake-up
+		for (auto& resampler : resampler_) resampler->reset();
+		isIdle_ = true;
+	}
 	return true;
 }
 
@@ -256,36 +425,16 @@ bool OPNA::mix(int16_t* stream, size_t nSamples)
  */
 size_t OPNA::dequeueData()
 {
-	size_t waitCount = 0;
-
-	if (!forcedRegWrites_.empty()) {
-		auto& unit = forcedRegWrites_.front();
-		if (unit.isPortA_) {
-			intf_->writeAddressToPortA(unit.address & 0xff);
-			intf_->writeDataToPortA(unit.data & 0xff);
-		}
-		else {
-			intf_->writeAddressToPortB(unit.address & 0xff);
-			intf_->writeDataToPortB(unit.data & 0xff);
-		}
-		waitCount = unit.address == 0x10 ? 4 : 1;
-		forcedRegWrites_.pop_front();
-	}
-	else if (!regWrites_.empty()) {
-		auto& unit = regWrites_.front();
-		if (unit.isPortA_) {
-			intf_->writeAddressToPortA(unit.address & 0xff);
-			intf_->writeDataToPortA(unit.data & 0xff);
-		}
-		else {
-			intf_->writeAddressToPortB(unit.address & 0xff);
-			intf_->writeDataToPortB(unit.data & 0xff);
+	for (RegisterWriteQueue* queue : { &forcedRegWrites_, &regWrites_ }) {
+		if (const RegisterWrite* unit = queue->front()) {
+			writeData(*unit);
+			size_t waitCount = unit->address == 0x10 ? 4 : 1;
+			queue->pop();
+			return waitCount;
 		}
-		waitCount = unit.address == 0x10 ? 4 : 1;
-		regWrites_.pop_front();
 	}
 
-	return waitCount;
+	return 0;
 }
 
 bool OPNA::storeBufferForImmediate(size_t nSamples, size_t& pointFm, size_t& pointSsg)
@@ -301,10 +450,7 @@ bool OPNA::storeBufferForImmediate(size_t nSamples, size_t& pointFm, size_t& poi
 
 	size_t intrSizeSsg = resampler_[SSG]->calculateInternalSampleSize(nSamples, ok);
 	if (!ok) return false;
-	intf_->updateSsgStream(tmpBuf_, intrSizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], intrSizeSsg, buffer_[SSG][pan] + pointSsg);
-	}
+	intf_->updateSsgStream(buffer_[SSG][STEREO_LEFT] + pointSsg, intrSizeSsg);
 	pointSsg += intrSizeSsg;
 
 	return true;
@@ -323,10 +469,7 @@ void OPNA::flushWait(size_t& pointFm, size_t maxFm, size_t& pointSsg2, size_t ma
 	size_t pointSsg = pointSsg2 >> 1;
 	size_t endPointSsg2 = std::min(pointSsg2 + waitRestSsg2_, maxSsg2);
 	size_t sizeSsg = (endPointSsg2 >> 1) - pointSsg;
-	intf_->updateSsgStream(tmpBuf_, sizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeSsg, buffer_[SSG][pan] + pointSsg);
-	}
+	intf_->updateSsgStream(buffer_[SSG][STEREO_LEFT] + pointSsg, sizeSsg);
 	size_t sizeSsg2 = endPointSsg2 - pointSsg2;
 	waitRestSsg2_ -= sizeSsg2;
 	pointSsg2 += sizeSsg2;
@@ -367,10 +510,7 @@ bool OPNA::storeBufferForWait(size_t nSamples, size_t& pointFm, size_t& pointSsg
 
 	pointSsg = pointSsg2 >> 1;
 	size_t sizeSsg = (intrSizeSsg2 >> 1) - pointSsg;
-	intf_->updateSsgStream(tmpBuf_, sizeSsg);
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
-		std::copy_n(tmpBuf_[pan], sizeSsg, buffer_[SSG][pan] + pointSsg);
-	}
+	intf_->updateSsgStream(buffer_[SSG][STEREO_LEFT] + pointSsg, sizeSsg);
 	size_t sizeSsg2 = intrSizeSsg2 - pointSsg2;
 	if (sizeSsg2 <= waitRestSsg2_) waitRestSsg2_ -= sizeSsg2;
 	pointSsg = (pointSsg2 + sizeSsg2) >> 1;
@@ -389,11 +529,13 @@ void OPNA::setSsgResampler(std::unique_ptr<AbstractResampler> resampler)
 {
 	std::lock_guard<std::mutex> lg(mutex_);
 	resampler_[SSG] = std::move(resampler);
+	resampler_[SSG]->setChannelCount(1);
 	initResampler();
 }
 
 void OPNA::connectToRealChip(RealChipInterfaceType type, RealChipInterfaceGeneratorFunc* f)
 {
+	std::lock_guard<std::mutex> lg(rcMutex_);
 	switch (type) {
 	default:	// Fall through
 	case RealChipInterfaceType::NONE:
@@ -418,11 +560,59 @@ void OPNA::connectToRealChip(RealChipInterfaceType type, RealChipInterfaceGenera
 
 RealChipInterfaceType OPNA::getRealChipInterfaceType() const
 {
+	std::lock_guard<std::mutex> lg(rcMutex_);
 	return rcIntf_->getType();
 }
 
 bool OPNA::hasConnectedToRealChip() const
 {
+	std::lock_guard<std::mutex> lg(rcMutex_);
 	return rcIntf_->hasConnected();
 }
+
+RegisterWriteStatistics OPNA::getRegisterWriteStatistics() const noexcept
+{
+	return { nWrites_.load(), nWriteContentions_.load(), nMixContentions_.load(),
+				nOverruns_.load(), peakQueueSize_.load() };
+}
+
+void OPNA::resetRegisterWriteStatistics() noexcept
+{
+	nWrites_ = 0;
+	nWriteContentions_ = 0;
+	nMixContentions_ = 0;
+	nOverruns_ = 0;
+	peakQueueSize_ = 0;
+}
+
+void OPNA::setStageProfilingEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> lg(mutex_);
+	isStageProfiling_ = enabled;
+}
+
+MixStageProfile OPNA::getMixStageProfile()
+{
+	std::lock_guard<std::mutex> lg(mutex_);
+	return stageProfile_;
+}
+
+void OPNA::resetMixStageProfile()
+{
+	std::lock_guard<std::mutex> lg(mutex_);
+	stageProfile_ = MixStageProfile();
+}
+
+void OPNA::setSilenceSkipEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> lg(mutex_);
+	isSilenceSkipEnabled_ = enabled;
+	isIdle_ = false;
+	silentFmSamples_ = 0;
+}
+
+void OPNA::setChannelsActive(bool active) noexcept
+{
+	hasActiveChannels_.store(active, std::memory_order_release);
+}
 }
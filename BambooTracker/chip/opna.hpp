@@ -27,8 +27,12 @@
 
 #include "chip.hpp"
 #include <memory>
-#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include "resampler.hpp"
+#include "register_write_queue.hpp"
 #include "2608_interface.hpp"
 #include "real_chip_interface.hpp"
 
@@ -43,12 +47,39 @@ enum class OpnaEmulator
 	Last = Ymfm,
 };
 
+/// Output rate of the ymfm SSG. FM is always generated at its synthesis rate.
+enum class YmfmFidelity : int
+{
+	Max,	///< clock / 32, no averaging
+	Medium,	///< clock / 48, averages 3 SSG samples into 2
+	Min,	///< clock / 144, averages 9 SSG samples into 2
+	First = Max,
+	Last = Min,
+};
+
+struct RegisterWriteStatistics
+{
+	size_t writes;				///< Number of register writes
+	size_t writeContentions;	///< Times a writer waited for another writer
+	size_t mixContentions;		///< Times the mixer output silence while the chip was reconfigured
+	size_t overruns;			///< Times a write queue filled up and was flushed without waits
+	size_t peakQueueSize;
+};
+
+struct MixStageProfile
+{
+	std::chrono::nanoseconds synthesis;		///< Chip emulation including register writes between waits
+	std::chrono::nanoseconds resampling;
+	std::chrono::nanoseconds mixing;		///< Gain and mix into the output stream
+	size_t samples;							///< Number of output samples
+};
+
 class OPNA final : public Chip
 {
 public:
 	// [rate]
 	// 0 = rate is 55466 (FM synthesis rate when clock is 3993600 * 2)
-	OPNA(OpnaEmulator emu, int clock, int rate, size_t maxDuration, size_t dramSize,
+	OPNA(OpnaEmulator emu, YmfmFidelity ymfmFidelity, int clock, int rate, size_t maxDuration, size_t dramSize,
 		 std::unique_ptr<AbstractResampler> fmResampler = std::make_unique<BlipResampler>(),
 		 std::unique_ptr<AbstractResampler> ssgResampler = std::make_unique<BlipResampler>(),
 		 std::shared_ptr<AbstractRegisterWriteLogger> logger = nullptr);
@@ -64,9 +95,20 @@ public:
 	void setVolumeSSG(double dB);
 	double getVolumeSSG() const noexcept { return volumeSsg_; }
 	size_t getDRAMSize() const noexcept;
+	/**
+	 * @brief Load data into the ADPCM DRAM in one go.
+	 *        Emulators take the data at the start of the next mix, while a logger and a real chip
+	 *        receive the bytes as memory data writes, so the caller sets up the write beforehand.
+	 * @param offset byte offset in the DRAM.
+	 * @param data loaded data.
+	 * @param length number of bytes.
+	 */
+	void writeDRAM(size_t offset, const uint8_t* data, size_t length);
 
 	/**
 	 * @brief mix samples.
+	 *        It never waits for register writers. While another thread resets or reconfigures
+	 *        the chip, the block is filled with silence instead.
 	 * @param stream buffer where mixed samples are stored.
 	 * @param nSamples number of samples
 	 * @return true if sample generation is success, otherwise false.
@@ -80,30 +122,74 @@ public:
 	RealChipInterfaceType getRealChipInterfaceType() const;
 	bool hasConnectedToRealChip() const;
 
+	RegisterWriteStatistics getRegisterWriteStatistics() const noexcept;
+	void resetRegisterWriteStatistics() noexcept;
+
+	void setStageProfilingEnabled(bool enabled);
+	MixStageProfile getMixStageProfile();
+	void resetMixStageProfile();
+
+	/**
+	 * @brief Enable to skip synthesis of silent blocks.
+	 *        Emulator state is held while skipping, so the output is no longer sample-exact.
+	 * @param enabled true if enabled.
+	 */
+	void setSilenceSkipEnabled(bool enabled);
+	bool isSilenceSkipEnabled() const noexcept { return isSilenceSkipEnabled_; }
+	/**
+	 * @brief Notify whether any channel is keyed on.
+	 *        The chip is never idle while active channels are notified.
+	 * @param active true if any channel is keyed on.
+	 */
+	void setChannelsActive(bool active) noexcept;
+
 private:
-	static size_t count_;
+	static std::atomic<size_t> count_;
 
 	std::unique_ptr<Ym2608Interface> intf_;
 	double volumeFm_, volumeSsg_;
 	constexpr static int VOLUME_RATIO_MOD_ = 2;
 	size_t dramSize_;
 
+	// Serializes real chip access among register writes, reset and connection.
+	// It is taken last, after any other lock.
+	mutable std::mutex rcMutex_;
 	std::unique_ptr<SimpleRealChipInterface> rcIntf_;
 
 	void resetSpecific() override;
 
-	struct RegisterWrite
+	// Writers only contend with each other on writeMutex_,
+	// and the mixer consumes the queues without taking it.
+	// Writes in immediate mode are all applied at the start of the next mix.
+	std::mutex writeMutex_;
+	std::atomic<bool> isForcedRegWrite_;	// Also cleared by reset without writeMutex_
+	RegisterWriteQueue regWrites_, forcedRegWrites_, immediateRegWrites_;
+
+	// DRAM loads waiting for the mixer, which takes dramMutex_ only when it is free
+	struct PendingDRAMBlock
 	{
-		uint32_t address;
-		uint8_t data;
-		bool isPortA_;
+		size_t offset, length;
 	};
+	std::mutex dramMutex_;
+	std::vector<uint8_t> pendingDram_;
+	std::vector<PendingDRAMBlock> pendingDramBlocks_;
+	std::atomic<bool> hasPendingDram_;
 
-	bool isForcedRegWrite_;
-	std::deque<RegisterWrite> regWrites_, forcedRegWrites_;
+	std::atomic<size_t> nWrites_, nWriteContentions_, nMixContentions_, nOverruns_, peakQueueSize_;
 
 	void enqueueData(uint32_t offset, uint8_t value);
-	void writeDataImmediately(uint32_t offset, uint8_t value);
+	void writeData(const RegisterWrite& write);
+	void writeImmediateData();
+	void writePendingDRAM();
+
+	bool isStageProfiling_;
+	MixStageProfile stageProfile_;
+
+	bool isSilenceSkipEnabled_, isIdle_;
+	std::atomic<bool> hasActiveChannels_, hasWrittenSinceProbe_;
+	size_t silentFmSamples_;	// Successive silent samples at FM internal rate
+	void probeSilence(size_t nFm, size_t nSsg);
+	bool canIdle();
 
 	size_t dequeueData();
 
@@ -116,9 +202,8 @@ private:
 
 	struct WriteModeFuncs
 	{
-		void (OPNA::*setRegister)(uint32_t, uint8_t);
 		bool (OPNA::*storeBuffer)(size_t, size_t&, size_t&);
 	} writeFuncs[2];
-	WriteModeFuncs* writeFunc;
+	std::atomic<WriteModeFuncs*> writeFunc;	// Read by both writers and the mixer
 };
 }
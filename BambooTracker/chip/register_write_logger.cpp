@@ -39,6 +39,11 @@ AbstractRegisterWriteLogger::AbstractRegisterWriteLogger(int target)
 {
 }
 
+void AbstractRegisterWriteLogger::recordRegisterChanges(uint32_t offset, const uint8_t* data, size_t length)
+{
+	for (size_t i = 0; i < length; ++i) recordRegisterChange(offset, data[i]);
+}
+
 void AbstractRegisterWriteLogger::elapse(size_t count) noexcept
 {
 	lastWait_ += count;
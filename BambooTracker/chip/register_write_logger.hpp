@@ -37,6 +37,8 @@ public:
 	explicit AbstractRegisterWriteLogger(int target);
 	virtual ~AbstractRegisterWriteLogger() = default;
 	virtual void recordRegisterChange(uint32_t offset, uint8_t value) = 0;
+	/// Records consecutive writes to one register, such as a block of the ADPCM memory.
+	virtual void recordRegisterChanges(uint32_t offset, const uint8_t* data, size_t length);
 	void elapse(size_t count) noexcept;
 	bool empty() const noexcept;
 	void clear() noexcept;
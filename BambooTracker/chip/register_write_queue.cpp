@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "register_write_queue.hpp"
+
+namespace chip
+{
+namespace
+{
+size_t roundUpToPowerOf2(size_t n) noexcept
+{
+	size_t p = 1;
+	while (p < n) p <<= 1;
+	return p;
+}
+}
+
+RegisterWriteQueue::RegisterWriteQueue(size_t capacity)
+	: buf_(roundUpToPowerOf2(capacity)),
+	  mask_(buf_.size() - 1),
+	  head_(0),
+	  tail_(0)
+{
+}
+
+bool RegisterWriteQueue::push(const RegisterWrite& write) noexcept
+{
+	size_t tail = tail_.load(std::memory_order_relaxed);
+	if (tail - head_.load(std::memory_order_acquire) == buf_.size()) return false;
+
+	buf_[tail & mask_] = write;
+	tail_.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+const RegisterWrite* RegisterWriteQueue::front() const noexcept
+{
+	size_t head = head_.load(std::memory_order_relaxed);
+	if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+	return &buf_[head & mask_];
+}
+
+void RegisterWriteQueue::pop() noexcept
+{
+	head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void RegisterWriteQueue::clear() noexcept
+{
+	head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool RegisterWriteQueue::empty() const noexcept
+{
+	return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+}
+
+size_t RegisterWriteQueue::size() const noexcept
+{
+	return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+}
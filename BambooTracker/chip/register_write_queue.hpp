@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <vector>
+
+namespace chip
+{
+struct RegisterWrite
+{
+	uint32_t address;
+	uint8_t data;
+	bool isPortA_;
+};
+
+/**
+ * @brief Lock-free ring buffer of register writes.
+ *
+ * It is safe for one thread to push while another thread reads,
+ * but producers and consumers must be serialized among themselves.
+ */
+class RegisterWriteQueue
+{
+public:
+	/// @param capacity is rounded up to a power of two.
+	explicit RegisterWriteQueue(size_t capacity);
+
+	// Producer side
+	/// @return false if the queue is full.
+	bool push(const RegisterWrite& write) noexcept;
+
+	// Consumer side
+	/// @return nullptr if the queue is empty.
+	const RegisterWrite* front() const noexcept;
+	void pop() noexcept;
+	void clear() noexcept;
+
+	bool empty() const noexcept;
+	size_t size() const noexcept;
+	size_t capacity() const noexcept { return buf_.size(); }
+
+private:
+	std::vector<RegisterWrite> buf_;
+	size_t mask_;
+	alignas(64) std::atomic<size_t> head_;
+	alignas(64) std::atomic<size_t> tail_;
+};
+}
@@ -27,10 +27,14 @@
 #include <algorithm>
 #include <iterator>
 #include "./blip_buf/blip_buf.h"
+#ifdef CHIP_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace chip
 {
 AbstractResampler::AbstractResampler()
+	: nCh_(2)
 {
 	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
 		destBuf_[pan] = new sample[CHIP_SMPL_BUF_SIZE_]();
@@ -63,7 +67,7 @@ sample** LinearResampler::interpolate(sample** src, size_t nSamples, size_t)
 	if (srcRate_ == destRate_) return src;
 
 	// Linear interplation
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
+	for (int pan = STEREO_LEFT; pan < nCh_; ++pan) {
 		for (size_t n = 0; n < nSamples; ++n) {
 			float curnf = n * rateRatio_;
 			int curni = static_cast<int>(curnf);
@@ -113,6 +117,7 @@ void BlipResampler::reset()
 {
 	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
 		blip_clear(ch_[pan].blipBuf_);
+		ch_[pan].prevSample_ = 0;
 	}
 }
 
@@ -134,7 +139,7 @@ sample** BlipResampler::interpolate(sample** src, size_t nSamples, size_t intrSi
 	if (srcRate_ == destRate_) return src;
 
 	short tmpBuf[CHIP_SMPL_BUF_SIZE_];
-	for (int pan = STEREO_LEFT; pan <= STEREO_RIGHT; ++pan) {
+	for (int pan = STEREO_LEFT; pan < nCh_; ++pan) {
 		auto& ch = ch_[pan];
 		if (ch.blipBuf_ == nullptr) continue;
 
@@ -152,4 +157,221 @@ sample** BlipResampler::interpolate(sample** src, size_t nSamples, size_t intrSi
 
 	return destBuf_;
 }
+
+/****************************************/
+namespace
+{
+struct SincParameter
+{
+	int zeroCrossings;
+	size_t nPhases;
+	double rolloff;
+	double beta;
+};
+
+SincParameter getSincParameter(SincResampler::Quality quality)
+{
+	switch (quality) {
+	case SincResampler::Quality::Fast:	return { 4, 64, 0.85, 5.0 };
+	default:
+	case SincResampler::Quality::Standard:	return { 8, 128, 0.9, 7.0 };
+	case SincResampler::Quality::Best:	return { 16, 256, 0.94, 9.0 };
+	}
+}
+
+double besselI0(double x)
+{
+	double sum = 1., term = 1.;
+	for (int k = 1; term > sum * 1e-12; ++k) {
+		double t = x / (2. * k);
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr int FRAC_BITS = 32;
+constexpr uint64_t FRAC_MASK = (uint64_t(1) << FRAC_BITS) - 1;
+
+/// Single channel version of the stereo kernel in SincResampler::interpolate, summed in the same order.
+float convolveMono(const float* x, const float* c, const float* d, float a, size_t nTaps)
+{
+#ifdef CHIP_USE_SSE2
+	__m128 acc = _mm_setzero_ps(), accD = _mm_setzero_ps();
+	for (size_t i = 0; i < nTaps; i += 4) {
+		__m128 xv = _mm_loadu_ps(x + i);
+		acc = _mm_add_ps(acc, _mm_mul_ps(xv, _mm_loadu_ps(c + i)));
+		accD = _mm_add_ps(accD, _mm_mul_ps(xv, _mm_loadu_ps(d + i)));
+	}
+	acc = _mm_add_ps(acc, _mm_mul_ps(accD, _mm_set1_ps(a)));
+	__m128 s = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(s);
+#else
+	float acc = 0.f, accD = 0.f;
+	for (size_t i = 0; i < nTaps; ++i) {
+		acc += x[i] * c[i];
+		accD += x[i] * d[i];
+	}
+	return acc + accD * a;
+#endif
+}
+}
+
+SincResampler::SincResampler(Quality quality)
+	: quality_(quality), nTaps_(0), nPhases_(0), histSize_(0), pos_(0), step_(0)
+{
+}
+
+void SincResampler::init(int srcRate, int destRate, size_t maxDuration)
+{
+	AbstractResampler::init(srcRate, destRate, maxDuration);
+
+	const SincParameter param = getSincParameter(quality_);
+	const double ratio = static_cast<double>(srcRate) / destRate;
+	// Cutoff frequency in cycles per source sample
+	const double cutoff = 0.5 * param.rolloff / std::max(1., ratio);
+	const double halfWidth = param.zeroCrossings / (2. * cutoff);
+	nTaps_ = (static_cast<size_t>(std::ceil(2. * halfWidth)) + 3) & ~size_t(3);
+	nPhases_ = param.nPhases;
+	step_ = static_cast<uint64_t>(std::llround(ratio * (uint64_t(1) << FRAC_BITS)));
+
+	// Kernel centered between the taps (nTaps_ / 2 - 1) and (nTaps_ / 2)
+	const double i0Beta = besselI0(param.beta);
+	const double center = static_cast<double>(nTaps_ / 2 - 1);
+	std::vector<double> row(nTaps_);
+	coefs_.assign((nPhases_ + 1) * nTaps_, 0.f);
+	for (size_t ph = 0; ph <= nPhases_; ++ph) {
+		double sum = 0.;
+		for (size_t i = 0; i < nTaps_; ++i) {
+			double x = i - center - static_cast<double>(ph) / nPhases_;
+			double r = x / halfWidth;
+			if (std::abs(r) >= 1.) {
+				row[i] = 0.;
+				continue;
+			}
+			double px = 2. * cutoff * x * 3.14159265358979323846;
+			double sinc = (x == 0.) ? 1. : std::sin(px) / px;
+			row[i] = sinc * besselI0(param.beta * std::sqrt(1. - r * r)) / i0Beta;
+			sum += row[i];
+		}
+		for (size_t i = 0; i < nTaps_; ++i) {
+			coefs_[ph * nTaps_ + i] = static_cast<float>(row[i] / sum);	// Unity gain on DC
+		}
+	}
+	coefDiffs_.assign(nPhases_ * nTaps_, 0.f);
+	for (size_t i = 0; i < coefDiffs_.size(); ++i) {
+		coefDiffs_[i] = coefs_[i + nTaps_] - coefs_[i];
+	}
+
+	for (auto& hist : hist_) hist.assign(nTaps_ + CHIP_SMPL_BUF_SIZE_, 0.f);
+	clearHistory();
+}
+
+void SincResampler::reset()
+{
+	clearHistory();
+}
+
+void SincResampler::clearHistory()
+{
+	// Zero padding before the first sample so that the kernel is centered on it
+	histSize_ = nTaps_ / 2 - 1;
+	for (auto& hist : hist_) std::fill_n(hist.begin(), histSize_, 0.f);
+	pos_ = 0;
+}
+
+size_t SincResampler::calculateInternalSampleSize(size_t nSamples, bool& ok)
+{
+	ok = true;
+	if (srcRate_ == destRate_) return nSamples;
+	if (!nSamples) return 0;
+
+	size_t last = static_cast<size_t>((pos_ + step_ * (nSamples - 1)) >> FRAC_BITS) + nTaps_;
+	return (last > histSize_) ? last - histSize_ : 0;
+}
+
+sample** SincResampler::interpolate(sample** src, size_t nSamples, size_t intrSize)
+{
+	if (srcRate_ == destRate_) return src;
+
+	intrSize = std::min(intrSize, hist_[STEREO_LEFT].size() - histSize_);
+	for (int pan = STEREO_LEFT; pan < nCh_; ++pan) {
+		std::copy_n(src[pan], intrSize, hist_[pan].begin() + static_cast<std::ptrdiff_t>(histSize_));
+	}
+	histSize_ += intrSize;
+
+	const float* histL = hist_[STEREO_LEFT].data();
+	const float* histR = hist_[STEREO_RIGHT].data();
+	const float phaseScale = static_cast<float>(nPhases_) / static_cast<float>(uint64_t(1) << FRAC_BITS);
+	for (size_t n = 0; n < nSamples; ++n, pos_ += step_) {
+		size_t idx = static_cast<size_t>(pos_ >> FRAC_BITS);
+		if (idx + nTaps_ > histSize_) {	// Lack of source samples
+			destBuf_[STEREO_LEFT][n] = 0;
+			destBuf_[STEREO_RIGHT][n] = 0;
+			continue;
+		}
+
+		float phf = static_cast<float>(pos_ & FRAC_MASK) * phaseScale;
+		size_t ph = std::min(static_cast<size_t>(phf), nPhases_ - 1);
+		float a = phf - ph;
+		const float* c = coefs_.data() + ph * nTaps_;
+		const float* d = coefDiffs_.data() + ph * nTaps_;
+		const float* l = histL + idx;
+		if (nCh_ == 1) {
+			destBuf_[STEREO_LEFT][n] = static_cast<sample>(std::lrint(convolveMono(l, c, d, a, nTaps_)));
+			continue;
+		}
+		const float* r = histR + idx;
+
+		float outL, outR;
+#ifdef CHIP_USE_SSE2
+		__m128 accL = _mm_setzero_ps(), accDL = _mm_setzero_ps();
+		__m128 accR = _mm_setzero_ps(), accDR = _mm_setzero_ps();
+		for (size_t i = 0; i < nTaps_; i += 4) {
+			__m128 cv = _mm_loadu_ps(c + i);
+			__m128 dv = _mm_loadu_ps(d + i);
+			__m128 lv = _mm_loadu_ps(l + i);
+			__m128 rv = _mm_loadu_ps(r + i);
+			accL = _mm_add_ps(accL, _mm_mul_ps(lv, cv));
+			accDL = _mm_add_ps(accDL, _mm_mul_ps(lv, dv));
+			accR = _mm_add_ps(accR, _mm_mul_ps(rv, cv));
+			accDR = _mm_add_ps(accDR, _mm_mul_ps(rv, dv));
+		}
+		__m128 av = _mm_set1_ps(a);
+		accL = _mm_add_ps(accL, _mm_mul_ps(accDL, av));
+		accR = _mm_add_ps(accR, _mm_mul_ps(accDR, av));
+		// Horizontal sums: (L0+L2, L1+L3, R0+R2, R1+R3) -> (L, R)
+		__m128 lo = _mm_movelh_ps(accL, accR);
+		__m128 hi = _mm_movehl_ps(accR, accL);
+		__m128 s = _mm_add_ps(lo, hi);
+		s = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 3, 0, 1)));
+		outL = _mm_cvtss_f32(s);
+		outR = _mm_cvtss_f32(_mm_movehl_ps(s, s));
+#else
+		float accL = 0.f, accDL = 0.f, accR = 0.f, accDR = 0.f;
+		for (size_t i = 0; i < nTaps_; ++i) {
+			accL += l[i] * c[i];
+			accDL += l[i] * d[i];
+			accR += r[i] * c[i];
+			accDR += r[i] * d[i];
+		}
+		outL = accL + accDL * a;
+		outR = accR + accDR * a;
+#endif
+		destBuf_[STEREO_LEFT][n] = static_cast<sample>(std::lrint(outL));
+		destBuf_[STEREO_RIGHT][n] = static_cast<sample>(std::lrint(outR));
+	}
+
+	// Drop consumed source samples
+	size_t consumed = std::min(static_cast<size_t>(pos_ >> FRAC_BITS), histSize_);
+	for (int pan = STEREO_LEFT; pan < nCh_; ++pan) {
+		std::copy(hist_[pan].begin() + static_cast<std::ptrdiff_t>(consumed),
+				  hist_[pan].begin() + static_cast<std::ptrdiff_t>(histSize_), hist_[pan].begin());
+	}
+	histSize_ -= consumed;
+	pos_ -= static_cast<uint64_t>(consumed) << FRAC_BITS;
+
+	return destBuf_;
+}
 }
@@ -28,6 +28,8 @@
 #include "chip_defs.h"
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 struct blip_t;
 
@@ -38,6 +40,9 @@ enum class ResamplerType : int
 	Linear = 0,
 	BlipBuf,
 	FastBlipBuf,
+	Sinc,
+	FastSinc,
+	BestSinc,
 };
 
 class AbstractResampler
@@ -54,6 +59,11 @@ public:
 	}
 
 	virtual void setMaxDuration(size_t maxDuration) noexcept;
+
+	/// Sets the number of channels to interpolate. Only the left channel is used when it is 1.
+	void setChannelCount(int nCh) noexcept { nCh_ = nCh; }
+	int getChannelCount() const noexcept { return nCh_; }
+
 	virtual sample** interpolate(sample** src, size_t nSamples, size_t intrSize) = 0;
 
 	/**
@@ -72,6 +82,7 @@ protected:
 	int srcRate_, destRate_;
 	size_t maxDuration_;
 	float rateRatio_;
+	int nCh_;
 	sample* destBuf_[2];
 
 	void updateRateRatio()
@@ -111,4 +122,35 @@ private:
 
 	void (*addDelta)(blip_t*, unsigned int, int);
 };
+
+/// Polyphase FIR resampler with Kaiser-windowed sinc kernels.
+class SincResampler final : public AbstractResampler
+{
+public:
+	enum class Quality { Fast, Standard, Best };
+
+	explicit SincResampler(Quality quality = Quality::Standard);
+	void init(int srcRate, int destRate, size_t maxDuration) override;
+	void reset() override;
+
+	void setDestributionRate(int destRate) override
+	{
+		init(srcRate_, destRate, maxDuration_);
+	}
+
+	size_t calculateInternalSampleSize(size_t nSamples, bool& ok) override;
+	sample** interpolate(sample** src, size_t nSamples, size_t intrSize) override;
+
+private:
+	const Quality quality_;
+	size_t nTaps_;	// Multiple of 4
+	size_t nPhases_;
+	/// Rows of (nPhases_ + 1) coefficients and the differences to the next row.
+	std::vector<float> coefs_, coefDiffs_;
+	std::vector<float> hist_[2];
+	size_t histSize_;
+	uint64_t pos_, step_;	// 32.32 fixed point position in hist_
+
+	void clearHistory();
+};
 }
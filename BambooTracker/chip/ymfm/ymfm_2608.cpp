@@ -24,11 +24,19 @@
  */
 
 #include "ymfm_2608.hpp"
+#include <algorithm>
+#include "../opna.hpp"
 
 extern const unsigned char YM2608_ADPCM_ROM[0x2000];
 
 namespace chip
 {
+namespace
+{
+// Samples generated by one call of ymfm
+constexpr int BLOCK_SIZE = 256;
+}
+
 Ymfm2608::YmfmInterface::YmfmInterface(uint32_t dramSize) : dram_(dramSize) {}
 
 uint8_t Ymfm2608::YmfmInterface::ymfm_external_read(ymfm::access_class type, uint32_t address)
@@ -50,7 +58,15 @@ void Ymfm2608::YmfmInterface::ymfm_external_write(ymfm::access_class type, uint3
 	}
 }
 
+void Ymfm2608::YmfmInterface::writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	if (offset >= dram_.size()) return;
+	std::copy_n(data, std::min<size_t>(length, dram_.size() - offset), dram_.begin() + offset);
+}
+
 //**************************************************
+Ymfm2608::Ymfm2608(YmfmFidelity fidelity) : fidelity_(fidelity) {}
+
 Ymfm2608::~Ymfm2608()
 {
 	stopDevice();
@@ -61,9 +77,22 @@ int Ymfm2608::startDevice(int clock, int& rateSsg, uint32_t dramSize)
 	ymfmIntf_ = std::make_unique<YmfmInterface>(dramSize);
 	ymfm_ = std::make_unique<ymfm::ym2608>(*ymfmIntf_);
 	// Prescale = 6
-	// Set FM output rate
-	ymfm_->set_fidelity(ymfm::opn_fidelity::OPN_FIDELITY_MIN);
-	rateSsg = clock / 32;
+	// FM is always generated at its synthesis rate, and the fidelity selects the SSG output rate
+	switch (fidelity_) {
+	default:
+	case YmfmFidelity::Max:
+		ymfm_->set_fidelity(ymfm::opn_fidelity::OPN_FIDELITY_MAX);
+		rateSsg = clock / 32;
+		break;
+	case YmfmFidelity::Medium:
+		ymfm_->set_fidelity(ymfm::opn_fidelity::OPN_FIDELITY_MED);
+		rateSsg = clock / 48;
+		break;
+	case YmfmFidelity::Min:
+		ymfm_->set_fidelity(ymfm::opn_fidelity::OPN_FIDELITY_MIN);
+		rateSsg = clock / 144;
+		break;
+	}
 
 	ymfm_->reset();
 
@@ -105,32 +134,40 @@ uint8_t Ymfm2608::readData()
 	return ymfm_->read_data();
 }
 
+void Ymfm2608::writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	ymfmIntf_->writeDRAM(offset, data, length);
+}
+
 void Ymfm2608::updateStream(sample** outputs, int nSamples)
 {
 	sample* bufl = outputs[STEREO_LEFT];
 	sample* bufr = outputs[STEREO_RIGHT];
 
-	ymfm::ym2608::output_data data;
-	for (int i = 0; i < nSamples; ++i) {
-		ymfm_->generate_fm_adpcm(&data);
-		// Raise volume
-		*bufl++ = data.data[0] << 1;
-		*bufr++ = data.data[1] << 1;
+	ymfm::ym2608::output_data data[BLOCK_SIZE];
+	while (nSamples > 0) {
+		int n = std::min(nSamples, BLOCK_SIZE);
+		ymfm_->generate_fm_adpcm(data, n);
+		for (int i = 0; i < n; ++i) {
+			// Raise volume
+			*bufl++ = data[i].data[0] << 1;
+			*bufr++ = data[i].data[1] << 1;
+		}
+		nSamples -= n;
 	}
 }
 
-void Ymfm2608::updateSsgStream(sample** outputs, int nSamples)
+void Ymfm2608::updateSsgStream(sample* output, int nSamples)
 {
-	sample* bufl = outputs[STEREO_LEFT];
-	sample* bufr = outputs[STEREO_RIGHT];
-
-	ymfm::ym2608::output_data data;
-	for (int i = 0; i < nSamples; ++i) {
-		ymfm_->generate_ssg(&data);
-		// Modify volume
-		int32_t s = data.data[2] * 3 / 4;
-		*bufl++ = s;
-		*bufr++ = s;
+	ymfm::ym2608::output_data data[BLOCK_SIZE];
+	while (nSamples > 0) {
+		int n = std::min(nSamples, BLOCK_SIZE);
+		ymfm_->generate_ssg(data, n);
+		for (int i = 0; i < n; ++i) {
+			// Modify volume
+			*output++ = data[i].data[2] * 3 / 4;
+		}
+		nSamples -= n;
 	}
 }
 }
@@ -33,9 +33,12 @@
 
 namespace chip
 {
+enum class YmfmFidelity : int;
+
 class Ymfm2608 final : public Ym2608Interface
 {
 public:
+	explicit Ymfm2608(YmfmFidelity fidelity);
 	~Ymfm2608() override;
 	int startDevice(int clock, int& rateSsg, uint32_t dramSize) override;
 	void stopDevice() override;
@@ -45,8 +48,9 @@ public:
 	void writeDataToPortA(uint8_t data) override;
 	void writeDataToPortB(uint8_t data) override;
 	uint8_t readData() override;
+	void writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length) override;
 	void updateStream(sample** outputs, int nSamples) override;
-	void updateSsgStream(sample** outputs, int nSamples) override;
+	void updateSsgStream(sample* output, int nSamples) override;
 
 private:
 	class YmfmInterface final : public ymfm::ymfm_interface
@@ -55,11 +59,13 @@ private:
 		YmfmInterface(uint32_t dramSize);
 		uint8_t ymfm_external_read(ymfm::access_class type, uint32_t address) override;
 		void ymfm_external_write(ymfm::access_class type, uint32_t address, uint8_t data) override;
+		void writeDRAM(uint32_t offset, const uint8_t* data, uint32_t length);
 
 	private:
 		std::vector<uint8_t> dram_;
 	};
 
+	YmfmFidelity fidelity_;
 	std::unique_ptr<ymfm::ym2608> ymfm_;
 	std::unique_ptr<YmfmInterface> ymfmIntf_;
 };
@@ -1366,6 +1366,12 @@ void ym2608::update_prescale(uint8_t prescale)
 	//     3        1.5:1     1:3          3:1     2:3          9:1     2:1
 	//     2          1:1     1:6          2:1     1:3          6:1     1:1
 
+	/* [BambooTracker] Local patch
+	 * The prescale 6 rows below differ from the table above and from upstream ymfm.
+	 * FM is output at its synthesis rate (clock/144) in every fidelity, and the fidelity
+	 * only selects the SSG rate: maximum clock/32, medium clock/48, minimum clock/144.
+	 * Keep them when updating ymfm. */
+
 	// compute the number of FM samples per output sample, and select the
 	// resampler function
 	if (m_fidelity == OPN_FIDELITY_MIN)
@@ -1375,8 +1381,8 @@ void ym2608::update_prescale(uint8_t prescale)
 			default:
 			/* [BambooTracker]
 			 * We use only prescale = 6, match output rate to FM synthesis rate
-			 * and do not resample SSG */
-			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 1);	break;
+			 * and average SSG down to the same rate (clock/144) */
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(2, 9);	break;
 			case 3: m_fm_samples_per_output = 0;	m_ssg_resampler.configure(1, 3);	break;
 			case 2: m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 6);	break;
 		}
@@ -1386,7 +1392,10 @@ void ym2608::update_prescale(uint8_t prescale)
 		switch (prescale)
 		{
 			default:
-			case 6:	m_fm_samples_per_output = 6;	m_ssg_resampler.configure(4, 3);	break;
+			/* [BambooTracker]
+			 * We use only prescale = 6, match output rate to FM synthesis rate
+			 * and average SSG at clock/48 */
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(2, 3);	break;
 			case 3: m_fm_samples_per_output = 3;	m_ssg_resampler.configure(2, 3);	break;
 			case 2: m_fm_samples_per_output = 2;	m_ssg_resampler.configure(1, 3);	break;
 		}
@@ -1396,7 +1405,10 @@ void ym2608::update_prescale(uint8_t prescale)
 		switch (prescale)
 		{
 			default:
-			case 6:	m_fm_samples_per_output = 18;	m_ssg_resampler.configure(4, 1);	break;
+			/* [BambooTracker]
+			 * We use only prescale = 6, match output rate to FM synthesis rate
+			 * and do not resample SSG (clock/32) */
+			case 6:	m_fm_samples_per_output = 1;	m_ssg_resampler.configure(1, 1);	break;
 			case 3: m_fm_samples_per_output = 9;	m_ssg_resampler.configure(2, 1);	break;
 			case 2: m_fm_samples_per_output = 6;	m_ssg_resampler.configure(1, 1);	break;
 		}
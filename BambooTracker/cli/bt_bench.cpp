@@ -0,0 +1,822 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// bt-bench: renders modules with every emulator and resampler and reports the throughput
+// and the time spent in each stage of the stream as JSON.
+// Renders run one after another on the calling thread so that the timings do not disturb each other.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bamboo_tracker.hpp"
+#include "configuration.hpp"
+#include "chip/opna.hpp"
+#include "chip/mix_kernels.hpp"
+#include "chip/resampler.hpp"
+#include "io/binary_container.hpp"
+#include "io/wav_stream_writer.hpp"
+#include "step.hpp"
+#include "rt_alloc_check.hpp"
+#include "cli_common.hpp"
+
+namespace
+{
+struct Emulator
+{
+	const char* name;
+	chip::OpnaEmulator type;
+	chip::YmfmFidelity fidelity;
+};
+
+constexpr Emulator EMULATORS[] = {
+	{ "mame", chip::OpnaEmulator::Mame, chip::YmfmFidelity::Max },
+	{ "nuked", chip::OpnaEmulator::Nuked, chip::YmfmFidelity::Max },
+	{ "ymfm", chip::OpnaEmulator::Ymfm, chip::YmfmFidelity::Max },
+	{ "ymfm-med", chip::OpnaEmulator::Ymfm, chip::YmfmFidelity::Medium },
+	{ "ymfm-min", chip::OpnaEmulator::Ymfm, chip::YmfmFidelity::Min }
+};
+
+struct Resampler
+{
+	const char* name;
+	chip::ResamplerType type;
+};
+
+constexpr Resampler RESAMPLERS[] = {
+	{ "linear", chip::ResamplerType::Linear },
+	{ "blip", chip::ResamplerType::BlipBuf },
+	{ "fastblip", chip::ResamplerType::FastBlipBuf },
+	{ "sinc", chip::ResamplerType::Sinc },
+	{ "fastsinc", chip::ResamplerType::FastSinc },
+	{ "bestsinc", chip::ResamplerType::BestSinc }
+};
+
+struct BenchOptions
+{
+	std::vector<Emulator> emulators;
+	std::vector<Resampler> resamplers;
+	bool allSongs = false;
+	bool render = true;
+	int rate = 44100;
+	double timeLimit = 0;	// 0: whole song
+	int loadRepeat = 5;
+	std::string outPath;
+	std::vector<std::string> files;
+};
+
+struct ModuleResult
+{
+	std::string path;
+	size_t fileSize = 0;
+	size_t songCount = 0;
+	double loadTime = 0;	// Best of the repeats
+	double fileLoadTime = 0;	// Reading the file into memory and loading it, best of the repeats
+	double fileLoadMappedTime = 0;	// Mapping the file and loading it, best of the repeats
+	size_t steps = 0;		// Steps of song 0 in order
+	double traverseTime = 0;	// Best of the repeats
+	size_t ticks = 0;		// Ticks of song 0 played through once
+	double sequenceTime = 0;	// Best of the repeats
+	size_t edits = 0;		// Whole pattern edits of song 0
+	double editTime = 0;
+	size_t undoCommands = 0;	// Commands kept by the undo history after the edits
+	size_t undoBytes = 0;
+	double undoTime = 0;	// Undoing all kept commands
+	std::string error;
+};
+
+/// BinaryContainer operations used by the file loaders, on a 16 MiB buffer. Best of the repeats.
+struct ContainerResult
+{
+	double appendUint32Time = 0;	// 4 Mi appends
+	double readUint32Time = 0;		// 4 Mi reads
+	double readUint16Time = 0;		// 8 Mi reads
+	double subcontainerTime = 0;	// 10 copies of the whole buffer through getSubcontainer().toVector()
+};
+
+/// Gain and mix kernels of the chip on 1023 frames per call, as the audio callback sees them. Best of the repeats.
+struct MixKernelResult
+{
+	bool simd = false;	// Whether the default kernels have SIMD paths
+	double gainNs = 0;	// Per frame of the stereo FM buffer
+	double gainScalarNs = 0;
+	double mixNs = 0;	// Per output frame
+	double mixScalarNs = 0;
+};
+
+struct RenderResult
+{
+	std::string path;
+	int song = 0;
+	const char* emulator = "";
+	const char* resampler = "";
+	size_t samples = 0;
+	double elapsed = 0;
+	bool truncated = false;
+	StreamProfile profile {};
+	std::string error;
+};
+
+/// Discards samples, so that only the stream generation is measured.
+class NullWavWriter : public io::WavStreamWriter
+{
+public:
+	explicit NullWavWriter(uint32_t rate) : io::WavStreamWriter(rate, 2, 16) {}
+
+protected:
+	bool writeBytes(const uint8_t*, size_t) override { return true; }
+	bool writeBytesAt(size_t, const uint8_t*, size_t) override { return true; }
+};
+
+void printUsage(const char* prog)
+{
+	std::fprintf(stderr,
+				 "Usage: %s [options] [<module or directory>...]\n"
+				 "Renders every module (default: ./data) with each emulator and resampler\n"
+				 "and writes the results as JSON.\n"
+				 "Options:\n"
+				 "  -e, --emulator <name>       mame, nuked, ymfm, ymfm-med or ymfm-min\n"
+				 "                              (repeatable, default: all)\n"
+				 "  -R, --resampler <name>      linear, blip, fastblip, sinc, fastsinc or bestsinc\n"
+				 "                              (repeatable, default: all)\n"
+				 "  -a, --all-songs             Render all songs instead of song 0\n"
+				 "  -n, --no-render             Only measure loading, traversal, sequencing and editing of modules\n"
+				 "  -r, --rate <Hz>             Sample rate (default: 44100)\n"
+				 "  -t, --time-limit <sec>      Stop each render after this length of audio\n"
+				 "  -o, --output <file>         Write JSON to the file instead of stdout\n"
+				 "  -h, --help                  Show this help\n",
+				 prog);
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& opts)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto hasValue = [&]() { return i + 1 < argc; };
+
+		if (arg == "-h" || arg == "--help") {
+			return false;
+		}
+		else if (arg == "-a" || arg == "--all-songs") {
+			opts.allSongs = true;
+		}
+		else if (arg == "-n" || arg == "--no-render") {
+			opts.render = false;
+		}
+		else if ((arg == "-e" || arg == "--emulator") && hasValue()) {
+			std::string e = argv[++i];
+			auto it = std::find_if(std::begin(EMULATORS), std::end(EMULATORS),
+								   [&e](const Emulator& emu) { return e == emu.name; });
+			if (it == std::end(EMULATORS)) return false;
+			opts.emulators.push_back(*it);
+		}
+		else if ((arg == "-R" || arg == "--resampler") && hasValue()) {
+			std::string r = argv[++i];
+			auto it = std::find_if(std::begin(RESAMPLERS), std::end(RESAMPLERS),
+								   [&r](const Resampler& rs) { return r == rs.name; });
+			if (it == std::end(RESAMPLERS)) return false;
+			opts.resamplers.push_back(*it);
+		}
+		else if ((arg == "-r" || arg == "--rate") && hasValue()) {
+			char* end = nullptr;
+			long v = std::strtol(argv[++i], &end, 10);
+			if (*end != '\0' || v <= 0) return false;
+			opts.rate = static_cast<int>(v);
+		}
+		else if ((arg == "-t" || arg == "--time-limit") && hasValue()) {
+			char* end = nullptr;
+			opts.timeLimit = std::strtod(argv[++i], &end);
+			if (*end != '\0' || opts.timeLimit < 0) return false;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue()) {
+			opts.outPath = argv[++i];
+		}
+		else if (!arg.empty() && arg.front() == '-') {
+			return false;
+		}
+		else {
+			opts.files.push_back(arg);
+		}
+	}
+
+	if (opts.emulators.empty()) opts.emulators.assign(std::begin(EMULATORS), std::end(EMULATORS));
+	if (opts.resamplers.empty()) opts.resamplers.assign(std::begin(RESAMPLERS), std::end(RESAMPLERS));
+	if (opts.files.empty()) opts.files.push_back("data");
+	return true;
+}
+
+double seconds(std::chrono::nanoseconds ns)
+{
+	return std::chrono::duration<double>(ns).count();
+}
+
+void benchmarkLoad(ModuleResult& result, const io::BinaryContainer& data,
+				   std::shared_ptr<Configuration> config, int repeat)
+{
+	BambooTracker bt(config);
+	result.loadTime = -1;
+	for (int i = 0; i < repeat; ++i) {
+		auto begin = std::chrono::steady_clock::now();
+		bt.loadModule(data);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if (result.loadTime < 0 || elapsed < result.loadTime) result.loadTime = elapsed;
+	}
+	result.songCount = bt.getSongCount();
+}
+
+/// Loads the module from its file, read into memory and mapped.
+void benchmarkFileLoad(ModuleResult& result, const std::string& path,
+					   std::shared_ptr<Configuration> config, int repeat)
+{
+	BambooTracker bt(config);
+	auto measure = [&](auto read) {
+		double best = -1;
+		for (int i = 0; i < repeat; ++i) {
+			auto begin = std::chrono::steady_clock::now();
+			io::BinaryContainer data;
+			read(data);
+			bt.loadModule(data);
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			if (best < 0 || elapsed < best) best = elapsed;
+		}
+		return best;
+	};
+
+	result.fileLoadTime = measure([&](io::BinaryContainer& data) { cli::readFile(path, data); });
+	result.fileLoadMappedTime = measure([&](io::BinaryContainer& data) {
+		data = io::BinaryContainer::mapFile(path);
+	});
+}
+
+volatile uint32_t containerSink;	// Keeps the reads of the container benchmark
+
+ContainerResult benchmarkContainer(int repeat)
+{
+	constexpr size_t SIZE = 16 << 20;
+	constexpr int SUBCONTAINER_COPIES = 10;
+
+	auto best = [repeat](auto func) {
+		double time = -1;
+		for (int i = 0; i < repeat; ++i) {
+			auto begin = std::chrono::steady_clock::now();
+			func();
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			if (time < 0 || elapsed < time) time = elapsed;
+		}
+		return time;
+	};
+
+	ContainerResult result;
+	io::BinaryContainer data;
+	result.appendUint32Time = best([&] {
+		data.clear();
+		for (uint32_t i = 0; i < SIZE / 4; ++i) data.appendUint32(i);
+	});
+
+	uint32_t checksum = 0;
+	result.readUint32Time = best([&] {
+		for (size_t offset = 0; offset < SIZE; offset += 4) checksum += data.readUint32(offset);
+	});
+	result.readUint16Time = best([&] {
+		for (size_t offset = 0; offset < SIZE; offset += 2) checksum += data.readUint16(offset);
+	});
+	result.subcontainerTime = best([&] {
+		for (int i = 0; i < SUBCONTAINER_COPIES; ++i) checksum += data.getSubcontainer(0, SIZE).toVector().back();
+	});
+	containerSink = checksum;
+
+	return result;
+}
+
+volatile int16_t mixKernelSink;	// Keeps the output of the mix kernel benchmark
+
+MixKernelResult benchmarkMixKernels(int repeat)
+{
+	constexpr size_t FRAMES = 1023;
+	constexpr int CALLS = 1 << 14;
+	constexpr double GAIN = 0.8912509381337456;	// -1 dB
+
+	std::vector<sample> fm[2], ssg(FRAMES);
+	uint32_t seed = 1;
+	auto random = [&seed] {
+		seed = seed * 1664525u + 1013904223u;
+		return static_cast<sample>(seed >> 16) - 32768;	// Partially saturates after doubling
+	};
+	for (auto& buf : fm) {
+		buf.resize(FRAMES);
+		std::generate(buf.begin(), buf.end(), random);
+	}
+	std::generate(ssg.begin(), ssg.end(), random);
+	std::vector<int16_t> stream(FRAMES * 2);
+
+	auto best = [repeat](auto func) {
+		double time = -1;
+		for (int i = 0; i < repeat; ++i) {
+			auto begin = std::chrono::steady_clock::now();
+			for (int c = 0; c < CALLS; ++c) func();
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			if (time < 0 || elapsed < time) time = elapsed;
+		}
+		return time * 1e9 / (static_cast<double>(CALLS) * FRAMES);
+	};
+
+	MixKernelResult result;
+	result.simd = chip::hasSimdMixKernels();
+	sample* bufFM[2] = { fm[STEREO_LEFT].data(), fm[STEREO_RIGHT].data() };
+	// Gain works in place, so it runs on copies to keep the mix input intact
+	std::vector<sample> work[2] = { fm[STEREO_LEFT], fm[STEREO_RIGHT] };
+	sample* bufWork[2] = { work[STEREO_LEFT].data(), work[STEREO_RIGHT].data() };
+	result.gainNs = best([&] { chip::gainSamples(bufWork, 2, FRAMES, GAIN); });
+	result.gainScalarNs = best([&] { chip::gainSamplesScalar(bufWork, 2, FRAMES, GAIN); });
+	result.mixNs = best([&] { chip::mixSamples(stream.data(), bufFM, ssg.data(), FRAMES); });
+	mixKernelSink = stream.back();
+	result.mixScalarNs = best([&] { chip::mixSamplesScalar(stream.data(), bufFM, ssg.data(), FRAMES); });
+	mixKernelSink = stream.back();
+
+	return result;
+}
+
+volatile long traverseSink;	// Keeps the reads of the traversal
+
+/// Reads every cell of song 0 in order as the pattern editor does.
+void benchmarkTraverse(ModuleResult& result, const io::BinaryContainer& data,
+					   std::shared_ptr<Configuration> config, int repeat)
+{
+	BambooTracker bt(config);
+	bt.loadModule(data);
+
+	size_t nTracks = bt.getSongStyle(0).trackAttribs.size();
+	size_t nOrders = bt.getOrderSize(0);
+	long checksum = 0;
+	result.traverseTime = -1;
+	for (int i = 0; i < repeat; ++i) {
+		size_t steps = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (size_t o = 0; o < nOrders; ++o) {
+			int order = static_cast<int>(o);
+			int size = static_cast<int>(bt.getPatternSizeFromOrderNumber(0, order));
+			for (size_t t = 0; t < nTracks; ++t) {
+				int track = static_cast<int>(t);
+				for (int step = 0; step < size; ++step) {
+					checksum += bt.getStepNoteNumber(0, track, order, step);
+					checksum += bt.getStepInstrument(0, track, order, step);
+					checksum += bt.getStepVolume(0, track, order, step);
+					for (int e = 0; e < Step::N_EFFECT; ++e) {
+						checksum += bt.getStepEffectID(0, track, order, step, e).front();
+						checksum += bt.getStepEffectValue(0, track, order, step, e);
+					}
+				}
+			}
+			steps += static_cast<size_t>(size) * nTracks;
+		}
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if (result.traverseTime < 0 || elapsed < result.traverseTime) result.traverseTime = elapsed;
+		result.steps = steps;
+	}
+	traverseSink = checksum;
+}
+
+/// Plays song 0 through once without generating samples, so that only the tick processing
+/// of the playback is measured. Register writes still reach the chip.
+void benchmarkSequence(ModuleResult& result, const io::BinaryContainer& data,
+					   std::shared_ptr<Configuration> config, int repeat)
+{
+	constexpr size_t MAX_TICKS = 1000000;
+
+	BambooTracker bt(config);
+	bt.loadModule(data);
+	bt.setCurrentSongNumber(0);
+
+	result.sequenceTime = -1;
+	for (int i = 0; i < repeat; ++i) {
+		size_t ticks = 0;
+		int prevOrder = 0;
+		bt.startPlayFromStart();
+		auto begin = std::chrono::steady_clock::now();
+		while (ticks < MAX_TICKS) {
+			int state = bt.streamCountUp();
+			++ticks;
+			if (state < 0) break;
+			if (!state) {	// Stop at the end of the song or at the first jump backward
+				int order = bt.getPlayingOrderNumber();
+				if (order < prevOrder) break;
+				prevOrder = order;
+			}
+		}
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		bt.stopPlaySong();
+		if (result.sequenceTime < 0 || elapsed < result.sequenceTime) result.sequenceTime = elapsed;
+		result.ticks = ticks;
+	}
+}
+
+/// Applies whole pattern edits to song 0 with the default undo memory limit and undoes them.
+void benchmarkEditHistory(ModuleResult& result, const io::BinaryContainer& data,
+						  std::shared_ptr<Configuration> config)
+{
+	constexpr int EDIT_COUNT = 500;
+
+	BambooTracker bt(config);
+	bt.loadModule(data);
+
+	int nTracks = static_cast<int>(bt.getSongStyle(0).trackAttribs.size());
+	int nOrders = static_cast<int>(bt.getOrderSize(0));
+	constexpr int END_COL = Step::N_COLUMN - 1;
+	auto begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < EDIT_COUNT; ++i) {
+		int order = i % nOrders;
+		int endStep = static_cast<int>(bt.getPatternSizeFromOrderNumber(0, order)) - 1;
+		switch (i % 5) {
+		case 0:
+		{
+			PatternCellBlock cells = bt.getPatternCells(
+										 0, 0, 0, order, 0, static_cast<size_t>(nTracks * Step::N_COLUMN),
+										 static_cast<size_t>(endStep + 1));
+			bt.pastePatternCells(0, 0, 0, (order + 1) % nOrders, 0, cells);
+			break;
+		}
+		case 1:	bt.expandPattern(0, 0, 0, order, 0, nTracks - 1, END_COL, endStep);		break;
+		case 2:	bt.shrinkPattern(0, 0, 0, order, 0, nTracks - 1, END_COL, endStep);		break;
+		case 3:	bt.transposeNoteInPattern(0, 0, order, 0, nTracks - 1, endStep, 1);	break;
+		case 4:	bt.reversePattern(0, 0, 0, order, 0, nTracks - 1, END_COL, endStep);	break;
+		}
+	}
+	result.editTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	result.edits = EDIT_COUNT;
+	result.undoCommands = bt.getUndoCount();
+	result.undoBytes = bt.getCommandHistoryMemoryUsage();
+
+	begin = std::chrono::steady_clock::now();
+	while (bt.canUndo()) bt.undo();
+	result.undoTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void render(RenderResult& result, const io::BinaryContainer& data, const BenchOptions& opts,
+			std::shared_ptr<Configuration> config)
+{
+	BambooTracker bt(config);
+	bt.loadModule(data);
+	bt.setCurrentSongNumber(result.song);
+	bt.assignSampleADPCMRawSamples();
+	cli::applyModuleMixer(bt, *config);
+
+	NullWavWriter writer(static_cast<uint32_t>(opts.rate));
+	size_t limit = static_cast<size_t>(opts.timeLimit * opts.rate);
+	auto cancel = [&] {
+		result.truncated = limit && writer.getSampleCount() >= limit;
+		return result.truncated;
+	};
+
+	bt.setStreamProfilingEnabled(true);
+	bt.resetStreamProfile();
+	auto begin = std::chrono::steady_clock::now();
+	bool completed = bt.exportToWav(writer, 1, cancel);	// Play through once as bt-render does
+	result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	result.profile = bt.getStreamProfile();
+	result.samples = writer.getSampleCount();
+
+	if (!completed && !result.truncated) throw std::runtime_error("Failed to render");
+}
+
+/// Writes JSON values. Keys and values are written in the order they are given.
+class JsonWriter
+{
+public:
+	explicit JsonWriter(FILE* fp) : fp_(fp), first_(true), depth_(0) {}
+
+	void beginObject(const char* key = nullptr) { begin(key, '{'); }
+	void endObject() { end('}'); }
+	void beginArray(const char* key = nullptr) { begin(key, '['); }
+	void endArray() { end(']'); }
+
+	void value(const char* key, const std::string& str)
+	{
+		prefix(key);
+		writeString(str);
+	}
+
+	void value(const char* key, const char* str) { value(key, std::string(str)); }
+
+	void value(const char* key, double num)
+	{
+		prefix(key);
+		std::fprintf(fp_, "%.9g", num);
+	}
+
+	void value(const char* key, size_t num)
+	{
+		prefix(key);
+		std::fprintf(fp_, "%zu", num);
+	}
+
+	void value(const char* key, int num)
+	{
+		prefix(key);
+		std::fprintf(fp_, "%d", num);
+	}
+
+	void value(const char* key, bool b)
+	{
+		prefix(key);
+		std::fputs(b ? "true" : "false", fp_);
+	}
+
+	void finish() { std::fputc('\n', fp_); }
+
+private:
+	FILE* fp_;
+	bool first_;
+	int depth_;
+
+	void prefix(const char* key)
+	{
+		if (depth_) {
+			if (!first_) std::fputc(',', fp_);
+			std::fprintf(fp_, "\n%*s", depth_ * 2, "");
+		}
+		first_ = false;
+		if (key) {
+			writeString(key);
+			std::fputs(": ", fp_);
+		}
+	}
+
+	void begin(const char* key, char bracket)
+	{
+		prefix(key);
+		std::fputc(bracket, fp_);
+		first_ = true;
+		++depth_;
+	}
+
+	void end(char bracket)
+	{
+		--depth_;
+		if (!first_) std::fprintf(fp_, "\n%*s", depth_ * 2, "");
+		std::fputc(bracket, fp_);
+		first_ = false;
+	}
+
+	void writeString(const std::string& str)
+	{
+		std::fputc('"', fp_);
+		for (unsigned char c : str) {
+			switch (c) {
+			case '"':	std::fputs("\\\"", fp_);	break;
+			case '\\':	std::fputs("\\\\", fp_);	break;
+			case '\n':	std::fputs("\\n", fp_);		break;
+			case '\t':	std::fputs("\\t", fp_);		break;
+			default:
+				if (c < 0x20) std::fprintf(fp_, "\\u%04x", c);
+				else std::fputc(c, fp_);
+				break;
+			}
+		}
+		std::fputc('"', fp_);
+	}
+};
+
+void writeRender(JsonWriter& json, const RenderResult& r, int rate)
+{
+	json.beginObject();
+	json.value("module", r.path);
+	json.value("song", r.song);
+	json.value("emulator", r.emulator);
+	json.value("resampler", r.resampler);
+	if (!r.error.empty()) {
+		json.value("error", r.error);
+		json.endObject();
+		return;
+	}
+
+	double audio = static_cast<double>(r.samples) / rate;
+	json.value("samples", r.samples);
+	json.value("audio_seconds", audio);
+	json.value("elapsed_seconds", r.elapsed);
+	json.value("samples_per_second", r.samples / r.elapsed);
+	json.value("realtime_factor", audio / r.elapsed);
+	json.value("truncated", r.truncated);
+
+	const chip::MixStageProfile& mix = r.profile.mix;
+	double sequencing = seconds(r.profile.sequencing);
+	double synthesis = seconds(mix.synthesis);
+	double resampling = seconds(mix.resampling);
+	double mixing = seconds(mix.mixing);
+	json.beginObject("stage_seconds");
+	json.value("sequencing", sequencing);
+	json.value("synthesis", synthesis);
+	json.value("resampling", resampling);
+	json.value("mixing", mixing);
+	json.value("other", std::max(0.0, r.elapsed - sequencing - synthesis - resampling - mixing));
+	json.endObject();
+
+	const chip::RegisterWriteStatistics& regs = r.profile.registerWrites;
+	json.beginObject("register_writes");
+	json.value("writes", regs.writes);
+	json.value("write_contentions", regs.writeContentions);
+	json.value("mix_contentions", regs.mixContentions);
+	json.value("overruns", regs.overruns);
+	json.value("peak_queue_size", regs.peakQueueSize);
+	json.endObject();
+
+	json.endObject();
+}
+
+void writeSummary(JsonWriter& json, const std::vector<RenderResult>& renders, const BenchOptions& opts)
+{
+	json.beginArray("summary");
+	for (const Emulator& emu : opts.emulators) {
+		for (const Resampler& rs : opts.resamplers) {
+			size_t samples = 0;
+			double elapsed = 0;
+			for (const RenderResult& r : renders) {
+				if (r.error.empty() && !std::strcmp(r.emulator, emu.name) && !std::strcmp(r.resampler, rs.name)) {
+					samples += r.samples;
+					elapsed += r.elapsed;
+				}
+			}
+			if (!elapsed) continue;
+
+			json.beginObject();
+			json.value("emulator", emu.name);
+			json.value("resampler", rs.name);
+			json.value("samples", samples);
+			json.value("elapsed_seconds", elapsed);
+			json.value("samples_per_second", samples / elapsed);
+			json.value("realtime_factor", static_cast<double>(samples) / opts.rate / elapsed);
+			json.endObject();
+		}
+	}
+	json.endArray();
+}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opts;
+	if (!parseArguments(argc, argv, opts)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (!opts.outPath.empty() && !(out = std::fopen(opts.outPath.c_str(), "w"))) {
+		std::fprintf(stderr, "Failed to open %s\n", opts.outPath.c_str());
+		return 1;
+	}
+
+	ContainerResult container = benchmarkContainer(opts.loadRepeat);
+	MixKernelResult mixKernel = benchmarkMixKernels(opts.loadRepeat);
+
+	int failures = 0;
+	std::vector<ModuleResult> modules;
+	std::vector<RenderResult> renders;
+	for (const std::string& path : cli::collectModules(opts.files, true)) {
+		ModuleResult module;
+		module.path = path;
+		io::BinaryContainer data;
+		try {
+			cli::readFile(path, data);
+			module.fileSize = data.size();
+			benchmarkLoad(module, data, std::make_shared<Configuration>(), opts.loadRepeat);
+			benchmarkFileLoad(module, path, std::make_shared<Configuration>(), opts.loadRepeat);
+			benchmarkTraverse(module, data, std::make_shared<Configuration>(), opts.loadRepeat);
+			auto seqConfig = std::make_shared<Configuration>();
+			seqConfig->setEmulator(static_cast<int>(chip::OpnaEmulator::Mame));	// Cheapest register writes
+			benchmarkSequence(module, data, seqConfig, opts.loadRepeat);
+			benchmarkEditHistory(module, data, std::make_shared<Configuration>());
+		}
+		catch (std::exception& e) {
+			module.error = e.what();
+			std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+			++failures;
+			modules.push_back(std::move(module));
+			continue;
+		}
+
+		int songCnt = !opts.render ? 0 : opts.allSongs ? static_cast<int>(module.songCount) : 1;
+		for (int song = 0; song < songCnt; ++song) {
+			for (const Emulator& emu : opts.emulators) {
+				for (const Resampler& rs : opts.resamplers) {
+					auto config = std::make_shared<Configuration>();
+					config->setEmulator(static_cast<int>(emu.type));
+					config->setYmfmFidelity(emu.fidelity);
+					config->setResamplerType(rs.type);
+
+					RenderResult result;
+					result.path = path;
+					result.song = song;
+					result.emulator = emu.name;
+					result.resampler = rs.name;
+					try {
+						render(result, data, opts, config);
+						std::fprintf(stderr, "%s #%d [%s, %s]: %.1fx real-time\n", path.c_str(), song,
+									 emu.name, rs.name, result.samples / result.elapsed / opts.rate);
+					}
+					catch (std::exception& e) {
+						result.error = e.what();
+						std::fprintf(stderr, "%s #%d [%s, %s]: %s\n", path.c_str(), song,
+									 emu.name, rs.name, e.what());
+						++failures;
+					}
+					renders.push_back(std::move(result));
+				}
+			}
+		}
+		modules.push_back(std::move(module));
+	}
+
+	JsonWriter json(out);
+	json.beginObject();
+	json.value("rate", opts.rate);
+	json.value("time_limit_seconds", opts.timeLimit);
+	json.value("step_bytes", sizeof(Step));
+
+	json.beginObject("binary_container_seconds");
+	json.value("append_uint32", container.appendUint32Time);
+	json.value("read_uint32", container.readUint32Time);
+	json.value("read_uint16", container.readUint16Time);
+	json.value("subcontainer_to_vector", container.subcontainerTime);
+	json.endObject();
+
+	json.beginObject("mix_kernel_ns_per_frame");
+	json.value("simd", mixKernel.simd);
+	json.value("gain", mixKernel.gainNs);
+	json.value("gain_scalar", mixKernel.gainScalarNs);
+	json.value("mix", mixKernel.mixNs);
+	json.value("mix_scalar", mixKernel.mixScalarNs);
+	json.endObject();
+
+	json.beginArray("modules");
+	for (const ModuleResult& module : modules) {
+		json.beginObject();
+		json.value("path", module.path);
+		if (module.error.empty()) {
+			json.value("file_bytes", module.fileSize);
+			json.value("songs", module.songCount);
+			json.value("load_seconds", module.loadTime);
+			json.value("file_load_seconds", module.fileLoadTime);
+			json.value("file_load_mapped_seconds", module.fileLoadMappedTime);
+			json.value("steps", module.steps);
+			json.value("traverse_seconds", module.traverseTime);
+			json.value("ticks", module.ticks);
+			json.value("sequence_seconds", module.sequenceTime);
+			json.value("ticks_per_second", module.ticks / module.sequenceTime);
+			json.beginObject("edit_history");
+			json.value("edits", module.edits);
+			json.value("edit_seconds", module.editTime);
+			json.value("undo_commands", module.undoCommands);
+			json.value("undo_bytes", module.undoBytes);
+			json.value("undo_seconds", module.undoTime);
+			json.endObject();
+		}
+		else {
+			json.value("error", module.error);
+		}
+		json.endObject();
+	}
+	json.endArray();
+
+	json.beginArray("renders");
+	for (const RenderResult& r : renders) writeRender(json, r, opts.rate);
+	json.endArray();
+
+	writeSummary(json, renders, opts);
+
+	if (rt_alloc_check::ENABLED)
+		json.value("audio_path_heap_allocations", rt_alloc_check::getViolationCount());
+
+	json.endObject();
+	json.finish();
+	if (out != stdout) std::fclose(out);
+
+	return failures ? 1 : 0;
+}
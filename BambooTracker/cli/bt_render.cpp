@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// bt-render: renders modules to WAV/VGM/S98 without GUI.
+// Each job owns its own BambooTracker instance (and so its own OPNA, playback manager
+// and tick counter), so songs and modules are rendered in parallel without sharing state.
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bamboo_tracker.hpp"
+#include "configuration.hpp"
+#include "chip/opna.hpp"
+#include "chip/resampler.hpp"
+#include "io/binary_container.hpp"
+#include "io/export_io.hpp"
+#include "io/wav_stream_writer.hpp"
+#include "rt_alloc_check.hpp"
+#include "cli_common.hpp"
+
+namespace
+{
+enum class OutputFormat { WAV, VGM, S98 };
+
+struct RenderOptions
+{
+	OutputFormat format = OutputFormat::WAV;
+	std::string outDir;
+	int song = 0;
+	bool allSongs = false;
+	int loopCount = 1;
+	int rate = 0;	// 0: default of each format
+	int emulator = -1;	// -1: default in configuration
+	int ymfmFidelity = -1;	// -1: default in configuration
+	int resampler = -1;	// -1: default in configuration
+	int jobs = 0;	// 0: number of hardware threads
+	bool quiet = false;
+	std::vector<std::string> files;
+};
+
+struct RenderJob
+{
+	std::string path;
+	std::shared_ptr<const io::BinaryContainer> data;
+	int song = 0;
+	std::string outPath;
+	double audioLength = -1;
+	double elapsed = 0;
+	std::string error;
+};
+
+constexpr int DEFAULT_WAV_RATE = 44100;
+constexpr int DEFAULT_S98_RESOLUTION = 1000;
+
+void printUsage(const char* prog)
+{
+	std::fprintf(stderr,
+				 "Usage: %s [options] <module|dir>...\n"
+				 "A directory renders all modules (*.btm) directly in it.\n"
+				 "Options:\n"
+				 "  -f, --format <wav|vgm|s98>  Output format (default: wav)\n"
+				 "  -o, --output <dir>          Output directory (default: module directory)\n"
+				 "  -s, --song <n>              Song number (default: 0)\n"
+				 "  -a, --all-songs             Render all songs in each module\n"
+				 "  -j, --jobs <n>              Number of parallel jobs (default: number of CPU threads)\n"
+				 "  -l, --loops <n>             Loop count of WAV export (default: 1)\n"
+				 "  -r, --rate <Hz>             WAV sample rate (default: 44100)\n"
+				 "                              or S98 timer resolution (default: 1000)\n"
+				 "  -e, --emulator <name>       mame, nuked, ymfm, ymfm-med or ymfm-min\n"
+				 "  -R, --resampler <name>      linear, blip, fastblip, sinc, fastsinc or bestsinc\n"
+				 "  -q, --quiet                 Suppress progress output\n"
+				 "  -h, --help                  Show this help\n",
+				 prog);
+}
+
+bool parseInt(const char* str, int& value)
+{
+	char* end = nullptr;
+	long v = std::strtol(str, &end, 10);
+	if (end == str || *end != '\0') return false;
+	value = static_cast<int>(v);
+	return true;
+}
+
+bool parseArguments(int argc, char* argv[], RenderOptions& opts)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto hasValue = [&]() { return i + 1 < argc; };
+
+		if (arg == "-h" || arg == "--help") {
+			return false;
+		}
+		else if (arg == "-q" || arg == "--quiet") {
+			opts.quiet = true;
+		}
+		else if ((arg == "-f" || arg == "--format") && hasValue()) {
+			std::string f = argv[++i];
+			if (f == "wav") opts.format = OutputFormat::WAV;
+			else if (f == "vgm") opts.format = OutputFormat::VGM;
+			else if (f == "s98") opts.format = OutputFormat::S98;
+			else return false;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue()) {
+			opts.outDir = argv[++i];
+		}
+		else if ((arg == "-s" || arg == "--song") && hasValue()) {
+			if (!parseInt(argv[++i], opts.song) || opts.song < 0) return false;
+		}
+		else if (arg == "-a" || arg == "--all-songs") {
+			opts.allSongs = true;
+		}
+		else if ((arg == "-j" || arg == "--jobs") && hasValue()) {
+			if (!parseInt(argv[++i], opts.jobs) || opts.jobs <= 0) return false;
+		}
+		else if ((arg == "-l" || arg == "--loops") && hasValue()) {
+			if (!parseInt(argv[++i], opts.loopCount) || opts.loopCount < 0) return false;
+		}
+		else if ((arg == "-r" || arg == "--rate") && hasValue()) {
+			if (!parseInt(argv[++i], opts.rate) || opts.rate <= 0) return false;
+		}
+		else if ((arg == "-e" || arg == "--emulator") && hasValue()) {
+			std::string e = argv[++i];
+			if (e == "mame") opts.emulator = static_cast<int>(chip::OpnaEmulator::Mame);
+			else if (e == "nuked") opts.emulator = static_cast<int>(chip::OpnaEmulator::Nuked);
+			else if (e == "ymfm") opts.emulator = static_cast<int>(chip::OpnaEmulator::Ymfm);
+			else if (e == "ymfm-med") {
+				opts.emulator = static_cast<int>(chip::OpnaEmulator::Ymfm);
+				opts.ymfmFidelity = static_cast<int>(chip::YmfmFidelity::Medium);
+			}
+			else if (e == "ymfm-min") {
+				opts.emulator = static_cast<int>(chip::OpnaEmulator::Ymfm);
+				opts.ymfmFidelity = static_cast<int>(chip::YmfmFidelity::Min);
+			}
+			else return false;
+		}
+		else if ((arg == "-R" || arg == "--resampler") && hasValue()) {
+			std::string r = argv[++i];
+			if (r == "linear") opts.resampler = static_cast<int>(chip::ResamplerType::Linear);
+			else if (r == "blip") opts.resampler = static_cast<int>(chip::ResamplerType::BlipBuf);
+			else if (r == "fastblip") opts.resampler = static_cast<int>(chip::ResamplerType::FastBlipBuf);
+			else if (r == "sinc") opts.resampler = static_cast<int>(chip::ResamplerType::Sinc);
+			else if (r == "fastsinc") opts.resampler = static_cast<int>(chip::ResamplerType::FastSinc);
+			else if (r == "bestsinc") opts.resampler = static_cast<int>(chip::ResamplerType::BestSinc);
+			else return false;
+		}
+		else if (!arg.empty() && arg.front() == '-') {
+			return false;
+		}
+		else {
+			opts.files.push_back(arg);
+		}
+	}
+
+	return !opts.files.empty();
+}
+
+template <class Container>
+void writeFile(const std::string& path, const Container& container)
+{
+	std::ofstream ofs(path, std::ios::binary);
+	if (!ofs) throw std::runtime_error("Failed to open " + path);
+	std::copy(container.begin(), container.end(), std::ostreambuf_iterator<char>(ofs));
+	if (!ofs) throw std::runtime_error("Failed to write " + path);
+}
+
+std::string makeOutputPath(const RenderOptions& opts, const std::string& modPath, int song)
+{
+	size_t sep = modPath.find_last_of("/\\");
+	std::string dir = (sep == std::string::npos) ? "." : modPath.substr(0, sep);
+	std::string base = (sep == std::string::npos) ? modPath : modPath.substr(sep + 1);
+	size_t dot = base.find_last_of('.');
+	if (dot != std::string::npos) base.erase(dot);
+
+	if (!opts.outDir.empty()) dir = opts.outDir;
+	if (song) base += "-" + std::to_string(song);
+
+	switch (opts.format) {
+	default:
+	case OutputFormat::WAV:	return dir + "/" + base + ".wav";
+	case OutputFormat::VGM:	return dir + "/" + base + ".vgm";
+	case OutputFormat::S98:	return dir + "/" + base + ".s98";
+	}
+}
+
+/// Returns the length of rendered audio in seconds, or negative value when it is not an audio output.
+double renderSong(BambooTracker& bt, const RenderOptions& opts, const std::string& outPath)
+{
+	auto cancel = [] { return false; };
+
+	switch (opts.format) {
+	default:
+	case OutputFormat::WAV:
+	{
+		uint32_t rate = static_cast<uint32_t>(opts.rate ? opts.rate : DEFAULT_WAV_RATE);
+		bool isDone = false;
+		size_t nSamples = 0;
+		std::exception_ptr ex;
+		{
+			io::WavFileWriter writer(outPath, rate, 2, 16);
+			if (!writer.isOpen()) throw std::runtime_error("Failed to open " + outPath);
+			try {
+				isDone = bt.exportToWav(writer, opts.loopCount, cancel);
+			}
+			catch (...) {
+				ex = std::current_exception();
+			}
+			nSamples = writer.getSampleCount();
+		}	// Close the file
+
+		// Do not leave a truncated file
+		if (!isDone) {
+			std::remove(outPath.c_str());
+			if (ex) std::rethrow_exception(ex);
+			throw std::runtime_error("Failed to render WAV");
+		}
+		return static_cast<double>(nSamples) / rate;
+	}
+	case OutputFormat::VGM:
+	{
+		io::GD3Tag tag;
+		tag.trackNameEn = bt.getSongTitle(bt.getCurrentSongNumber());
+		tag.authorEn = bt.getModuleAuthor();
+		tag.notes = bt.getModuleComment();
+		io::BinaryContainer container;
+		if (!bt.exportToVgm(container, io::Export_YM2608, true, tag, false, 0, cancel))
+			throw std::runtime_error("Failed to render VGM");
+		writeFile(outPath, container);
+		return -1;
+	}
+	case OutputFormat::S98:
+	{
+		io::S98Tag tag;
+		tag.title = bt.getSongTitle(bt.getCurrentSongNumber());
+		tag.artist = bt.getModuleAuthor();
+		tag.copyright = bt.getModuleCopyright();
+		tag.comment = bt.getModuleComment();
+		int res = opts.rate ? opts.rate : DEFAULT_S98_RESOLUTION;
+		io::BinaryContainer container;
+		if (!bt.exportToS98(container, io::Export_YM2608, true, tag, res, cancel))
+			throw std::runtime_error("Failed to render S98");
+		writeFile(outPath, container);
+		return -1;
+	}
+	}
+}
+
+void render(RenderJob& job, const RenderOptions& opts, std::shared_ptr<Configuration> config)
+{
+	BambooTracker bt(config);
+	bt.loadModule(*job.data);
+	bt.setModulePath(job.path);
+	bt.setCurrentSongNumber(job.song);
+	bt.assignSampleADPCMRawSamples();
+	cli::applyModuleMixer(bt, *config);
+
+	auto begin = std::chrono::steady_clock::now();
+	job.audioLength = renderSong(bt, opts, job.outPath);
+	job.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void printJob(const RenderJob& job)
+{
+	if (!job.error.empty()) {
+		std::fprintf(stderr, "%s: %s\n", job.path.c_str(), job.error.c_str());
+	}
+	else if (job.audioLength >= 0) {
+		std::printf("%s: %.2fs audio in %.3fs (%.1fx real-time)\n", job.outPath.c_str(),
+					job.audioLength, job.elapsed, job.audioLength / job.elapsed);
+	}
+	else {
+		std::printf("%s: rendered in %.3fs\n", job.outPath.c_str(), job.elapsed);
+	}
+}
+}
+
+int main(int argc, char* argv[])
+{
+	RenderOptions opts;
+	if (!parseArguments(argc, argv, opts)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	auto config = std::make_shared<Configuration>();
+	if (opts.emulator != -1) config->setEmulator(opts.emulator);
+	if (opts.ymfmFidelity != -1) config->setYmfmFidelity(static_cast<chip::YmfmFidelity>(opts.ymfmFidelity));
+	if (opts.resampler != -1) config->setResamplerType(static_cast<chip::ResamplerType>(opts.resampler));
+
+	// Read modules and make render jobs
+	int failures = 0;
+	std::vector<RenderJob> jobs;
+	for (const std::string& path : cli::collectModules(opts.files)) {
+		try {
+			auto data = std::make_shared<io::BinaryContainer>();
+			cli::readFile(path, *data);
+
+			int songCnt;
+			{
+				BambooTracker probe(config);
+				probe.loadModule(*data);
+				songCnt = static_cast<int>(probe.getSongCount());
+			}
+
+			auto addJob = [&](int song) {
+				RenderJob job;
+				job.path = path;
+				job.data = data;
+				job.song = song;
+				job.outPath = makeOutputPath(opts, path, song);
+				jobs.push_back(std::move(job));
+			};
+			if (opts.allSongs) {
+				for (int song = 0; song < songCnt; ++song) addJob(song);
+			}
+			else if (opts.song < songCnt) {
+				addJob(opts.song);
+			}
+			else {
+				throw std::out_of_range("Song " + std::to_string(opts.song) + " does not exist");
+			}
+		}
+		catch (std::exception& e) {
+			std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+			++failures;
+		}
+	}
+
+	// Render jobs in parallel
+	size_t nThreads = opts.jobs ? static_cast<size_t>(opts.jobs)
+								: std::max(1u, std::thread::hardware_concurrency());
+	nThreads = std::min(nThreads, jobs.size());
+
+	std::atomic<size_t> next(0);
+	std::mutex printMutex;
+	auto worker = [&] {
+		for (size_t i; (i = next++) < jobs.size();) {
+			RenderJob& job = jobs[i];
+			try {
+				render(job, opts, config);
+			}
+			catch (std::exception& e) {
+				job.error = e.what();
+			}
+
+			if (!opts.quiet || !job.error.empty()) {
+				std::lock_guard<std::mutex> lock(printMutex);
+				printJob(job);
+			}
+		}
+	};
+
+	auto begin = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < nThreads; ++i) threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads) thread.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	double totalAudio = 0;
+	for (const RenderJob& job : jobs) {
+		if (!job.error.empty()) ++failures;
+		else if (job.audioLength > 0) totalAudio += job.audioLength;
+	}
+
+	if (!opts.quiet && totalAudio > 0) {
+		std::printf("Total: %.2fs audio in %.3fs on %zu thread(s) (%.1fx real-time)\n",
+					totalAudio, elapsed.count(), std::max<size_t>(nThreads, 1),
+					totalAudio / elapsed.count());
+	}
+
+	if (rt_alloc_check::ENABLED) {
+		size_t nHeapCalls = rt_alloc_check::getViolationCount();
+		std::printf("Heap allocations on the audio path: %zu\n", nHeapCalls);
+		if (nHeapCalls) return 1;
+	}
+
+	return failures ? 1 : 0;
+}
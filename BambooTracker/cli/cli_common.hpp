@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Helpers shared by the command-line tools.
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bamboo_tracker.hpp"
+#include "configuration.hpp"
+#include "io/binary_container.hpp"
+
+namespace cli
+{
+/// Expands directories to the module files they contain.
+inline std::vector<std::string> collectModules(const std::vector<std::string>& paths, bool recursive = false)
+{
+	namespace fs = std::filesystem;
+
+	std::vector<std::string> modules;
+	for (const std::string& path : paths) {
+		if (!fs::is_directory(path)) {
+			modules.push_back(path);
+			continue;
+		}
+
+		std::vector<std::string> entries;
+		auto add = [&](const fs::directory_entry& entry) {
+			if (entry.is_regular_file() && entry.path().extension() == ".btm")
+				entries.push_back(entry.path().string());
+		};
+		if (recursive) std::for_each(fs::recursive_directory_iterator(path), fs::recursive_directory_iterator(), add);
+		else std::for_each(fs::directory_iterator(path), fs::directory_iterator(), add);
+		std::sort(entries.begin(), entries.end());
+		modules.insert(modules.end(), entries.begin(), entries.end());
+	}
+	return modules;
+}
+
+/// Reads the whole file into the container.
+inline void readFile(const std::string& path, io::BinaryContainer& container)
+{
+	std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+	if (!ifs) throw std::runtime_error("Failed to open " + path);
+	std::vector<uint8_t> buf(static_cast<size_t>(ifs.tellg()));
+	ifs.seekg(0);
+	if (!ifs.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size())))
+		throw std::runtime_error("Failed to read " + path);
+	container = io::BinaryContainer(std::move(buf));
+}
+
+// Same presets as the mixer settings in the application
+inline void applyModuleMixer(BambooTracker& bt, const Configuration& config)
+{
+	switch (bt.getModuleMixerType()) {
+	case MixerType::UNSPECIFIED:
+		bt.setMasterVolumeFM(config.getMixerVolumeFM());
+		bt.setMasterVolumeSSG(config.getMixerVolumeSSG());
+		break;
+	case MixerType::CUSTOM:
+		bt.setMasterVolumeFM(bt.getModuleCustomMixerFMLevel());
+		bt.setMasterVolumeSSG(bt.getModuleCustomMixerSSGLevel());
+		break;
+	case MixerType::PC_9821_PC_9801_86:
+		bt.setMasterVolumeFM(0);
+		bt.setMasterVolumeSSG(-5.5);
+		break;
+	case MixerType::PC_9821_SPEAK_BOARD:
+		bt.setMasterVolumeFM(0);
+		bt.setMasterVolumeSSG(-3.0);
+		break;
+	case MixerType::PC_8801_VA2:
+		bt.setMasterVolumeFM(0);
+		bt.setMasterVolumeSSG(1.5);
+		break;
+	case MixerType::PC_8801_MKII_SR:
+		bt.setMasterVolumeFM(0);
+		bt.setMasterVolumeSSG(2.5);
+		break;
+	}
+}
+}
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "command_id.hpp"
 
 class AbstractCommand
@@ -40,6 +41,8 @@ public:
 		(void)other;
 		return false;
 	}
+	/// Bytes of module data copied by the command to undo or redo it.
+	virtual size_t getFootprint() const { return 0; }
 
 private:
 	const CommandId id_;
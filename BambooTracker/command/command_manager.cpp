@@ -24,38 +24,119 @@
  */
 
 #include "command_manager.hpp"
+#include <algorithm>
 #include <utility>
 
-void CommandManager::invoke(CommandIPtr command)
+namespace
+{
+// Object and allocation overhead of a command besides its footprint
+constexpr size_t COMMAND_OVERHEAD = 64;
+
+/// Scope covering both commands of a merge, which are edits of the same place.
+CommandScope uniteScopes(const CommandScope& a, const CommandScope& b)
+{
+	if (a.song != b.song) return a.song < 0 ? b : a;
+	CommandScope scope(a.song, std::min(a.order, b.order));
+	if (a.beginTrack >= 0 && b.beginTrack >= 0) {
+		scope.beginTrack = std::min(a.beginTrack, b.beginTrack);
+		scope.endTrack = std::max(a.endTrack, b.endTrack);
+	}
+	return scope;
+}
+}
+
+CommandManager::CommandManager()
+	: usage_(0),
+	  limit_(0)
+{
+}
+
+void CommandManager::invoke(CommandIPtr command, const CommandScope& scope)
 {
 	command->redo();
+	notifySongEdit(scope);
 
-	redoStack_ = std::stack<CommandIPtr>();
-	if (undoStack_.empty() || !undoStack_.top()->mergeWith(command.get())) {
-		undoStack_.push(std::move(command));
+	clearRedoStack();
+	if (!undoStack_.empty()) {
+		Entry& top = undoStack_.back();
+		if (top.command->mergeWith(command.get())) {
+			top.scope = uniteScopes(top.scope, scope);
+			usage_ -= top.footprint;
+			top.footprint = COMMAND_OVERHEAD + top.command->getFootprint();
+			usage_ += top.footprint;
+			discardOldCommands();
+			return;
+		}
 	}
+	undoStack_.push_back(makeEntry(std::move(command), scope));
+	discardOldCommands();
 }
 
 void CommandManager::undo()
 {
 	if (undoStack_.empty()) return;
-	CommandIPtr command = std::move(undoStack_.top());
-	command->undo();
-	undoStack_.pop();
-	redoStack_.push(std::move(command));
+	Entry entry = std::move(undoStack_.back());
+	undoStack_.pop_back();
+	entry.command->undo();
+	notifySongEdit(entry.scope);
+	usage_ -= entry.footprint;
+	redoStack_.push(makeEntry(std::move(entry.command), entry.scope));
 }
 
 void CommandManager::redo()
 {
 	if (redoStack_.empty()) return;
-	CommandIPtr command = std::move(redoStack_.top());
-	command->redo();
+	Entry entry = std::move(redoStack_.top());
 	redoStack_.pop();
-	undoStack_.push(std::move(command));
+	entry.command->redo();
+	notifySongEdit(entry.scope);
+	usage_ -= entry.footprint;
+	undoStack_.push_back(makeEntry(std::move(entry.command), entry.scope));
 }
 
 void CommandManager::clear()
 {
-	redoStack_ = std::stack<CommandIPtr>();
-	undoStack_ = std::stack<CommandIPtr>();
+	redoStack_ = std::stack<Entry>();
+	undoStack_.clear();
+	usage_ = 0;
+}
+
+void CommandManager::setMemoryLimit(size_t bytes)
+{
+	limit_ = bytes;
+	discardOldCommands();
+}
+
+void CommandManager::setSongEditHandler(std::function<void(const CommandScope&)> handler)
+{
+	songEditHandler_ = std::move(handler);
+}
+
+CommandManager::Entry CommandManager::makeEntry(CommandIPtr command, const CommandScope& scope)
+{
+	size_t footprint = COMMAND_OVERHEAD + command->getFootprint();
+	usage_ += footprint;
+	return { std::move(command), scope, footprint };
+}
+
+void CommandManager::notifySongEdit(const CommandScope& scope) const
+{
+	if (scope.song >= 0 && songEditHandler_) songEditHandler_(scope);
+}
+
+void CommandManager::clearRedoStack()
+{
+	while (!redoStack_.empty()) {
+		usage_ -= redoStack_.top().footprint;
+		redoStack_.pop();
+	}
+}
+
+void CommandManager::discardOldCommands()
+{
+	if (!limit_) return;
+	while (usage_ > limit_ && undoStack_.size() > 1) {
+		usage_ -= undoStack_.front().footprint;
+		undoStack_.pop_front();
+	}
 }
@@ -25,20 +25,66 @@
 
 #pragma once
 
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <stack>
 #include <memory>
 #include "abstract_command.hpp"
 
+/// Part of a song changed by a command.
+struct CommandScope
+{
+	int song;	///< -1 when the command changes no song
+	int order;	///< First changed order
+	int beginTrack, endTrack;	///< Tracks of the changed patterns, -1 when orders are changed
+
+	CommandScope() : song(-1), order(0), beginTrack(-1), endTrack(-1) {}
+	explicit CommandScope(int songNum, int orderNum = 0)
+		: song(songNum), order(orderNum), beginTrack(-1), endTrack(-1) {}
+	CommandScope(int songNum, int beginTrackNum, int endTrackNum, int orderNum)
+		: song(songNum), order(orderNum), beginTrack(beginTrackNum), endTrack(endTrackNum) {}
+};
+
 class CommandManager
 {
 public:
 	using CommandIPtr = std::unique_ptr<AbstractCommand>;
 
-	void invoke(CommandIPtr command);
+	CommandManager();
+	void invoke(CommandIPtr command, const CommandScope& scope = CommandScope());
 	void undo();
 	void redo();
 	void clear();
 
+	bool canUndo() const noexcept { return !undoStack_.empty(); }
+	size_t getUndoCount() const noexcept { return undoStack_.size(); }
+
+	/// Bytes of the undo and redo history.
+	size_t getMemoryUsage() const noexcept { return usage_; }
+	/// Oldest commands are discarded while the history exceeds the limit.
+	/// The latest command is always kept. 0 means no limit.
+	void setMemoryLimit(size_t bytes);
+
+	/// Called with the scope of a command after it is invoked, undone or redone,
+	/// so that caches built from the song can be discarded.
+	void setSongEditHandler(std::function<void(const CommandScope&)> handler);
+
 private:
-	std::stack<CommandIPtr> undoStack_, redoStack_;
+	struct Entry
+	{
+		CommandIPtr command;
+		CommandScope scope;
+		size_t footprint;
+	};
+
+	std::deque<Entry> undoStack_;	// Back is the latest
+	std::stack<Entry> redoStack_;
+	size_t usage_, limit_;
+	std::function<void(const CommandScope&)> songEditHandler_;
+
+	Entry makeEntry(CommandIPtr command, const CommandScope& scope);
+	void notifySongEdit(const CommandScope& scope) const;
+	void clearRedoStack();
+	void discardOldCommands();
 };
@@ -55,3 +55,8 @@ void AddInstrumentCommand::undo()
 {
 	manager_.lock()->removeInstrument(num_);
 }
+
+size_t AddInstrumentCommand::getFootprint() const
+{
+	return name_.capacity() + (inst_ ? inst_->getFootprint() : 0);
+}
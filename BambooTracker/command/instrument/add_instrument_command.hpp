@@ -40,6 +40,7 @@ public:
 						 std::unique_ptr<AbstractInstrument> inst);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<InstrumentsManager> manager_;
@@ -44,3 +44,8 @@ void ChangeInstrumentNameCommand::undo()
 {
 	manager_.lock()->setInstrumentName(instNum_, oldName_);
 }
+
+size_t ChangeInstrumentNameCommand::getFootprint() const
+{
+	return oldName_.capacity() + newName_.capacity();
+}
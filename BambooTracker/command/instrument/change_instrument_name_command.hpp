@@ -37,6 +37,7 @@ public:
 								int num, const std::string& name);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<InstrumentsManager> manager_;
@@ -41,3 +41,8 @@ void RemoveInstrumentCommand::undo()
 {
 	manager_.lock()->addInstrument(inst_.release());
 }
+
+size_t RemoveInstrumentCommand::getFootprint() const
+{
+	return inst_ ? inst_->getFootprint() : 0;
+}
@@ -36,6 +36,7 @@ public:
 	RemoveInstrumentCommand(std::weak_ptr<InstrumentsManager> manager, int number);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<InstrumentsManager> manager_;
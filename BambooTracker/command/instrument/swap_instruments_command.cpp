@@ -59,6 +59,7 @@ void SwapInstrumentsCommand::swapInstrumentsInPatterns()
 		Track& track = song.getTrack(attrib.number);
 		for (int i = 0; i < 256; ++i) {	// Used track size
 			Pattern& pat = track.getPattern(i);
+			if (!pat.hasEvent()) continue;
 			for (size_t j = 0; j < pat.getSize(); ++j) {
 				Step& step = pat.getStep(static_cast<int>(j));
 				if (step.getInstrumentNumber() == inst1Num_) step.setInstrumentNumber(inst2Num_);
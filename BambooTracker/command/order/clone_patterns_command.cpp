@@ -69,3 +69,10 @@ void ClonePatternsCommand::undo()
 		}
 	}
 }
+
+size_t ClonePatternsCommand::getFootprint() const
+{
+	size_t size = 0;
+	for (const auto& odrs : prevOdrs_) size += odrs.capacity() * sizeof(OrderInfo);
+	return size;
+}
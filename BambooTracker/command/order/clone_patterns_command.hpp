@@ -37,6 +37,7 @@ public:
 						 int beginOrder, int beginTrack, int endOrder, int endTrack);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<Module> mod_;
@@ -67,3 +67,11 @@ void PasteCopiedDataToOrderCommand::setCells(const std::vector<std::vector<std::
 		}
 	}
 }
+
+size_t PasteCopiedDataToOrderCommand::getFootprint() const
+{
+	size_t size = 0;
+	for (const auto& row : cells_) size += row.capacity() * sizeof(std::string);
+	for (const auto& row : prevCells_) size += row.capacity() * sizeof(std::string);
+	return size;
+}
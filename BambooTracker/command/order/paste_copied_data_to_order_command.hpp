@@ -39,6 +39,7 @@ public:
 			const std::vector<std::vector<std::string>>& cells);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<Module> mod_;
@@ -151,3 +151,10 @@ void ChangeValuesInPatternCommand::undo()
 		}
 	}
 }
+
+size_t ChangeValuesInPatternCommand::getFootprint() const
+{
+	size_t size = 0;
+	for (const auto& vals : prevVals_) size += vals.capacity() * sizeof(int);
+	return size;
+}
@@ -48,24 +48,12 @@ void EraseCellsInPatternCommand::redo()
 	auto& sng = mod_.lock()->getSong(song_);
 
 	int s = bStep_;
-	for (size_t i = 0; i < prevCells_.size(); ++i) {
+	for (size_t i = 0; i < prevCells_.height(); ++i) {
 		int t = bTrack_;
 		int c = bCol_;
-		for (size_t j = 0; j < prevCells_.at(i).size(); ++j) {
+		for (size_t j = 0; j < prevCells_.width(); ++j) {
 			Step& st = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:		st.clearNoteNumber();		break;
-			case 1:		st.clearInstrumentNumber();	break;
-			case 2:		st.clearVolume();			break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) st.clearEffectValue(ei);
-				else st.clearEffectId(ei);
-				break;
-			}
-			}
+			PatternCellBlock::writeCell(st, c, PatternCellBlock::EMPTY_CELL);
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -79,3 +67,8 @@ void EraseCellsInPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, bTrack_, bCol_, order_, bStep_);
 }
+
+size_t EraseCellsInPatternCommand::getFootprint() const
+{
+	return prevCells_.getFootprint();
+}
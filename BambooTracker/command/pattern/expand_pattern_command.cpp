@@ -46,47 +46,16 @@ ExpandPatternCommand::ExpandPatternCommand(
 void ExpandPatternCommand::redo()
 {
 	auto& sng = mod_.lock()->getSong(song_);
+	const PatternCellBlock prevCells = prevCells_.unpack();
 
 	int s = bStep_;
-	for (size_t i = 0; i < prevCells_.size(); ++i) {
+	for (size_t i = 0; i < prevCells_.height(); ++i) {
 		int t = bTrack_;
 		int c = bCol_;
-		for (size_t j = 0; j < prevCells_.at(i).size(); ++j) {
+		for (size_t j = 0; j < prevCells_.width(); ++j) {
 			Step& st = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:
-			{
-				if (i % 2) st.clearNoteNumber();
-				else st.setNoteNumber(std::stoi(prevCells_.at(i / 2).at(j)));
-				break;
-			}
-			case 1:
-			{
-				if (i % 2) st.clearInstrumentNumber();
-				else st.setInstrumentNumber(std::stoi(prevCells_.at(i / 2).at(j)));
-				break;
-			}
-			case 2:
-			{
-				if (i % 2) st.clearVolume();
-				else st.setVolume(std::stoi(prevCells_.at(i / 2).at(j)));
-				break;
-			}
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) {
-					if (i % 2) st.clearEffectValue(ei);
-					else st.setEffectValue(ei, std::stoi(prevCells_.at(i / 2).at(j)));
-				}
-				else {
-					if (i % 2) st.clearEffectId(ei);
-					else st.setEffectId(ei, prevCells_.at(i / 2).at(j));
-				}
-				break;
-			}
-			}
+			if (i % 2) PatternCellBlock::writeCell(st, c, PatternCellBlock::EMPTY_CELL);
+			else PatternCellBlock::writeCell(st, c, prevCells.at(i / 2, j));
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -100,3 +69,8 @@ void ExpandPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, bTrack_, bCol_, order_, bStep_);
 }
+
+size_t ExpandPatternCommand::getFootprint() const
+{
+	return prevCells_.getFootprint();
+}
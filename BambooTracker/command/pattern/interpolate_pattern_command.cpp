@@ -55,14 +55,14 @@ InterpolatePatternCommand::InterpolatePatternCommand(
 void InterpolatePatternCommand::redo()
 {
 	auto& sng = mod_.lock()->getSong(song_);
-	int div = static_cast<int>(prevCells_.size()) - 1;
+	int div = static_cast<int>(prevCells_.height()) - 1;
 	if (!div) div = 1;
 
 	int t = bTrack_;
 	int c = bCol_;
-	for (size_t i = 0; i < prevCells_.front().size(); ++i) {
+	for (size_t i = 0; i < prevCells_.width(); ++i) {
 		int s = bStep_;
-		for (size_t j = 0; j < prevCells_.size(); ++j) {
+		for (size_t j = 0; j < prevCells_.height(); ++j) {
 			Pattern& pattern = command_utils::getPattern(sng, t, order_);
 			Step& sa = pattern.getStep(bStep_);
 			Step& sb = pattern.getStep(eStep_);
@@ -116,3 +116,8 @@ void InterpolatePatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, bTrack_, bCol_, order_, bStep_);
 }
+
+size_t InterpolatePatternCommand::getFootprint() const
+{
+	return prevCells_.getFootprint();
+}
@@ -26,10 +26,9 @@
 #pragma once
 
 #include <memory>
-#include <vector>
-#include <string>
 #include "../abstract_command.hpp"
 #include "module.hpp"
+#include "pattern_cell_block.hpp"
 
 class InterpolatePatternCommand final : public AbstractCommand
 {
@@ -39,10 +38,11 @@ public:
 							  int endTrack, int endColumn, int endStep);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<Module> mod_;
 	int song_, bTrack_, bCol_, order_, bStep_;
 	int eStep_;
-	std::vector<std::vector<std::string>> prevCells_;
+	PackedPatternCellBlock prevCells_;
 };
@@ -28,7 +28,7 @@
 
 PasteCopiedDataToPatternCommand::PasteCopiedDataToPatternCommand(
 		std::weak_ptr<Module> mod, int songNum, int beginTrack, int beginColmn,
-		int beginOrder, int beginStep, const std::vector<std::vector<std::string>>& cells)
+		int beginOrder, int beginStep, const PatternCellBlock& cells)
 	: AbstractCommand(CommandId::PasteCopiedDataToPattern),
 	  mod_(mod),
 	  song_(songNum),
@@ -39,7 +39,7 @@ PasteCopiedDataToPatternCommand::PasteCopiedDataToPatternCommand(
 	  cells_(cells)
 {
 	auto& song = mod.lock()->getSong(songNum);
-	prevCells_ = command_utils::getPreviousCells(song, cells.front().size(), cells.size(),
+	prevCells_ = command_utils::getPreviousCells(song, cells.width(), cells.height(),
 												 beginTrack, beginColmn, beginOrder, beginStep);
 }
 
@@ -52,3 +52,8 @@ void PasteCopiedDataToPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, track_, col_, order_, step_);
 }
+
+size_t PasteCopiedDataToPatternCommand::getFootprint() const
+{
+	return cells_.getFootprint() + prevCells_.getFootprint();
+}
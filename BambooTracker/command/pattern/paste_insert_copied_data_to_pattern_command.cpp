@@ -24,28 +24,30 @@
  */
 
 #include "paste_insert_copied_data_to_pattern_command.hpp"
-#include <algorithm>
-#include <iterator>
 #include "pattern_command_utils.hpp"
 
 PasteInsertCopiedDataToPatternCommand::PasteInsertCopiedDataToPatternCommand(
 		std::weak_ptr<Module> mod, int songNum, int beginTrack, int beginColumn,
-		int beginOrder, int beginStep, const std::vector<std::vector<std::string>>& cells)
+		int beginOrder, int beginStep, const PatternCellBlock& cells)
 	: AbstractCommand(CommandId::PasteInsertCopiedDataToPattern),
 	  mod_(mod),
 	  song_(songNum),
 	  track_(beginTrack),
 	  col_(beginColumn),
 	  order_(beginOrder),
-	  step_(beginStep),
-	  cells_(cells)
+	  step_(beginStep)
 {
 	auto& song = mod.lock()->getSong(songNum);
 	size_t newStepSize = song.getTrack(track_).getPatternFromOrderNumber(order_).getSize() - step_;
-	prevCells_ = command_utils::getPreviousCells(song, cells.front().size(), newStepSize,
+	prevCells_ = command_utils::getPreviousCells(song, cells.width(), newStepSize,
 												 beginTrack, beginColumn, beginOrder, beginStep);
-	if (cells.size() < newStepSize) {
-		std::copy(prevCells_.begin(), prevCells_.end() - cells.size(), std::back_inserter(cells_));
+	if (cells.height() < newStepSize) {
+		PatternCellBlock newCells = cells;
+		newCells.appendRows(prevCells_.unpack(), newStepSize - cells.height());
+		cells_ = PackedPatternCellBlock(newCells);
+	}
+	else {
+		cells_ = PackedPatternCellBlock(cells);
 	}
 }
 
@@ -58,3 +60,8 @@ void PasteInsertCopiedDataToPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, track_, col_, order_, step_);
 }
+
+size_t PasteInsertCopiedDataToPatternCommand::getFootprint() const
+{
+	return cells_.getFootprint() + prevCells_.getFootprint();
+}
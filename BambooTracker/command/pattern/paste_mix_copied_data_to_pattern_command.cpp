@@ -28,7 +28,7 @@
 
 PasteMixCopiedDataToPatternCommand::PasteMixCopiedDataToPatternCommand(
 		std::weak_ptr<Module> mod, int songNum, int beginTrack, int beginColumn,
-		int beginOrder, int beginStep, const std::vector<std::vector<std::string>>& cells)
+		int beginOrder, int beginStep, const PatternCellBlock& cells)
 	: AbstractCommand(CommandId::PasteMixCopiedDataToPattern),
 	  mod_(mod),
 	  song_(songNum),
@@ -39,52 +39,25 @@ PasteMixCopiedDataToPatternCommand::PasteMixCopiedDataToPatternCommand(
 	  cells_(cells)
 {
 	auto& song = mod.lock()->getSong(songNum);
-	prevCells_ = command_utils::getPreviousCells(song, cells.front().size(), cells.size(),
+	prevCells_ = command_utils::getPreviousCells(song, cells.width(), cells.height(),
 												 beginTrack, beginColumn, beginOrder, beginStep);
 }
 
 void PasteMixCopiedDataToPatternCommand::redo()
 {
 	auto& sng = mod_.lock()->getSong(song_);
+	const PatternCellBlock cells = cells_.unpack();
 
 	int s = step_;
-	for (const auto& row : cells_) {
+	for (size_t i = 0; i < cells.height(); ++i) {
 		int t = track_;
 		int c = col_;
-		for (const std::string& cell : row) {
+		for (size_t j = 0; j < cells.width(); ++j) {
 			Step& step = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:
-			{
-				int n = std::stoi(cell);
-				if (!Step::testEmptyNote(n) && step.isEmptyNote()) step.setNoteNumber(n);
-				break;
-			}
-			case 1:
-			{
-				int n = std::stoi(cell);
-				if (!Step::testEmptyInstrument(n) && !step.hasInstrument()) step.setInstrumentNumber(n);
-				break;
-			}
-			case 2:
-			{
-				int vol = std::stoi(cell);
-				if (!Step::testEmptyVolume(vol) && !step.hasVolume()) step.setVolume(vol);
-				break;
-			}
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) {	// Value
-					int val = std::stoi(cell);
-					if (!Step::testEmptyEffectValue(val) && !step.hasEffectValue(ei)) step.setEffectValue(ei, val);
-				}
-				else {	// ID
-					if (!Step::testEmptyEffectId(cell) && !step.hasEffectId(ei)) step.setEffectId(ei, cell);
-				}
-				break;
-			}
+			const PatternCell& cell = cells.at(i, j);
+			if (!PatternCellBlock::isEmptyCell(cell, c)
+					&& PatternCellBlock::isEmptyCell(PatternCellBlock::readCell(step, c), c)) {
+				PatternCellBlock::writeCell(step, c, cell);
 			}
 
 			++c;
@@ -100,3 +73,8 @@ void PasteMixCopiedDataToPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, track_, col_, order_, step_);
 }
+
+size_t PasteMixCopiedDataToPatternCommand::getFootprint() const
+{
+	return cells_.getFootprint() + prevCells_.getFootprint();
+}
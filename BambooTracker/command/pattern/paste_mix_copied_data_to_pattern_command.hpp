@@ -26,22 +26,22 @@
 #pragma once
 
 #include <memory>
-#include <vector>
-#include <string>
 #include "../abstract_command.hpp"
 #include "module.hpp"
+#include "pattern_cell_block.hpp"
 
 class PasteMixCopiedDataToPatternCommand final : public AbstractCommand
 {
 public:
 	PasteMixCopiedDataToPatternCommand(
 			std::weak_ptr<Module> mod, int songNum, int beginTrack, int beginColumn,
-			int beginOrder, int beginStep, const std::vector<std::vector<std::string>>& cells);
+			int beginOrder, int beginStep, const PatternCellBlock& cells);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<Module> mod_;
 	int song_, track_, col_, order_, step_;
-	std::vector<std::vector<std::string>> cells_, prevCells_;
+	PackedPatternCellBlock cells_, prevCells_;
 };
@@ -48,71 +48,36 @@ size_t calculateColumnSize(int beginTrack, int beginColumn, int endTrack, int en
 	return static_cast<size_t>(w);
 }
 
-std::vector<std::vector<std::string>> getPreviousCells(Song& song, size_t w, size_t h, int beginTrack,
-													   int beginColumn, int beginOrder, int beginStep)
+PackedPatternCellBlock getPreviousCells(Song& song, size_t w, size_t h, int beginTrack,
+										int beginColumn, int beginOrder, int beginStep)
 {
-	std::vector<std::vector<std::string>> cells(h);
+	PatternCellBlock cells(w, h);
 	int s = beginStep;
 	for (size_t i = 0; i < h; ++i) {
 		int t = beginTrack;
 		int c = beginColumn;
-		cells[i].resize(w);
 		for (size_t j = 0; j < w; ++j) {
-			Step& st = song.getTrack(t).getPatternFromOrderNumber(beginOrder).getStep(s);
-			std::string val;
-			switch (c) {
-			case 0:		val = std::to_string(st.getNoteNumber());		break;
-			case 1:		val = std::to_string(st.getInstrumentNumber());	break;
-			case 2:		val = std::to_string(st.getVolume());			break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) {	// Value
-					val = std::to_string(st.getEffectValue(ei));
-				}
-				else {	// ID
-					val = st.getEffectId(ei);
-				}
-				break;
-			}
-			}
-			cells[i][j] = val;
+			const Step& st = song.getTrack(t).getPatternFromOrderNumber(beginOrder).getStep(s);
+			cells.at(i, j) = PatternCellBlock::readCell(st, c);
 
 			t += (++c / Step::N_COLUMN);
-			c %= 11;
+			c %= Step::N_COLUMN;
 		}
 		++s;
 	}
-	return cells;
+	return PackedPatternCellBlock(cells);
 }
 
-void restorePattern(Song& song, const std::vector<std::vector<std::string>>& cells, int beginTrack,
+void restorePattern(Song& song, const PatternCellBlock& cells, int beginTrack,
 					int beginColumn, int beginOrder, int beginStep)
 {
 	int s = beginStep;
-	for (const auto& row : cells) {
+	for (size_t i = 0; i < cells.height(); ++i) {
 		int t = beginTrack;
 		int c = beginColumn;
-		for (const std::string& cell : row) {
+		for (size_t j = 0; j < cells.width(); ++j) {
 			Step& st = song.getTrack(t).getPatternFromOrderNumber(beginOrder).getStep(s);
-			switch (c) {
-			case 0:		st.setNoteNumber(std::stoi(cell));			break;
-			case 1:		st.setInstrumentNumber(std::stoi(cell));	break;
-			case 2:		st.setVolume(std::stoi(cell));				break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) {	// Value
-					st.setEffectValue(ei, std::stoi(cell));
-				}
-				else {	// ID
-					st.setEffectId(ei, cell);
-				}
-				break;
-			}
-			}
+			PatternCellBlock::writeCell(st, c, cells.at(i, j));
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -25,10 +25,9 @@
 
 #pragma once
 
-#include <vector>
-#include <string>
 #include <memory>
 #include "module.hpp"
+#include "pattern_cell_block.hpp"
 
 namespace command_utils
 {
@@ -55,9 +54,15 @@ inline Pattern& getPattern(Song& song, int track, int order)
 
 size_t calculateColumnSize(int beginTrack, int beginColumn, int endTrack, int endColumn);
 
-std::vector<std::vector<std::string>> getPreviousCells(Song& song, size_t w, size_t h, int beginTrack,
-													   int beginColumn, int beginOrder, int beginStep);
+PackedPatternCellBlock getPreviousCells(Song& song, size_t w, size_t h, int beginTrack,
+										int beginColumn, int beginOrder, int beginStep);
 
-void restorePattern(Song& song, const std::vector<std::vector<std::string>>& cells, int beginTrack,
+void restorePattern(Song& song, const PatternCellBlock& cells, int beginTrack,
 					int beginColumn, int beginOrder, int beginStep);
+
+inline void restorePattern(Song& song, const PackedPatternCellBlock& cells, int beginTrack,
+						   int beginColumn, int beginOrder, int beginStep)
+{
+	restorePattern(song, cells.unpack(), beginTrack, beginColumn, beginOrder, beginStep);
+}
 }
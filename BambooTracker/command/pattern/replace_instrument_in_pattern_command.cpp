@@ -73,3 +73,8 @@ void ReplaceInstrumentInPatternCommand::undo()
 		}
 	}
 }
+
+size_t ReplaceInstrumentInPatternCommand::getFootprint() const
+{
+	return prevInsts_.capacity() * sizeof(int);
+}
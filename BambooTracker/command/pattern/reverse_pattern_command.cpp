@@ -46,27 +46,16 @@ ReversePatternCommand::ReversePatternCommand(
 void ReversePatternCommand::redo()
 {
 	auto& sng = mod_.lock()->getSong(song_);
+	const PatternCellBlock prevCells = prevCells_.unpack();
 
-	size_t l = prevCells_.size() - 1;
+	size_t l = prevCells_.height() - 1;
 	int s = bStep_;
-	for (size_t i = 0; i < prevCells_.size(); ++i) {
+	for (size_t i = 0; i < prevCells_.height(); ++i) {
 		int t = bTrack_;
 		int c = bCol_;
-		for (size_t j = 0; j < prevCells_.at(i).size(); ++j) {
+		for (size_t j = 0; j < prevCells_.width(); ++j) {
 			Step& st = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:		st.setNoteNumber(std::stoi(prevCells_.at(l - i).at(j)));		break;
-			case 1:		st.setInstrumentNumber(std::stoi(prevCells_.at(l - i).at(j)));	break;
-			case 2:		st.setVolume(std::stoi(prevCells_.at(l - i).at(j)));			break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) st.setEffectValue(ei, std::stoi(prevCells_.at(l - i).at(j)));
-				else st.setEffectId(ei, prevCells_.at(l - i).at(j));
-				break;
-			}
-			}
+			PatternCellBlock::writeCell(st, c, prevCells.at(l - i, j));
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -80,3 +69,8 @@ void ReversePatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, bTrack_, bCol_, order_, bStep_);
 }
+
+size_t ReversePatternCommand::getFootprint() const
+{
+	return prevCells_.getFootprint();
+}
@@ -47,26 +47,15 @@ ShrinkPatternCommand::ShrinkPatternCommand(
 void ShrinkPatternCommand::redo()
 {
 	auto& sng = mod_.lock()->getSong(song_);
+	const PatternCellBlock prevCells = prevCells_.unpack();
 
 	int s = bStep_;
-	for (size_t i = 0; i < prevCells_.size(); i += 2) {
+	for (size_t i = 0; i < prevCells_.height(); i += 2) {
 		int t = bTrack_;
 		int c = bCol_;
-		for (size_t j = 0; j < prevCells_.at(i).size(); ++j) {
+		for (size_t j = 0; j < prevCells_.width(); ++j) {
 			Step& st = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:		st.setNoteNumber(std::stoi(prevCells_.at(i).at(j)));		break;
-			case 1:		st.setInstrumentNumber(std::stoi(prevCells_.at(i).at(j)));	break;
-			case 2:		st.setVolume(std::stoi(prevCells_.at(i).at(j)));			break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) st.setEffectValue(ei, std::stoi(prevCells_.at(i).at(j)));
-				else st.setEffectId(ei, prevCells_.at(i).at(j));
-				break;
-			}
-			}
+			PatternCellBlock::writeCell(st, c, prevCells.at(i, j));
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -78,21 +67,9 @@ void ShrinkPatternCommand::redo()
 	for (; s <= eStep_; ++s) {
 		int t = bTrack_;
 		int c = bCol_;
-		for (size_t j = 0; j < prevCells_.at(0).size(); ++j) {
+		for (size_t j = 0; j < prevCells_.width(); ++j) {
 			Step& st = command_utils::getStep(sng, t, order_, s);
-			switch (c) {
-			case 0:		st.clearNoteNumber();		break;
-			case 1:		st.clearInstrumentNumber();	break;
-			case 2:		st.clearVolume();			break;
-			default:
-			{
-				int ec = c - 3;
-				int ei = ec / 2;
-				if (ec % 2) st.clearEffectValue(ei);
-				else st.clearEffectId(ei);
-				break;
-			}
-			}
+			PatternCellBlock::writeCell(st, c, PatternCellBlock::EMPTY_CELL);
 
 			t += (++c / Step::N_COLUMN);
 			c %= Step::N_COLUMN;
@@ -104,3 +81,8 @@ void ShrinkPatternCommand::undo()
 {
 	command_utils::restorePattern(mod_.lock()->getSong(song_), prevCells_, bTrack_, bCol_, order_, bStep_);
 }
+
+size_t ShrinkPatternCommand::getFootprint() const
+{
+	return prevCells_.getFootprint();
+}
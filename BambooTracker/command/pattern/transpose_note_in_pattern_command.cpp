@@ -78,3 +78,8 @@ void TransposeNoteInPatternCommand::undo()
 		}
 	}
 }
+
+size_t TransposeNoteInPatternCommand::getFootprint() const
+{
+	return prevKeys_.capacity() * sizeof(int);
+}
@@ -38,6 +38,7 @@ public:
 								  int endTrack, int endStep, int semitone);
 	void redo() override;
 	void undo() override;
+	size_t getFootprint() const override;
 
 private:
 	std::weak_ptr<Module> mod_;
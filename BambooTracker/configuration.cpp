@@ -29,6 +29,7 @@
 #include "jamming.hpp"
 #include "chip/real_chip_interface.hpp"
 #include "chip/resampler.hpp"
+#include "chip/opna.hpp"
 
 namespace
 {
@@ -131,6 +132,8 @@ const std::unordered_map<std::string, JamKey> KEY_MAP_AZERTY = {
 	{u8"Ç",         JamKey::HighCS2}, //ç - \xc7
 	{u8"O",         JamKey::HighD2},
 };
+
+constexpr chip::YmfmFidelity DEFAULT_YMFM_FIDELITY = chip::YmfmFidelity::Max;
 }
 
 Configuration::Configuration()
@@ -204,6 +207,7 @@ Configuration::Configuration()
 	pageJumpLength_ = 4;
 	editableStep_ = 1;
 	keyRepetision_ = true;
+	undoHistoryLimit_ = 64;
 
 	// Wave view
 	waveViewFps_ = 30;
@@ -291,6 +295,7 @@ Configuration::Configuration()
 	sndDevice_ = u8"";
 	realChip_ = RealChipInterfaceType::NONE;
 	emulator_ = 1;
+	ymfmFidelity_ = DEFAULT_YMFM_FIDELITY;
 	sampleRate_ = 44100;
 	bufferLength_ = 40;
 	resamplerType_ = chip::ResamplerType::BlipBuf;
@@ -762,3 +767,10 @@ std::unordered_map<std::string, JamKey> Configuration::getCustomLayoutKeys() con
 {
 	return mappingLayouts.at(KeyboardLayout::Custom);
 }
+
+// Sound
+void Configuration::setYmfmFidelity(chip::YmfmFidelity fidelity)
+{
+	if (chip::YmfmFidelity::First <= fidelity && fidelity <= chip::YmfmFidelity::Last) ymfmFidelity_ = fidelity;
+	else ymfmFidelity_ = DEFAULT_YMFM_FIDELITY;
+}
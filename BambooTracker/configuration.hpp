@@ -59,6 +59,7 @@ enum class NoteNotationSystem : int
 namespace chip
 {
 enum class ResamplerType : int;
+enum class YmfmFidelity : int;
 }
 
 class Configuration
@@ -228,8 +229,11 @@ public:
 	size_t getEditableStep() const { return editableStep_; }
 	void setKeyRepetition(bool enabled) { keyRepetision_ = enabled; }
 	bool getKeyRepetition() const { return keyRepetision_; }
+	/// Memory limit of the undo history in MiB. 0 means no limit.
+	void setUndoHistoryLimit(size_t mib) { undoHistoryLimit_ = mib; }
+	size_t getUndoHistoryLimit() const { return undoHistoryLimit_; }
 private:
-	size_t pageJumpLength_, editableStep_;
+	size_t pageJumpLength_, editableStep_, undoHistoryLimit_;
 	bool keyRepetision_;
 
 	// Wave view
@@ -295,6 +299,9 @@ public:
 	RealChipInterfaceType getRealChipInterface() const { return realChip_; }
 	void setEmulator(int emulator) { emulator_ = emulator; }
 	int getEmulator() const { return emulator_; }
+	/// Unknown values, e.g. from a broken settings file, fall back to the default.
+	void setYmfmFidelity(chip::YmfmFidelity fidelity);
+	chip::YmfmFidelity getYmfmFidelity() const { return ymfmFidelity_; }
 	void setSampleRate(uint32_t rate) { sampleRate_ = rate; }
 	uint32_t getSampleRate() const { return sampleRate_; }
 	void setBufferLength(size_t length) { bufferLength_ = length; }
@@ -308,6 +315,7 @@ private:
 	std::string sndAPI_, sndDevice_;
 	RealChipInterfaceType realChip_;
 	int emulator_;
+	chip::YmfmFidelity ymfmFidelity_;
 	uint32_t sampleRate_;
 	size_t bufferLength_;
 	chip::ResamplerType resamplerType_;
@@ -25,36 +25,47 @@
 
 #pragma once
 
-#include <deque>
+#include <cstddef>
+#include <array>
+#include <stdexcept>
 #include "note.hpp"
 
+/// Ring buffer of the latest notes, which never allocates on the audio thread.
 class EchoBuffer
 {
-	using DequeType = std::deque<Note>;
 public:
-	using reference = DequeType::reference;
-	using const_reference = DequeType::const_reference;
-	using size_type = DequeType::size_type;
+	using reference = Note&;
+	using const_reference = const Note&;
+	using size_type = size_t;
 
-	reference at(size_type n) { return deque_.at(n); }
-	const_reference at(size_type n) const { return deque_.at(n); }
+	EchoBuffer() : head_(0), size_(0) {}
 
-	reference operator[](size_type n) { return deque_[n]; }
-	const_reference operator[](size_type n) const { return deque_[n]; }
+	reference at(size_type n) { checkRange(n); return (*this)[n]; }
+	const_reference at(size_type n) const { checkRange(n); return (*this)[n]; }
 
-	reference latest() { return deque_.front(); }
-	const_reference latest() const { return deque_.front(); }
+	reference operator[](size_type n) { return buf_[(head_ + n) % MAX_]; }
+	const_reference operator[](size_type n) const { return buf_[(head_ + n) % MAX_]; }
 
-	size_type size() const noexcept { return deque_.size(); }
+	reference latest() { return buf_[head_]; }
+	const_reference latest() const { return buf_[head_]; }
 
-	void clear() noexcept { deque_.clear(); }
+	size_type size() const noexcept { return size_; }
+
+	void clear() noexcept { size_ = 0; }
 
 	void push(const Note& y) {
-		deque_.push_front(y);
-		if (MAX_ <= deque_.size()) deque_.pop_back();
+		head_ = (head_ + MAX_ - 1) % MAX_;
+		buf_[head_] = y;
+		if (size_ < MAX_ - 1) ++size_;
 	}
 
 private:
-	std::deque<Note> deque_;
 	static constexpr size_type MAX_ = 4;
+	std::array<Note, MAX_> buf_;
+	size_type head_, size_;	// Holds up to (MAX_ - 1) notes
+
+	void checkRange(size_type n) const
+	{
+		if (size_ <= n) throw std::out_of_range("EchoBuffer::at");
+	}
 };
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+
+/**
+ * Free list of fixed-size memory blocks reserved in static storage.
+ *
+ * It serves objects which are created and destroyed on the audio thread,
+ * so that they do not call the global allocator.
+ * A request which is too large or exceeds the pool falls back to the global allocator.
+ */
+template <size_t BLOCK_SIZE, size_t N_BLOCKS>
+class FixedBlockPool
+{
+public:
+	static void* allocate(size_t size)
+	{
+		if (size <= BLOCK_SIZE) {
+			if (void* p = instance().pop()) return p;
+		}
+		return ::operator new(size);
+	}
+
+	static void deallocate(void* ptr) noexcept
+	{
+		FixedBlockPool& pool = instance();
+		auto p = static_cast<unsigned char*>(ptr);
+		if (pool.storage_ <= p && p < pool.storage_ + sizeof(pool.storage_)) pool.push(p);
+		else ::operator delete(ptr);
+	}
+
+private:
+	union Block
+	{
+		Block* next;
+		alignas(std::max_align_t) unsigned char data[BLOCK_SIZE];
+	};
+
+	alignas(Block) unsigned char storage_[sizeof(Block) * N_BLOCKS];
+	Block* head_;
+	std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+
+	FixedBlockPool() noexcept
+	{
+		head_ = nullptr;
+		for (size_t i = N_BLOCKS; i > 0; --i) {
+			auto block = reinterpret_cast<Block*>(storage_ + sizeof(Block) * (i - 1));
+			block->next = head_;
+			head_ = block;
+		}
+	}
+
+	static FixedBlockPool& instance() noexcept
+	{
+		static FixedBlockPool pool;
+		return pool;
+	}
+
+	// Critical sections are a few instructions, so spin instead of sleeping on a mutex
+	void* pop() noexcept
+	{
+		while (lock_.test_and_set(std::memory_order_acquire)) {}
+		Block* block = head_;
+		if (block) head_ = block->next;
+		lock_.clear(std::memory_order_release);
+		return block;
+	}
+
+	void push(void* ptr) noexcept
+	{
+		auto block = static_cast<Block*>(ptr);
+		while (lock_.test_and_set(std::memory_order_acquire)) {}
+		block->next = head_;
+		head_ = block;
+		lock_.clear(std::memory_order_release);
+	}
+};
+
+/// Allocator which takes memory from FixedBlockPool.
+template <class T, class Pool>
+class FixedBlockPoolAllocator
+{
+public:
+	using value_type = T;
+
+	FixedBlockPoolAllocator() noexcept = default;
+	template <class U>
+	FixedBlockPoolAllocator(const FixedBlockPoolAllocator<U, Pool>&) noexcept {}
+
+	template <class U>
+	struct rebind { using other = FixedBlockPoolAllocator<U, Pool>; };
+
+	T* allocate(size_t n) { return static_cast<T*>(Pool::allocate(n * sizeof(T))); }
+	void deallocate(T* ptr, size_t) noexcept { Pool::deallocate(ptr); }
+
+	template <class U>
+	friend bool operator==(const FixedBlockPoolAllocator&, const FixedBlockPoolAllocator<U, Pool>&) noexcept { return true; }
+	template <class U>
+	friend bool operator!=(const FixedBlockPoolAllocator&, const FixedBlockPoolAllocator<U, Pool>&) noexcept { return false; }
+};
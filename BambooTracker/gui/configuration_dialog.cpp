@@ -142,6 +142,7 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 
 	// Edit settings
 	ui->pageJumpLengthSpinBox->setValue(static_cast<int>(configLocked->getPageJumpLength()));
+	ui->undoHistoryLimitSpinBox->setValue(static_cast<int>(configLocked->getUndoHistoryLimit()));
 
 	// Wave view
 	ui->waveViewRateSpinBox->setValue(configLocked->getWaveViewFrameRate());
@@ -302,6 +303,12 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 	ui->emulatorComboBox->addItem("Nuked OPN-Mod", static_cast<int>(chip::OpnaEmulator::Nuked));
 	ui->emulatorComboBox->addItem("ymfm", static_cast<int>(chip::OpnaEmulator::Ymfm));
 	ui->emulatorComboBox->setCurrentIndex(ui->emulatorComboBox->findData(configLocked->getEmulator()));
+	ui->ymfmFidelityComboBox->addItem(tr("Maximum fidelity"), static_cast<int>(chip::YmfmFidelity::Max));
+	ui->ymfmFidelityComboBox->addItem(tr("Medium fidelity"), static_cast<int>(chip::YmfmFidelity::Medium));
+	ui->ymfmFidelityComboBox->addItem(tr("Minimum fidelity"), static_cast<int>(chip::YmfmFidelity::Min));
+	ui->ymfmFidelityComboBox->setCurrentIndex(
+				ui->ymfmFidelityComboBox->findData(static_cast<int>(configLocked->getYmfmFidelity())));
+	on_emulatorComboBox_currentIndexChanged(ui->emulatorComboBox->currentIndex());
 
 	ui->zeroWaitWriteCheckBox->setChecked(configLocked->getImmediateWriteModeEnabled());
 
@@ -364,6 +371,9 @@ ConfigurationDialog::ConfigurationDialog(std::weak_ptr<Configuration> config, st
 	ui->resamplerComboBox->addItem(QString("Linear (%1)").arg(tr("old, deprecated")), static_cast<int>(chip::ResamplerType::Linear));
 	ui->resamplerComboBox->addItem("blip_buf", static_cast<int>(chip::ResamplerType::BlipBuf));
 	ui->resamplerComboBox->addItem(QString("blip_buf (%1)").arg(tr("fast")), static_cast<int>(chip::ResamplerType::FastBlipBuf));
+	ui->resamplerComboBox->addItem(QString("Sinc (%1)").arg(tr("fast")), static_cast<int>(chip::ResamplerType::FastSinc));
+	ui->resamplerComboBox->addItem("Sinc", static_cast<int>(chip::ResamplerType::Sinc));
+	ui->resamplerComboBox->addItem(QString("Sinc (%1)").arg(tr("best")), static_cast<int>(chip::ResamplerType::BestSinc));
 	for (int i = 0; i < ui->resamplerComboBox->count(); ++i) {
 		if (static_cast<chip::ResamplerType>(ui->resamplerComboBox->itemData(i).toInt()) == configLocked->getResamplerType()) {
 			ui->resamplerComboBox->setCurrentIndex(i);
@@ -458,6 +468,7 @@ void ConfigurationDialog::on_ConfigurationDialog_accepted()
 
 	// Edit settings
 	configLocked->setPageJumpLength(static_cast<size_t>(ui->pageJumpLengthSpinBox->value()));
+	configLocked->setUndoHistoryLimit(static_cast<size_t>(ui->undoHistoryLimitSpinBox->value()));
 
 	// Wave view
 	configLocked->setWaveViewFrameRate(ui->waveViewRateSpinBox->value());
@@ -486,6 +497,11 @@ void ConfigurationDialog::on_ConfigurationDialog_accepted()
 		configLocked->setEmulator(emu);
 		changedEmu = true;
 	}
+	auto fidelity = static_cast<chip::YmfmFidelity>(ui->ymfmFidelityComboBox->currentData().toInt());
+	if (fidelity != configLocked->getYmfmFidelity()) {
+		configLocked->setYmfmFidelity(fidelity);
+		changedEmu = true;
+	}
 
 	configLocked->setImmediateWriteModeEnabled(ui->zeroWaitWriteCheckBox->isChecked());
 
@@ -556,6 +572,12 @@ void ConfigurationDialog::on_mixerResetPushButton_clicked()
 }
 
 /***** Sound *****/
+void ConfigurationDialog::on_emulatorComboBox_currentIndexChanged(int index)
+{
+	ui->ymfmFidelityComboBox->setEnabled(
+				ui->emulatorComboBox->itemData(index).toInt() == static_cast<int>(chip::OpnaEmulator::Ymfm));
+}
+
 void ConfigurationDialog::on_audioApiComboBox_currentIndexChanged(const QString &arg1)
 {
 	ui->audioDeviceComboBox->clear();
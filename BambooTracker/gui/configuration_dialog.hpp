@@ -77,6 +77,7 @@ private slots:
 
 	/***** Sound *****/
 private slots:
+	void on_emulatorComboBox_currentIndexChanged(int index);
 	void on_audioApiComboBox_currentIndexChanged(const QString &arg1);
 	void on_midiApiComboBox_currentIndexChanged(const QString &arg1);
 	void onMidiApiChanged(const QString &arg1, bool hasInitialized = true);
@@ -226,6 +226,7 @@ bool saveConfiguration(std::weak_ptr<Configuration> config)
 		settings.setValue("pageJumpLength", static_cast<int>(configLocked->getPageJumpLength()));
 		settings.setValue("editableStep", static_cast<int>(configLocked->getEditableStep()));
 		settings.setValue("keyRepetition", configLocked->getKeyRepetition());
+		settings.setValue("undoHistoryLimit", static_cast<int>(configLocked->getUndoHistoryLimit()));
 		settings.endGroup();
 
 		// Wave view
@@ -255,6 +256,7 @@ bool saveConfiguration(std::weak_ptr<Configuration> config)
 		settings.setValue("soundDevice", gui_utils::utf8ToQString(configLocked->getSoundDevice()));
 		settings.setValue("realChipInterface",	static_cast<int>(configLocked->getRealChipInterface()));
 		settings.setValue("emulator",		configLocked->getEmulator());
+		settings.setValue("ymfmFidelity",	static_cast<int>(configLocked->getYmfmFidelity()));
 		settings.setValue("sampleRate",   static_cast<int>(configLocked->getSampleRate()));
 		settings.setValue("bufferLength", static_cast<int>(configLocked->getBufferLength()));
 		settings.setValue("resamplerType", static_cast<int>(configLocked->getResamplerType()));
@@ -393,6 +395,9 @@ bool loadConfiguration(std::weak_ptr<Configuration> config)
 		editableStepWorkaround.setValue(configLocked->getEditableStep());
 		configLocked->setEditableStep(static_cast<size_t>(settings.value("editableStep", editableStepWorkaround).toInt()));
 		configLocked->setKeyRepetition(settings.value("keyRepetition", configLocked->getKeyRepetition()).toBool());
+		QVariant undoHistoryLimitWorkaround;
+		undoHistoryLimitWorkaround.setValue(configLocked->getUndoHistoryLimit());
+		configLocked->setUndoHistoryLimit(static_cast<size_t>(settings.value("undoHistoryLimit", undoHistoryLimitWorkaround).toInt()));
 		settings.endGroup();
 
 		// Wave view
@@ -438,6 +443,8 @@ bool loadConfiguration(std::weak_ptr<Configuration> config)
 		configLocked->setRealChipInterface(static_cast<RealChipInterfaceType>(
 											   settings.value("realChipInterface", static_cast<int>(configLocked->getRealChipInterface())).toInt()));
 		configLocked->setEmulator(settings.value("emulator", configLocked->getEmulator()).toInt());
+		configLocked->setYmfmFidelity(static_cast<chip::YmfmFidelity>(
+										  settings.value("ymfmFidelity", static_cast<int>(configLocked->getYmfmFidelity())).toInt()));
 		QVariant sampleRateWorkaround;
 		sampleRateWorkaround.setValue(configLocked->getSampleRate());
 		configLocked->setSampleRate(static_cast<uint32_t>(settings.value("sampleRate", sampleRateWorkaround).toInt()));
@@ -50,6 +50,9 @@ inline QKeySequence strToKeySeq(std::string str)
 
 std::vector<int> adaptVisibleTrackList(const std::vector<int> list,
 									   const SongType prevType, const SongType curType);
+
+/// Clipboard format of pattern cells copied in this application.
+const QString PATTERN_CELLS_MIME_TYPE = "application/x-bambootracker-pattern-cells";
 }
 
 namespace io
@@ -344,7 +344,7 @@ void ADPCMSampleEditor::importSampleFrom(const QString file)
 			}
 			QByteArray array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
+			container.appendArray(reinterpret_cast<const uint8_t*>(array.constData()), static_cast<size_t>(array.size()));
 		}
 
 		wav = std::make_unique<io::WavContainer>(container);
@@ -58,6 +58,7 @@
 #include "io/bank_io.hpp"
 #include "io/binary_container.hpp"
 #include "io/wav_container.hpp"
+#include "io/wav_stream_writer.hpp"
 #include "version.hpp"
 #include "gui/command/instrument/instrument_commands_qt.hpp"
 #include "gui/instrument_editor/fm_instrument_editor.hpp"
@@ -98,6 +99,30 @@ const std::unordered_map<Configuration::ToolbarPosition, Qt::ToolBarArea> TB_POS
 };
 
 constexpr int STATUS_DISPLAY_TIMEOUT = 0;
+
+class QFileWavWriter : public io::WavStreamWriter
+{
+public:
+	QFileWavWriter(QFile& file, uint32_t rate, uint16_t nCh, uint16_t bitSize)
+		: io::WavStreamWriter(rate, nCh, bitSize), file_(file) {}
+
+protected:
+	bool writeBytes(const uint8_t* data, size_t size) override
+	{
+		return file_.write(reinterpret_cast<const char*>(data), static_cast<qint64>(size))
+				== static_cast<qint64>(size);
+	}
+
+	bool writeBytesAt(size_t pos, const uint8_t* data, size_t size) override
+	{
+		qint64 cur = file_.pos();
+		bool res = file_.seek(static_cast<qint64>(pos)) && writeBytes(data, size);
+		return file_.seek(cur) && res;
+	}
+
+private:
+	QFile& file_;
+};
 }
 
 ModuleSaveCheckDialog::ModuleSaveCheckDialog(const std::string& name, QWidget* parent) :
@@ -198,7 +223,7 @@ MainWindow::MainWindow(std::weak_ptr<Configuration> config, QString filePath, bo
 	QObject::connect(comStack_.get(), &QUndoStack::indexChanged,
 					 this, [&](int idx) {
 		setWindowModified(idx || isModifiedForNotCommand_);
-		ui->actionUndo->setEnabled(comStack_->canUndo());
+		ui->actionUndo->setEnabled(comStack_->canUndo() && bt_->canUndo());
 		ui->actionRedo->setEnabled(comStack_->canRedo());
 	});
 
@@ -1796,7 +1821,7 @@ void MainWindow::funcLoadInstrument(QString file)
 			}
 			QByteArray&& array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
+			container.appendArray(reinterpret_cast<const uint8_t*>(array.constData()), static_cast<size_t>(array.size()));
 		}
 		bt_->loadInstrument(container, file.toStdString(), n);
 
@@ -1902,7 +1927,7 @@ void MainWindow::funcImportInstrumentsFromBank(QString file)
 			}
 			QByteArray&& array = fp.readAll();
 			fp.close();
-			std::move(array.begin(), array.end(), std::back_inserter(container));
+			container.appendArray(reinterpret_cast<const uint8_t*>(array.constData()), static_cast<size_t>(array.size()));
 		}
 
 		bank.reset(io::BankIO::getInstance().loadBank(container, file.toStdString()));
@@ -2096,6 +2121,7 @@ void MainWindow::swapInstruments(int row1, int row2)
 /********** Undo-Redo **********/
 void MainWindow::undo()
 {
+	if (!bt_->canUndo()) return;	// Older commands were discarded by the memory limit
 	bt_->undo();
 	comStack_->undo();
 }
@@ -2212,7 +2238,7 @@ void MainWindow::openModule(const QString& file)
 			{
 				QByteArray&& array = fp.readAll();
 				fp.close();
-				std::move(array.begin(), array.end(), std::back_inserter(container));
+				container.appendArray(reinterpret_cast<const uint8_t*>(array.constData()), static_cast<size_t>(array.size()));
 			}
 
 			bt_->loadModule(container);
@@ -2810,7 +2836,9 @@ void MainWindow::updateMenuByPattern()
 	}
 	else {
 		// Edit
-		bool enabled = QApplication::clipboard()->text().startsWith("PATTERN_");
+		const QMimeData* clipData = QApplication::clipboard()->mimeData();
+		bool enabled = clipData->hasFormat(gui_utils::PATTERN_CELLS_MIME_TYPE)
+					   || clipData->text().startsWith("PATTERN_");
 		ui->actionPaste->setEnabled(enabled);
 		ui->actionMix->setEnabled(enabled);
 		ui->actionOverwrite->setEnabled(enabled);
@@ -3619,36 +3647,34 @@ void MainWindow::on_actionWAV_triggered()
 			}
 		}
 
-		try {
-			QByteArray bytes;
-			{
-				const uint32_t rate = static_cast<uint32_t>(dialog.getSampleRate());
-				const uint16_t nCh = 2;
-				const int loopCnt = dialog.getLoopCount();
-				io::WavContainer container(rate, nCh, 16);
-				if (!bt_->exportToWav(container, loopCnt, bar))
-					break;	// Jump if cancelled
-				bytes.reserve(container.size());
-				std::move(container.begin(), container.end(), std::back_inserter(bytes));
-			}
+		if (curTrack > -1) path = QString("%1/%2 - %3.wav").arg(exDir).arg(curTrack + 1, 2, 10, QChar('0')).arg(name);
+		QFile fp(path);
+		if (!fp.open(QIODevice::WriteOnly)) {
+			FileIOErrorMessageBox::openError(path, false, io::FileType::WAV, this);
+			break;	// Jump to post process
+		}
 
-			if (curTrack > -1) path = QString("%1/%2 - %3.wav").arg(exDir).arg(curTrack + 1, 2, 10, QChar('0')).arg(name);
-			QFile fp(path);
-			if (!fp.open(QIODevice::WriteOnly)) {
-				FileIOErrorMessageBox::openError(path, false, io::FileType::WAV, this);
-				break;	// Jump to post process
+		try {
+			const uint32_t rate = static_cast<uint32_t>(dialog.getSampleRate());
+			const uint16_t nCh = 2;
+			const int loopCnt = dialog.getLoopCount();
+			QFileWavWriter writer(fp, rate, nCh, 16);
+			if (!bt_->exportToWav(writer, loopCnt, bar)) {
+				fp.remove();
+				break;	// Jump if cancelled
 			}
-			fp.write(bytes);
 			fp.close();
 			bar();
 
 			config_.lock()->setWorkingDirectory(QFileInfo(path).dir().path().toStdString());
 		}
 		catch (io::FileIOError& e) {
+			fp.remove();
 			FileIOErrorMessageBox(path, false, e, this).exec();
 			break;
 		}
 		catch (std::exception& e) {
+			fp.remove();
 			FileIOErrorMessageBox(path, false, io::FileType::WAV, QString(e.what()), this).exec();
 			break;
 		}
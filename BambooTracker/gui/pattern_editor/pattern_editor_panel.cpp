@@ -40,6 +40,9 @@
 #endif
 #include <QApplication>
 #include <QClipboard>
+#include <QMimeData>
+#include <QDataStream>
+#include <QStringList>
 #include <QMenu>
 #include <QAction>
 #include <QRegularExpression>
@@ -50,6 +53,8 @@
 #include "jamming.hpp"
 #include "note.hpp"
 #include "step.hpp"
+#include "pattern.hpp"
+#include "track.hpp"
 #include "bamboo_tracker_defs.hpp"
 #include "gui/dpi.hpp"
 #include "gui/event_guard.hpp"
@@ -1783,77 +1788,51 @@ void PatternEditorPanel::copySelectedCells()
 {
 	if (selLeftAbovePos_.order == -1) return;
 
+	storeSelectedCellsToClipboard(false);
+}
+
+void PatternEditorPanel::storeSelectedCellsToClipboard(bool isCut)
+{
 	int r = visTracks_.at(selRightBelowPos_.trackVisIdx) * 11 + selRightBelowPos_.colInTrack;
 	int l = visTracks_.at(selLeftAbovePos_.trackVisIdx) * 11 + selLeftAbovePos_.colInTrack;
 	int w = 1 + r - l;	// Real selected region width
 	int h = 1 + calculateStepDistance(selLeftAbovePos_.order, selLeftAbovePos_.step,
 									  selRightBelowPos_.order, selRightBelowPos_.step);
-	QString str = QString("PATTERN_COPY:%1,%2,%3,").arg(selLeftAbovePos_.colInTrack).arg(w).arg(h);
-	// NOTE: pos.trackVisIdx, endPos.trackVisIdx indecates a real track number.
-	PatternPosition pos = {
-		visTracks_.at(selLeftAbovePos_.trackVisIdx), selLeftAbovePos_.colInTrack,
-		selLeftAbovePos_.order, selLeftAbovePos_.step
-	};
-	const PatternPosition endPos = {
-		visTracks_.at(selRightBelowPos_.trackVisIdx), selRightBelowPos_.colInTrack,
-		selRightBelowPos_.order, selRightBelowPos_.step
-	};
-	while (true) {
-		switch (pos.colInTrack) {
-		case 0:
-			str += QString::number(bt_->getStepNoteNumber(curSongNum_, pos.trackVisIdx, pos.order, pos.step));
-			break;
-		case 1:
-			str += QString::number(bt_->getStepInstrument(curSongNum_, pos.trackVisIdx, pos.order, pos.step));
-			break;
-		case 2:
-			str += QString::number(bt_->getStepVolume(curSongNum_, pos.trackVisIdx, pos.order, pos.step));
-			break;
-		case 3:
-			str += QString::fromStdString(bt_->getStepEffectID(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 0));
-			break;
-		case 4:
-			str += QString::number(bt_->getStepEffectValue(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 0));
-			break;
-		case 5:
-			str += QString::fromStdString(bt_->getStepEffectID(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 1));
-			break;
-		case 6:
-			str += QString::number(bt_->getStepEffectValue(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 1));
-			break;
-		case 7:
-			str += QString::fromStdString(bt_->getStepEffectID(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 2));
-			break;
-		case 8:
-			str += QString::number(bt_->getStepEffectValue(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 2));
-			break;
-		case 9:
-			str += QString::fromStdString(bt_->getStepEffectID(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 3));
-			break;
-		case 10:
-			str += QString::number(bt_->getStepEffectValue(curSongNum_, pos.trackVisIdx, pos.order, pos.step, 3));
-			break;
-		}
+	int sCol = selLeftAbovePos_.colInTrack;
+	PatternCellBlock cells = bt_->getPatternCells(
+								 curSongNum_, visTracks_.at(selLeftAbovePos_.trackVisIdx), sCol,
+								 selLeftAbovePos_.order, selLeftAbovePos_.step,
+								 static_cast<size_t>(w), static_cast<size_t>(h));
 
-		if (pos.isEqualCols(endPos)) {
-			if (pos.isEqualRows(endPos)) {
-				break;
-			}
-			else {
-				pos.setCols(visTracks_.at(selLeftAbovePos_.trackVisIdx), selLeftAbovePos_.colInTrack);
-				++pos.step;
-			}
-		}
-		else {
-			++pos.colInTrack;
-			pos.trackVisIdx += (pos.colInTrack / 11);
-			pos.colInTrack %= 11;
+	// Binary data for pasting in this application
+	QByteArray bin;
+	QDataStream out(&bin, QIODevice::WriteOnly);
+	out << static_cast<qint32>(sCol) << static_cast<quint32>(w) << static_cast<quint32>(h);
+	for (size_t i = 0; i < cells.height(); ++i) {
+		for (size_t j = 0; j < cells.width(); ++j) {
+			const PatternCell& cell = cells.at(i, j);
+			out << static_cast<qint16>(cell.value) << static_cast<qint8>(cell.id[0]) << static_cast<qint8>(cell.id[1]);
 		}
+	}
 
-		str += ",";
+	// Text data for other applications
+	QStringList vals;
+	vals.reserve(w * h);
+	for (size_t i = 0; i < cells.height(); ++i) {
+		int c = sCol;
+		for (size_t j = 0; j < cells.width(); ++j) {
+			const PatternCell& cell = cells.at(i, j);
+			if (PatternCellBlock::isEffectIdColumn(c)) vals << QString::fromLatin1(cell.id, 2);
+			else vals << QString::number(cell.value);
+			c = (c + 1) % 11;
+		}
 	}
 
-	QApplication::clipboard()->setText(str);
+	auto mime = new QMimeData;
+	mime->setData(gui_utils::PATTERN_CELLS_MIME_TYPE, bin);
+	mime->setText(QString("PATTERN_%1:%2,%3,%4,").arg(isCut ? "CUT" : "COPY").arg(sCol).arg(w).arg(h)
+				  + vals.join(","));
+	QApplication::clipboard()->setMimeData(mime);
 }
 
 void PatternEditorPanel::eraseSelectedCells()
@@ -1867,74 +1846,124 @@ void PatternEditorPanel::eraseSelectedCells()
 void PatternEditorPanel::pasteCopiedCells(const PatternPosition& cursorPos)
 {
 	int sCol = 0;
-	PatternCells cells = decodeCells(QApplication::clipboard()->text(), sCol);
-	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.front().size());
+	PatternCellBlock cells = decodeCells(QApplication::clipboard()->mimeData(), sCol);
+	if (cells.empty()) return;
+	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.width());
 	if (config_->getPasteMode() == Configuration::PasteMode::Fill && selLeftAbovePos_.order != -1) {
 		cells = compandPasteCells(pos, cells);
 	}
 
 	bt_->pastePatternCells(
-				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, std::move(cells));
+				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, cells);
 	comStack_.lock()->push(new PasteCopiedDataToPatternQtCommand(this));
 }
 
 void PatternEditorPanel::pasteMixCopiedCells(const PatternPosition& cursorPos)
 {
 	int sCol = 0;
-	PatternCells cells = decodeCells(QApplication::clipboard()->text(), sCol);
-	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.front().size());
+	PatternCellBlock cells = decodeCells(QApplication::clipboard()->mimeData(), sCol);
+	if (cells.empty()) return;
+	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.width());
 	if (config_->getPasteMode() == Configuration::PasteMode::Fill && selLeftAbovePos_.order != -1) {
 		cells = compandPasteCells(pos, cells);
 	}
 
 	bt_->pasteMixPatternCells(
-				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, std::move(cells));
+				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, cells);
 	comStack_.lock()->push(new PasteMixCopiedDataToPatternQtCommand(this));
 }
 
 void PatternEditorPanel::pasteOverwriteCopiedCells(const PatternPosition& cursorPos)
 {
 	int sCol = 0;
-	PatternCells cells = decodeCells(QApplication::clipboard()->text(), sCol);
-	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.front().size());
+	PatternCellBlock cells = decodeCells(QApplication::clipboard()->mimeData(), sCol);
+	if (cells.empty()) return;
+	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.width());
 	if (config_->getPasteMode() == Configuration::PasteMode::Fill && selLeftAbovePos_.order != -1) {
 		cells = compandPasteCells(pos, cells);
 	}
 
 	bt_->pasteOverwritePatternCells(
-				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, std::move(cells));
+				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, cells);
 	comStack_.lock()->push(new PasteOverwriteCopiedDataToPatternQtCommand(this));
 }
 
 void PatternEditorPanel::pasteInsertCopiedCells(const PatternPosition& cursorPos)
 {
 	int sCol = 0;
-	PatternCells cells = decodeCells(QApplication::clipboard()->text(), sCol);
-	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.front().size());
+	PatternCellBlock cells = decodeCells(QApplication::clipboard()->mimeData(), sCol);
+	if (cells.empty()) return;
+	PatternPosition pos = getPasteLeftAbovePosition(sCol, cursorPos, cells.width());
 	if (config_->getPasteMode() == Configuration::PasteMode::Fill && selLeftAbovePos_.order != -1) {
 		cells = compandPasteCells(pos, cells);
 	}
 
 	bt_->pasteInsertPatternCells(
-				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, std::move(cells));
+				curSongNum_, visTracks_.at(pos.trackVisIdx), pos.colInTrack, pos.order, pos.step, cells);
 	comStack_.lock()->push(new PasteInsertCopiedDataToPatternQtCommand(this));
 }
 
-PatternEditorPanel::PatternCells PatternEditorPanel::decodeCells(QString str, int& startCol)
+PatternCellBlock PatternEditorPanel::decodeCells(const QMimeData* mime, int& startCol) const
 {
+	if (!mime) return PatternCellBlock();
+
+	// Any application can put data on the clipboard, so check the size before allocating the block
+	auto isValidSize = [&](int col, size_t w, size_t h) {
+		size_t maxW = songStyle_.trackAttribs.size() * Step::N_COLUMN;
+		size_t maxH = static_cast<size_t>(Track::MAX_ORDER_SIZE) * Pattern::MAX_STEP_SIZE;
+		return (-1 < col && col < Step::N_COLUMN && 0 < w && static_cast<size_t>(col) + w <= maxW && 0 < h && h <= maxH);
+	};
+
+	if (mime->hasFormat(gui_utils::PATTERN_CELLS_MIME_TYPE)) {
+		const QByteArray bin = mime->data(gui_utils::PATTERN_CELLS_MIME_TYPE);
+		QDataStream in(bin);
+		qint32 col;
+		quint32 w, h;
+		in >> col >> w >> h;
+		if (in.status() != QDataStream::Ok || !isValidSize(col, w, h)) return PatternCellBlock();	// Error
+		constexpr size_t HEADER_SIZE = 12;	// Column, width and height
+		constexpr size_t CELL_SIZE = 4;		// Value and 2 ID characters
+		if (static_cast<size_t>(bin.size()) != HEADER_SIZE + CELL_SIZE * w * h) return PatternCellBlock();	// Error
+		startCol = col;
+		PatternCellBlock cells(w, h);
+		for (size_t i = 0; i < h; ++i) {
+			for (size_t j = 0; j < w; ++j) {
+				qint16 val;
+				qint8 id0, id1;
+				in >> val >> id0 >> id1;
+				cells.at(i, j) = { val, { static_cast<char>(id0), static_cast<char>(id1) } };
+			}
+		}
+		if (in.status() != QDataStream::Ok) return PatternCellBlock();	// Error
+		return cells;
+	}
+
+	QString str = mime->text();
+	if (!str.startsWith("PATTERN_COPY:") && !str.startsWith("PATTERN_CUT:")) return PatternCellBlock();
 	str.remove(QRegularExpression("PATTERN_(COPY|CUT):"));
 	QStringList data = str.split(",");
-	if (data.size() < 3) {};	// Error
+	if (data.size() < 3) return PatternCellBlock();	// Error
 	startCol = data[0].toInt();
 	size_t w = data[1].toUInt();
 	size_t h = data[2].toUInt();
 	data.erase(data.begin(), data.begin() + 3);
-	if (static_cast<int>(w * h) != data.size()) return {};	// Error
+	if (!isValidSize(startCol, w, h) || w * h != static_cast<size_t>(data.size())) return PatternCellBlock();	// Error
 
-	PatternCells cells(h, PatternCells::value_type(w));
+	PatternCellBlock cells(w, h);
 	for (size_t i = 0; i < h; ++i) {
+		int c = startCol;
 		for (size_t j = 0; j < w; ++j) {
-			cells[i][j] = data[i * w + j].toStdString();
+			const QString& val = data[i * w + j];
+			PatternCell& cell = cells.at(i, j);
+			if (PatternCellBlock::isEffectIdColumn(c)) {
+				QByteArray id = val.toLatin1();
+				cell.id[0] = id.size() > 0 ? id[0] : '-';
+				cell.id[1] = id.size() > 1 ? id[1] : '-';
+			}
+			else {
+				cell.value = static_cast<int16_t>(val.toInt());
+			}
+			c = (c + 1) % 11;
 		}
 	}
 
@@ -1966,48 +1995,25 @@ void PatternEditorPanel::cutSelectedCells()
 {
 	if (selLeftAbovePos_.order == -1) return;
 
-	copySelectedCells();
+	storeSelectedCellsToClipboard(true);
 	eraseSelectedCells();
-	QString str = QApplication::clipboard()->text();
-	str.replace("COPY", "CUT");
-	QApplication::clipboard()->setText(str);
 }
 
-PatternEditorPanel::PatternCells PatternEditorPanel::compandPasteCells(const PatternPosition& laPos, const PatternCells& cells)
+PatternCellBlock PatternEditorPanel::compandPasteCells(const PatternPosition& laPos, const PatternCellBlock& cells)
 {
-	PatternCells newCells;
-	int ow = cells.front().size();
-	int oh = cells.size();
+	int ow = static_cast<int>(cells.width());
+	size_t oh = cells.height();
 	int l = laPos.trackVisIdx * 11 + laPos.colInTrack;
 	int r = selRightBelowPos_.trackVisIdx * 11 + selRightBelowPos_.colInTrack;
 	int w = r - l + 1;	// Real selected region width
 	size_t h = static_cast<size_t>(calculateStepDistance(laPos.order, laPos.step,
 														 selRightBelowPos_.order, selRightBelowPos_.step) + 1);
 	int bw = ((ow - 1) / 11 + 1) * 11;
-	size_t padSize = bw - ow;
-	std::vector<std::string> pad(padSize);
-	int lc = (laPos.colInTrack + ow) % 11;
-	for (size_t i = 0; i < padSize; ++i) {
-		switch (lc) {
-		case 3:
-		case 5:
-		case 7:
-		case 9:
-			pad[i] = "--";
-			break;
-		default:
-			pad[i] = "-1";
-			break;
-		}
-		lc = (lc + 1) % 11;
-	}
+	// Padding cells are left empty
+	PatternCellBlock newCells(static_cast<size_t>(w), h);
 	for (size_t i = 0; i < h; ++i) {
-		newCells.emplace_back(w);
-		auto&& rowBeginIt = newCells.back().begin();
 		for (int dw = w, p = 0; dw > 0; dw -= bw, p += bw) {
-			int ws = std::min(ow, dw);
-			std::copy_n(cells.at(i % oh).begin(), ws, rowBeginIt + p);
-			std::copy_n(pad.begin(), std::min(dw - ws, static_cast<int>(padSize)), rowBeginIt + p + ws);
+			std::copy_n(&cells.at(i % oh, 0), std::min(ow, dw), &newCells.at(i, p));
 		}
 	}
 
@@ -2268,8 +2274,10 @@ void PatternEditorPanel::showPatternContextMenu(const PatternPosition& pos, cons
 		cinVal->setEnabled(false);
 	}
 	else {
-		QString clipText = QApplication::clipboard()->text();
-		if (!clipText.startsWith("PATTERN_COPY") && !clipText.startsWith("PATTERN_CUT")) {
+		const QMimeData* clipData = QApplication::clipboard()->mimeData();
+		QString clipText = clipData->text();
+		if (!clipData->hasFormat(gui_utils::PATTERN_CELLS_MIME_TYPE)
+				&& !clipText.startsWith("PATTERN_COPY") && !clipText.startsWith("PATTERN_CUT")) {
 			paste->setEnabled(false);
 			pasteMix->setEnabled(false);
 			pasteOver->setEnabled(false);
@@ -2295,7 +2303,7 @@ void PatternEditorPanel::showPatternContextMenu(const PatternPosition& pos, cons
 			cinVal->setEnabled(false);
 		}
 	}
-	if (!comStack_.lock()->canUndo()) {
+	if (!comStack_.lock()->canUndo() || !bt_->canUndo()) {
 		undo->setEnabled(false);
 	}
 	if (!comStack_.lock()->canRedo()) {
@@ -41,12 +41,14 @@
 #include <QString>
 #include <QPoint>
 #include <QShortcut>
+#include <QMimeData>
 #include <memory>
 #include <vector>
 #include <atomic>
 #include "bamboo_tracker.hpp"
 #include "configuration.hpp"
 #include "song.hpp"
+#include "pattern_cell_block.hpp"
 #include "gui/pattern_editor/pattern_position.hpp"
 #include "gui/color_palette.hpp"
 
@@ -300,11 +302,11 @@ private:
 	void pasteMixCopiedCells(const PatternPosition& cursorPos);
 	void pasteOverwriteCopiedCells(const PatternPosition& cursorPos);
 	void pasteInsertCopiedCells(const PatternPosition& cursorPos);
-	using PatternCells = std::vector<std::vector<std::string>>;
-	PatternCells decodeCells(QString str, int& startCol);
+	void storeSelectedCellsToClipboard(bool isCut);
+	PatternCellBlock decodeCells(const QMimeData* mime, int& startCol) const;
 	PatternPosition getPasteLeftAbovePosition(
 			int pasteCol, const PatternPosition& cursorPos, size_t cellW) const;
-	PatternCells compandPasteCells(const PatternPosition& laPos, const PatternCells& cells);
+	PatternCellBlock compandPasteCells(const PatternPosition& laPos, const PatternCellBlock& cells);
 
 	void transposeNote(const PatternPosition& startPos, const PatternPosition& endPos, int semitone);
 	void changeValuesInPattern(const PatternPosition& startPos, const PatternPosition& endPos, int value);
@@ -26,7 +26,7 @@
 #include "abstract_instrument_property.hpp"
 
 AbstractInstrumentProperty::AbstractInstrumentProperty(int num)
-	: num_(num)
+	: num_(num), hash_(0), isHashValid_(false)
 {
 }
 
@@ -50,3 +50,12 @@ void AbstractInstrumentProperty::clearUserInstruments()
 {
 	users_.clear();
 }
+
+std::size_t AbstractInstrumentProperty::getHash() const
+{
+	if (!isHashValid_) {
+		hash_ = calculateHash();
+		isHashValid_ = true;
+	}
+	return hash_;
+}
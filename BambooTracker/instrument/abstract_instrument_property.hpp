@@ -26,6 +26,7 @@
 #pragma once
 
 #include <set>
+#include <cstddef>
 
 class AbstractInstrumentProperty
 {
@@ -44,10 +45,20 @@ public:
 	virtual bool isEdited() const = 0;
 	virtual void clearParameters() = 0;
 
+	/// Content hash of the parameters compared by the property's operator==.
+	/// Equal properties always have the same hash, so it is used to bucket properties before comparing them.
+	std::size_t getHash() const;
+
 protected:
 	explicit AbstractInstrumentProperty(int num);
 
+	/// Must be called by every method which changes the compared parameters.
+	inline void invalidateHash() noexcept { isHashValid_ = false; }
+	virtual std::size_t calculateHash() const = 0;
+
 private:
 	int num_;
 	std::multiset<int> users_;
+	mutable std::size_t hash_;
+	mutable bool isHashValid_;
 };
@@ -72,30 +72,26 @@ int ArpeggioEffectIterator::end()
 }
 
 WavingEffectIterator::WavingEffectIterator(int period, int depth)
+	: period_(period), depth_(depth)
 {
-	for (int i = 0; i <= period; ++i) {
-		seq_.emplace_back(i * depth);
-	}
-	for (size_t i = static_cast<size_t>(period - 1); i > 0; --i) {
-		seq_.push_back(seq_.at(i));
-	}
-	size_t p2 = static_cast<size_t>(period) << 1;
-	for (size_t i = 0; i < p2; ++i) {
-		seq_.emplace_back(-seq_.at(i).data);
-	}
-
-	pos_ = static_cast<int>(seq_.size()) - 1;
+	pos_ = (period << 2) - 1;
 }
 
 InstrumentSequenceBaseUnit WavingEffectIterator::data() const
 {
-	return (hasEnded() ? InstrumentSequenceBaseUnit() : seq_.at(static_cast<size_t>(pos_)));
+	if (hasEnded()) return InstrumentSequenceBaseUnit();
+
+	// Rise to the peak at period_, fall to 0 at 2 * period_, then the negated half
+	int p2 = period_ << 1;
+	int pos = pos_ % p2;
+	int value = (pos <= period_ ? pos : p2 - pos) * depth_;
+	return InstrumentSequenceBaseUnit(pos_ < p2 ? value : -value);
 }
 
 int WavingEffectIterator::next()
 {
 	state_ = SequenceIteratorState::Run;
-	pos_ = (pos_ + 1) % static_cast<int>(seq_.size());
+	pos_ = (pos_ + 1) % (period_ << 2);
 	return pos_;
 }
 
@@ -114,31 +110,24 @@ int WavingEffectIterator::end()
 }
 
 NoteSlideEffectIterator::NoteSlideEffectIterator(int speed, int semitone)
-	: SequenceIteratorInterface<InstrumentSequenceBaseUnit>(0)
-{
-	int d = semitone * Note::SEMITONE_PITCH;
-	if (speed) {
-		int prev = 0;
-		for (int i = 0; i <= speed; ++i) {
-			int dif = d * i / speed - prev;
-			seq_.emplace_back(dif);
-			prev += dif;
-		}
-	}
-	else {
-		seq_.emplace_back(d);
-	}
+	: SequenceIteratorInterface<InstrumentSequenceBaseUnit>(0),
+	  speed_(speed),
+	  pitch_(semitone * Note::SEMITONE_PITCH)
+{
 }
 
 InstrumentSequenceBaseUnit NoteSlideEffectIterator::data() const
 {
-	return (hasEnded() ? InstrumentSequenceBaseUnit() : seq_.at(static_cast<size_t>(pos_)));
+	if (hasEnded()) return InstrumentSequenceBaseUnit();
+	if (!speed_) return InstrumentSequenceBaseUnit(pitch_);
+	int prev = pos_ ? pitch_ * (pos_ - 1) / speed_ : 0;
+	return InstrumentSequenceBaseUnit(pitch_ * pos_ / speed_ - prev);
 }
 
 int NoteSlideEffectIterator::next()
 {			
 	if (!hasEnded()) {
-		if (state_ == SequenceIteratorState::NotBegin || ++pos_ < static_cast<int>(seq_.size())) {
+		if (state_ == SequenceIteratorState::NotBegin || ++pos_ <= speed_) {
 			state_ = SequenceIteratorState::Run;
 		}
 		else {
@@ -24,7 +24,6 @@
  */
 
 #pragma once
-#include <vector>
 #include "sequence_iterator_interface.hpp"
 #include "sequence_property.hpp"
 
@@ -59,7 +58,8 @@ public:
 	int end() override;
 
 private:
-	std::vector<InstrumentSequenceBaseUnit> seq_;
+	// Triangle wave of 4 * period_ steps, computed on the fly
+	int period_, depth_;
 };
 
 class NoteSlideEffectIterator : public SequenceIteratorInterface<InstrumentSequenceBaseUnit>
@@ -76,7 +76,8 @@ public:
 	int end() override;
 
 private:
-	std::vector<InstrumentSequenceBaseUnit> seq_;
+	// Pitch differences at each of (speed_ + 1) steps, computed on the fly
+	int speed_, pitch_;
 };
 
 class XVolumeSlideEffectIterator : public SequenceIteratorInterface<InstrumentSequenceBaseUnit>
@@ -24,6 +24,7 @@
  */
 
 #include "envelope_fm.hpp"
+#include "utils.hpp"
 
 namespace
 {
@@ -94,6 +95,7 @@ bool EnvelopeFM::getOperatorEnabled(int num) const
 void EnvelopeFM::setOperatorEnabled(int num, bool enabled)
 {
 	isEnabledOp_.set(num, enabled);
+	invalidateHash();
 }
 
 int EnvelopeFM::getParameterValue(FMEnvelopeParameter param) const
@@ -104,6 +106,7 @@ int EnvelopeFM::getParameterValue(FMEnvelopeParameter param) const
 void EnvelopeFM::setParameterValue(FMEnvelopeParameter param, int value)
 {
 	params_.at(param) = value;
+	invalidateHash();
 }
 
 bool EnvelopeFM::isEdited() const
@@ -115,4 +118,13 @@ void EnvelopeFM::clearParameters()
 {
 	params_ = DEF_PARAMS;
 	isEnabledOp_.set();
+	invalidateHash();
+}
+
+std::size_t EnvelopeFM::calculateHash() const
+{
+	// Visit the parameters in the fixed order of the default table
+	std::size_t seed = isEnabledOp_.to_ulong();
+	for (const auto& pair : DEF_PARAMS) utils::hashCombine(seed, params_.at(pair.first));
+	return seed;
 }
@@ -63,6 +63,9 @@ public:
 	bool isEdited() const override;
 	void clearParameters() override;
 
+protected:
+	std::size_t calculateHash() const override;
+
 private:
 	std::unordered_map<FMEnvelopeParameter, int> params_;
 	std::bitset<4> isEnabledOp_;
@@ -24,6 +24,7 @@
  */
 
 #include "instrument.hpp"
+#include <unordered_set>
 #include "instruments_manager.hpp"
 #include "utils.hpp"
 
@@ -173,6 +174,11 @@ AbstractInstrument* InstrumentFM::clone()
 	return new InstrumentFM(*this);
 }
 
+size_t InstrumentFM::getFootprint() const
+{
+	return sizeof(InstrumentFM) + name_.capacity();
+}
+
 int InstrumentFM::getEnvelopeParameter(FMEnvelopeParameter param) const
 {
 	return owner_->getEnvelopeFMParameter(envNum_, param);
@@ -390,6 +396,11 @@ AbstractInstrument* InstrumentSSG::clone()
 	return new InstrumentSSG(*this);
 }
 
+size_t InstrumentSSG::getFootprint() const
+{
+	return sizeof(InstrumentSSG) + name_.capacity();
+}
+
 std::vector<SSGWaveformUnit> InstrumentSSG::getWaveformSequence() const
 {
 	return owner_->getWaveformSSGSequence(wfNum_);
@@ -521,6 +532,11 @@ AbstractInstrument* InstrumentADPCM::clone()
 	return new InstrumentADPCM(*this);
 }
 
+size_t InstrumentADPCM::getFootprint() const
+{
+	return sizeof(InstrumentADPCM) + name_.capacity() + getRawSampleBuffer()->size();
+}
+
 int InstrumentADPCM::getSampleRootKeyNumber() const
 {
 	return owner_->getSampleADPCMRootKeyNumber(sampNum_);
@@ -551,6 +567,11 @@ std::vector<uint8_t> InstrumentADPCM::getRawSample() const
 	return owner_->getSampleADPCMRawSample(sampNum_);
 }
 
+SampleADPCMBuffer InstrumentADPCM::getRawSampleBuffer() const
+{
+	return owner_->getSampleADPCMRawSampleBuffer(sampNum_);
+}
+
 size_t InstrumentADPCM::getSampleStartAddress() const
 {
 	return owner_->getSampleADPCMStartAddress(sampNum_);
@@ -663,6 +684,18 @@ AbstractInstrument* InstrumentDrumkit::clone()
 	return new InstrumentDrumkit(*this);
 }
 
+size_t InstrumentDrumkit::getFootprint() const
+{
+	size_t size = sizeof(InstrumentDrumkit) + name_.capacity()
+				  + kit_.size() * (sizeof(std::pair<const int, KitProperty>) + 2 * sizeof(void*));
+	std::unordered_set<int> samples;
+	for (const auto& pair : kit_) {
+		if (samples.insert(pair.second.sampNum).second)
+			size += owner_->getSampleADPCMRawSampleBuffer(pair.second.sampNum)->size();
+	}
+	return size;
+}
+
 std::vector<int> InstrumentDrumkit::getAssignedKeys() const
 {
 	return utils::getMapKeys(kit_);
@@ -719,6 +752,11 @@ std::vector<uint8_t> InstrumentDrumkit::getRawSample(int key) const
 	return owner_->getSampleADPCMRawSample(kit_.at(key).sampNum);
 }
 
+SampleADPCMBuffer InstrumentDrumkit::getRawSampleBuffer(int key) const
+{
+	return owner_->getSampleADPCMRawSampleBuffer(kit_.at(key).sampNum);
+}
+
 size_t InstrumentDrumkit::getSampleStartAddress(int key) const
 {
 	return owner_->getSampleADPCMStartAddress(kit_.at(key).sampNum);
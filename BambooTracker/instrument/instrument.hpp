@@ -33,6 +33,7 @@
 #include "lfo_fm.hpp"
 #include "sequence_property.hpp"
 #include "sample_repeat.hpp"
+#include "sample_adpcm_pool.hpp"
 #include "instrument_property_defs.hpp"
 #include "enum_hash.hpp"
 #include "bamboo_tracker_defs.hpp"
@@ -54,6 +55,8 @@ public:
 	inline void setName(const std::string& name) { name_ = name; }
 	bool isRegisteredWithManager() const;
 	virtual AbstractInstrument* clone() = 0;
+	/// Approximate bytes of the instrument and of the ADPCM samples it refers to.
+	virtual size_t getFootprint() const = 0;
 
 protected:
 	InstrumentsManager* owner_;
@@ -72,6 +75,7 @@ class InstrumentFM final : public AbstractInstrument
 public:
 	InstrumentFM(int number, const std::string& name, InstrumentsManager* owner);
 	AbstractInstrument* clone() override;
+	size_t getFootprint() const override;
 
 	inline void setEnvelopeNumber(int n) noexcept { envNum_ = n; }
 	inline int getEnvelopeNumber() const noexcept { return envNum_; }
@@ -147,6 +151,7 @@ class InstrumentSSG final : public AbstractInstrument
 public:
 	InstrumentSSG(int number, const std::string& name, InstrumentsManager* owner);
 	AbstractInstrument* clone() override;
+	size_t getFootprint() const override;
 
 	inline void setWaveformEnabled(bool enabled) noexcept { wfEnabled_ = enabled; }
 	inline bool getWaveformEnabled() const noexcept { return wfEnabled_; }
@@ -214,6 +219,7 @@ class InstrumentADPCM final : public AbstractInstrument
 public:
 	InstrumentADPCM(int number, const std::string& name, InstrumentsManager* owner);
 	AbstractInstrument* clone() override;
+	size_t getFootprint() const override;
 
 	inline void setSampleNumber(int n) noexcept { sampNum_ = n; }
 	inline int getSampleNumber() const noexcept { return sampNum_; }
@@ -223,6 +229,7 @@ public:
 	SampleRepeatFlag getSampleRepeatFlag() const;
 	SampleRepeatRange getSampleRepeatRange() const;
 	std::vector<uint8_t> getRawSample() const;
+	SampleADPCMBuffer getRawSampleBuffer() const;
 	size_t getSampleStartAddress() const;
 	size_t getSampleStopAddress() const;
 
@@ -282,6 +289,7 @@ class InstrumentDrumkit final : public AbstractInstrument
 public:
 	InstrumentDrumkit(int number, const std::string& name, InstrumentsManager* owner);
 	AbstractInstrument* clone() override;
+	size_t getFootprint() const override;
 
 	std::vector<int> getAssignedKeys() const;
 
@@ -295,6 +303,7 @@ public:
 	SampleRepeatFlag getSampleRepeatFlag(int key) const;
 	SampleRepeatRange getSampleRepeatRange(int key) const;
 	std::vector<uint8_t> getRawSample(int key) const;
+	SampleADPCMBuffer getRawSampleBuffer(int key) const;
 	size_t getSampleStartAddress(int key) const;
 	size_t getSampleStopAddress(int key) const;
 
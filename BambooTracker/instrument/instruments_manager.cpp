@@ -788,7 +788,6 @@ int InstrumentsManager::findFirstFreeInstrument() const
 std::unordered_map<int, int> InstrumentsManager::getDuplicateInstrumentMap() const
 {
 	std::unordered_map<int, int> dupMap;
-	std::vector<int> idcs = getInstrumentIndices();
 	static const std::unordered_map<InstrumentType,
 			bool (InstrumentsManager::*)(std::shared_ptr<AbstractInstrument>,
 										 std::shared_ptr<AbstractInstrument>) const> eqCheck = {
@@ -797,20 +796,40 @@ std::unordered_map<int, int> InstrumentsManager::getDuplicateInstrumentMap() con
 	{ InstrumentType::ADPCM, &InstrumentsManager::equalPropertiesADPCM },
 	{ InstrumentType::Drumkit, &InstrumentsManager::equalPropertiesDrumkit }
 };
+	static const std::unordered_map<InstrumentType,
+			size_t (InstrumentsManager::*)(std::shared_ptr<AbstractInstrument>) const> hashCalc = {
+	{ InstrumentType::FM, &InstrumentsManager::hashPropertiesFM },
+	{ InstrumentType::SSG, &InstrumentsManager::hashPropertiesSSG },
+	{ InstrumentType::ADPCM, &InstrumentsManager::hashPropertiesADPCM },
+	{ InstrumentType::Drumkit, &InstrumentsManager::hashPropertiesDrumkit }
+};
+
+	// Equal instruments always fall into the same bucket,
+	// so only instruments in a bucket are compared in depth
+	std::unordered_map<size_t, std::vector<int>> buckets;
+	for (const int idx : getInstrumentIndices()) {
+		const std::shared_ptr<AbstractInstrument>& inst = insts_[idx];
+		size_t hash = (this->*hashCalc.at(inst->getType()))(inst);
+		utils::hashCombine(hash, static_cast<int>(inst->getType()));
+		buckets[hash].push_back(idx);
+	}
 
-	for (size_t i = 0; i < idcs.size(); ++i) {
-		int baseIdx = idcs[i];
-		std::shared_ptr<AbstractInstrument> base = insts_[baseIdx];
-
-		for (size_t j = i + 1; j < idcs.size();) {
-			int tgtIdx = idcs[j];
-			std::shared_ptr<AbstractInstrument> tgt = insts_[tgtIdx];
-			if (base->getType() == tgt->getType() && (this->*eqCheck.at(base->getType()))(base, tgt)) {
-				dupMap[tgtIdx] = baseIdx;
-				idcs.erase(idcs.begin() + j);
-				continue;
+	for (auto& pair : buckets) {
+		std::vector<int>& idcs = pair.second;
+		for (size_t i = 0; i < idcs.size(); ++i) {
+			int baseIdx = idcs[i];
+			std::shared_ptr<AbstractInstrument> base = insts_[baseIdx];
+
+			for (size_t j = i + 1; j < idcs.size();) {
+				int tgtIdx = idcs[j];
+				std::shared_ptr<AbstractInstrument> tgt = insts_[tgtIdx];
+				if (base->getType() == tgt->getType() && (this->*eqCheck.at(base->getType()))(base, tgt)) {
+					dupMap[tgtIdx] = baseIdx;
+					idcs.erase(idcs.begin() + j);
+					continue;
+				}
+				++j;
 			}
-			++j;
 		}
 	}
 
@@ -1402,6 +1421,30 @@ bool InstrumentsManager::equalPropertiesFM(std::shared_ptr<AbstractInstrument> a
 	return true;
 }
 
+/// Hash consistent with equalPropertiesFM.
+/// Pan is left out because it is compared only when the first instrument enables it.
+size_t InstrumentsManager::hashPropertiesFM(std::shared_ptr<AbstractInstrument> inst) const
+{
+	auto fm = std::dynamic_pointer_cast<InstrumentFM>(inst);
+
+	size_t seed = envFM_[fm->getEnvelopeNumber()]->getHash();
+	utils::hashCombine(seed, fm->getLFOEnabled());
+	if (fm->getLFOEnabled()) utils::hashCombine(seed, lfoFM_[fm->getLFONumber()]->getHash());
+	for (auto& pair : opSeqFM_) {
+		bool enabled = fm->getOperatorSequenceEnabled(pair.first);
+		utils::hashCombine(seed, enabled);
+		if (enabled) utils::hashCombine(seed, pair.second[fm->getOperatorSequenceNumber(pair.first)]->getHash());
+	}
+	for (auto& type : FM_OP_TYPES) {
+		utils::hashCombine(seed, fm->getArpeggioEnabled(type));
+		if (fm->getArpeggioEnabled(type)) utils::hashCombine(seed, arpFM_[fm->getArpeggioNumber(type)]->getHash());
+		utils::hashCombine(seed, fm->getPitchEnabled(type));
+		if (fm->getPitchEnabled(type)) utils::hashCombine(seed, ptFM_[fm->getPitchNumber(type)]->getHash());
+		utils::hashCombine(seed, fm->getEnvelopeResetEnabled(type));
+	}
+	return seed;
+}
+
 //----- SSG methods -----
 void InstrumentsManager::setInstrumentSSGWaveformEnabled(int instNum, bool enabled)
 {
@@ -1981,6 +2024,25 @@ bool InstrumentsManager::equalPropertiesSSG(std::shared_ptr<AbstractInstrument>
 	return true;
 }
 
+/// Hash consistent with equalPropertiesSSG.
+size_t InstrumentsManager::hashPropertiesSSG(std::shared_ptr<AbstractInstrument> inst) const
+{
+	auto ssg = std::dynamic_pointer_cast<InstrumentSSG>(inst);
+
+	size_t seed = 0;
+	utils::hashCombine(seed, ssg->getWaveformEnabled());
+	if (ssg->getWaveformEnabled()) utils::hashCombine(seed, wfSSG_[ssg->getWaveformNumber()]->getHash());
+	utils::hashCombine(seed, ssg->getToneNoiseEnabled());
+	if (ssg->getToneNoiseEnabled()) utils::hashCombine(seed, tnSSG_[ssg->getToneNoiseNumber()]->getHash());
+	utils::hashCombine(seed, ssg->getEnvelopeEnabled());
+	if (ssg->getEnvelopeEnabled()) utils::hashCombine(seed, envSSG_[ssg->getEnvelopeNumber()]->getHash());
+	utils::hashCombine(seed, ssg->getArpeggioEnabled());
+	if (ssg->getArpeggioEnabled()) utils::hashCombine(seed, arpSSG_[ssg->getArpeggioNumber()]->getHash());
+	utils::hashCombine(seed, ssg->getPitchEnabled());
+	if (ssg->getPitchEnabled()) utils::hashCombine(seed, ptSSG_[ssg->getPitchNumber()]->getHash());
+	return seed;
+}
+
 //----- ADPCM methods -----
 void InstrumentsManager::setInstrumentADPCMSample(int instNum, int sampNum)
 {
@@ -2043,12 +2105,14 @@ SampleRepeatRange InstrumentsManager::getSampleADPCMRepeatRange(int sampNum) con
 
 void InstrumentsManager::storeSampleADPCMRawSample(int sampNum, const std::vector<uint8_t>& sample)
 {
-	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(sample);
+	if (sample.empty()) return;
+	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(sampPoolADPCM_.intern(sample));
 }
 
 void InstrumentsManager::storeSampleADPCMRawSample(int sampNum, std::vector<uint8_t>&& sample)
 {
-	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(sample);
+	if (sample.empty()) return;
+	sampADPCM_.at(static_cast<size_t>(sampNum))->storeSample(sampPoolADPCM_.intern(std::move(sample)));
 }
 
 void InstrumentsManager::clearSampleADPCMRawSample(int sampNum)
@@ -2061,6 +2125,12 @@ std::vector<uint8_t> InstrumentsManager::getSampleADPCMRawSample(int sampNum) co
 	return sampADPCM_.at(static_cast<size_t>(sampNum))->getSamples();
 }
 
+/// Shared payload without copying. Samples with the same payload share the buffer.
+SampleADPCMBuffer InstrumentsManager::getSampleADPCMRawSampleBuffer(int sampNum) const
+{
+	return sampADPCM_.at(static_cast<size_t>(sampNum))->getSampleBuffer();
+}
+
 void InstrumentsManager::setSampleADPCMStartAddress(int sampNum, size_t addr)
 {
 	sampADPCM_.at(static_cast<size_t>(sampNum))->setStartAddress(addr);
@@ -2577,6 +2647,22 @@ bool InstrumentsManager::equalPropertiesADPCM(std::shared_ptr<AbstractInstrument
 	return true;
 }
 
+/// Hash consistent with equalPropertiesADPCM.
+/// Pan is left out because it is compared only when the first instrument enables it.
+size_t InstrumentsManager::hashPropertiesADPCM(std::shared_ptr<AbstractInstrument> inst) const
+{
+	auto adpcm = std::dynamic_pointer_cast<InstrumentADPCM>(inst);
+
+	size_t seed = sampADPCM_[adpcm->getSampleNumber()]->getHash();
+	utils::hashCombine(seed, adpcm->getEnvelopeEnabled());
+	if (adpcm->getEnvelopeEnabled()) utils::hashCombine(seed, envADPCM_[adpcm->getEnvelopeNumber()]->getHash());
+	utils::hashCombine(seed, adpcm->getArpeggioEnabled());
+	if (adpcm->getArpeggioEnabled()) utils::hashCombine(seed, arpADPCM_[adpcm->getArpeggioNumber()]->getHash());
+	utils::hashCombine(seed, adpcm->getPitchEnabled());
+	if (adpcm->getPitchEnabled()) utils::hashCombine(seed, ptADPCM_[adpcm->getPitchNumber()]->getHash());
+	return seed;
+}
+
 //----- Drumkit methods -----
 void InstrumentsManager::setInstrumentDrumkitSamplesEnabled(int instNum, int key, bool enabled)
 {
@@ -2643,3 +2729,20 @@ bool InstrumentsManager::equalPropertiesDrumkit(std::shared_ptr<AbstractInstrume
 
 	return true;
 }
+
+/// Hash consistent with equalPropertiesDrumkit.
+size_t InstrumentsManager::hashPropertiesDrumkit(std::shared_ptr<AbstractInstrument> inst) const
+{
+	auto kit = std::dynamic_pointer_cast<InstrumentDrumkit>(inst);
+
+	std::vector<int> keys = kit->getAssignedKeys();
+	std::sort(keys.begin(), keys.end());
+	size_t seed = keys.size();
+	for (const int& key : keys) {
+		utils::hashCombine(seed, key);
+		utils::hashCombine(seed, sampADPCM_[kit->getSampleNumber(key)]->getHash());
+		utils::hashCombine(seed, kit->getPitch(key));
+		utils::hashCombine(seed, kit->getPan(key));
+	}
+	return seed;
+}
@@ -195,6 +195,7 @@ private:
 	std::array<std::shared_ptr<InstrumentSequenceProperty<PanUnit>>, 128> panFM_;
 
 	bool equalPropertiesFM(std::shared_ptr<AbstractInstrument> a, std::shared_ptr<AbstractInstrument> b) const;
+	size_t hashPropertiesFM(std::shared_ptr<AbstractInstrument> inst) const;
 
 	//----- SSG methods -----
 public:
@@ -310,6 +311,7 @@ private:
 	std::array<std::shared_ptr<InstrumentSequenceProperty<PitchUnit>>, 128> ptSSG_;
 
 	bool equalPropertiesSSG(std::shared_ptr<AbstractInstrument> a, std::shared_ptr<AbstractInstrument> b) const;
+	size_t hashPropertiesSSG(std::shared_ptr<AbstractInstrument> inst) const;
 
 	//----- ADPCM methods -----
 public:
@@ -328,6 +330,7 @@ public:
 	void storeSampleADPCMRawSample(int sampNum, std::vector<uint8_t>&& sample);
 	void clearSampleADPCMRawSample(int sampNum);
 	std::vector<uint8_t> getSampleADPCMRawSample(int sampNum) const;
+	SampleADPCMBuffer getSampleADPCMRawSampleBuffer(int sampNum) const;
 	void setSampleADPCMStartAddress(int sampNum, size_t addr);
 	size_t getSampleADPCMStartAddress(int sampNum) const;
 	void setSampleADPCMStopAddress(int sampNum, size_t addr);
@@ -424,12 +427,14 @@ public:
 
 private:
 	std::array<std::shared_ptr<SampleADPCM>, 128> sampADPCM_;
+	SampleADPCMPool sampPoolADPCM_;
 	std::array<std::shared_ptr<InstrumentSequenceProperty<ADPCMEnvelopeUnit>>, 128> envADPCM_;
 	std::array<std::shared_ptr<InstrumentSequenceProperty<ArpeggioUnit>>, 128> arpADPCM_;
 	std::array<std::shared_ptr<InstrumentSequenceProperty<PitchUnit>>, 128> ptADPCM_;
 	std::array<std::shared_ptr<InstrumentSequenceProperty<PanUnit>>, 128> panADPCM_;
 
 	bool equalPropertiesADPCM(std::shared_ptr<AbstractInstrument> a, std::shared_ptr<AbstractInstrument> b) const;
+	size_t hashPropertiesADPCM(std::shared_ptr<AbstractInstrument> inst) const;
 
 	//----- Drumkit methods -----
 public:
@@ -443,4 +448,5 @@ public:
 
 private:
 	bool equalPropertiesDrumkit(std::shared_ptr<AbstractInstrument> a, std::shared_ptr<AbstractInstrument> b) const;
+	size_t hashPropertiesDrumkit(std::shared_ptr<AbstractInstrument> inst) const;
 };
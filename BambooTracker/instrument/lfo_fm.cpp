@@ -24,6 +24,7 @@
  */
 
 #include "lfo_fm.hpp"
+#include "utils.hpp"
 
 namespace
 {
@@ -55,6 +56,7 @@ std::unique_ptr<LFOFM> LFOFM::clone()
 void LFOFM::setParameterValue(FMLFOParameter param, int value)
 {
 	params_.at(param) = value;
+	invalidateHash();
 }
 
 int LFOFM::getParameterValue(FMLFOParameter param) const
@@ -70,4 +72,13 @@ bool LFOFM::isEdited() const
 void LFOFM::clearParameters()
 {
 	params_ = DEF_PARAMS;
+	invalidateHash();
+}
+
+std::size_t LFOFM::calculateHash() const
+{
+	// Visit the parameters in the fixed order of the default table
+	std::size_t seed = 0;
+	for (const auto& pair : DEF_PARAMS) utils::hashCombine(seed, params_.at(pair.first));
+	return seed;
 }
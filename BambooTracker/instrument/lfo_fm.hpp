@@ -52,6 +52,9 @@ public:
 	bool isEdited() const override;
 	void clearParameters() override;
 
+protected:
+	std::size_t calculateHash() const override;
+
 private:
 	std::unordered_map<FMLFOParameter, int> params_;
 };
@@ -25,11 +25,18 @@
 
 #include "sample_adpcm.hpp"
 #include <algorithm>
+#include "utils.hpp"
 
 namespace
 {
 constexpr int DEF_RT_DELTAN_ = 0x49cd;	// 16000Hz
 constexpr bool DEF_REPET_ = false;
+
+const SampleADPCMBuffer& emptySample()
+{
+	static const SampleADPCMBuffer EMPTY = std::make_shared<const std::vector<uint8_t>>(1);
+	return EMPTY;
+}
 }
 
 SampleADPCM::SampleADPCM(int num)
@@ -40,7 +47,8 @@ SampleADPCM::SampleADPCM(int num)
 
 bool operator==(const SampleADPCM& a, const SampleADPCM& b) {
 	return (a.rootKeyNum_ == b.rootKeyNum_ && a.rootDeltaN_ == b.rootDeltaN_
-			&& a.isRepeated_ == b.isRepeated_ && a.sample_ == b.sample_);
+			&& a.isRepeated_ == b.isRepeated_
+			&& (a.sample_ == b.sample_ || *a.sample_ == *b.sample_));
 }
 
 std::unique_ptr<SampleADPCM> SampleADPCM::clone()
@@ -54,8 +62,9 @@ void SampleADPCM::clearSample()
 {
 	startAddress_ = 0;
 	stopAddress_ = 0;
-	sample_ = std::vector<uint8_t>(1);
-	repeatRange_ = SampleRepeatRange(0, (sample_.size() - 1) >> 5);	// By 32 bytes
+	sample_ = emptySample();
+	repeatRange_ = SampleRepeatRange(0, (sample_->size() - 1) >> 5);	// By 32 bytes
+	invalidateHash();
 }
 
 bool SampleADPCM::isEdited() const
@@ -63,8 +72,8 @@ bool SampleADPCM::isEdited() const
 	if (rootKeyNum_ != DEF_ROOT_KEY
 			|| rootDeltaN_ != DEF_RT_DELTAN_
 			|| isRepeated_ != DEF_REPET_
-			|| sample_.size() != 1
-			|| sample_.front() != 0)
+			|| sample_->size() != 1
+			|| sample_->front() != 0)
 		return true;
 	return false;
 }
@@ -80,7 +89,7 @@ void SampleADPCM::clearParameters()
 
 bool SampleADPCM::setRepeatRange(const SampleRepeatRange& range) noexcept
 {
-	if (sample_.size() <= range.last()) {
+	if (sample_->size() <= range.last()) {
 		return false;
 	}
 
@@ -88,22 +97,22 @@ bool SampleADPCM::setRepeatRange(const SampleRepeatRange& range) noexcept
 	return true;
 }
 
-bool SampleADPCM::storeSample(const std::vector<uint8_t>& sample)
+bool SampleADPCM::storeSample(const SampleADPCMBuffer& sample)
 {
-	if (sample.empty()) return false;
+	if (!sample || sample->empty()) return false;
 
-	repeatRange_ = repeatRange_.clampLast((sample.size() - 1) >> 5);	// By 32 bytes
+	repeatRange_ = repeatRange_.clampLast((sample->size() - 1) >> 5);	// By 32 bytes
 	sample_ = sample;
+	invalidateHash();
 
 	return true;
 }
 
-bool SampleADPCM::storeSample(std::vector<uint8_t>&& sample)
+std::size_t SampleADPCM::calculateHash() const
 {
-	if (sample.empty()) return false;
-
-	repeatRange_ = repeatRange_.clampLast((sample.size() - 1) >> 5);	// By 32 bytes
-	sample_ = std::move(sample);
-
-	return true;
+	std::size_t seed = SampleADPCMPool::calculateHash(*sample_);
+	utils::hashCombine(seed, rootKeyNum_);
+	utils::hashCombine(seed, rootDeltaN_);
+	utils::hashCombine(seed, isRepeated_);
+	return seed;
 }
@@ -31,6 +31,7 @@
 #include <cmath>
 #include "abstract_instrument_property.hpp"
 #include "sample_repeat.hpp"
+#include "sample_adpcm_pool.hpp"
 
 class SampleADPCM final : public AbstractInstrumentProperty
 {
@@ -42,12 +43,24 @@ public:
 
 	std::unique_ptr<SampleADPCM> clone();
 
-	void setRootKeyNumber(int n) noexcept { rootKeyNum_ = n; }
+	void setRootKeyNumber(int n) noexcept
+	{
+		rootKeyNum_ = n;
+		invalidateHash();
+	}
 	int getRootKeyNumber() const noexcept {return rootKeyNum_; }
-	void setRootDeltaN(int dn) noexcept { rootDeltaN_ = dn; }
+	void setRootDeltaN(int dn) noexcept
+	{
+		rootDeltaN_ = dn;
+		invalidateHash();
+	}
 	int getRootDeltaN() const noexcept { return rootDeltaN_; }
 
-	void setRepeatEnabled(bool enabled) noexcept { isRepeated_ = enabled; }
+	void setRepeatEnabled(bool enabled) noexcept
+	{
+		isRepeated_ = enabled;
+		invalidateHash();
+	}
 	bool isRepeatable() const noexcept { return isRepeated_; }
 	SampleRepeatFlag getRepeatFlag() const noexcept {
 		if (!isRepeated_) return SampleRepeatFlag::Disabled;
@@ -56,7 +69,7 @@ public:
 		if (repeatRange_.first() != 0) {
 			flags |= SampleRepeatFlag::ShouldRewriteStart;
 		}
-		if (repeatRange_.last() != sample_.size() - 1) {
+		if (repeatRange_.last() != sample_->size() - 1) {
 			flags |= SampleRepeatFlag::ShouldRewriteStop;
 		}
 		return static_cast<SampleRepeatFlag>(flags);
@@ -64,9 +77,10 @@ public:
 	bool setRepeatRange(const SampleRepeatRange& range) noexcept;
 	SampleRepeatRange getRepeatRange() const noexcept { return repeatRange_; }
 
-	bool storeSample(const std::vector<uint8_t>& sample);
-	bool storeSample(std::vector<uint8_t>&& sample);
-	std::vector<uint8_t> getSamples() const { return sample_; }
+	/// Payload should be interned by the owner's SampleADPCMPool.
+	bool storeSample(const SampleADPCMBuffer& sample);
+	const std::vector<uint8_t>& getSamples() const noexcept { return *sample_; }
+	const SampleADPCMBuffer& getSampleBuffer() const noexcept { return sample_; }
 	void clearSample();
 	void setStartAddress(size_t addr) noexcept { startAddress_ = addr; }
 	size_t getStartAddress() const noexcept { return startAddress_; }
@@ -83,11 +97,14 @@ public:
 		return static_cast<int>(std::round((rate << 16) / 55500.));
 	}
 
+protected:
+	std::size_t calculateHash() const override;
+
 private:
 	int rootKeyNum_, rootDeltaN_;
 	bool isRepeated_;
 	/// Range (first byte, last byte)
 	SampleRepeatRange repeatRange_;
-	std::vector<uint8_t> sample_;
+	SampleADPCMBuffer sample_;
 	size_t startAddress_, stopAddress_;
 };
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "sample_adpcm_pool.hpp"
+#include <string_view>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+namespace
+{
+constexpr size_t MIN_SWEEP_THRESHOLD = 256;
+}
+
+SampleADPCMPool::SampleADPCMPool()
+	: sweepThreshold_(MIN_SWEEP_THRESHOLD)
+{
+}
+
+SampleADPCMBuffer SampleADPCMPool::intern(const std::vector<uint8_t>& sample)
+{
+	size_t hash = calculateHash(sample);
+	if (SampleADPCMBuffer buf = find(hash, sample)) return buf;
+	return insert(hash, std::vector<uint8_t>(sample));
+}
+
+SampleADPCMBuffer SampleADPCMPool::intern(std::vector<uint8_t>&& sample)
+{
+	size_t hash = calculateHash(sample);
+	if (SampleADPCMBuffer buf = find(hash, sample)) return buf;
+	return insert(hash, std::move(sample));
+}
+
+size_t SampleADPCMPool::getLiveCount() const
+{
+	size_t cnt = 0;
+	for (const auto& pair : entries_) {
+		if (!pair.second.expired()) ++cnt;
+	}
+	return cnt;
+}
+
+size_t SampleADPCMPool::calculateHash(const std::vector<uint8_t>& sample)
+{
+	return std::hash<std::string_view>()(
+				std::string_view(reinterpret_cast<const char*>(sample.data()), sample.size()));
+}
+
+SampleADPCMBuffer SampleADPCMPool::find(size_t hash, const std::vector<uint8_t>& sample)
+{
+	auto range = entries_.equal_range(hash);
+	for (auto it = range.first; it != range.second;) {
+		if (SampleADPCMBuffer buf = it->second.lock()) {
+			if (*buf == sample) return buf;
+			++it;
+		}
+		else {
+			it = entries_.erase(it);
+		}
+	}
+	return nullptr;
+}
+
+SampleADPCMBuffer SampleADPCMPool::insert(size_t hash, std::vector<uint8_t>&& sample)
+{
+	// Not made by std::make_shared so that the payload is freed
+	// as soon as it is unused, regardless of the weak reference here
+	SampleADPCMBuffer buf(new std::vector<uint8_t>(std::move(sample)));
+	entries_.emplace(hash, buf);
+	if (entries_.size() > sweepThreshold_) sweep();
+	return buf;
+}
+
+void SampleADPCMPool::sweep()
+{
+	for (auto it = entries_.begin(); it != entries_.end();) {
+		if (it->second.expired()) it = entries_.erase(it);
+		else ++it;
+	}
+	sweepThreshold_ = std::max(MIN_SWEEP_THRESHOLD, entries_.size() * 2);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+/// Immutable raw ADPCM sample payload shared by sample properties.
+using SampleADPCMBuffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+/// Content-addressed store of raw ADPCM sample payloads.
+/// Identical payloads are interned to one shared buffer,
+/// which is released when the last owner drops it. Besides sample properties,
+/// OPNAController keeps the payloads placed in the DRAM until it stores other samples.
+class SampleADPCMPool
+{
+public:
+	SampleADPCMPool();
+
+	SampleADPCMBuffer intern(const std::vector<uint8_t>& sample);
+	SampleADPCMBuffer intern(std::vector<uint8_t>&& sample);
+
+	/// Number of payloads still referred to by some property.
+	size_t getLiveCount() const;
+
+	static size_t calculateHash(const std::vector<uint8_t>& sample);
+
+private:
+	std::unordered_multimap<size_t, std::weak_ptr<const std::vector<uint8_t>>> entries_;
+	size_t sweepThreshold_;
+
+	SampleADPCMBuffer find(size_t hash, const std::vector<uint8_t>& sample);
+	SampleADPCMBuffer insert(size_t hash, std::vector<uint8_t>&& sample);
+	void sweep();
+};
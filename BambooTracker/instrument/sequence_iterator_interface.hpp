@@ -25,6 +25,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include "fixed_block_pool.hpp"
+
 enum class SequenceType
 {
 	PlainSequence,
@@ -47,6 +50,10 @@ class SequenceIteratorInterface
 public:
 	virtual ~SequenceIteratorInterface() = default;
 
+	// Iterators are replaced on the audio thread at each instrument change
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* ptr) noexcept { Pool::deallocate(ptr); }
+
 	static constexpr int END_SEQ_POS = -1;
 	int pos() const noexcept { return pos_; }
 	bool hasEnded() const noexcept { return pos_ == END_SEQ_POS; }
@@ -60,6 +67,9 @@ public:
 	virtual int release() = 0;
 	virtual int end() = 0;
 
+private:
+	using Pool = FixedBlockPool<128, 1024>;
+
 protected:
 	explicit SequenceIteratorInterface(int initPos = 0)
 		: pos_(initPos), state_(SequenceIteratorState::NotBegin) {}
@@ -256,8 +256,9 @@ LoopStack::StackItem::StackItem(const InstrumentSequenceLoop::Ptr& ptr)
 }
 
 LoopStack::LoopStack(const std::shared_ptr<InstrumentSequenceLoopRoot>& ptr)
-	: stack_{ StackItem(std::static_pointer_cast<InstrumentSequenceLoop>(ptr)) }
 {
+	stack_.reserve(POOLED_DEPTH_);
+	stack_.emplace_back(std::static_pointer_cast<InstrumentSequenceLoop>(ptr));
 }
 
 void LoopStack::clear()
@@ -27,11 +27,12 @@
 #include <vector>
 #include <memory>
 #include <map>
-#include <deque>
 #include <algorithm>
 #include <utility>
 #include "abstract_instrument_property.hpp"
 #include "sequence_iterator_interface.hpp"
+#include "fixed_block_pool.hpp"
+#include "utils.hpp"
 
 struct InstrumentSequenceBaseUnit
 {
@@ -208,7 +209,9 @@ private:
 
 		explicit StackItem(const InstrumentSequenceLoop::Ptr& ptr);
 	};
-	std::deque<StackItem> stack_;
+	static constexpr size_t POOLED_DEPTH_ = 8;
+	using Pool = FixedBlockPool<sizeof(StackItem) * POOLED_DEPTH_, 1024>;
+	std::vector<StackItem, FixedBlockPoolAllocator<StackItem, Pool>> stack_;
 
 public:
 	explicit LoopStack(const std::shared_ptr<InstrumentSequenceLoopRoot>& ptr);
@@ -287,7 +290,11 @@ public:
 		return clone;
 	}
 
-	inline void setType(SequenceType type) noexcept { type_ = type; }
+	inline void setType(SequenceType type) noexcept
+	{
+		type_ = type;
+		invalidateHash();
+	}
 	inline SequenceType getType() const noexcept { return type_; }
 
 	bool isEdited() const override
@@ -301,6 +308,7 @@ public:
 		seq_ = { DEF_UNIT_ };
 		loop_->clear();
 		release_.disable();
+		invalidateHash();
 	}
 
 	//***** Sequence *****
@@ -311,6 +319,7 @@ public:
 	void addSequenceUnit(const T& unit) {
 		seq_.push_back(unit);
 		loop_->extend();
+		invalidateHash();
 	}
 
 	void removeSequenceUnit()
@@ -319,9 +328,14 @@ public:
 		loop_->shrink();
 		if (release_.getBeginPos() == static_cast<int>(seq_.size()))
 			release_.disable();
+		invalidateHash();
 	}
 
-	void setSequenceUnit(int n, const T& unit) { seq_.at(static_cast<size_t>(n)) = unit; }
+	void setSequenceUnit(int n, const T& unit)
+	{
+		seq_.at(static_cast<size_t>(n)) = unit;
+		invalidateHash();
+	}
 
 	//***** Loop *****
 	inline InstrumentSequenceLoopRoot getLoopRoot() const { return *loop_; }
@@ -335,7 +349,11 @@ public:
 
 	//***** Release *****
 	InstrumentSequenceRelease getRelease() const noexcept { return release_; }
-	inline void setRelease(const InstrumentSequenceRelease& release) { release_ = release; }
+	inline void setRelease(const InstrumentSequenceRelease& release)
+	{
+		release_ = release;
+		invalidateHash();
+	}
 
 	class Iterator final : public SequenceIteratorInterface<T>
 	{
@@ -481,6 +499,18 @@ public:
 		return std::make_unique<Iterator>(this);
 	}
 
+protected:
+	/// Loops are left out since operator== compares them by identity.
+	/// Units are hashed by their data only, which is a part of their comparison.
+	std::size_t calculateHash() const override
+	{
+		std::size_t seed = static_cast<std::size_t>(type_);
+		for (const T& unit : seq_) utils::hashCombine(seed, unit.data);
+		utils::hashCombine(seed, static_cast<int>(release_.getType()));
+		utils::hashCombine(seed, release_.getBeginPos());
+		return seed;
+	}
+
 private:
 	const SequenceType DEF_TYPE_;
 	const T DEF_UNIT_;
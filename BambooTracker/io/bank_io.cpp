@@ -25,6 +25,7 @@
 
 #include "bank_io.hpp"
 #include <algorithm>
+#include <mutex>
 #include "file_io_error.hpp"
 #include "btb_io.hpp"
 #include "wopn_io.hpp"
@@ -74,7 +75,8 @@ BankIO::BankIO()
 
 BankIO& BankIO::getInstance()
 {
-	if (!instance_) instance_.reset(new BankIO);
+	static std::once_flag flag;
+	std::call_once(flag, [] { instance_.reset(new BankIO); });
 	return *instance_;
 }
 
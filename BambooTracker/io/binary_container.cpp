@@ -24,270 +24,355 @@
  */
 
 #include "binary_container.hpp"
+#include <cstddef>
 #include <algorithm>
-#include <iterator>
 #include <utility>
 #include <stdexcept>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace io
 {
+/// Read-only mapping of a whole file, unmapped on destruction.
+class BinaryContainer::MappedFile
+{
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline const uint8_t* data() const noexcept { return data_; }
+	inline size_type size() const noexcept { return size_; }
+
+private:
+	const uint8_t* data_;
+	size_type size_;
+};
+
+#ifdef _WIN32
+BinaryContainer::MappedFile::MappedFile(const std::string& path)
+	: data_(nullptr), size_(0)
+{
+	int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+	std::wstring wpath(static_cast<size_t>(std::max(len, 1)), L'\0');
+	if (!len || !MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], len))
+		throw std::runtime_error("Invalid file path: " + path);
+
+	HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open " + path);
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		throw std::runtime_error("Failed to open " + path);
+	}
+	size_ = static_cast<size_type>(size.QuadPart);
+	if (size_) {
+		// The view keeps the mapping alive after its handles are closed
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	if (size_ && !data_) throw std::runtime_error("Failed to map " + path);
+}
+
+BinaryContainer::MappedFile::~MappedFile()
+{
+	if (data_) UnmapViewOfFile(data_);
+}
+#else
+BinaryContainer::MappedFile::MappedFile(const std::string& path)
+	: data_(nullptr), size_(0)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) throw std::runtime_error("Failed to open " + path);
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		throw std::runtime_error("Failed to open " + path);
+	}
+	size_ = static_cast<size_type>(st.st_size);
+	if (size_) {
+		// The mapping stays valid after the file is closed
+		int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+		flags |= MAP_POPULATE;	// Loaders read the whole file, so fault it in at once
+#endif
+		void* addr = mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+		if (addr != MAP_FAILED) data_ = static_cast<const uint8_t*>(addr);
+	}
+	close(fd);
+	if (size_ && !data_) throw std::runtime_error("Failed to map " + path);
+}
+
+BinaryContainer::MappedFile::~MappedFile()
+{
+	if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+#endif
+
+//**************************************************
 BinaryContainer::BinaryContainer()
-	: isLE_(true)
+	: view_(nullptr),
+	  viewSize_(0),
+	  isLE_(true)
 {
 }
 
 BinaryContainer::BinaryContainer(const std::vector<uint8_t>& buf)
-	: isLE_(true)
+	: buf_(buf),
+	  view_(nullptr),
+	  viewSize_(0),
+	  isLE_(true)
 {
-	std::copy(buf.cbegin(), buf.cend(), std::back_inserter(buf_));
 }
 
 BinaryContainer::BinaryContainer(std::vector<uint8_t>&& buf)
-	: isLE_(true)
+	: buf_(std::move(buf)),
+	  view_(nullptr),
+	  viewSize_(0),
+	  isLE_(true)
 {
-	std::move(buf.begin(), buf.end(), std::back_inserter(buf_));
+}
+
+BinaryContainer BinaryContainer::mapFile(const std::string& path)
+{
+	BinaryContainer bc;
+	auto map = std::make_shared<const MappedFile>(path);
+	if (map->size()) {
+		bc.view_ = map->data();
+		bc.viewSize_ = map->size();
+		bc.map_ = std::move(map);
+	}
+	return bc;
+}
+
+void BinaryContainer::checkWritable() const
+{
+	if (map_) throw std::logic_error("Binary container of a mapped file is read-only");
 }
 
 void BinaryContainer::clear()
 {
+	map_.reset();
+	view_ = nullptr;
+	viewSize_ = 0;
 	buf_.clear();
 	buf_.shrink_to_fit();
 }
 
 void BinaryContainer::appendInt8(int8_t v)
 {
+	checkWritable();
 	buf_.push_back(static_cast<uint8_t>(v));
 }
 
 void BinaryContainer::appendUint8(uint8_t v)
 {
+	checkWritable();
 	buf_.push_back(v);
 }
 
 void BinaryContainer::appendInt16(int16_t v)
 {
-	append({
-			   static_cast<uint8_t>(0x00ff & v),
-			   static_cast<uint8_t>(v >> 8),
-		   });
+	append(v);
 }
 
 void BinaryContainer::appendUint16(uint16_t v)
 {
-	append({
-			   static_cast<uint8_t>(0x00ff & v),
-			   static_cast<uint8_t>(v >> 8),
-		   });
+	append(v);
 }
 
 void BinaryContainer::appendInt32(int32_t v)
 {
-	append({
-			   static_cast<uint8_t>(0x000000ff & v),
-			   static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			   static_cast<uint8_t>(0x00ff & (v >> 16)),
-			   static_cast<uint8_t>(v >> 24),
-		   });
+	append(v);
 }
 
 void BinaryContainer::appendUint32(uint32_t v)
 {
-	append({
-			   static_cast<uint8_t>(0x000000ff & v),
-			   static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			   static_cast<uint8_t>(0x00ff & (v >> 16)),
-			   static_cast<uint8_t>(v >> 24),
-		   });
+	append(v);
 }
 
 void BinaryContainer::appendChar(char c)
 {
+	checkWritable();
 	buf_.push_back(static_cast<uint8_t>(c));
 }
 
 void BinaryContainer::appendString(const std::string& str)
 {
-	std::copy(str.cbegin(), str.cend(), std::back_inserter(buf_));
+	checkWritable();
+	buf_.insert(buf_.end(), str.cbegin(), str.cend());
 }
 
 void BinaryContainer::appendArray(const uint8_t* array, size_type size)
 {
-	std::copy(array, array + size, std::back_inserter(buf_));
+	checkWritable();
+	buf_.insert(buf_.end(), array, array + size);
 }
 
 void BinaryContainer::appendVector(const std::vector<uint8_t>& vec)
 {
-	std::copy(vec.cbegin(), vec.cend(), std::back_inserter(buf_));
+	checkWritable();
+	buf_.insert(buf_.end(), vec.cbegin(), vec.cend());
 }
 
 void BinaryContainer::appendVector(std::vector<uint8_t>&& vec)
 {
-	std::move(vec.begin(), vec.end(), std::back_inserter(buf_));
+	checkWritable();
+	if (buf_.empty()) buf_ = std::move(vec);
+	else buf_.insert(buf_.end(), vec.cbegin(), vec.cend());
 }
 
 void BinaryContainer::appendBinaryContainer(const BinaryContainer& bc)
 {
-	std::copy(bc.cbegin(), bc.cend(), std::back_inserter(buf_));
+	checkWritable();
+	buf_.insert(buf_.end(), bc.begin(), bc.end());
 }
 
 void BinaryContainer::appendBinaryContainer(BinaryContainer&& bc)
 {
-	std::move(bc.begin(), bc.end(), std::back_inserter(buf_));
+	if (bc.map_) appendBinaryContainer(bc);
+	else appendVector(std::move(bc.buf_));
 }
 
 void BinaryContainer::writeInt8(size_type offset, int8_t v)
 {
+	checkWritable();
 	buf_.at(offset) = static_cast<uint8_t>(v);
 }
 
 void BinaryContainer::writeUint8(size_type offset, uint8_t v)
 {
+	checkWritable();
 	buf_.at(offset) = v;
 }
 
 void BinaryContainer::writeInt16(size_type offset, int16_t v)
 {
-	write(offset, {
-			  static_cast<uint8_t>(0x00ff & v),
-			  static_cast<uint8_t>(v >> 8),
-		  });
+	write(offset, v);
 }
 
 void BinaryContainer::writeUint16(size_type offset, uint16_t v)
 {
-	write(offset, {
-			  static_cast<uint8_t>(0x00ff & v),
-			  static_cast<uint8_t>(v >> 8),
-		  });
+	write(offset, v);
 }
 
 void BinaryContainer::writeInt32(size_type offset, int32_t v)
 {
-	write(offset, {
-			  static_cast<uint8_t>(0x000000ff & v),
-			  static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			  static_cast<uint8_t>(0x00ff & (v >> 16)),
-			  static_cast<uint8_t>(v >> 24),
-		  });
+	write(offset, v);
 }
 
 void BinaryContainer::writeUint32(size_type offset, uint32_t v)
 {
-	write(offset, {
-			  static_cast<uint8_t>(0x000000ff & v),
-			  static_cast<uint8_t>(0x0000ff & (v >> 8)),
-			  static_cast<uint8_t>(0x00ff & (v >> 16)),
-			  static_cast<uint8_t>(v >> 24),
-		  });
+	write(offset, v);
 }
 
 void BinaryContainer::writeChar(size_type offset, char c)
 {
+	checkWritable();
 	buf_.at(offset) = static_cast<uint8_t>(c);
 }
 
 void BinaryContainer::writeString(size_type offset, const std::string& str)
 {
-	if (buf_.size() <= offset || buf_.size() < offset + str.length())
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	std::copy(str.cbegin(), str.cend(), buf_.begin() + static_cast<int>(offset));
+	checkWritable();
+	checkRange(offset, str.length());
+	std::copy(str.cbegin(), str.cend(), buf_.begin() + static_cast<std::ptrdiff_t>(offset));
 }
 
 int8_t BinaryContainer::readInt8(size_type offset) const
 {
-	return static_cast<int8_t>(buf_.at(offset));
+	return static_cast<int8_t>(readUint8(offset));
 }
 
 uint8_t BinaryContainer::readUint8(size_type offset) const
 {
-	return static_cast<uint8_t>(buf_.at(offset));
+	checkRange(offset, 1);
+	return bytes()[offset];
 }
 
 int16_t BinaryContainer::readInt16(size_type offset) const
 {
-	std::vector<uint8_t> data = read(offset, 2);
-	return static_cast<int16_t>(data[0] | (data[1] << 8));
+	return read<int16_t>(offset);
 }
 
 uint16_t BinaryContainer::readUint16(size_type offset) const
 {
-	std::vector<uint8_t> data = read(offset, 2);
-	return static_cast<uint16_t>(data[0] | (data[1] << 8));
+	return read<uint16_t>(offset);
 }
 
 int32_t BinaryContainer::readInt32(size_type offset) const
 {
-	std::vector<uint8_t> data = read(offset, 4);
-	return static_cast<int32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
+	return read<int32_t>(offset);
 }
 
 uint32_t BinaryContainer::readUint32(size_type offset) const
 {
-	std::vector<uint8_t> data = read(offset, 4);
-	return static_cast<uint32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
+	return read<uint32_t>(offset);
 }
 
 char BinaryContainer::readChar(size_type offset) const
 {
-	return buf_.at(offset);
+	return static_cast<char>(readUint8(offset));
 }
 
 std::string BinaryContainer::readString(size_type offset, size_type length) const
 {
-	if (buf_.size() <= offset || buf_.size() < offset + length)
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	return std::string(buf_.begin() + static_cast<int>(offset), buf_.begin() + static_cast<int>(offset + length));
+	checkRange(offset, length);
+	const uint8_t* p = bytes() + offset;
+	return std::string(p, p + length);
 }
 
-BinaryContainer BinaryContainer::getSubcontainer(size_type offset, size_type length) const
+void BinaryContainer::readArray(size_type offset, uint8_t* array, size_type size) const
 {
-	if (buf_.size() <= offset || buf_.size() < offset + length)
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	BinaryContainer sub;
-	std::copy_n(buf_.begin() + static_cast<int>(offset), length, std::back_inserter(sub));
-	return sub;
+	checkRange(offset, size);
+	std::copy_n(bytes() + offset, size, array);
 }
 
-std::vector<uint8_t> BinaryContainer::toVector() const
+std::vector<uint8_t> BinaryContainer::readVector(size_type offset, size_type length) const
 {
-	std::vector<uint8_t> vec;
-	vec.reserve(buf_.size());
-	std::copy(buf_.cbegin(), buf_.cend(), std::back_inserter(vec));
-	return vec;
+	checkRange(offset, length);
+	const uint8_t* p = bytes() + offset;
+	return std::vector<uint8_t>(p, p + length);
 }
 
-void BinaryContainer::append(const std::vector<uint8_t>&& a)
+BinaryContainer BinaryContainer::getSubcontainer(size_type offset, size_type length) const
 {
-	if (isLE_)
-		std::copy(a.cbegin(), a.cend(), std::back_inserter(buf_));
-	else
-		std::reverse_copy(a.cbegin(), a.cend(), std::back_inserter(buf_));
+	if (!map_) return BinaryContainer(readVector(offset, length));
+
+	// Share the mapped file
+	checkRange(offset, length);
+	BinaryContainer bc;
+	bc.map_ = map_;
+	bc.view_ = view_ + offset;
+	bc.viewSize_ = length;
+	return bc;
 }
 
-void BinaryContainer::write(size_t offset, const std::vector<uint8_t>&& a)
+std::vector<uint8_t> BinaryContainer::toVector() const
 {
-	if (buf_.size() <= offset || buf_.size() < offset + a.size())
-		throw std::out_of_range("Invalid buffer range in binary container");
-
-	if (isLE_)
-		std::copy(a.cbegin(), a.cend(), buf_.begin() + static_cast<int>(offset));
-	else
-		std::reverse_copy(a.cbegin(), a.cend(), buf_.begin() + static_cast<int>(offset));
+	return std::vector<uint8_t>(begin(), end());
 }
 
-std::vector<uint8_t> BinaryContainer::read(size_type offset, size_type size) const
+void BinaryContainer::checkRange(size_type offset, size_type size) const
 {
-	if (buf_.size() <= offset || buf_.size() < offset + size)
+	if (this->size() <= offset || this->size() < offset + size)
 		throw std::out_of_range("Invalid buffer range in binary container");
-
-	std::vector<uint8_t> data;
-	if (isLE_)
-		std::copy(buf_.cbegin() + static_cast<int>(offset), buf_.cbegin() + static_cast<int>(offset + size), std::back_inserter(data));
-	else
-		std::reverse_copy(buf_.cbegin() + static_cast<int>(offset), buf_.cbegin() + static_cast<int>(offset + size), std::back_inserter(data));
-	return data;
 }
 }
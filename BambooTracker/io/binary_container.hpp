@@ -25,51 +25,68 @@
 
 #pragma once
 
-#include <deque>
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <memory>
+#include <iterator>
+#include <type_traits>
 
 namespace io
 {
 class BinaryContainer
 {
 public:
-	using container_type = std::deque<uint8_t>;
+	using container_type = std::vector<uint8_t>;
 	using value_type = container_type::value_type;
 	using size_type = container_type::size_type;
-	using iterator = container_type::iterator;
-	using const_iterator = container_type::const_iterator;
-	using reverse_iterator = container_type::reverse_iterator;
-	using const_reverse_iterator = container_type::const_reverse_iterator;
+	using iterator = uint8_t*;
+	using const_iterator = const uint8_t*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 	explicit BinaryContainer();
 	explicit BinaryContainer(const std::vector<uint8_t>& buf);
 	explicit BinaryContainer(std::vector<uint8_t>&& buf);
 
-	inline iterator begin() noexcept { return buf_.begin(); }
-	inline const_iterator begin() const noexcept { return buf_.begin(); }
+	/**
+	 * @brief Map a file into a read-only container without copying it.
+	 *        Reads and subcontainers refer to the mapped file directly.
+	 *        Modifications other than clear(), including taking a non-const iterator,
+	 *        throw std::logic_error.
+	 * @param path file path in UTF-8.
+	 * @return container of the file.
+	 * @throw std::runtime_error if the file cannot be mapped.
+	 */
+	static BinaryContainer mapFile(const std::string& path);
+	inline bool isMapped() const noexcept { return static_cast<bool>(map_); }
 
-	inline iterator end() noexcept { return buf_.end(); }
-	inline const_iterator end() const noexcept { return buf_.end(); }
+	inline iterator begin() { checkWritable(); return buf_.data(); }
+	inline const_iterator begin() const noexcept { return bytes(); }
 
-	inline const_iterator cbegin() const noexcept { return buf_.cbegin(); }
-	inline const_iterator cend() const noexcept { return buf_.cend(); }
+	inline iterator end() { checkWritable(); return buf_.data() + buf_.size(); }
+	inline const_iterator end() const noexcept { return bytes() + size(); }
 
-	inline reverse_iterator rbegin() noexcept { return buf_.rbegin(); }
-	inline const_reverse_iterator rbegin() const noexcept { return buf_.rbegin(); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
 
-	inline reverse_iterator rend() noexcept { return buf_.rend(); }
-	inline const_reverse_iterator rend() const noexcept { return buf_.rend(); }
+	inline reverse_iterator rbegin() { return reverse_iterator(end()); }
+	inline const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
 
-	inline const_reverse_iterator crbegin() const noexcept { return buf_.crbegin(); }
-	inline const_reverse_iterator crend() const noexcept { return buf_.crend(); }
+	inline reverse_iterator rend() { return reverse_iterator(begin()); }
+	inline const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	inline const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+	inline const_reverse_iterator crend() const noexcept { return rend(); }
 
 	inline void push_back(uint8_t v) { appendUint8(v); }
 
-	inline size_type size() const noexcept { return buf_.size(); }
+	inline size_type size() const noexcept { return map_ ? viewSize_ : buf_.size(); }
 	void clear();
-	inline void resize(size_type size) { buf_.resize(size); }
+	inline void resize(size_type size) { checkWritable(); buf_.resize(size); }
+	inline void reserve(size_type size) { checkWritable(); buf_.reserve(size); }
+
+	inline const uint8_t* data() const noexcept { return bytes(); }
 
 	inline void setEndian(bool isLittleEndian) noexcept { isLE_ = isLittleEndian; }
 	inline bool isLittleEndian() const noexcept { return isLE_; }
@@ -105,17 +122,58 @@ public:
 	uint32_t readUint32(size_type offset) const;
 	char readChar(size_type offset) const;
 	std::string readString(size_type offset, size_type length) const;
+	void readArray(size_type offset, uint8_t* array, size_type size) const;
+	std::vector<uint8_t> readVector(size_type offset, size_type length) const;
 
 	BinaryContainer getSubcontainer(size_type offset, size_type length) const;
 
 	std::vector<uint8_t> toVector() const;
 
 private:
+	class MappedFile;
+
 	container_type buf_;
+	std::shared_ptr<const MappedFile> map_;	///< Set while the bytes are read from a mapped file
+	const uint8_t* view_;	///< Bytes in the mapped file
+	size_type viewSize_;
 	bool isLE_;
 
-	void append(const std::vector<uint8_t>&& a);
-	void write(size_t offset, const std::vector<uint8_t>&& a);
-	std::vector<uint8_t> read(size_type offset, size_type size) const;
+	inline const uint8_t* bytes() const noexcept { return map_ ? view_ : buf_.data(); }
+	/// @throw std::logic_error if the container is mapped.
+	void checkWritable() const;
+	void checkRange(size_type offset, size_type size) const;
+
+	template <typename T>
+	void append(T v)
+	{
+		checkWritable();
+		size_type offset = buf_.size();
+		buf_.resize(offset + sizeof(T));
+		write(offset, v);
+	}
+
+	template <typename T>
+	void write(size_type offset, T v)
+	{
+		checkWritable();
+		checkRange(offset, sizeof(T));
+		auto u = static_cast<std::make_unsigned_t<T>>(v);
+		uint8_t* p = buf_.data() + offset;
+		for (size_type i = 0; i < sizeof(T); ++i) {
+			p[isLE_ ? i : sizeof(T) - 1 - i] = static_cast<uint8_t>(u >> (8 * i));
+		}
+	}
+
+	template <typename T>
+	T read(size_type offset) const
+	{
+		checkRange(offset, sizeof(T));
+		std::make_unsigned_t<T> u = 0;
+		const uint8_t* p = bytes() + offset;
+		for (size_type i = 0; i < sizeof(T); ++i) {
+			u |= static_cast<std::make_unsigned_t<T>>(p[isLE_ ? i : sizeof(T) - 1 - i]) << (8 * i);
+		}
+		return static_cast<T>(u);
+	}
 };
 }
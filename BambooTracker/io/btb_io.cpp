@@ -768,9 +768,9 @@ void BtbIO::save(BinaryContainer& ctr, const std::weak_ptr<InstrumentsManager> i
 			ctr.appendUint8(static_cast<uint8_t>(instMan.lock()->getSampleADPCMRootKeyNumber(idx)));
 			ctr.appendUint16(static_cast<uint16_t>(instMan.lock()->getSampleADPCMRootDeltaN(idx)));
 			ctr.appendUint8(static_cast<uint8_t>(instMan.lock()->isSampleADPCMRepeatable(idx)));
-			std::vector<uint8_t> samples = instMan.lock()->getSampleADPCMRawSample(idx);
-			ctr.appendUint32(samples.size());
-			ctr.appendVector(samples);
+			SampleADPCMBuffer samples = instMan.lock()->getSampleADPCMRawSampleBuffer(idx);
+			ctr.appendUint32(samples->size());
+			ctr.appendVector(*samples);
 			SampleRepeatRange range = instMan.lock()->getSampleADPCMRepeatRange(idx);
 			ctr.appendUint16(range.first());
 			ctr.appendUint16(range.last());
@@ -1888,7 +1888,7 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 				instManLocked->setSampleADPCMRepeatEnabled(sampNum, (propCtr.readUint8(sampCsr++) & 0x01) != 0);
 				uint32_t len = propCtr.readUint32(sampCsr);
 				sampCsr += 4;
-				std::vector<uint8_t> samples = propCtr.getSubcontainer(sampCsr, len).toVector();
+				std::vector<uint8_t> samples = propCtr.readVector(sampCsr, len);
 				sampCsr += len;
 				instManLocked->storeSampleADPCMRawSample(sampNum, samples);
 				if (bankVersion >= Version::toBCD(1, 3, 1)) {
@@ -2226,7 +2226,7 @@ AbstractInstrument* BtbIO::loadInstrument(const BinaryContainer& instCtr,
 						instManLocked->setSampleADPCMRepeatEnabled(newSamp, (propCtr.readUint8(sampCsr++) & 0x01) != 0);
 						uint32_t len = propCtr.readUint32(sampCsr);
 						sampCsr += 4;
-						std::vector<uint8_t> samples = propCtr.getSubcontainer(sampCsr, len).toVector();
+						std::vector<uint8_t> samples = propCtr.readVector(sampCsr, len);
 						sampCsr += len;
 						instManLocked->storeSampleADPCMRawSample(newSamp, samples);
 						if (bankVersion >= Version::toBCD(1, 3, 1)) {
@@ -1568,7 +1568,7 @@ AbstractInstrument* BtiIO::load(const BinaryContainer& ctr, const std::string& f
 					instManLocked->setSampleADPCMRepeatEnabled(idx, (ctr.readUint8(csr++) & 0x01) != 0);
 					uint32_t len = ctr.readUint32(csr);
 					csr += 4;
-					std::vector<uint8_t> samples = ctr.getSubcontainer(csr, len).toVector();
+					std::vector<uint8_t> samples = ctr.readVector(csr, len);
 					 csr += len;
 					instManLocked->storeSampleADPCMRawSample(idx, samples);
 					if (fileVersion >= Version::toBCD(1, 5, 1)) {
@@ -2463,9 +2463,9 @@ void BtiIO::save(BinaryContainer& ctr,
 			ctr.appendUint8(static_cast<uint8_t>(instManLocked->getSampleADPCMRootKeyNumber(sampNum)));
 			ctr.appendUint16(static_cast<uint16_t>(instManLocked->getSampleADPCMRootDeltaN(sampNum)));
 			ctr.appendUint8(static_cast<uint8_t>(instManLocked->isSampleADPCMRepeatable(sampNum)));
-			std::vector<uint8_t> samples = instManLocked->getSampleADPCMRawSample(sampNum);
-			ctr.appendUint32(samples.size());
-			ctr.appendVector(std::move(samples));
+			SampleADPCMBuffer samples = instManLocked->getSampleADPCMRawSampleBuffer(sampNum);
+			ctr.appendUint32(samples->size());
+			ctr.appendVector(*samples);
 			SampleRepeatRange range = instMan.lock()->getSampleADPCMRepeatRange(sampNum);
 			ctr.appendUint16(range.first());
 			ctr.appendUint16(range.last());
@@ -2659,9 +2659,9 @@ void BtiIO::save(BinaryContainer& ctr,
 					ctr.appendUint8(static_cast<uint8_t>(instManLocked->getSampleADPCMRootKeyNumber(samp)));
 					ctr.appendUint16(static_cast<uint16_t>(instManLocked->getSampleADPCMRootDeltaN(samp)));
 					ctr.appendUint8(static_cast<uint8_t>(instManLocked->isSampleADPCMRepeatable(samp)));
-					std::vector<uint8_t> samples = instManLocked->getSampleADPCMRawSample(samp);
-					ctr.appendUint32(samples.size());
-					ctr.appendVector(std::move(samples));
+					SampleADPCMBuffer samples = instManLocked->getSampleADPCMRawSampleBuffer(samp);
+					ctr.appendUint32(samples->size());
+					ctr.appendVector(*samples);
 					SampleRepeatRange range = instMan.lock()->getSampleADPCMRepeatRange(samp);
 					ctr.appendUint16(range.first());
 					ctr.appendUint16(range.last());
@@ -1281,7 +1281,7 @@ size_t loadInstrumentPropertySection(std::weak_ptr<InstrumentsManager> instMan,
 				instManLocked->setSampleADPCMRepeatEnabled(idx, (ctr.readUint8(csr++) & 0x01) != 0);
 				uint32_t len = ctr.readUint32(csr);
 				csr += 4;
-				std::vector<uint8_t> samples = ctr.getSubcontainer(csr, len).toVector();
+				std::vector<uint8_t> samples = ctr.readVector(csr, len);
 				 csr += len;
 				instManLocked->storeSampleADPCMRawSample(idx, samples);
 				if (version >= Version::toBCD(1, 6, 1)) {
@@ -2471,9 +2471,9 @@ void BtmIO::save(BinaryContainer& ctr, const std::weak_ptr<Module> mod,
 			ctr.appendUint8(static_cast<uint8_t>(instManLocked->getSampleADPCMRootKeyNumber(idx)));
 			ctr.appendUint16(static_cast<uint16_t>(instManLocked->getSampleADPCMRootDeltaN(idx)));
 			ctr.appendUint8(static_cast<uint8_t>(instManLocked->isSampleADPCMRepeatable(idx)));
-			std::vector<uint8_t> samples = instManLocked->getSampleADPCMRawSample(idx);
-			ctr.appendUint32(samples.size());
-			ctr.appendVector(std::move(samples));
+			SampleADPCMBuffer samples = instManLocked->getSampleADPCMRawSampleBuffer(idx);
+			ctr.appendUint32(samples->size());
+			ctr.appendVector(*samples);
 			SampleRepeatRange range = instMan.lock()->getSampleADPCMRepeatRange(idx);
 			ctr.appendUint16(range.first());
 			ctr.appendUint16(range.last());
@@ -24,6 +24,7 @@
  */
 
 #include "instrument_io.hpp"
+#include <mutex>
 #include "file_io_error.hpp"
 #include "bti_io.hpp"
 #include "dmp_io.hpp"
@@ -74,7 +75,8 @@ InstrumentIO::InstrumentIO()
 
 InstrumentIO& InstrumentIO::getInstance()
 {
-	if (!instance_) instance_.reset(new InstrumentIO);
+	static std::once_flag flag;
+	std::call_once(flag, [] { instance_.reset(new InstrumentIO); });
 	return *instance_;
 }
 
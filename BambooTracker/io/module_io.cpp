@@ -24,6 +24,7 @@
  */
 
 #include "module_io.hpp"
+#include <mutex>
 #include "file_io_error.hpp"
 #include "btm_io.hpp"
 
@@ -58,7 +59,8 @@ ModuleIO::ModuleIO()
 
 ModuleIO& ModuleIO::getInstance()
 {
-	if (!instance_) instance_.reset(new ModuleIO);
+	static std::once_flag flag;
+	std::call_once(flag, [] { instance_.reset(new ModuleIO); });
 	return *instance_;
 }
 
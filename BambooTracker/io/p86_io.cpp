@@ -70,7 +70,7 @@ AbstractBank* P86IO::load(const BinaryContainer& ctr) const
 			if (ids.empty()) offs = start;
 			ids.push_back(i);
 
-			std::vector<uint8_t>&& smp = ctr.getSubcontainer(SAMP_OFFS + start - offs, len).toVector();
+			std::vector<uint8_t>&& smp = ctr.readVector(SAMP_OFFS + start - offs, len);
 			std::vector<int16_t> buf(smp.size());
 			std::transform(smp.begin(), smp.end(), buf.begin(), [](uint8_t v) {
 				return static_cast<int16_t>(static_cast<int8_t>(v)) << 8;
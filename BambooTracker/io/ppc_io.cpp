@@ -61,7 +61,7 @@ AbstractBank* PpcIO::load(const BinaryContainer& ctr) const
 			ids.push_back(i);
 			size_t st = sampOffs + static_cast<size_t>((start - offs) << 5);
 			size_t sampSize = std::min<size_t>((stop + 1u - start) << 5, ctr.size() - st);
-			samples.push_back(ctr.getSubcontainer(st, sampSize).toVector());
+			samples.push_back(ctr.readVector(st, sampSize));
 		}
 	}
 
@@ -58,7 +58,7 @@ AbstractBank* PviIO::load(const BinaryContainer& ctr) const
 			ids.push_back(static_cast<int>(i));
 			size_t st = sampOffs + static_cast<size_t>((start - offs) << 5);
 			size_t sampSize = std::min<size_t>((stop + 1u - start) << 5, ctr.size() - st);
-			samples.push_back(ctr.getSubcontainer(st, sampSize).toVector());
+			samples.push_back(ctr.readVector(st, sampSize));
 		}
 	}
 	/* if (ids.size() != cnt) throw FileCorruptionError(FileType::Bank, 11); */
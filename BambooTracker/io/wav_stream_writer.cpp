@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "wav_stream_writer.hpp"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace io
+{
+namespace
+{
+constexpr size_t FILE_SIZE_OFFS = 4;
+constexpr size_t DATA_SIZE_OFFS = 40;
+constexpr size_t HEADER_SIZE = 44;
+
+void appendString(std::vector<uint8_t>& buf, const char* str)
+{
+	buf.insert(buf.end(), str, str + std::strlen(str));
+}
+
+void appendUint16(std::vector<uint8_t>& buf, uint16_t v)
+{
+	buf.push_back(v & 0xff);
+	buf.push_back(v >> 8);
+}
+
+void appendUint32(std::vector<uint8_t>& buf, uint32_t v)
+{
+	for (int i = 0; i < 4; ++i) buf.push_back((v >> (i * 8)) & 0xff);
+}
+}
+
+WavStreamWriter::WavStreamWriter(uint32_t rate, uint16_t nCh, uint16_t bitSize)
+	: nCh_(nCh),
+	  bitSize_(bitSize),
+	  blockSize_(nCh * bitSize / 8),
+	  rate_(rate),
+	  dataSize_(0)
+{
+	buf_.reserve(CHUNK_SIZE_);
+
+	// RIFF header
+	appendString(buf_, "RIFF");
+	appendUint32(buf_, 0);	// Patched in finish()
+	appendString(buf_, "WAVE");
+
+	// fmt chunk
+	appendString(buf_, "fmt ");
+	appendUint32(buf_, 16);
+	appendUint16(buf_, 1);	// Raw linear PCM
+	appendUint16(buf_, nCh_);
+	appendUint32(buf_, rate_);
+	appendUint32(buf_, blockSize_ * rate_);
+	appendUint16(buf_, blockSize_);
+	appendUint16(buf_, bitSize_);
+
+	// Data chunk
+	appendString(buf_, "data");
+	appendUint32(buf_, 0);	// Patched in finish()
+}
+
+void WavStreamWriter::appendSample(const int16_t* sample, size_t nSamples)
+{
+	auto src = reinterpret_cast<const uint8_t*>(sample);
+	size_t rest = nCh_ * nSamples * sizeof(int16_t);
+	dataSize_ += rest;
+
+	while (rest) {
+		size_t size = std::min(rest, CHUNK_SIZE_ - buf_.size());
+		buf_.insert(buf_.end(), src, src + size);
+		src += size;
+		rest -= size;
+		if (buf_.size() == CHUNK_SIZE_) flush();
+	}
+}
+
+void WavStreamWriter::finish()
+{
+	flush();
+
+	std::vector<uint8_t> size;
+	appendUint32(size, static_cast<uint32_t>(HEADER_SIZE - 8 + dataSize_));
+	if (!writeBytesAt(FILE_SIZE_OFFS, size.data(), size.size()))
+		throw std::runtime_error("Failed to write WAV header");
+	size.clear();
+	appendUint32(size, static_cast<uint32_t>(dataSize_));
+	if (!writeBytesAt(DATA_SIZE_OFFS, size.data(), size.size()))
+		throw std::runtime_error("Failed to write WAV header");
+}
+
+void WavStreamWriter::flush()
+{
+	if (buf_.empty()) return;
+	if (!writeBytes(buf_.data(), buf_.size()))
+		throw std::runtime_error("Failed to write WAV data");
+	buf_.clear();
+}
+
+//------------------------------------------------------------
+
+WavFileWriter::WavFileWriter(const std::string& path, uint32_t rate, uint16_t nCh, uint16_t bitSize)
+	: WavStreamWriter(rate, nCh, bitSize),
+	  ofs_(path, std::ios::binary),
+	  hasPending_(false),
+	  isStopped_(false),
+	  hasFailed_(false)
+{
+	if (ofs_.is_open()) thread_ = std::thread(&WavFileWriter::run, this);
+}
+
+WavFileWriter::~WavFileWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopped_ = true;
+	}
+	cv_.notify_all();
+	if (thread_.joinable()) thread_.join();
+}
+
+bool WavFileWriter::writeBytes(const uint8_t* data, size_t size)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (!waitWritten(lock) || !thread_.joinable()) return false;
+	pending_.assign(data, data + size);
+	hasPending_ = true;
+	lock.unlock();
+	cv_.notify_all();
+	return true;
+}
+
+bool WavFileWriter::writeBytesAt(size_t pos, const uint8_t* data, size_t size)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (!waitWritten(lock)) return false;
+	std::streampos cur = ofs_.tellp();
+	ofs_.seekp(static_cast<std::streamoff>(pos));
+	ofs_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	ofs_.seekp(cur);
+	return ofs_.good();
+}
+
+void WavFileWriter::run()
+{
+	std::vector<uint8_t> chunk;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		cv_.wait(lock, [&] { return hasPending_ || isStopped_; });
+		if (!hasPending_) return;
+
+		// The encoder fills its next chunk meanwhile
+		chunk.swap(pending_);
+		lock.unlock();
+		ofs_.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+		bool failed = !ofs_.good();
+		lock.lock();
+
+		hasFailed_ = hasFailed_ || failed;
+		hasPending_ = false;
+		cv_.notify_all();
+	}
+}
+
+bool WavFileWriter::waitWritten(std::unique_lock<std::mutex>& lock)
+{
+	cv_.wait(lock, [&] { return !hasPending_; });
+	return !hasFailed_;
+}
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace io
+{
+/// Writes a linear PCM WAV stream chunk by chunk.
+/// The RIFF and data sizes are patched in finish(), so the memory usage is constant.
+class WavStreamWriter
+{
+public:
+	WavStreamWriter(uint32_t rate, uint16_t nCh, uint16_t bitSize);
+	virtual ~WavStreamWriter() = default;
+
+	inline uint16_t getChannelCount() const noexcept { return nCh_; }
+	inline uint16_t getBitSize() const noexcept { return bitSize_; }
+	inline uint32_t getSampleRate() const noexcept { return rate_; }
+	inline size_t getSampleCount() const noexcept { return dataSize_ / blockSize_; }
+
+	void appendSample(const int16_t* sample, size_t nSamples);
+	void finish();
+
+protected:
+	virtual bool writeBytes(const uint8_t* data, size_t size) = 0;
+	virtual bool writeBytesAt(size_t pos, const uint8_t* data, size_t size) = 0;
+
+private:
+	uint16_t nCh_, bitSize_, blockSize_;
+	uint32_t rate_;
+	size_t dataSize_;
+	std::vector<uint8_t> buf_;
+
+	static constexpr size_t CHUNK_SIZE_ = 0x10000;
+
+	void flush();
+};
+
+/// Writes a WAV file on a background thread, so that encoding the next chunk overlaps
+/// with writing the previous one. A write error is reported by the next write or finish().
+class WavFileWriter : public WavStreamWriter
+{
+public:
+	WavFileWriter(const std::string& path, uint32_t rate, uint16_t nCh, uint16_t bitSize);
+	~WavFileWriter() override;
+
+	inline bool isOpen() const { return ofs_.is_open(); }
+
+protected:
+	bool writeBytes(const uint8_t* data, size_t size) override;
+	bool writeBytesAt(size_t pos, const uint8_t* data, size_t size) override;
+
+private:
+	std::ofstream ofs_;
+	std::vector<uint8_t> pending_;	// Chunk handed to the writer thread
+	bool hasPending_, isStopped_, hasFailed_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::thread thread_;
+
+	void run();
+	/// Waits until the writer thread has written the pending chunk.
+	/// [Return] true if all chunks have been written successfully
+	bool waitWritten(std::unique_lock<std::mutex>& lock);
+};
+}
@@ -24,6 +24,8 @@
  */
 
 #include "effect.hpp"
+#include <cstdint>
+#include <array>
 #include <unordered_map>
 #include "step.hpp"
 
@@ -47,6 +49,52 @@ const std::unordered_map<char, int> CTOHEX = {
 	{ 'E', 14 },
 	{ 'F', 15 }
 };
+
+// Effect ID characters are 0-9, A-Z and others in this order,
+// so the index of a hexadecimal digit is its value
+constexpr int N_ID_SYMBOLS = 37;
+constexpr int ID_SYMBOL_OTHER = 36;
+
+inline int toIdSymbol(char c) noexcept
+{
+	if ('0' <= c && c <= '9') return c - '0';
+	if ('A' <= c && c <= 'Z') return c - 'A' + 10;
+	return ID_SYMBOL_OTHER;
+}
+
+/// Effect types of all pairs of ID symbols for each sound source.
+using EffectTypeTable = std::array<std::array<uint8_t, N_ID_SYMBOLS * N_ID_SYMBOLS>, N_SOUND_SOURCE>;
+
+EffectTypeTable makeEffectTypeTable()
+{
+	auto toChar = [](int sym) {
+		return (sym < 10) ? static_cast<char>('0' + sym)
+						  : (sym < ID_SYMBOL_OTHER) ? static_cast<char>('A' + sym - 10) : '-';
+	};
+
+	EffectTypeTable table;
+	for (SoundSource src : { SoundSource::FM, SoundSource::SSG, SoundSource::RHYTHM, SoundSource::ADPCM }) {
+		auto& types = table[soundSourceIndex(src)];
+		for (int s1 = 0; s1 < N_ID_SYMBOLS; ++s1) {
+			for (int s2 = 0; s2 < N_ID_SYMBOLS; ++s2) {
+				EffectType type = effect_utils::validateEffectId(src, { toChar(s1), toChar(s2) });
+				switch (type) {
+				case EffectType::VolumeDelay:
+				case EffectType::TLControl:
+				case EffectType::ARControl:
+				case EffectType::DRControl:
+					// The second character is the upper digit of the value
+					if (s2 > 0xf) type = EffectType::NoEffect;
+					break;
+				default:
+					break;
+				}
+				types[s1 * N_ID_SYMBOLS + s2] = static_cast<uint8_t>(type);
+			}
+		}
+	}
+	return table;
+}
 }
 
 namespace effect_utils
@@ -357,4 +405,25 @@ Effect validateEffect(SoundSource src, const std::string& id, int value)
 
 	return { type, v };
 }
+
+Effect validateEffect(SoundSource src, const Step::PlainEffect& plain)
+{
+	if (plain.value == Step::EFF_VAL_NONE) return { EffectType::NoEffect, Step::EFF_VAL_NONE };
+
+	static const EffectTypeTable table = makeEffectTypeTable();
+	int upper = toIdSymbol(plain.id[1]);
+	auto type = static_cast<EffectType>(table[soundSourceIndex(src)][toIdSymbol(plain.id[0]) * N_ID_SYMBOLS + upper]);
+
+	switch (type) {
+	case EffectType::NoEffect:
+		return { type, Step::EFF_VAL_NONE };
+	case EffectType::VolumeDelay:
+	case EffectType::TLControl:
+	case EffectType::ARControl:
+	case EffectType::DRControl:
+		return { type, (upper << 8) | plain.value };
+	default:
+		return { type, plain.value };
+	}
+}
 }
@@ -49,10 +49,8 @@ namespace effect_utils
 {
 EffectType validateEffectId(SoundSource src, const std::string& id);
 Effect validateEffect(SoundSource src, const std::string& id, int value);
-inline Effect validateEffect(SoundSource src, const Step::PlainEffect& plain)
-{
-	return validateEffect(src, plain.id, plain.value);
-}
+/// Same as validateEffect(src, id, value), but decodes the ID by a table lookup without strings.
+Effect validateEffect(SoundSource src, const Step::PlainEffect& plain);
 
 inline int reverseFmVolume(int volume, bool over0 = false) noexcept
 {
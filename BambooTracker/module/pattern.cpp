@@ -29,13 +29,8 @@
 #include "note.hpp"
 #include "utils.hpp"
 
-namespace
-{
-constexpr size_t MAX_STEP_SIZE = 256;
-}
-
 Pattern::Pattern(int n, size_t defSize)
-	: num_(n), size_(defSize), steps_(defSize), usedCnt_(0)
+	: num_(n), size_(defSize), usedCnt_(0)
 {
 }
 
@@ -44,18 +39,28 @@ Pattern::Pattern(int n, size_t size, const std::vector<Step>& steps)
 {
 }
 
+int Pattern::increaseUsedCount()
+{
+	// Allocate steps before the pattern gets reachable from orders
+	if (steps_.empty()) steps_.resize(size_);
+	return ++usedCnt_;
+}
+
 Step& Pattern::getStep(int n)
 {
+	if (steps_.empty()) steps_.resize(size_);
 	return steps_.at(static_cast<size_t>(n));
 }
 
 size_t Pattern::getSize() const
 {
+	if (steps_.empty()) return size_;
+
 	for (size_t i = 0; i < size_; ++i) {
 		for (int j = 0; j < Step::N_EFFECT; ++j) {
 			if (!steps_[i].hasEffectValue(j)) continue;
 			// "SoundSource::FM" is dummy, these effects are not related with sound source
-			switch (effect_utils::validateEffectId(SoundSource::FM, steps_[i].getEffectId(j))) {
+			switch (effect_utils::validateEffect(SoundSource::FM, steps_[i].getEffect(j)).type) {
 			case EffectType::PositionJump:
 			case EffectType::SongEnd:
 			case EffectType::PatternBreak:
@@ -72,19 +77,19 @@ void Pattern::changeSize(size_t size)
 {
 	if (size && size <= MAX_STEP_SIZE) {
 		size_ = size;
-		if (steps_.size() < size) steps_.resize(size);
+		if (!steps_.empty() && steps_.size() < size) steps_.resize(size);
 	}
 }
 
 void Pattern::insertStep(int n)
 {
-	if (n < static_cast<int>(size_))
+	if (!steps_.empty() && n < static_cast<int>(size_))
 		steps_.emplace(steps_.begin() + n);
 }
 
 void Pattern::deletePreviousStep(int n)
 {
-	if (!n) return;
+	if (!n || steps_.empty()) return;
 
 	steps_.erase(steps_.begin() + n - 1);
 	if (steps_.size() < size_)
@@ -93,6 +98,8 @@ void Pattern::deletePreviousStep(int n)
 
 bool Pattern::hasEvent() const
 {
+	if (steps_.empty()) return false;
+
 	auto endIt = steps_.cbegin() + static_cast<int>(size_);
 	return std::any_of(steps_.cbegin(), endIt,
 					   [](const Step& step) { return step.hasEvent(); });
@@ -100,6 +107,8 @@ bool Pattern::hasEvent() const
 
 std::vector<int> Pattern::getEditedStepIndices() const
 {
+	if (steps_.empty()) return {};
+
 	auto endIt = steps_.cbegin() + static_cast<int>(size_);
 	return utils::findIndicesIf(steps_.cbegin(), endIt,
 								[](const Step& step) { return step.hasEvent(); });
@@ -108,6 +117,8 @@ std::vector<int> Pattern::getEditedStepIndices() const
 std::set<int> Pattern::getRegisteredInstruments() const
 {
 	std::set<int> set;
+	if (steps_.empty()) return set;
+
 	for (size_t i = 0; i < size_; ++i) {
 		const Step& step = steps_.at(i);
 		if (step.hasInstrument()) set.insert(step.getInstrumentNumber());
@@ -122,6 +133,8 @@ Pattern Pattern::clone(int asNumber)
 
 void Pattern::transpose(int semitones, const std::vector<int>& excludeInsts)
 {
+	if (steps_.empty()) return;
+
 	for (size_t i = 0; i < size_; ++i) {
 		Step& step = steps_.at(i);
 		int note = step.getNoteNumber();
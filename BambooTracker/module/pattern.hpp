@@ -33,12 +33,14 @@
 class Pattern
 {
 public:
+	static constexpr size_t MAX_STEP_SIZE = 256;
+
 	Pattern(int n, size_t defSize);
 
 	inline void setNumber(int n) noexcept { num_ = n; }
 	inline int getNumber() const noexcept { return num_; }
 
-	inline int increaseUsedCount() noexcept { return ++usedCnt_; }
+	int increaseUsedCount();
 	inline int decreaseUsedCount() noexcept { return --usedCnt_; }
 	inline int getUsedCount() const noexcept { return usedCnt_; }
 
@@ -63,6 +65,7 @@ public:
 private:
 	int num_;
 	size_t size_;
+	/// Empty until the pattern is registered to an order or edited, all steps are blank in the meantime.
 	std::vector<Step> steps_;
 	int usedCnt_;
 
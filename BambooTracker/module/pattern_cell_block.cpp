@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pattern_cell_block.hpp"
+#include <algorithm>
+#include <limits>
+
+PatternCellBlock::PatternCellBlock(size_t width, size_t height)
+	: width_(width),
+	  height_(height),
+	  cells_(width * height, EMPTY_CELL)
+{
+}
+
+void PatternCellBlock::appendRows(const PatternCellBlock& other, size_t count)
+{
+	count = std::min(count, other.height_);
+	cells_.insert(cells_.end(), other.cells_.begin(), other.cells_.begin() + count * width_);
+	height_ += count;
+}
+
+PatternCellBlock PatternCellBlock::cropped(size_t width, size_t height) const
+{
+	width = std::min(width, width_);
+	height = std::min(height, height_);
+	PatternCellBlock block(width, height);
+	for (size_t i = 0; i < height; ++i) {
+		std::copy_n(&at(i, 0), width, &block.at(i, 0));
+	}
+	return block;
+}
+
+PatternCell PatternCellBlock::readCell(const Step& step, int column)
+{
+	PatternCell cell = EMPTY_CELL;
+	switch (column) {
+	case 0:		cell.value = static_cast<int16_t>(step.getNoteNumber());		break;
+	case 1:		cell.value = static_cast<int16_t>(step.getInstrumentNumber());	break;
+	case 2:		cell.value = static_cast<int16_t>(step.getVolume());			break;
+	default:
+	{
+		int ec = column - 3;
+		Step::PlainEffect eff = step.getEffect(ec / 2);
+		if (ec % 2) {	// Value
+			cell.value = eff.value;
+		}
+		else {	// ID
+			cell.id[0] = eff.id[0];
+			cell.id[1] = eff.id[1];
+		}
+		break;
+	}
+	}
+	return cell;
+}
+
+void PatternCellBlock::writeCell(Step& step, int column, const PatternCell& cell)
+{
+	switch (column) {
+	case 0:		step.setNoteNumber(cell.value);			break;
+	case 1:		step.setInstrumentNumber(cell.value);	break;
+	case 2:		step.setVolume(cell.value);				break;
+	default:
+	{
+		int ec = column - 3;
+		int ei = ec / 2;
+		if (ec % 2) {	// Value
+			step.setEffectValue(ei, cell.value);
+		}
+		else {	// ID
+			Step::PlainEffect eff = step.getEffect(ei);
+			eff.id[0] = cell.id[0];
+			eff.id[1] = cell.id[1];
+			step.setEffect(ei, eff);
+		}
+		break;
+	}
+	}
+}
+
+bool PatternCellBlock::isEmptyCell(const PatternCell& cell, int column)
+{
+	if (isEffectIdColumn(column)) return cell.id[0] == '-' && cell.id[1] == '-';
+	else return cell.value == -1;	// All *_NONE values in Step are -1
+}
+
+namespace
+{
+inline bool isEmptyCellInAnyColumn(const PatternCell& cell) noexcept
+{
+	return cell.value == PatternCellBlock::EMPTY_CELL.value
+			&& cell.id[0] == PatternCellBlock::EMPTY_CELL.id[0]
+			&& cell.id[1] == PatternCellBlock::EMPTY_CELL.id[1];
+}
+}
+
+PackedPatternCellBlock::PackedPatternCellBlock()
+	: width_(0),
+	  height_(0)
+{
+}
+
+PackedPatternCellBlock::PackedPatternCellBlock(const PatternCellBlock& block)
+	: width_(block.width()),
+	  height_(block.height())
+{
+	constexpr uint16_t RUN_MAX = std::numeric_limits<uint16_t>::max();
+
+	const PatternCell* src = block.data();
+	const size_t n = width_ * height_;
+	size_t i = 0;
+	while (i < n) {
+		Run run = { 0, 0 };
+		for (; i < n && run.empties < RUN_MAX && isEmptyCellInAnyColumn(src[i]); ++i) ++run.empties;
+		for (; i < n && run.cells < RUN_MAX && !isEmptyCellInAnyColumn(src[i]); ++i) {
+			cells_.push_back(src[i]);
+			++run.cells;
+		}
+		runs_.push_back(run);
+	}
+	runs_.shrink_to_fit();
+	cells_.shrink_to_fit();
+}
+
+PatternCellBlock PackedPatternCellBlock::unpack() const
+{
+	PatternCellBlock block(width_, height_);
+	PatternCell* dest = block.data();
+	auto it = cells_.begin();
+	for (const Run& run : runs_) {
+		dest += run.empties;
+		dest = std::copy_n(it, run.cells, dest);
+		it += run.cells;
+	}
+	return block;
+}
+
+size_t PackedPatternCellBlock::getFootprint() const noexcept
+{
+	return runs_.capacity() * sizeof(Run) + cells_.capacity() * sizeof(PatternCell);
+}
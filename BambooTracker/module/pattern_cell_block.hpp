@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "step.hpp"
+
+/// A pattern column value.
+/// Effect ID columns use \c id and the other columns use \c value.
+struct PatternCell
+{
+	int16_t value;
+	char id[2];
+};
+
+/// Rectangular range of pattern columns, stored row by row.
+/// Columns continue over tracks in the order of Step::N_COLUMN.
+class PatternCellBlock
+{
+public:
+	explicit PatternCellBlock(size_t width = 0, size_t height = 0);
+
+	size_t width() const noexcept { return width_; }
+	size_t height() const noexcept { return height_; }
+	bool empty() const noexcept { return cells_.empty(); }
+
+	PatternCell& at(size_t row, size_t col) { return cells_[row * width_ + col]; }
+	const PatternCell& at(size_t row, size_t col) const { return cells_[row * width_ + col]; }
+
+	PatternCell* data() noexcept { return cells_.data(); }
+	const PatternCell* data() const noexcept { return cells_.data(); }
+
+	/// Append the first \c count rows of \c other which has the same width.
+	void appendRows(const PatternCellBlock& other, size_t count);
+	PatternCellBlock cropped(size_t width, size_t height) const;
+
+	/// Empty value of every column kind.
+	static constexpr PatternCell EMPTY_CELL = { -1, { '-', '-' } };
+
+	/// \c column is a column index in a step.
+	static bool isEffectIdColumn(int column) noexcept { return column > 2 && !((column - 3) % 2); }
+	static PatternCell readCell(const Step& step, int column);
+	static void writeCell(Step& step, int column, const PatternCell& cell);
+	static bool isEmptyCell(const PatternCell& cell, int column);
+
+private:
+	size_t width_, height_;
+	std::vector<PatternCell> cells_;
+};
+
+/// PatternCellBlock with run-length encoded empty cells and the non-empty cells between them stored as they are.
+/// Patterns are mostly empty, so snapshots kept for undo take much less memory in this form.
+class PackedPatternCellBlock
+{
+public:
+	PackedPatternCellBlock();
+	explicit PackedPatternCellBlock(const PatternCellBlock& block);
+
+	size_t width() const noexcept { return width_; }
+	size_t height() const noexcept { return height_; }
+	PatternCellBlock unpack() const;
+
+	/// Bytes of the packed data.
+	size_t getFootprint() const noexcept;
+
+private:
+	struct Run
+	{
+		uint16_t empties, cells;
+	};
+
+	size_t width_, height_;
+	std::vector<Run> runs_;
+	std::vector<PatternCell> cells_;
+};
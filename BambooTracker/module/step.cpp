@@ -32,12 +32,17 @@ Step::Step()
 	  inst_(INST_NONE),
 	  vol_(VOLUME_NONE)
 {
-	for (size_t i = 0; i < N_EFFECT; ++i) {
-		eff_[i].id = EFF_ID_NONE;
-		eff_[i].value = EFF_VAL_NONE;
+	for (int i = 0; i < N_EFFECT; ++i) {
+		clearEffect(i);
 	}
 }
 
+void Step::setEffectId(int n, const std::string& str)
+{
+	eff_[n].id[0] = str.size() > 0 ? str[0] : '-';
+	eff_[n].id[1] = str.size() > 1 ? str[1] : '-';
+}
+
 void Step::clear()
 {
 	clearNoteNumber();
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <stdexcept>
 
@@ -45,10 +46,10 @@ public:
 		NOTE_KEY_CUT	= -7,
 	};
 	int getNoteNumber() const noexcept { return note_; }
-	void setNoteNumber(int num) { note_ = num; }
+	void setNoteNumber(int num) { note_ = static_cast<int16_t>(num); }
 	void setKeyOff() { note_ = NOTE_KEY_OFF; }
 	void setKeyCut() { note_ = NOTE_KEY_CUT; }
-	void setEchoBuffer(int n) { note_ = NOTE_ECHO0 - n; }
+	void setEchoBuffer(int n) { note_ = static_cast<int16_t>(NOTE_ECHO0 - n); }
 	void clearNoteNumber() noexcept { note_ = NOTE_NONE; }
 	bool hasGeneralNote() const noexcept { return note_ > NOTE_NONE; }
 	bool hasKeyOff() const noexcept { return note_ == NOTE_KEY_OFF; }
@@ -60,7 +61,7 @@ public:
 
 	static constexpr int INST_NONE = -1;
 	int getInstrumentNumber() const noexcept { return inst_; }
-	void setInstrumentNumber(int num) { inst_ = num; }
+	void setInstrumentNumber(int num) { inst_ = static_cast<int16_t>(num); }
 	void clearInstrumentNumber() noexcept { inst_ = INST_NONE; }
 	bool hasInstrument() const noexcept { return inst_ != INST_NONE; }
 
@@ -68,32 +69,33 @@ public:
 
 	static constexpr int VOLUME_NONE = -1;
 	int getVolume() const noexcept { return vol_; }
-	void setVolume(int volume) { vol_ = volume; }
+	void setVolume(int volume) { vol_ = static_cast<int16_t>(volume); }
 	void clearVolume() noexcept { vol_ = VOLUME_NONE; }
 	bool hasVolume() const noexcept { return vol_ != VOLUME_NONE; }
 
 	static bool testEmptyVolume(int vol) { return vol == VOLUME_NONE; }
 
 	static const std::string EFF_ID_NONE;	// "--"
-	std::string getEffectId(int n) const { return eff_[n].id; }
-	void setEffectId(int n, const std::string& str) { eff_[n].id = str; }
-	void clearEffectId(int n) { eff_[n].id = EFF_ID_NONE; }
-	bool hasEffectId(int n) const { return eff_[n].id != EFF_ID_NONE; }
+	std::string getEffectId(int n) const { return std::string(eff_[n].id, sizeof(eff_[n].id)); }
+	void setEffectId(int n, const std::string& str);
+	void clearEffectId(int n) { eff_[n].id[0] = eff_[n].id[1] = '-'; }
+	bool hasEffectId(int n) const { return eff_[n].id[0] != '-' || eff_[n].id[1] != '-'; }
 
 	static bool testEmptyEffectId(const std::string& id) { return id == EFF_ID_NONE; }
 
 	static constexpr int EFF_VAL_NONE = -1;
 	int getEffectValue(int n) const { return eff_[n].value; }
-	void setEffectValue(int n, int v) { eff_[n].value = v; }
+	void setEffectValue(int n, int v) { eff_[n].value = static_cast<int16_t>(v); }
 	void clearEffectValue(int n) { eff_[n].value = EFF_VAL_NONE; }
 	bool hasEffectValue(int n) const { return eff_[n].value != EFF_VAL_NONE; }
 
 	static bool testEmptyEffectValue(int v) { return v == EFF_VAL_NONE; }
 
+	/// Effect as entered, without validation against the sound source of its track.
 	struct PlainEffect
 	{
-		std::string id;
-		int value;
+		char id[2];
+		int16_t value;
 	};
 
 	static constexpr int N_EFFECT = 4;
@@ -127,19 +129,19 @@ private:
 	///		 -5: echo 3 notes before
 	///		 -6: echo 4 notes before
 	///		 -7: key cut
-	int note_;
+	int16_t note_;
 	/// instNum_
 	///		0<=: instrument number
 	///		 -1: none
-	int inst_;
+	int16_t inst_;
 	/// vol_
 	///		0<=: volume level
 	///		 -1: none
-	int vol_;
+	int16_t vol_;
 	/// eff
 	///	[id]
 	///		 "--": none
-	///		other: effect ID
+	///		other: 2 characters of effect ID
 	/// [value]
 	///		0<=: effect value
 	///		 -1: none
@@ -31,7 +31,6 @@
 namespace
 {
 constexpr int PATTERN_SIZE = 256;
-constexpr int MAX_ORDER_SIZE = 256;
 }
 
 Track::Track(int number, SoundSource source, int channelInSource, int defPattenSize)
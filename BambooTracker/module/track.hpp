@@ -48,6 +48,8 @@ struct OrderInfo
 class Track
 {
 public:
+	static constexpr int MAX_ORDER_SIZE = 256;
+
 	Track(int number, SoundSource source, int channelInSource, int defPattenSize);
 
 	void setAttribute(int number, SoundSource source, int channelInSource) noexcept;
@@ -26,12 +26,16 @@
 #include "opna_controller.hpp"
 #include <stdexcept>
 #include <limits>
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
 #include "note.hpp"
 #include "utils.hpp"
 
 namespace
 {
 constexpr int UNUSED_VALUE = -1;
+constexpr size_t DRAM_SIZE = 262144;	// 256KiB
 
 const std::unordered_map<FMOperatorType, std::vector<FMEnvelopeParameter>> FM_ENV_PARAMS_OP = {
 	{ FMOperatorType::All, {
@@ -79,16 +83,19 @@ std::unique_ptr<chip::AbstractResampler> generateResampler(chip::ResamplerType t
 	case chip::ResamplerType::BlipBuf:		return std::make_unique<chip::BlipResampler>(false);
 	case chip::ResamplerType::FastBlipBuf:	return std::make_unique<chip::BlipResampler>(true);
 	case chip::ResamplerType::Linear:		return std::make_unique<chip::LinearResampler>();
+	case chip::ResamplerType::Sinc:			return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Standard);
+	case chip::ResamplerType::FastSinc:		return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Fast);
+	case chip::ResamplerType::BestSinc:		return std::make_unique<chip::SincResampler>(chip::SincResampler::Quality::Best);
 	}
 }
 }
 
-OPNAController::OPNAController(chip::OpnaEmulator emu, int clock, int rate, int duration, chip::ResamplerType resampler)
+OPNAController::OPNAController(chip::OpnaEmulator emu, chip::YmfmFidelity ymfmFidelity, int clock, int rate, int duration,
+							   chip::ResamplerType resampler)
 	: mode_(SongType::Standard),
-	  storePointADPCM_(0)
+	  dramAllocADPCM_(DRAM_SIZE >> 5)
 {
-	constexpr size_t DRAM_SIZE = 262144;	// 256KiB
-	opna_ = std::make_unique<chip::OPNA>(emu, clock, rate, duration, DRAM_SIZE,
+	opna_ = std::make_unique<chip::OPNA>(emu, ymfmFidelity, clock, rate, duration, DRAM_SIZE,
 										 generateResampler(resampler), generateResampler(resampler));
 
 	for (size_t inch = 0; inch < 6; ++inch) {
@@ -130,6 +137,17 @@ void OPNAController::resetState()
 	initSSG();
 	initRhythm();
 	initADPCM();
+
+	updateChannelActivity();
+}
+
+void OPNAController::updateChannelActivity()
+{
+	auto isKeyOn = [](const auto& ch) { return ch.isKeyOn; };
+	bool isActive = isKeyOnADPCM_
+					|| std::any_of(fm_, fm_ + Song::getFMChannelCount(mode_), isKeyOn)
+					|| std::any_of(std::begin(ssg_), std::end(ssg_), isKeyOn);
+	opna_->setChannelsActive(isActive);
 }
 
 /********** Forward instrument sequence **********/
@@ -159,6 +177,7 @@ size_t OPNAController::getDRAMSize() const
 void OPNAController::updateRegisterStates()
 {
 	updateKeyOnOffStatusRhythm();
+	updateChannelActivity();
 
 	// Check direct register set
 	if (!registerDirectSetBuf_.empty()) {
@@ -173,6 +192,7 @@ void OPNAController::updateRegisterStates()
 void OPNAController::connectToRealChip(RealChipInterfaceType type, RealChipInterfaceGeneratorFunc* f)
 {
 	opna_->connectToRealChip(type, f);
+	clearSamplesADPCM();	// The new chip has none of the samples
 }
 
 RealChipInterfaceType OPNAController::getRealChipInterfaceType() const
@@ -298,9 +318,47 @@ void OPNAController::setMasterVolume(int percentage)
 	opna_->setMasterVolume(percentage);
 }
 
+void OPNAController::setSilenceSkipEnabled(bool enabled)
+{
+	opna_->setSilenceSkipEnabled(enabled);
+}
+
+bool OPNAController::isSilenceSkipEnabled() const
+{
+	return opna_->isSilenceSkipEnabled();
+}
+
+/********** Profiling **********/
+void OPNAController::setStageProfilingEnabled(bool enabled)
+{
+	opna_->setStageProfilingEnabled(enabled);
+}
+
+chip::MixStageProfile OPNAController::getMixStageProfile() const
+{
+	return opna_->getMixStageProfile();
+}
+
+void OPNAController::resetMixStageProfile()
+{
+	opna_->resetMixStageProfile();
+}
+
+chip::RegisterWriteStatistics OPNAController::getRegisterWriteStatistics() const
+{
+	return opna_->getRegisterWriteStatistics();
+}
+
+void OPNAController::resetRegisterWriteStatistics()
+{
+	opna_->resetRegisterWriteStatistics();
+}
+
+/********** Export **********/
 void OPNAController::setExportContainer(std::shared_ptr<chip::AbstractRegisterWriteLogger> cntr)
 {
 	opna_->setRegisterWriteLogger(cntr);
+	if (cntr) clearSamplesADPCM();	// Samples are uploaded again to be recorded
 }
 
 /********** Internal common process **********/
@@ -642,6 +700,7 @@ void OPNAController::keyOnFM(int ch, const Note& note, bool isJam)
 	}
 
 	fm.hasKeyOnBefore = true;
+	updateChannelActivity();
 	opna_->setForcedWriteMode(false);
 }
 
@@ -671,6 +730,7 @@ void OPNAController::keyOffFM(int ch, bool isJam)
 	fm.hasPreSetTickEvent = isJam;
 
 	fm.isKeyOn = false;
+	updateChannelActivity();
 
 	uint8_t chdata = FM_KEYOFF_MASK[fm.inCh];
 	switch (mode_) {
@@ -1192,6 +1252,11 @@ void OPNAController::haltSequencesFM(int ch)
 	if (auto& xVolSldItr = fm.xVolSldItr) xVolSldItr->end();
 }
 
+void OPNAController::setEchoBufferFM(int ch, const EchoBuffer& buf)
+{
+	fm_[ch].echoBuf = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnFM(int ch) const
 {
@@ -1227,8 +1292,9 @@ void OPNAController::initFM()
 	opna_->setRegister(0x27, mode);
 
 	for (size_t inch = 0; inch < 6; ++inch) {
-		// Init envelope
-		envFM_[inch] = std::make_unique<EnvelopeFM>(-1);
+		// Init envelope (reuse it because reset also runs on the audio thread at the end of a song)
+		if (envFM_[inch]) envFM_[inch]->clearParameters();
+		else envFM_[inch] = std::make_unique<EnvelopeFM>(-1);
 		refInstFM_[inch].reset();
 
 		// Init pan
@@ -2121,6 +2187,7 @@ void OPNAController::keyOnSSG(int ch, const Note& note, bool isJam)
 	ssg.shouldSkip1stTickExec = isJam;
 	ssg.isKeyOn = true;
 	ssg.hasKeyOnBefore = true;
+	updateChannelActivity();
 
 	opna_->setForcedWriteMode(false);
 }
@@ -2149,6 +2216,7 @@ void OPNAController::keyOffSSG(int ch, bool isJam, bool forceSilence)
 	releaseStartSSGSequences(ssg, forceSilence);
 	ssg.shouldSkip1stTickExec = isJam;
 	ssg.isKeyOn = false;
+	updateChannelActivity();
 
 	opna_->setForcedWriteMode(false);
 }
@@ -2445,6 +2513,11 @@ void OPNAController::haltSequencesSSG(int ch)
 	if (auto& xVolSldItr = ssg.xVolSldItr) xVolSldItr->end();
 }
 
+void OPNAController::setEchoBufferSSG(int ch, const EchoBuffer& buf)
+{
+	ssg_[ch].echoBuf = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnSSG(int ch) const
 {
@@ -2530,6 +2603,7 @@ void OPNAController::setMuteSSGState(int ch, bool isMute)
 	if (isMute) {
 		opna_->setRegister(0x08 + ssg.ch, 0);
 		ssg.isKeyOn = false;
+		updateChannelActivity();
 	}
 }
 
@@ -3582,6 +3656,7 @@ void OPNAController::keyOnADPCM(const Note& note, bool isJam)
 	}
 
 	hasKeyOnBeforeADPCM_ = true;
+	updateChannelActivity();
 
 	opna_->setForcedWriteMode(false);
 }
@@ -3608,6 +3683,7 @@ void OPNAController::keyOffADPCM(bool isJam, bool forceSilence)
 	releaseStartADPCMSequences(forceSilence);
 	shouldSkip1stTickExecADPCM_ = isJam;
 	isKeyOnADPCM_ = false;
+	updateChannelActivity();
 
 	opna_->setForcedWriteMode(false);
 }
@@ -3728,51 +3804,83 @@ void OPNAController::updateInstrumentDrumkit(int instNum, int key)
 
 void OPNAController::clearSamplesADPCM()
 {
-	storePointADPCM_ = 0;
+	residentSamplesADPCM_.clear();
+	dramAllocADPCM_.clear();
 	startAddrADPCM_ = std::numeric_limits<size_t>::max();
 	stopAddrADPCM_ = startAddrADPCM_;
 }
 
-bool OPNAController::storeSampleADPCM(const std::vector<uint8_t>& sample, size_t& startAddr, size_t& stopAddr)
+bool OPNAController::storeSamplesADPCM(const std::vector<SampleADPCMBuffer>& samples,
+									   std::unordered_map<const std::vector<uint8_t>*, std::array<size_t, 2>>& addrs)
 {
-	// Turn on immediate-write mode to avoid suspending sample writes
-	bool isImmediate = opna_->isImmediateWriteMode();
-	opna_->setImmediateWriteMode(true);
-
-	opna_->setRegister(0x110, 0x80);
-	opna_->setRegister(0x100, 0x61);
-	opna_->setRegister(0x100, 0x60);
-	opna_->setRegister(0x101, 0x02);
+	auto countBlocks = [](const SampleADPCMBuffer& sample) { return ((sample->size() - 1) >> 5) + 1; };
 
-	size_t dramLim = (opna_->getDRAMSize() - 1) >> 5;	// By 32 bytes
-	opna_->setRegister(0x10c, dramLim & 0xff);
-	opna_->setRegister(0x10d, (dramLim >> 8) & 0xff);
-
-	bool stored = false;
-	if (storePointADPCM_ < dramLim) {
-		startAddr = storePointADPCM_;
-		opna_->setRegister(0x102, startAddr & 0xff);
-		opna_->setRegister(0x103, (startAddr >> 8) & 0xff);
+	// Samples sharing a payload share its region
+	std::vector<SampleADPCMBuffer> uniqSamples;
+	std::unordered_set<const std::vector<uint8_t>*> used;
+	for (const SampleADPCMBuffer& sample : samples) {
+		if (used.insert(sample.get()).second) uniqSamples.push_back(sample);
+	}
 
-		stopAddr = startAddr + ((sample.size() - 1) >> 5);	// By 32 bytes
-		stopAddr = std::min(stopAddr, dramLim);
-		opna_->setRegister(0x104, stopAddr & 0xff);
-		opna_->setRegister(0x105, (stopAddr >> 8) & 0xff);
-		storePointADPCM_ = stopAddr + 1;
+	// Release the samples no longer used, and the truncated ones to place them again
+	for (auto it = residentSamplesADPCM_.begin(); it != residentSamplesADPCM_.end();) {
+		const ResidentSampleADPCM& res = it->second;
+		if (used.count(it->first) && res.stopAddr - res.startAddr + 1 == countBlocks(res.sample)) {
+			++it;
+		}
+		else {
+			dramAllocADPCM_.release(res.startAddr);
+			it = residentSamplesADPCM_.erase(it);
+		}
+	}
 
-		size_t size = sample.size();
-		for (size_t i = 0; i < size; ++i) {
-			opna_->setRegister(0x108, sample[i]);
+	// Fill free ranges with the new samples
+	std::vector<ResidentSampleADPCM> added;
+	bool isFragmented = false;
+	for (const SampleADPCMBuffer& sample : uniqSamples) {
+		if (residentSamplesADPCM_.count(sample.get())) continue;
+		size_t blocks = countBlocks(sample);
+		size_t start;
+		if (!dramAllocADPCM_.allocate(blocks, start)) {
+			isFragmented = true;
+			break;
 		}
-		stored = true;
+		added.push_back({ sample, start, start + blocks - 1 });
 	}
 
-	opna_->setRegister(0x100, 0x00);
-	opna_->setRegister(0x110, 0x80);
+	// Pack all samples from the top of the DRAM again if some do not fit into free ranges,
+	// and cut the last one at the end of the DRAM as before
+	if (isFragmented) {
+		clearSamplesADPCM();
+		added.clear();
+		for (const SampleADPCMBuffer& sample : uniqSamples) {
+			size_t start, stop;
+			if (!dramAllocADPCM_.allocateTail(countBlocks(sample), start, stop)) break;
+			added.push_back({ sample, start, stop });
+		}
+	}
 
+	// Turn on immediate-write mode to avoid suspending sample writes
+	bool isImmediate = opna_->isImmediateWriteMode();
+	opna_->setImmediateWriteMode(true);
+	for (ResidentSampleADPCM& res : added) {
+		writeSampleADPCM(*res.sample, res.startAddr, res.stopAddr);
+		residentSamplesADPCM_.emplace(res.sample.get(), std::move(res));
+	}
 	opna_->setImmediateWriteMode(isImmediate);
+	if (!added.empty()) {
+		// Start and stop registers have been overwritten
+		startAddrADPCM_ = std::numeric_limits<size_t>::max();
+		stopAddrADPCM_ = startAddrADPCM_;
+	}
 
-	return stored;
+	bool storedAll = true;
+	for (const SampleADPCMBuffer& sample : uniqSamples) {
+		auto&& it = residentSamplesADPCM_.find(sample.get());
+		if (it == residentSamplesADPCM_.end()) storedAll = false;
+		else addrs[sample.get()] = {{ it->second.startAddr, it->second.stopAddr }};
+	}
+	return storedAll;
 }
 
 /********** Set volume **********/
@@ -3918,6 +4026,11 @@ void OPNAController::haltSequencesADPCM()
 	if (xVolSldItrAdpcm_) xVolSldItrAdpcm_->end();
 }
 
+void OPNAController::setEchoBufferADPCM(const EchoBuffer& buf)
+{
+	echoBufADPCM_ = buf;
+}
+
 /********** Chip details **********/
 bool OPNAController::isKeyOnADPCM() const
 {
@@ -3936,7 +4049,7 @@ Note OPNAController::getADPCMLatestNote() const
 
 size_t OPNAController::getADPCMStoredSize() const
 {
-	return storePointADPCM_ << 5;
+	return dramAllocADPCM_.getUsedEnd() << 5;
 }
 
 /***********************************/
@@ -3998,6 +4111,7 @@ void OPNAController::setMuteADPCMState(bool isMute)
 	if (isMute) {
 		opna_->setRegister(0x10b, 0);
 		isKeyOnADPCM_ = false;
+		updateChannelActivity();
 	}
 }
 
@@ -4361,3 +4475,27 @@ void OPNAController::triggerSamplePlayADPCM(size_t startAddress, size_t stopAddr
 	opna_->setRegister(0x100, 0xa0 | repeatFlag);
 	opna_->setRegister(0x101, panStateADPCM_ | 0x02);
 }
+
+void OPNAController::writeSampleADPCM(const std::vector<uint8_t>& sample, size_t startAddr, size_t stopAddr)
+{
+	opna_->setRegister(0x110, 0x80);
+	opna_->setRegister(0x100, 0x61);
+	opna_->setRegister(0x100, 0x60);
+	opna_->setRegister(0x101, 0x02);
+
+	size_t dramLim = (opna_->getDRAMSize() - 1) >> 5;	// By 32 bytes
+	opna_->setRegister(0x10c, dramLim & 0xff);
+	opna_->setRegister(0x10d, (dramLim >> 8) & 0xff);
+
+	opna_->setRegister(0x102, startAddr & 0xff);
+	opna_->setRegister(0x103, (startAddr >> 8) & 0xff);
+	opna_->setRegister(0x104, stopAddr & 0xff);
+	opna_->setRegister(0x105, (stopAddr >> 8) & 0xff);
+
+	// Load the payload at once instead of writing it to 0x108 byte by byte
+	size_t size = std::min(sample.size(), (stopAddr - startAddr + 1) << 5);
+	opna_->writeDRAM(startAddr << 5, sample.data(), size);
+
+	opna_->setRegister(0x100, 0x00);
+	opna_->setRegister(0x110, 0x80);
+}
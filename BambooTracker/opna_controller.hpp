@@ -29,12 +29,15 @@
 #include <memory>
 #include <unordered_map>
 #include <deque>
+#include <array>
+#include <vector>
 #include "song.hpp"
 #include "instrument.hpp"
 #include "effect_iterator.hpp"
 #include "sample_repeat.hpp"
 #include "note.hpp"
 #include "echo_buffer.hpp"
+#include "adpcm_memory_allocator.hpp"
 #include "chip/opna.hpp"
 #include "enum_hash.hpp"
 #include "bamboo_tracker_defs.hpp"
@@ -42,7 +45,8 @@
 class OPNAController
 {
 public:
-	OPNAController(chip::OpnaEmulator emu, int clock, int rate, int duration, chip::ResamplerType resampler);
+	OPNAController(chip::OpnaEmulator emu, chip::YmfmFidelity ymfmFidelity, int clock, int rate, int duration,
+				   chip::ResamplerType resampler);
 
 	// Reset and initialize
 	void reset();
@@ -90,6 +94,15 @@ public:
 	void setDuration(int duration);
 	void setResampler(chip::ResamplerType type);
 	void setMasterVolume(int percentage);
+	void setSilenceSkipEnabled(bool enabled);
+	bool isSilenceSkipEnabled() const;
+
+	// Profiling
+	void setStageProfilingEnabled(bool enabled);
+	chip::MixStageProfile getMixStageProfile() const;
+	void resetMixStageProfile();
+	chip::RegisterWriteStatistics getRegisterWriteStatistics() const;
+	void resetRegisterWriteStatistics();
 
 	// Export
 	void setExportContainer(std::shared_ptr<chip::AbstractRegisterWriteLogger> cntr = nullptr);
@@ -107,6 +120,7 @@ private:
 	std::deque<RegisterWrite> registerDirectSetBuf_;
 
 	void resetState();
+	void updateChannelActivity();
 
 	std::unique_ptr<int16_t[]> outputHistory_;
 	size_t outputHistoryIndex_;
@@ -168,6 +182,7 @@ public:
 
 	// For state retrieve
 	void haltSequencesFM(int ch);
+	void setEchoBufferFM(int ch, const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnFM(int ch) const;
@@ -292,6 +307,7 @@ public:
 	void setNoteCutSSG(int ch);
 
 	void haltSequencesSSG(int ch);
+	void setEchoBufferSSG(int ch, const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnSSG(int ch) const;
@@ -419,8 +435,11 @@ public:
 	void setInstrumentDrumkit(std::shared_ptr<InstrumentDrumkit> inst);
 	void updateInstrumentDrumkit(int instNum, int key);
 	void clearSamplesADPCM();
+	/// Place samples in the DRAM and set their start and stop addresses to @addrs.
+	/// Samples already in the DRAM are kept as they are, and the others are released.
 	/// [Return] true if sample assignment is success
-	bool storeSampleADPCM(const std::vector<uint8_t>& sample, size_t& startAddr, size_t& stopAddr);
+	bool storeSamplesADPCM(const std::vector<SampleADPCMBuffer>& samples,
+						   std::unordered_map<const std::vector<uint8_t>*, std::array<size_t, 2>>& addrs);
 
 	// Set volume
 	void setVolumeADPCM(int volume);
@@ -442,6 +461,7 @@ public:
 
 	// For state retrieve
 	void haltSequencesADPCM();
+	void setEchoBufferADPCM(const EchoBuffer& buf);
 
 	// Chip details
 	bool isKeyOnADPCM() const;
@@ -464,7 +484,17 @@ private:
 	bool shouldWriteEnvADPCM_;
 	bool shouldSetToneADPCM_;
 	size_t startAddrADPCM_, stopAddrADPCM_;	// By 32 bytes
-	size_t storePointADPCM_;	// Move by 32 bytes
+	struct ResidentSampleADPCM
+	{
+		SampleADPCMBuffer sample;	///< Held to keep its address unique while it is in the DRAM
+		size_t startAddr, stopAddr;	///< By 32 bytes
+	};
+	/// Samples in the DRAM, keyed by their payload.
+	/// The entries hold strong references, so a payload dropped by every sample property
+	/// stays alive, and counted by SampleADPCMPool::getLiveCount(), until the next storeSamplesADPCM()
+	/// or clearSamplesADPCM() releases it.
+	std::unordered_map<const std::vector<uint8_t>*, ResidentSampleADPCM> residentSamplesADPCM_;
+	ADPCMMemoryAllocator dramAllocADPCM_;
 	ADPCMEnvelopeIter envItrADPCM_;
 	ArpeggioIterInterface arpItrADPCM_;
 	PitchIter ptItrADPCM_;
@@ -510,6 +540,8 @@ private:
 	void setRealVolumeADPCM();
 
 	void triggerSamplePlayADPCM(size_t startAddress, size_t stopAddress, bool shouldRepeat);
+
+	void writeSampleADPCM(const std::vector<uint8_t>& sample, size_t startAddr, size_t stopAddr);
 };
 
 //-----------------------------------------------------------------------------
@@ -97,9 +97,9 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	/* opna mode is changed in BambooTracker class */
 
 	size_t fmch = Song::getFMChannelCount(songStyle_.type);
-	effOnKeyOnMem_[SoundSource::FM] = std::vector<EffectMemory>(fmch);
-	effOnStepBeginMem_[SoundSource::FM] = std::vector<EffectMemory>(fmch);
-	directRegisterSets_[SoundSource::FM] = DirectRegisterSetSource(fmch);
+	effOnKeyOnMem_[soundSourceIndex(SoundSource::FM)] = std::vector<EffectMemory>(fmch);
+	effOnStepBeginMem_[soundSourceIndex(SoundSource::FM)] = std::vector<EffectMemory>(fmch);
+	directRegisterSets_[soundSourceIndex(SoundSource::FM)] = DirectRegisterSetSource(fmch);
 	ntDlyCntFM_ = std::vector<int>(fmch);
 	ntReleaseDlyCntFM_ = std::vector<int>(fmch);
 	volDlyCntFM_ = std::vector<int>(fmch);
@@ -111,9 +111,9 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	rtrgCntValueFM_ = std::vector<int>(fmch);
 	rtrgVolValueFM_ = std::vector<int>(fmch);
 
-	effOnKeyOnMem_[SoundSource::SSG] = std::vector<EffectMemory>(3);
-	effOnStepBeginMem_[SoundSource::SSG] = std::vector<EffectMemory>(3);
-	directRegisterSets_[SoundSource::SSG] = DirectRegisterSetSource(3);
+	effOnKeyOnMem_[soundSourceIndex(SoundSource::SSG)] = std::vector<EffectMemory>(3);
+	effOnStepBeginMem_[soundSourceIndex(SoundSource::SSG)] = std::vector<EffectMemory>(3);
+	directRegisterSets_[soundSourceIndex(SoundSource::SSG)] = DirectRegisterSetSource(3);
 	ntDlyCntSSG_ = std::vector<int>(3);
 	ntReleaseDlyCntSSG_ = std::vector<int>(3);
 	volDlyCntSSG_ = std::vector<int>(3);
@@ -125,9 +125,9 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	rtrgCntValueSSG_ = std::vector<int>(3);
 	rtrgVolValueSSG_ = std::vector<int>(3);
 
-	effOnKeyOnMem_[SoundSource::RHYTHM] = std::vector<EffectMemory>(6);
-	effOnStepBeginMem_[SoundSource::RHYTHM] = std::vector<EffectMemory>(6);
-	directRegisterSets_[SoundSource::RHYTHM] = DirectRegisterSetSource(6);
+	effOnKeyOnMem_[soundSourceIndex(SoundSource::RHYTHM)] = std::vector<EffectMemory>(6);
+	effOnStepBeginMem_[soundSourceIndex(SoundSource::RHYTHM)] = std::vector<EffectMemory>(6);
+	directRegisterSets_[soundSourceIndex(SoundSource::RHYTHM)] = DirectRegisterSetSource(6);
 	ntDlyCntRhythm_ = std::vector<int>(6);
 	ntReleaseDlyCntRhythm_ = std::vector<int>(6);
 	volDlyCntRhythm_ = std::vector<int>(6);
@@ -137,9 +137,9 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	rtrgCntValueRhythm_ = std::vector<int>(6);
 	rtrgVolValueRhythm_ = std::vector<int>(6);
 
-	effOnKeyOnMem_[SoundSource::ADPCM] = std::vector<EffectMemory>(1);
-	effOnStepBeginMem_[SoundSource::ADPCM] = std::vector<EffectMemory>(1);
-	directRegisterSets_[SoundSource::ADPCM] = DirectRegisterSetSource(1);
+	effOnKeyOnMem_[soundSourceIndex(SoundSource::ADPCM)] = std::vector<EffectMemory>(1);
+	effOnStepBeginMem_[soundSourceIndex(SoundSource::ADPCM)] = std::vector<EffectMemory>(1);
+	directRegisterSets_[soundSourceIndex(SoundSource::ADPCM)] = DirectRegisterSetSource(1);
 	ntDlyCntADPCM_ = 0;
 	ntReleaseDlyCntADPCM_ = 0;
 	volDlyCntADPCM_ = 0;
@@ -148,6 +148,31 @@ void PlaybackManager::setSong(std::weak_ptr<Module> mod, int songNum)
 	rtrgCntADPCM_ = 0;
 	rtrgCntValueADPCM_ = 0;
 	rtrgVolValueADPCM_ = 0;
+
+	trackUnits_.clear();
+	trackUnits_.reserve(songStyle_.trackAttribs.size());
+	for (const auto& attrib : songStyle_.trackAttribs) {
+		TrackUnit unit;
+		unit.number = attrib.number;
+		unit.channel = attrib.channelInSource;
+		unit.source = attrib.source;
+		switch (attrib.source) {
+		default:
+		case SoundSource::FM:		unit.storeEffectToMap = &PlaybackManager::storeEffectToMapFM;		break;
+		case SoundSource::SSG:		unit.storeEffectToMap = &PlaybackManager::storeEffectToMapSSG;		break;
+		case SoundSource::RHYTHM:	unit.storeEffectToMap = &PlaybackManager::storeEffectToMapRhythm;	break;
+		case SoundSource::ADPCM:	unit.storeEffectToMap = &PlaybackManager::storeEffectToMapADPCM;		break;
+		}
+		size_t src = soundSourceIndex(attrib.source);
+		size_t uch = static_cast<size_t>(attrib.channelInSource);
+		unit.keyOnMem = &effOnKeyOnMem_[src].at(uch);
+		unit.stepBeginMem = &effOnStepBeginMem_[src].at(uch);
+		unit.directRegisterSet = &directRegisterSets_[src].at(uch);
+		unit.step = nullptr;
+		trackUnits_.push_back(unit);
+	}
+
+	stateCheckpoints_.clear();
 }
 
 /********** Play song **********/
@@ -384,33 +409,24 @@ void PlaybackManager::stepProcess()
 	auto& song = mod_.lock()->getSong(curSongNum_);
 
 	// Store effects from the step to map
-	for (auto& attrib : songStyle_.trackAttribs) {
-		auto& step = song.getTrack(attrib.number)
-					 .getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
-		size_t uch = static_cast<size_t>(attrib.channelInSource);
-		effOnKeyOnMem_[attrib.source].at(uch).clear();
-		directRegisterSets_[attrib.source].at(uch).clear();
-		using storeFunc = void (PlaybackManager::*)(int, const Effect&);
-		static const std::unordered_map<SoundSource, storeFunc> storeEffectToMap = {
-			{ SoundSource::FM, &PlaybackManager::storeEffectToMapFM },
-			{ SoundSource::SSG, &PlaybackManager::storeEffectToMapSSG },
-			{ SoundSource::RHYTHM, &PlaybackManager::storeEffectToMapRhythm },
-			{ SoundSource::ADPCM, &PlaybackManager::storeEffectToMapADPCM }
-		};
+	for (TrackUnit& unit : trackUnits_) {
+		unit.step = &song.getTrack(unit.number)
+					.getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
+		unit.keyOnMem->clear();
+		unit.directRegisterSet->clear();
 		for (int i = 0; i < Step::N_EFFECT; ++i) {
-			Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(i));
-			(this->*storeEffectToMap.at(attrib.source))(attrib.channelInSource, eff);
+			Effect&& eff = effect_utils::validateEffect(unit.source, unit.step->getEffect(i));
+			(this->*unit.storeEffectToMap)(unit.channel, eff);
 		}
 	}
 
 	// Execute step events
 	bool isNextSet = executeStoredEffectsGlobal();
 	const int countsInStep = tickCounter_.lock()->getCountsInCurrentStep();
-	for (auto& attrib : songStyle_.trackAttribs) {
+	for (TrackUnit& unit : trackUnits_) {
 		// Check whether it has been set note delay effect
-		size_t uch = static_cast<size_t>(attrib.channelInSource);
 		bool hasSetNoteDelay = false;
-		auto& mem = effOnStepBeginMem_[attrib.source].at(uch);
+		EffectMemory& mem = *unit.stepBeginMem;
 		for (auto itr = mem.begin(); itr != mem.end(); ) {
 			if (itr->type == EffectType::NoteDelay) {
 				if (itr->value < countsInStep) {
@@ -425,45 +441,44 @@ void PlaybackManager::stepProcess()
 		}
 
 		//
-		auto& step = song.getTrack(attrib.number)
-					 .getPatternFromOrderNumber(playingPos_.order).getStep(playingPos_.step);
-		switch (attrib.source) {
+		const Step& step = *unit.step;
+		switch (unit.source) {
 		case SoundSource::FM:
 			if (hasSetNoteDelay) {
 				// Set effect
-				executeStoredEffectsFM(attrib.channelInSource);
-				checkFMNoteDelayAndEnvelopeReset(step, attrib.channelInSource);
-				opnaCtrl_->tickEvent(SoundSource::FM, attrib.channelInSource);
+				executeStoredEffectsFM(unit.channel);
+				checkFMNoteDelayAndEnvelopeReset(step, unit.channel);
+				opnaCtrl_->tickEvent(SoundSource::FM, unit.channel);
 			}
 			else {
-				executeFMStepEvents(step, attrib.channelInSource);
+				executeFMStepEvents(step, unit.channel);
 			}
 			break;
 		case SoundSource::SSG:
 			if (hasSetNoteDelay) {
 				// Set effect
-				executeStoredEffectsSSG(attrib.channelInSource);
-				opnaCtrl_->tickEvent(SoundSource::SSG, attrib.channelInSource);
+				executeStoredEffectsSSG(unit.channel);
+				opnaCtrl_->tickEvent(SoundSource::SSG, unit.channel);
 			}
 			else {
-				executeSSGStepEvents(step, attrib.channelInSource);
+				executeSSGStepEvents(step, unit.channel);
 			}
 			break;
 		case SoundSource::RHYTHM:
 			if (hasSetNoteDelay) {
 				// Set effect
-				executeStoredEffectsRhythm(attrib.channelInSource);
-				opnaCtrl_->tickEvent(SoundSource::RHYTHM, attrib.channelInSource);
+				executeStoredEffectsRhythm(unit.channel);
+				opnaCtrl_->tickEvent(SoundSource::RHYTHM, unit.channel);
 			}
 			else {
-				executeRhythmStepEvents(step, attrib.channelInSource);
+				executeRhythmStepEvents(step, unit.channel);
 			}
 			break;
 		case SoundSource::ADPCM:
 			if (hasSetNoteDelay) {
 				// Set effect
 				executeStoredEffectsADPCM();
-				opnaCtrl_->tickEvent(SoundSource::ADPCM, attrib.channelInSource);
+				opnaCtrl_->tickEvent(SoundSource::ADPCM, unit.channel);
 			}
 			else {
 				executeADPCMStepEvents(step);
@@ -753,14 +768,14 @@ void PlaybackManager::storeEffectToMapFM(int ch, const Effect& eff)
 	case EffectType::NoteCut:
 	case EffectType::Retrigger:
 	case EffectType::XVolumeSlide:
-		effOnKeyOnMem_[SoundSource::FM].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnKeyOnMem_[soundSourceIndex(SoundSource::FM)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::SpeedTempoChange:
 	case EffectType::Groove:
 		playbackSpeedEffMem_.enqueue(eff);
 		break;
 	case EffectType::NoteDelay:
-		effOnStepBeginMem_[SoundSource::FM].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnStepBeginMem_[soundSourceIndex(SoundSource::FM)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::PositionJump:
 	case EffectType::SongEnd:
@@ -779,7 +794,7 @@ void PlaybackManager::executeStoredEffectsFM(int ch)
 	bool isNoteDelay = false;
 
 	// Read step beginning based effects
-	auto& stepBeginBasedEffs = effOnStepBeginMem_[SoundSource::FM].at(uch);
+	auto& stepBeginBasedEffs = effOnStepBeginMem_[soundSourceIndex(SoundSource::FM)].at(uch);
 	for (const auto& eff : stepBeginBasedEffs) {
 		switch (eff.type) {
 		case EffectType::NoteDelay:
@@ -794,7 +809,7 @@ void PlaybackManager::executeStoredEffectsFM(int ch)
 
 	// Read note on and step beginning based effects
 	if (!isNoteDelay) {
-		auto& keyOnBasedEffs = effOnKeyOnMem_[SoundSource::FM].at(uch);
+		auto& keyOnBasedEffs = effOnKeyOnMem_[soundSourceIndex(SoundSource::FM)].at(uch);
 		for (auto& eff : keyOnBasedEffs) {
 			switch (eff.type) {
 			case EffectType::Arpeggio:
@@ -917,7 +932,7 @@ void PlaybackManager::executeStoredEffectsFM(int ch)
 		}
 		keyOnBasedEffs.clear();
 
-		executeDirectRegisterSetEffect(directRegisterSets_[SoundSource::FM].at(uch));
+		executeDirectRegisterSetEffect(directRegisterSets_[soundSourceIndex(SoundSource::FM)].at(uch));
 	}
 }
 
@@ -946,14 +961,14 @@ void PlaybackManager::storeEffectToMapSSG(int ch, const Effect& eff)
 	case EffectType::NoteCut:
 	case EffectType::Retrigger:
 	case EffectType::XVolumeSlide:
-		effOnKeyOnMem_[SoundSource::SSG].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnKeyOnMem_[soundSourceIndex(SoundSource::SSG)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::SpeedTempoChange:
 	case EffectType::Groove:
 		playbackSpeedEffMem_.enqueue(eff);
 		break;
 	case EffectType::NoteDelay:
-		effOnStepBeginMem_[SoundSource::SSG].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnStepBeginMem_[soundSourceIndex(SoundSource::SSG)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::PositionJump:
 	case EffectType::SongEnd:
@@ -972,7 +987,7 @@ void PlaybackManager::executeStoredEffectsSSG(int ch)
 	bool isNoteDelay = false;
 
 	// Read step beginning based effects
-	auto& stepBeginBasedEffs = effOnStepBeginMem_[SoundSource::SSG].at(uch);
+	auto& stepBeginBasedEffs = effOnStepBeginMem_[soundSourceIndex(SoundSource::SSG)].at(uch);
 	for (const auto& eff : stepBeginBasedEffs) {
 		switch (eff.type) {
 		case EffectType::NoteDelay:
@@ -987,7 +1002,7 @@ void PlaybackManager::executeStoredEffectsSSG(int ch)
 
 	// Read note on and step beginning based effects
 	if (!isNoteDelay) {
-		auto& keyOnBasedEffs = effOnKeyOnMem_[SoundSource::SSG].at(uch);
+		auto& keyOnBasedEffs = effOnKeyOnMem_[soundSourceIndex(SoundSource::SSG)].at(uch);
 		for (const auto& eff : keyOnBasedEffs) {
 			switch (eff.type) {
 			case EffectType::Arpeggio:
@@ -1079,7 +1094,7 @@ void PlaybackManager::executeStoredEffectsSSG(int ch)
 		}
 		keyOnBasedEffs.clear();
 
-		executeDirectRegisterSetEffect(directRegisterSets_[SoundSource::SSG].at(uch));
+		executeDirectRegisterSetEffect(directRegisterSets_[soundSourceIndex(SoundSource::SSG)].at(uch));
 	}
 }
 
@@ -1092,14 +1107,14 @@ void PlaybackManager::storeEffectToMapRhythm(int ch, const Effect& eff)
 	case EffectType::VolumeDelay:
 	case EffectType::NoteCut:
 	case EffectType::Retrigger:
-		effOnKeyOnMem_[SoundSource::RHYTHM].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnKeyOnMem_[soundSourceIndex(SoundSource::RHYTHM)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::SpeedTempoChange:
 	case EffectType::Groove:
 		playbackSpeedEffMem_.enqueue(eff);
 		break;
 	case EffectType::NoteDelay:
-		effOnStepBeginMem_[SoundSource::RHYTHM].at(static_cast<size_t>(ch)).enqueue(eff);
+		effOnStepBeginMem_[soundSourceIndex(SoundSource::RHYTHM)].at(static_cast<size_t>(ch)).enqueue(eff);
 		break;
 	case EffectType::PositionJump:
 	case EffectType::SongEnd:
@@ -1118,7 +1133,7 @@ void PlaybackManager::executeStoredEffectsRhythm(int ch)
 	bool isNoteDelay = false;
 
 	// Read step beginning based effects
-	auto& stepBeginBasedEffs = effOnStepBeginMem_[SoundSource::RHYTHM].at(uch);
+	auto& stepBeginBasedEffs = effOnStepBeginMem_[soundSourceIndex(SoundSource::RHYTHM)].at(uch);
 	for (const auto& eff : stepBeginBasedEffs) {
 		switch (eff.type) {
 		case EffectType::NoteDelay:
@@ -1133,7 +1148,7 @@ void PlaybackManager::executeStoredEffectsRhythm(int ch)
 
 	// Read key on and step beginning based effects
 	if (!isNoteDelay) {
-		auto& keyOnBasedEffs = effOnKeyOnMem_[SoundSource::RHYTHM].at(uch);
+		auto& keyOnBasedEffs = effOnKeyOnMem_[soundSourceIndex(SoundSource::RHYTHM)].at(uch);
 		for (const auto& eff : keyOnBasedEffs) {
 			switch (eff.type) {
 			case EffectType::Pan:
@@ -1173,7 +1188,7 @@ void PlaybackManager::executeStoredEffectsRhythm(int ch)
 		}
 		keyOnBasedEffs.clear();
 
-		executeDirectRegisterSetEffect(directRegisterSets_[SoundSource::RHYTHM].at(uch));
+		executeDirectRegisterSetEffect(directRegisterSets_[soundSourceIndex(SoundSource::RHYTHM)].at(uch));
 	}
 }
 
@@ -1198,14 +1213,14 @@ void PlaybackManager::storeEffectToMapADPCM(int ch, const Effect& eff)
 	case EffectType::NoteCut:
 	case EffectType::Retrigger:
 	case EffectType::XVolumeSlide:
-		effOnKeyOnMem_[SoundSource::ADPCM].front().enqueue(eff);
+		effOnKeyOnMem_[soundSourceIndex(SoundSource::ADPCM)].front().enqueue(eff);
 		break;
 	case EffectType::SpeedTempoChange:
 	case EffectType::Groove:
 		playbackSpeedEffMem_.enqueue(eff);
 		break;
 	case EffectType::NoteDelay:
-		effOnStepBeginMem_[SoundSource::ADPCM].front().enqueue(eff);
+		effOnStepBeginMem_[soundSourceIndex(SoundSource::ADPCM)].front().enqueue(eff);
 		break;
 	case EffectType::PositionJump:
 	case EffectType::SongEnd:
@@ -1223,7 +1238,7 @@ void PlaybackManager::executeStoredEffectsADPCM()
 	bool isNoteDelay = false;
 
 	// Read step beginning based effects
-	auto& stepBeginBasedEffs = effOnStepBeginMem_[SoundSource::ADPCM].front();
+	auto& stepBeginBasedEffs = effOnStepBeginMem_[soundSourceIndex(SoundSource::ADPCM)].front();
 	for (const auto& eff : stepBeginBasedEffs) {
 		switch (eff.type) {
 		case EffectType::NoteDelay:
@@ -1238,7 +1253,7 @@ void PlaybackManager::executeStoredEffectsADPCM()
 
 	// Read note on and step beginning based effects
 	if (!isNoteDelay) {
-		auto& keyOnBasedEffs = effOnKeyOnMem_[SoundSource::ADPCM].front();
+		auto& keyOnBasedEffs = effOnKeyOnMem_[soundSourceIndex(SoundSource::ADPCM)].front();
 		for (const auto& eff : keyOnBasedEffs) {
 			switch (eff.type) {
 			case EffectType::Arpeggio:
@@ -1318,7 +1333,7 @@ void PlaybackManager::executeStoredEffectsADPCM()
 		}
 		keyOnBasedEffs.clear();
 
-		executeDirectRegisterSetEffect(directRegisterSets_[SoundSource::ADPCM].front());
+		executeDirectRegisterSetEffect(directRegisterSets_[soundSourceIndex(SoundSource::ADPCM)].front());
 	}
 }
 
@@ -1328,17 +1343,17 @@ void PlaybackManager::storeDirectRegisterSetEffectToQueue(SoundSource src, int c
 	switch (eff.type) {
 	case EffectType::RegisterAddress0:
 		if (-1 < eff.value && eff.value < 0x6c) {
-			directRegisterSets_.at(src).at(uch).push_back({ eff.value, 0, false });
+			directRegisterSets_[soundSourceIndex(src)].at(uch).push_back({ eff.value, 0, false });
 		}
 		break;
 	case EffectType::RegisterAddress1:
 		if (-1 < eff.value && eff.value < 0x6c) {
-			directRegisterSets_.at(src).at(uch).push_back({ 0x100 | eff.value, 0, false });
+			directRegisterSets_[soundSourceIndex(src)].at(uch).push_back({ 0x100 | eff.value, 0, false });
 		}
 		break;
 	case EffectType::RegisterValue:
 	{
-		DirectRegisterSetQueue& queue = directRegisterSets_.at(src).at(uch);
+		DirectRegisterSetQueue& queue = directRegisterSets_[soundSourceIndex(src)].at(uch);
 		if (!queue.empty() && -1 < eff.value) {
 			RegisterUnit& unit = queue.back();
 			unit.value = eff.value;
@@ -1586,14 +1601,14 @@ void PlaybackManager::clearEffectMaps()
 	playbackSpeedEffMem_.clear();
 	posChangeEffMem_.clear();
 
-	for (auto& maps: effOnKeyOnMem_) {
-		for (EffectMemory& mem : maps.second) mem.clear();
+	for (auto& mems: effOnKeyOnMem_) {
+		for (EffectMemory& mem : mems) mem.clear();
 	}
-	for (auto& maps: effOnStepBeginMem_) {
-		for (EffectMemory& mem : maps.second) mem.clear();
+	for (auto& mems: effOnStepBeginMem_) {
+		for (EffectMemory& mem : mems) mem.clear();
 	}
-	for (auto& maps: directRegisterSets_) {
-		for (DirectRegisterSetQueue& queue : maps.second) queue.clear();
+	for (auto& queues: directRegisterSets_) {
+		for (DirectRegisterSetQueue& queue : queues) queue.clear();
 	}
 }
 
@@ -1732,576 +1747,534 @@ void PlaybackManager::setChannelRetrieving(bool enabled)
 	isRetrieveChannel_ = enabled;
 }
 
+namespace
+{
+/// Slots of the channel states recorded for each channel.
+namespace ChannelState
+{
+enum : size_t
+{
+	Volume, Instrument, Arpeggio, Portamento, Vibrato, Tremolo, Pan, VolumeSlide, Detune, FineDetune,
+	XVolumeSlide, FBControl, TLControl, MLControl, ARControl, DRControl, RRControl, Brightness,
+	ToneNoiseMix, Count
+};
+}
+
+/// Slots of the channel states shared by all channels.
+namespace GlobalState
+{
+enum : size_t
+{
+	NoisePitch, HardEnvHighPeriod, HardEnvLowPeriod, AutoEnvelope, MasterVolumeRhythm,
+	Speed, Tempo, Groove, Count
+};
+}
+
+constexpr size_t RETRIEVED_SSG_CH_BEGIN = 9;
+constexpr size_t RETRIEVED_RHYTHM_CH_BEGIN = 12;
+constexpr size_t RETRIEVED_ADPCM_CH = 18;
+
+inline size_t retrievedChannelIndex(SoundSource src, int ch)
+{
+	switch (src) {
+	default:
+	case SoundSource::FM:		return static_cast<size_t>(ch);
+	case SoundSource::SSG:		return RETRIEVED_SSG_CH_BEGIN + static_cast<size_t>(ch);
+	case SoundSource::RHYTHM:	return RETRIEVED_RHYTHM_CH_BEGIN + static_cast<size_t>(ch);
+	case SoundSource::ADPCM:	return RETRIEVED_ADPCM_CH;
+	}
+}
+
+inline SoundSource retrievedChannelSource(size_t uch)
+{
+	if (uch < RETRIEVED_SSG_CH_BEGIN) return SoundSource::FM;
+	if (uch < RETRIEVED_RHYTHM_CH_BEGIN) return SoundSource::SSG;
+	if (uch < RETRIEVED_ADPCM_CH) return SoundSource::RHYTHM;
+	return SoundSource::ADPCM;
+}
+}
+
+PlaybackManager::ChannelStateRecord::ChannelStateRecord()
+	: stepCount(0)
+{
+	static_assert(ChannelState::Count == N_RETRIEVED_CH_STATE, "Mismatch of channel state count");
+	static_assert(GlobalState::Count == N_RETRIEVED_GLOBAL_STATE, "Mismatch of global state count");
+	static_assert(RETRIEVED_ADPCM_CH + 1 == N_RETRIEVED_CH, "Mismatch of channel count");
+
+	for (auto& state : states) state.rank = -1;
+}
+
+void PlaybackManager::invalidateChannelStates(int songNum, int order)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (songNum != curSongNum_) return;
+	// The checkpoint of an order holds the states set before the order
+	size_t size = static_cast<size_t>(std::max(order, 0)) + 1;
+	if (size < stateCheckpoints_.size())
+		stateCheckpoints_.erase(stateCheckpoints_.begin() + static_cast<std::ptrdiff_t>(size), stateCheckpoints_.end());
+}
+
 void PlaybackManager::retrieveChannelStates()
 {
+	// Replay the steps from the beginning of the order instead of the song
+	ChannelStateRecord record = getChannelStateCheckpoint(playingPos_.order);
+	recordChannelStates(record, playingPos_.order, 0, playingPos_.step, true);
+	// The states set in the current step are not restored, but hide the older ones
+	int64_t endRank = record.stepCount * static_cast<int64_t>(trackUnits_.size() * (Step::N_EFFECT + 2));
+	recordChannelStates(record, playingPos_.order, playingPos_.step, playingPos_.step + 1, false);
+	applyChannelStates(record, endRank);
+
+	// Sequence reset
 	size_t fmch = Song::getFMChannelCount(songStyle_.type);
+	for (size_t ch = 0; ch < fmch; ++ch) {
+		opnaCtrl_->haltSequencesFM(static_cast<int>(ch));
+	}
+	for (size_t ch = 0; ch < 3; ++ch) {
+		opnaCtrl_->haltSequencesSSG(static_cast<int>(ch));
+	}
+	opnaCtrl_->haltSequencesADPCM();
+}
+
+const PlaybackManager::ChannelStateRecord& PlaybackManager::getChannelStateCheckpoint(int order)
+{
+	if (stateCheckpoints_.empty()) stateCheckpoints_.emplace_back();
+
+	while (static_cast<int>(stateCheckpoints_.size()) <= order) {
+		int prevOrder = static_cast<int>(stateCheckpoints_.size()) - 1;
+		ChannelStateRecord record = stateCheckpoints_.back();
+		int size = static_cast<int>(getPatternSizeFromOrderNumber(curSongNum_, prevOrder));
+		recordChannelStates(record, prevOrder, 0, size, true);
+		stateCheckpoints_.push_back(std::move(record));
+	}
 
-	// Skip echo buffer due to takes time to search
-	std::vector<bool> isSetInstFM(fmch, false), isSetVolFM(fmch, false), isSetArpFM(fmch, false);
-	std::vector<bool> isSetPrtFM(fmch, false), isSetVibFM(fmch, false), isSetTreFM(fmch, false);
-	std::vector<bool> isSetPanFM(fmch, false), isSetVolSldFM(fmch, false), isSetDtnFM(fmch, false);
-	std::vector<bool> isSetFBCtrlFM(fmch, false), isSetTLCtrlFM(fmch, false), isSetMLCtrlFM(fmch, false);
-	std::vector<bool> isSetARCtrlFM(fmch, false), isSetDRCtrlFM(fmch, false), isSetRRCtrlFM(fmch, false);
-	std::vector<bool> isSetBrightFM(fmch, false), isSetFiDtnFM(fmch, false), isSetXVolSldFM(fmch, false);
-	std::vector<bool> isSetInstSSG(3, false), isSetVolSSG(3, false), isSetArpSSG(3, false), isSetPrtSSG(3, false);
-	std::vector<bool> isSetVibSSG(3, false), isSetTreSSG(3, false), isSetVolSldSSG(3, false), isSetDtnSSG(3, false);
-	std::vector<bool> isSetTNMixSSG(3, false), isSetFiDtnSSG(3, false), isSetXVolSldSSG(3, false);
-	std::vector<bool> isSetVolRhythm(6, false), isSetPanRhythm(6, false);
-	bool isSetInstADPCM(false), isSetVolADPCM(false), isSetArpADPCM(false), isSetPrtADPCM(false);
-	bool isSetVibADPCM(false), isSetTreADPCM(false), isSetPanADPCM(false), isSetVolSldADPCM(false);
-	bool isSetDtnADPCM(false), isSetFiDtnADPCM(false), isSetXVolSldADPCM(false);
-	bool isSetMVolRhythm = false;
-	bool isSetNoisePitchSSG = false;
-	bool isSetHardEnvPeriodHighSSG = false;
-	bool isSetHardEnvPeriodLowSSG = false;
-	bool isSetAutoEnvSSG = false;
-	/// bit0: step
-	/// bit1: tempo
-	/// bit2: groove
-	uint8_t speedStates = 0;
-
-	Position pos = playingPos_;
-	bool isPrevPos = false;
+	return stateCheckpoints_[static_cast<size_t>(order)];
+}
+
+void PlaybackManager::recordChannelStates(ChannelStateRecord& record, int order, int beginStep, int endStep,
+										  bool updatesEchoBuffer)
+{
 	Song& song = mod_.lock()->getSong(curSongNum_);
+	std::shared_ptr<InstrumentsManager> instMan = instMan_.lock();
+	const int grooveCnt = static_cast<int>(mod_.lock()->getGrooveCount());
+	const int64_t nTracks = static_cast<int64_t>(trackUnits_.size());
+	constexpr int64_t N_RANK_IN_TRACK = Step::N_EFFECT + 2;
+
+	for (int s = beginStep; s < endStep; ++s, ++record.stepCount) {
+		for (size_t t = 0; t < trackUnits_.size(); ++t) {
+			const TrackUnit& unit = trackUnits_[t];
+			const Step& step = song.getTrack(unit.number).getPatternFromOrderNumber(order).getStep(s);
+			const int ch = unit.channel;
+			const size_t uch = retrievedChannelIndex(unit.source, ch);
+			const int64_t rankBase = (record.stepCount * nTracks + static_cast<int64_t>(t)) * N_RANK_IN_TRACK;
+			RetrievedState* chStates = &record.states[uch * N_RETRIEVED_CH_STATE];
+			RetrievedState* globalStates = &record.states[N_RETRIEVED_CH * N_RETRIEVED_CH_STATE];
+			auto set = [ch](RetrievedState& state, int64_t rank, int value, EffectType type = EffectType::NoEffect) {
+				state.rank = rank;
+				state.ch = ch;
+				state.value = value;
+				state.type = type;
+			};
+
+			// Volume
+			int vol = step.getVolume();
+			if (step.hasVolume()) {
+				int nVol = 0;
+				switch (unit.source) {
+				case SoundSource::FM:		nVol = bt_defs::NSTEP_FM_VOLUME;		break;
+				case SoundSource::SSG:		nVol = bt_defs::NSTEP_SSG_VOLUME;		break;
+				case SoundSource::RHYTHM:	nVol = bt_defs::NSTEP_RHYTHM_VOLUME;	break;
+				case SoundSource::ADPCM:	nVol = bt_defs::NSTEP_ADPCM_VOLUME;	break;
+				}
+				if (vol < nVol) set(chStates[ChannelState::Volume], rankBase + Step::N_EFFECT + 1, vol);
+			}
 
-	while (true) {
-		for (auto it = songStyle_.trackAttribs.rbegin(), e = songStyle_.trackAttribs.rend(); it != e; ++it) {
-			Step& step = song.getTrack(it->number).getPatternFromOrderNumber(pos.order).getStep(pos.step);
-			int ch = it->channelInSource;
-			size_t uch = static_cast<size_t>(ch);
+			// Instrument
+			if (step.hasInstrument() && unit.source != SoundSource::RHYTHM) {
+				int num = step.getInstrumentNumber();
+				std::shared_ptr<AbstractInstrument> inst = instMan->getInstrumentSharedPtr(num);
+				bool isValid = false;
+				switch (unit.source) {
+				case SoundSource::FM:		isValid = std::dynamic_pointer_cast<InstrumentFM>(inst) != nullptr;	break;
+				case SoundSource::SSG:		isValid = std::dynamic_pointer_cast<InstrumentSSG>(inst) != nullptr;	break;
+				case SoundSource::ADPCM:	isValid = std::dynamic_pointer_cast<InstrumentADPCM>(inst) != nullptr;	break;
+				default:	break;
+				}
+				if (isValid) set(chStates[ChannelState::Instrument], rankBase + Step::N_EFFECT, num);
+			}
 
-			switch (it->source) {
-			case SoundSource::FM:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolFM[uch] && step.hasVolume() && vol < bt_defs::NSTEP_FM_VOLUME) {
-					isSetVolFM[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeFM(ch, vol);
+			// Effects
+			for (int i = 0; i < Step::N_EFFECT; ++i) {
+				Effect eff = effect_utils::validateEffect(unit.source, step.getEffect(i));
+				int64_t rank = rankBase + i;
+				switch (eff.type) {
+				case EffectType::Arpeggio:
+					set(chStates[ChannelState::Arpeggio], rank, eff.value);
+					break;
+				case EffectType::PortamentoUp:
+				case EffectType::PortamentoDown:
+				case EffectType::TonePortamento:
+					set(chStates[ChannelState::Portamento], rank, eff.value, eff.type);
+					break;
+				case EffectType::Vibrato:
+					set(chStates[ChannelState::Vibrato], rank, eff.value);
+					break;
+				case EffectType::Tremolo:
+					set(chStates[ChannelState::Tremolo], rank, eff.value);
+					break;
+				case EffectType::Pan:
+					if (-1 < eff.value && eff.value < 4) set(chStates[ChannelState::Pan], rank, eff.value);
+					break;
+				case EffectType::VolumeSlide:
+					set(chStates[ChannelState::VolumeSlide], rank, eff.value);
+					break;
+				case EffectType::SpeedTempoChange:
+					set(globalStates[eff.value < 0x20 ? GlobalState::Speed : GlobalState::Tempo], rank, eff.value);
+					break;
+				case EffectType::Groove:
+					if (eff.value < grooveCnt) set(globalStates[GlobalState::Groove], rank, eff.value);
+					break;
+				case EffectType::Detune:
+					set(chStates[ChannelState::Detune], rank, eff.value);
+					break;
+				case EffectType::FineDetune:
+					set(chStates[ChannelState::FineDetune], rank, eff.value);
+					break;
+				case EffectType::XVolumeSlide:
+					set(chStates[ChannelState::XVolumeSlide], rank, eff.value);
+					break;
+				case EffectType::FBControl:
+					set(chStates[ChannelState::FBControl], rank, eff.value);
+					break;
+				case EffectType::TLControl:
+					set(chStates[ChannelState::TLControl], rank, eff.value);
+					break;
+				case EffectType::MLControl:
+					set(chStates[ChannelState::MLControl], rank, eff.value);
+					break;
+				case EffectType::ARControl:
+					set(chStates[ChannelState::ARControl], rank, eff.value);
+					break;
+				case EffectType::DRControl:
+					set(chStates[ChannelState::DRControl], rank, eff.value);
+					break;
+				case EffectType::RRControl:
+					set(chStates[ChannelState::RRControl], rank, eff.value);
+					break;
+				case EffectType::Brightness:
+					set(chStates[ChannelState::Brightness], rank, eff.value);
+					break;
+				case EffectType::ToneNoiseMix:
+					if (-1 < eff.value && eff.value < 4) set(chStates[ChannelState::ToneNoiseMix], rank, eff.value);
+					break;
+				case EffectType::NoisePitch:
+					if (-1 < eff.value && eff.value < 32) set(globalStates[GlobalState::NoisePitch], rank, eff.value);
+					break;
+				case EffectType::HardEnvHighPeriod:
+					set(globalStates[GlobalState::HardEnvHighPeriod], rank, eff.value);
+					break;
+				case EffectType::HardEnvLowPeriod:
+					set(globalStates[GlobalState::HardEnvLowPeriod], rank, eff.value);
+					break;
+				case EffectType::AutoEnvelope:
+					set(globalStates[GlobalState::AutoEnvelope], rank, eff.value);
+					break;
+				case EffectType::MasterVolume:
+					if (-1 < eff.value && eff.value < 64) set(globalStates[GlobalState::MasterVolumeRhythm], rank, eff.value);
+					break;
+				default:
+					break;
 				}
-				// Instrument
-				if (!isSetInstFM[uch] && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentFM>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstFM[uch] = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentFM(ch, inst);
+			}
+
+			// Echo buffer
+			if (updatesEchoBuffer && unit.source != SoundSource::RHYTHM) {
+				EchoBuffer& buf = record.echoBuffers[uch];
+				int noteNum = step.getNoteNumber();
+				switch (noteNum) {
+				case Step::NOTE_NONE:
+				case Step::NOTE_KEY_OFF:
+				case Step::NOTE_KEY_CUT:
+					break;
+				case Step::NOTE_ECHO0:
+				case Step::NOTE_ECHO1:
+				case Step::NOTE_ECHO2:
+				case Step::NOTE_ECHO3:
+				{
+					size_t n = static_cast<size_t>(Step::NOTE_ECHO0 - noteNum);
+					if (n < buf.size()) {
+						Note note = buf[n];
+						buf.push(note);
 					}
+					break;
 				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::FM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpFM[uch]) {
-							isSetArpFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, -eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtFM[uch]) {
-							isSetPrtFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectFM(ch, eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibFM[uch]) {
-							isSetVibFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreFM[uch]) {
-							isSetTreFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectFM(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanFM[uch]) {
-							isSetPanFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPanFM(ch, eff.value);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldFM[uch]) {
-							isSetVolSldFM[uch] = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideFM(ch, hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideFM(ch, low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnFM[uch]) {
-							isSetDtnFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setDetuneFM(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnFM[uch]) {
-							isSetFiDtnFM[uch] = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneFM(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FBControl:
-						if (!isSetFBCtrlFM[uch]) {
-							isSetFBCtrlFM[uch] = true;
-							if (isPrevPos) {
-								if (-1 < eff.value && eff.value < 8) opnaCtrl_->setFBControlFM(ch, eff.value);
-							}
-						}
-						break;
-					case EffectType::TLControl:
-						if (!isSetTLCtrlFM[uch]) {
-							isSetTLCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 128)
-									opnaCtrl_->setTLControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::MLControl:
-						if (!isSetMLCtrlFM[uch]) {
-							isSetMLCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 4;
-								int val = eff.value & 0x0f;
-								if (0 < op && op < 5 && -1 < val && val < 16)
-									opnaCtrl_->setMLControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::ARControl:
-						if (!isSetARCtrlFM[uch]) {
-							isSetARCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 32)
-									opnaCtrl_->setARControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::DRControl:
-						if (!isSetDRCtrlFM[uch]) {
-							isSetDRCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 8;
-								int val = eff.value & 0x00ff;
-								if (0 < op && op < 5 && -1 < val && val < 32)
-									opnaCtrl_->setDRControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::RRControl:
-						if (!isSetRRCtrlFM[uch]) {
-							isSetRRCtrlFM[uch] = true;
-							if (isPrevPos) {
-								int op = eff.value >> 4;
-								int val = eff.value & 0x0f;
-								if (0 < op && op < 5 && -1 < val && val < 16)
-									opnaCtrl_->setRRControlFM(ch, op - 1, val);
-							}
-						}
-						break;
-					case EffectType::Brightness:
-						if (!isSetBrightFM[uch]) {
-							isSetBrightFM[uch] = true;
-							if (isPrevPos) {
-								if (0 < eff.value) opnaCtrl_->setBrightnessFM(ch, eff.value - 0x80);
-							}
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldFM[uch]) {
-							isSetXVolSldFM[uch] = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideFM(ch, factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
+				default:
+					buf.push(Note(noteNum));
+					break;
 				}
+			}
+		}
+	}
+}
+
+void PlaybackManager::applyChannelStates(const ChannelStateRecord& record, int64_t endRank)
+{
+	// Groove is used only when it is set after the last speed and tempo changes
+	const RetrievedState* globalStates = &record.states[N_RETRIEVED_CH * N_RETRIEVED_CH_STATE];
+	int64_t grooveRank = globalStates[GlobalState::Groove].rank;
+	bool usesGroove = (grooveRank > globalStates[GlobalState::Speed].rank
+					   && grooveRank > globalStates[GlobalState::Tempo].rank);
+
+	// Set states in the same order as searching backward from the position
+	std::vector<size_t> slots;
+	for (size_t i = 0; i < record.states.size(); ++i) {
+		const RetrievedState& state = record.states[i];
+		if (state.rank < 0 || endRank <= state.rank) continue;
+		if (i >= N_RETRIEVED_CH * N_RETRIEVED_CH_STATE) {
+			size_t kind = i - N_RETRIEVED_CH * N_RETRIEVED_CH_STATE;
+			if (usesGroove ? (kind == GlobalState::Speed || kind == GlobalState::Tempo)
+				: kind == GlobalState::Groove) continue;
+		}
+		slots.push_back(i);
+	}
+	std::sort(slots.begin(), slots.end(), [&record](size_t a, size_t b) {
+		return record.states[a].rank > record.states[b].rank;
+	});
+
+	std::shared_ptr<InstrumentsManager> instMan = instMan_.lock();
+	for (const size_t i : slots) {
+		const RetrievedState& state = record.states[i];
+		const int ch = state.ch;
+		const int value = state.value;
+
+		if (i >= N_RETRIEVED_CH * N_RETRIEVED_CH_STATE) {
+			switch (i - N_RETRIEVED_CH * N_RETRIEVED_CH_STATE) {
+			case GlobalState::NoisePitch:
+				opnaCtrl_->setNoisePitchSSG(ch, value);
+				break;
+			case GlobalState::HardEnvHighPeriod:
+				opnaCtrl_->setHardEnvelopePeriod(ch, true, value);
+				break;
+			case GlobalState::HardEnvLowPeriod:
+				opnaCtrl_->setHardEnvelopePeriod(ch, false, value);
+				break;
+			case GlobalState::AutoEnvelope:
+				opnaCtrl_->setAutoEnvelopeSSG(ch, (value >> 4) - 8, value & 0x0f);
+				break;
+			case GlobalState::MasterVolumeRhythm:
+				opnaCtrl_->setMasterVolumeRhythm(value);
+				break;
+			case GlobalState::Speed:
+				effSpeedChange(value);
+				break;
+			case GlobalState::Tempo:
+				effTempoChange(value);
+				break;
+			case GlobalState::Groove:
+				effGrooveChange(value);
+				break;
+			default:
 				break;
 			}
-			case SoundSource::SSG:
-			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolSSG[uch] && step.hasVolume() && vol < bt_defs::NSTEP_SSG_VOLUME) {
-					isSetVolSSG[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeSSG(ch, vol);
-				}
-				// Instrument
-				if (!isSetInstSSG[uch] && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentSSG>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstSSG[uch] = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentSSG(ch, inst);
-					}
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::SSG, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpSSG[uch]) {
-							isSetArpSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, -eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtSSG[uch]) {
-							isSetPrtSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectSSG(ch, eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibSSG[uch]) {
-							isSetVibSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreSSG[uch]) {
-							isSetTreSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectSSG(ch, eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldSSG[uch]) {
-							isSetVolSldSSG[uch] = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideSSG(ch, hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideSSG(ch, low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnSSG[uch]) {
-							isSetDtnSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setDetuneSSG(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnSSG[uch]) {
-							isSetFiDtnSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneSSG(ch, eff.value - 0x80);
-						}
-						break;
-					case EffectType::ToneNoiseMix:
-						if (-1 < eff.value && eff.value < 4 && !isSetTNMixSSG[uch]) {
-							isSetTNMixSSG[uch] = true;
-							if (isPrevPos) opnaCtrl_->setToneNoiseMixSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::NoisePitch:
-						if (-1 < eff.value && eff.value < 32 && !isSetNoisePitchSSG) {
-							isSetNoisePitchSSG = true;
-							if (isPrevPos) opnaCtrl_->setNoisePitchSSG(ch, eff.value);
-						}
-						break;
-					case EffectType::HardEnvHighPeriod:
-						if (!isSetHardEnvPeriodHighSSG) {
-							isSetHardEnvPeriodHighSSG = true;
-							if (isPrevPos) opnaCtrl_->setHardEnvelopePeriod(ch, true, eff.value);
-						}
-						break;
-					case EffectType::HardEnvLowPeriod:
-						if (!isSetHardEnvPeriodLowSSG) {
-							isSetHardEnvPeriodLowSSG = true;
-							if (isPrevPos) opnaCtrl_->setHardEnvelopePeriod(ch, false, eff.value);
-						}
-						break;
-					case EffectType::AutoEnvelope:
-						if (!isSetAutoEnvSSG) {
-							isSetAutoEnvSSG = true;
-							if (isPrevPos) opnaCtrl_->setAutoEnvelopeSSG(ch, (eff.value >> 4) - 8, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldSSG[uch]) {
-							isSetXVolSldSSG[uch] = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideSSG(ch, factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
+			continue;
+		}
+
+		const size_t kind = i % N_RETRIEVED_CH_STATE;
+		const int hi = value >> 4;
+		const int low = value & 0x0f;
+		switch (retrievedChannelSource(i / N_RETRIEVED_CH_STATE)) {
+		case SoundSource::FM:
+			switch (kind) {
+			case ChannelState::Volume:
+				opnaCtrl_->setVolumeFM(ch, value);
+				break;
+			case ChannelState::Instrument:
+				if (auto inst = std::dynamic_pointer_cast<InstrumentFM>(instMan->getInstrumentSharedPtr(value)))
+					opnaCtrl_->setInstrumentFM(ch, inst);
+				break;
+			case ChannelState::Arpeggio:
+				opnaCtrl_->setArpeggioEffectFM(ch, hi, low);
+				break;
+			case ChannelState::Portamento:
+				switch (state.type) {
+				case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectFM(ch, value);		break;
+				case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectFM(ch, -value);		break;
+				default:							opnaCtrl_->setPortamentoEffectFM(ch, value, true);	break;
 				}
 				break;
+			case ChannelState::Vibrato:
+				opnaCtrl_->setVibratoEffectFM(ch, hi, low);
+				break;
+			case ChannelState::Tremolo:
+				opnaCtrl_->setTremoloEffectFM(ch, hi, low);
+				break;
+			case ChannelState::Pan:
+				opnaCtrl_->setPanFM(ch, value);
+				break;
+			case ChannelState::VolumeSlide:
+				if (hi && !low) opnaCtrl_->setVolumeSlideFM(ch, hi, true);	// Slide up
+				else if (!hi) opnaCtrl_->setVolumeSlideFM(ch, low, false);	// Slide down
+				break;
+			case ChannelState::Detune:
+				opnaCtrl_->setDetuneFM(ch, value - 0x80);
+				break;
+			case ChannelState::FineDetune:
+				opnaCtrl_->setFineDetuneFM(ch, value - 0x80);
+				break;
+			case ChannelState::XVolumeSlide:
+				opnaCtrl_->setXVolumeSlideFM(ch, hi - low);
+				break;
+			case ChannelState::FBControl:
+				if (-1 < value && value < 8) opnaCtrl_->setFBControlFM(ch, value);
+				break;
+			case ChannelState::TLControl:
+			{
+				int op = value >> 8;
+				int val = value & 0x00ff;
+				if (0 < op && op < 5 && -1 < val && val < 128) opnaCtrl_->setTLControlFM(ch, op - 1, val);
+				break;
 			}
-			case SoundSource::RHYTHM:
+			case ChannelState::MLControl:
+				if (0 < hi && hi < 5) opnaCtrl_->setMLControlFM(ch, hi - 1, low);
+				break;
+			case ChannelState::ARControl:
 			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolRhythm[uch] && step.hasVolume() && vol < bt_defs::NSTEP_RHYTHM_VOLUME) {
-					isSetVolRhythm[uch] = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeRhythm(ch, vol);
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::RHYTHM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanRhythm[uch]) {
-							isSetPanRhythm[uch] = true;
-							if (isPrevPos) opnaCtrl_->setPanRhythm(ch, eff.value);
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::MasterVolume:
-						if (-1 < eff.value && eff.value < 64 && !isSetMVolRhythm) {
-							isSetMVolRhythm = true;
-							if (isPrevPos) opnaCtrl_->setMasterVolumeRhythm(eff.value);
-						}
-						break;
-					default:
-						break;
-					}
-				}
+				int op = value >> 8;
+				int val = value & 0x00ff;
+				if (0 < op && op < 5 && -1 < val && val < 32) opnaCtrl_->setARControlFM(ch, op - 1, val);
 				break;
 			}
-			case SoundSource::ADPCM:
+			case ChannelState::DRControl:
 			{
-				// Volume
-				int vol = step.getVolume();
-				if (!isSetVolADPCM && step.hasVolume() && vol < bt_defs::NSTEP_ADPCM_VOLUME) {
-					isSetVolADPCM = true;
-					if (isPrevPos)
-						opnaCtrl_->setVolumeADPCM(vol);
-				}
-				// Instrument
-				if (!isSetInstADPCM && step.hasInstrument()) {
-					if (auto inst = std::dynamic_pointer_cast<InstrumentADPCM>(
-								instMan_.lock()->getInstrumentSharedPtr(step.getInstrumentNumber()))) {
-						isSetInstADPCM = true;
-						if (isPrevPos)
-							opnaCtrl_->setInstrumentADPCM(inst);
-					}
-				}
-				// Effects
-				for (int i = Step::N_EFFECT - 1; i > -1; --i) {
-					Effect eff = effect_utils::validateEffect(SoundSource::ADPCM, step.getEffect(i));
-					switch (eff.type) {
-					case EffectType::Arpeggio:
-						if (!isSetArpADPCM) {
-							isSetArpADPCM = true;
-							if (isPrevPos) opnaCtrl_->setArpeggioEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::PortamentoUp:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(eff.value);
-						}
-						break;
-					case EffectType::PortamentoDown:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(-eff.value);
-						}
-						break;
-					case EffectType::TonePortamento:
-						if (!isSetPrtADPCM) {
-							isSetPrtADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPortamentoEffectADPCM(eff.value, true);
-						}
-						break;
-					case EffectType::Vibrato:
-						if (!isSetVibADPCM) {
-							isSetVibADPCM = true;
-							if (isPrevPos) opnaCtrl_->setVibratoEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Tremolo:
-						if (!isSetTreADPCM) {
-							isSetTreADPCM = true;
-							if (isPrevPos) opnaCtrl_->setTremoloEffectADPCM(eff.value >> 4, eff.value & 0x0f);
-						}
-						break;
-					case EffectType::Pan:
-						if (-1 < eff.value && eff.value < 4 && !isSetPanADPCM) {
-							isSetPanADPCM = true;
-							if (isPrevPos) opnaCtrl_->setPanADPCM(eff.value);
-						}
-						break;
-					case EffectType::VolumeSlide:
-						if (!isSetVolSldADPCM) {
-							isSetVolSldADPCM = true;
-							if (isPrevPos) {
-								int hi = eff.value >> 4;
-								int low = eff.value & 0x0f;
-								if (hi && !low) opnaCtrl_->setVolumeSlideADPCM(hi, true);	// Slide up
-								else if (!hi) opnaCtrl_->setVolumeSlideADPCM(low, false);	// Slide down
-							}
-						}
-						break;
-					case EffectType::SpeedTempoChange:
-						if (!(speedStates & 0x4)) {
-							if (eff.value < 0x20) {				// Speed change
-								if (!(speedStates & 0x1)) {
-									speedStates |= 0x1;
-									if (isPrevPos) effSpeedChange(eff.value);
-								}
-							}
-							else if (!(speedStates & 0x2)) {	// Tempo change
-								speedStates |= 0x2;
-								if (isPrevPos) effTempoChange(eff.value);
-							}
-						}
-						break;
-					case EffectType::Groove:
-						if (eff.value < static_cast<int>(mod_.lock()->getGrooveCount()) && !speedStates) {
-							speedStates |= 0x4;
-							if (isPrevPos) effGrooveChange(eff.value);
-						}
-						break;
-					case EffectType::Detune:
-						if (!isSetDtnADPCM) {
-							isSetDtnADPCM = true;
-							if (isPrevPos) opnaCtrl_->setDetuneADPCM(eff.value - 0x80);
-						}
-						break;
-					case EffectType::FineDetune:
-						if (!isSetFiDtnADPCM) {
-							isSetFiDtnADPCM = true;
-							if (isPrevPos) opnaCtrl_->setFineDetuneADPCM(eff.value - 0x80);
-						}
-						break;
-					case EffectType::XVolumeSlide:
-						if (!isSetXVolSldADPCM) {
-							isSetXVolSldADPCM = true;
-							if (isPrevPos) {
-								int factor = (eff.value >> 4) - (eff.value & 0x0f);
-								opnaCtrl_->setXVolumeSlideADPCM(factor);
-							}
-						}
-						break;
-					default:
-						break;
-					}
+				int op = value >> 8;
+				int val = value & 0x00ff;
+				if (0 < op && op < 5 && -1 < val && val < 32) opnaCtrl_->setDRControlFM(ch, op - 1, val);
+				break;
+			}
+			case ChannelState::RRControl:
+				if (0 < hi && hi < 5) opnaCtrl_->setRRControlFM(ch, hi - 1, low);
+				break;
+			case ChannelState::Brightness:
+				if (0 < value) opnaCtrl_->setBrightnessFM(ch, value - 0x80);
+				break;
+			default:
+				break;
+			}
+			break;
+		case SoundSource::SSG:
+			switch (kind) {
+			case ChannelState::Volume:
+				opnaCtrl_->setVolumeSSG(ch, value);
+				break;
+			case ChannelState::Instrument:
+				if (auto inst = std::dynamic_pointer_cast<InstrumentSSG>(instMan->getInstrumentSharedPtr(value)))
+					opnaCtrl_->setInstrumentSSG(ch, inst);
+				break;
+			case ChannelState::Arpeggio:
+				opnaCtrl_->setArpeggioEffectSSG(ch, hi, low);
+				break;
+			case ChannelState::Portamento:
+				switch (state.type) {
+				case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectSSG(ch, value);			break;
+				case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectSSG(ch, -value);		break;
+				default:							opnaCtrl_->setPortamentoEffectSSG(ch, value, true);	break;
 				}
 				break;
+			case ChannelState::Vibrato:
+				opnaCtrl_->setVibratoEffectSSG(ch, hi, low);
+				break;
+			case ChannelState::Tremolo:
+				opnaCtrl_->setTremoloEffectSSG(ch, hi, low);
+				break;
+			case ChannelState::VolumeSlide:
+				if (hi && !low) opnaCtrl_->setVolumeSlideSSG(ch, hi, true);	// Slide up
+				else if (!hi) opnaCtrl_->setVolumeSlideSSG(ch, low, false);	// Slide down
+				break;
+			case ChannelState::Detune:
+				opnaCtrl_->setDetuneSSG(ch, value - 0x80);
+				break;
+			case ChannelState::FineDetune:
+				opnaCtrl_->setFineDetuneSSG(ch, value - 0x80);
+				break;
+			case ChannelState::XVolumeSlide:
+				opnaCtrl_->setXVolumeSlideSSG(ch, hi - low);
+				break;
+			case ChannelState::ToneNoiseMix:
+				opnaCtrl_->setToneNoiseMixSSG(ch, value);
+				break;
+			default:
+				break;
 			}
+			break;
+		case SoundSource::RHYTHM:
+			switch (kind) {
+			case ChannelState::Volume:
+				opnaCtrl_->setVolumeRhythm(ch, value);
+				break;
+			case ChannelState::Pan:
+				opnaCtrl_->setPanRhythm(ch, value);
+				break;
+			default:
+				break;
 			}
-		}
-
-		// Move position
-		isPrevPos = true;
-		if (--pos.step < 0) {
-			if (--pos.order < 0) break;
-			pos.step = static_cast<int>(getPatternSizeFromOrderNumber(curSongNum_, pos.order)) - 1;
+			break;
+		case SoundSource::ADPCM:
+			switch (kind) {
+			case ChannelState::Volume:
+				opnaCtrl_->setVolumeADPCM(value);
+				break;
+			case ChannelState::Instrument:
+				if (auto inst = std::dynamic_pointer_cast<InstrumentADPCM>(instMan->getInstrumentSharedPtr(value)))
+					opnaCtrl_->setInstrumentADPCM(inst);
+				break;
+			case ChannelState::Arpeggio:
+				opnaCtrl_->setArpeggioEffectADPCM(hi, low);
+				break;
+			case ChannelState::Portamento:
+				switch (state.type) {
+				case EffectType::PortamentoUp:		opnaCtrl_->setPortamentoEffectADPCM(value);		break;
+				case EffectType::PortamentoDown:	opnaCtrl_->setPortamentoEffectADPCM(-value);		break;
+				default:							opnaCtrl_->setPortamentoEffectADPCM(value, true);	break;
+				}
+				break;
+			case ChannelState::Vibrato:
+				opnaCtrl_->setVibratoEffectADPCM(hi, low);
+				break;
+			case ChannelState::Tremolo:
+				opnaCtrl_->setTremoloEffectADPCM(hi, low);
+				break;
+			case ChannelState::Pan:
+				opnaCtrl_->setPanADPCM(value);
+				break;
+			case ChannelState::VolumeSlide:
+				if (hi && !low) opnaCtrl_->setVolumeSlideADPCM(hi, true);	// Slide up
+				else if (!hi) opnaCtrl_->setVolumeSlideADPCM(low, false);	// Slide down
+				break;
+			case ChannelState::Detune:
+				opnaCtrl_->setDetuneADPCM(value - 0x80);
+				break;
+			case ChannelState::FineDetune:
+				opnaCtrl_->setFineDetuneADPCM(value - 0x80);
+				break;
+			case ChannelState::XVolumeSlide:
+				opnaCtrl_->setXVolumeSlideADPCM(hi - low);
+				break;
+			default:
+				break;
+			}
+			break;
 		}
 	}
 
-	// Sequence reset
+	// Echo buffers
+	size_t fmch = Song::getFMChannelCount(songStyle_.type);
 	for (size_t ch = 0; ch < fmch; ++ch) {
-		opnaCtrl_->haltSequencesFM(static_cast<int>(ch));
+		opnaCtrl_->setEchoBufferFM(static_cast<int>(ch), record.echoBuffers[ch]);
 	}
 	for (size_t ch = 0; ch < 3; ++ch) {
-		opnaCtrl_->haltSequencesSSG(static_cast<int>(ch));
+		opnaCtrl_->setEchoBufferSSG(static_cast<int>(ch), record.echoBuffers[RETRIEVED_SSG_CH_BEGIN + ch]);
 	}
-	opnaCtrl_->haltSequencesADPCM();
+	opnaCtrl_->setEchoBufferADPCM(record.echoBuffers[RETRIEVED_ADPCM_CH]);
 }
 
 size_t PlaybackManager::getOrderSize(int songNum) const
@@ -25,13 +25,15 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <array>
 #include <vector>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
 #include "module.hpp"
 #include "effect.hpp"
-#include "enum_hash.hpp"
+#include "echo_buffer.hpp"
 #include "bamboo_tracker_defs.hpp"
 
 class OPNAController;
@@ -97,6 +99,9 @@ public:
 	void checkPlayPosition(int maxStepSize);
 
 	void setChannelRetrieving(bool enabled);
+	/// Discard the retrieved channel states which may be affected by edits in the order.
+	/// An order of 0 discards all of them.
+	void invalidateChannelStates(int songNum, int order = 0);
 
 private:
 	std::shared_ptr<OPNAController> opnaCtrl_;
@@ -141,7 +146,7 @@ private:
 	void executeADPCMStepEvents(const Step& step, bool calledByNoteDelay = false);
 
 	EffectMemory playbackSpeedEffMem_, posChangeEffMem_;
-	std::unordered_map<SoundSource, std::vector<EffectMemory>> effOnKeyOnMem_, effOnStepBeginMem_;
+	std::array<std::vector<EffectMemory>, N_SOUND_SOURCE> effOnKeyOnMem_, effOnStepBeginMem_;
 
 	struct RegisterUnit
 	{
@@ -150,7 +155,20 @@ private:
 	};
 	using DirectRegisterSetQueue = std::vector<RegisterUnit>;
 	using DirectRegisterSetSource = std::vector<DirectRegisterSetQueue>;
-	std::unordered_map<SoundSource, DirectRegisterSetSource> directRegisterSets_;
+	std::array<DirectRegisterSetSource, N_SOUND_SOURCE> directRegisterSets_;
+
+	/// Per-track dispatch resolved in \c setSong.
+	struct TrackUnit
+	{
+		int number, channel;
+		SoundSource source;
+		void (PlaybackManager::*storeEffectToMap)(int, const Effect&);
+		EffectMemory* keyOnMem;
+		EffectMemory* stepBeginMem;
+		DirectRegisterSetQueue* directRegisterSet;
+		const Step* step;	///< Current step set in \c stepProcess
+	};
+	std::vector<TrackUnit> trackUnits_;
 
 	bool executeStoredEffectsGlobal();
 	void storeEffectToMapFM(int ch, const Effect& eff);
@@ -236,6 +254,32 @@ private:
 	bool isRetrieveChannel_;
 	void retrieveChannelStates();
 
+	/// State set by the steps before a position, in which the latest setting wins.
+	struct RetrievedState
+	{
+		int64_t rank;	///< Playing order of the setting, -1 if unset
+		int ch, value;
+		EffectType type;
+	};
+	/// Channels of all sound sources: FM (up to 9), SSG, rhythm and ADPCM.
+	static constexpr size_t N_RETRIEVED_CH = 19;
+	static constexpr size_t N_RETRIEVED_CH_STATE = 19;
+	static constexpr size_t N_RETRIEVED_GLOBAL_STATE = 8;
+	struct ChannelStateRecord
+	{
+		std::array<RetrievedState, N_RETRIEVED_CH * N_RETRIEVED_CH_STATE + N_RETRIEVED_GLOBAL_STATE> states;
+		std::array<EchoBuffer, N_RETRIEVED_CH> echoBuffers;
+		int64_t stepCount;	///< Number of recorded steps
+
+		ChannelStateRecord();
+	};
+	/// Records at the beginning of each order, built on demand.
+	std::vector<ChannelStateRecord> stateCheckpoints_;
+	const ChannelStateRecord& getChannelStateCheckpoint(int order);
+	void recordChannelStates(ChannelStateRecord& record, int order, int beginStep, int endStep,
+							 bool updatesEchoBuffer);
+	void applyChannelStates(const ChannelStateRecord& record, int64_t endRank);
+
 	size_t getOrderSize(int songNum) const;
 	size_t getPatternSizeFromOrderNumber(int songNum, int orderNum) const;
 };
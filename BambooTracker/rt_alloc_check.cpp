@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "rt_alloc_check.hpp"
+
+#ifdef BT_RT_ALLOC_CHECK
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace rt_alloc_check
+{
+namespace
+{
+thread_local int scopeDepth = 0;
+std::atomic<size_t> violationCount(0);
+std::atomic<bool> isTrapEnabled(false);
+
+inline void checkHeapCall()
+{
+	if (scopeDepth) {
+		violationCount.fetch_add(1, std::memory_order_relaxed);
+		if (isTrapEnabled.load(std::memory_order_relaxed)) std::abort();
+	}
+}
+}
+
+RealTimeScope::RealTimeScope() noexcept
+{
+	static const bool trap = std::getenv("BT_RT_ALLOC_TRAP") != nullptr;
+	isTrapEnabled.store(trap, std::memory_order_relaxed);
+	++scopeDepth;
+}
+
+RealTimeScope::~RealTimeScope()
+{
+	--scopeDepth;
+}
+
+size_t getViolationCount() noexcept
+{
+	return violationCount.load();
+}
+
+void resetViolationCount() noexcept
+{
+	violationCount.store(0);
+}
+}
+
+// Replacements of the global allocation functions.
+// Over-aligned variants are left to the standard library and are not checked.
+void* operator new(std::size_t size)
+{
+	rt_alloc_check::checkHeapCall();
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	rt_alloc_check::checkHeapCall();
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (!ptr) return;
+	rt_alloc_check::checkHeapCall();
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	operator delete(ptr);
+}
+#endif
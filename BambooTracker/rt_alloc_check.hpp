@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Detection of heap allocations on the real-time audio thread.
+ *
+ * When built with BT_RT_ALLOC_CHECK, the global allocation functions are replaced
+ * and every allocation or deallocation made inside a RealTimeScope is counted.
+ * If the environment variable BT_RT_ALLOC_TRAP is set, such a call aborts
+ * so that a debugger stops at the offending code.
+ * Without BT_RT_ALLOC_CHECK, all of these are no-ops.
+ */
+namespace rt_alloc_check
+{
+class RealTimeScope
+{
+public:
+#ifdef BT_RT_ALLOC_CHECK
+	RealTimeScope() noexcept;
+	~RealTimeScope();
+#else
+	RealTimeScope() noexcept {}
+#endif
+	RealTimeScope(const RealTimeScope&) = delete;
+	RealTimeScope& operator=(const RealTimeScope&) = delete;
+};
+
+#ifdef BT_RT_ALLOC_CHECK
+constexpr bool ENABLED = true;
+
+size_t getViolationCount() noexcept;
+void resetViolationCount() noexcept;
+#else
+constexpr bool ENABLED = false;
+
+inline size_t getViolationCount() noexcept { return 0; }
+inline void resetViolationCount() noexcept {}
+#endif
+}
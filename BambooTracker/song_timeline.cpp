@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "song_timeline.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+#include "module.hpp"
+#include "enum_hash.hpp"
+
+namespace
+{
+inline double calculateStrictStepTicks(int rate, int tempo, int speed)
+{
+	return 2.5 * rate * speed / tempo;
+}
+}
+
+SongTimeline::SongTimeline()
+	: hasLength_(false),
+	  hasStepCount_(false),
+	  hasLoopPos_(false),
+	  length_(0.),
+	  introSize_(0),
+	  loopSize_(0),
+	  loopOrder_(-1),
+	  loopStep_(-1)
+{
+}
+
+void SongTimeline::invalidate(int order)
+{
+	size_t size = static_cast<size_t>(std::max(order, 0));
+	if (size < orders_.size()) orders_.resize(size);
+	invalidateResults();
+}
+
+void SongTimeline::invalidateResults() noexcept
+{
+	hasLength_ = false;
+	hasStepCount_ = false;
+	hasLoopPos_ = false;
+}
+
+const SongTimeline::OrderSummary& SongTimeline::getOrderSummary(Song& song, int order)
+{
+	// Keep the references to summaries valid during a query
+	if (orders_.size() < song.getOrderSize()) orders_.resize(song.getOrderSize(), OrderSummary{ false, 0, {}, {} });
+
+	OrderSummary& summary = orders_[static_cast<size_t>(order)];
+	if (summary.isValid) return summary;
+
+	summary.size = static_cast<int>(song.getPatternSizeFromOrderNumber(order));
+	summary.lastStepPosEffs.clear();
+	summary.speedEvents.clear();
+
+	std::vector<TrackAttribute> attribs = song.getTrackAttributes();
+	for (int stepNum = 0; stepNum < summary.size; ++stepNum) {
+		SpeedEvent event{ stepNum, false, false, 0, 0 };
+		for (const TrackAttribute& attrib : attribs) {
+			const Step& step = song.getTrack(attrib.number).getPatternFromOrderNumber(order).getStep(stepNum);
+			for (int e = 0; e < Step::N_EFFECT; ++e) {
+				Effect&& eff = effect_utils::validateEffect(attrib.source, step.getEffect(e));
+				switch (eff.type) {
+				case EffectType::SpeedTempoChange:
+					event.hasSpeedTempo = true;
+					event.speedTempo = eff.value;
+					break;
+				case EffectType::Groove:
+					event.hasGroove = true;
+					event.groove = eff.value;
+					break;
+				case EffectType::PositionJump:
+				case EffectType::SongEnd:
+				case EffectType::PatternBreak:
+					if (stepNum == summary.size - 1) summary.lastStepPosEffs.push_back(eff);	// Read only last step
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		if (event.hasSpeedTempo || event.hasGroove) summary.speedEvents.push_back(event);
+	}
+
+	summary.isValid = true;
+	return summary;
+}
+
+int SongTimeline::getPatternSize(Song& song, int order)
+{
+	if (order < 0 || static_cast<int>(song.getOrderSize()) <= order) return 0;	// Ilegal value
+	return getOrderSummary(song, order).size;
+}
+
+double SongTimeline::approximateLengthBySecond(Module& mod, int songNum)
+{
+	if (hasLength_) return length_;
+
+	Song& song = mod.getSong(songNum);
+	std::unordered_set<int> visitedOrder;
+	double tickCnt = 0.;
+
+	const int rate = static_cast<int>(mod.getTickFrequency());
+	int tempo = song.getTempo();
+	int speed = song.getSpeed();
+	std::vector<int> groove = mod.getGroove(song.getGroove());
+	double stepTicks = calculateStrictStepTicks(rate, tempo, speed);
+	size_t grooveIdx = 0;
+	bool isTempo = song.isUsedTempo();
+
+	int orderNum = 0;
+	int stepNum = 0;
+	int maxOrder = static_cast<int>(song.getOrderSize());
+
+	while (!visitedOrder.count(orderNum)) {
+		visitedOrder.insert(orderNum);
+
+		const OrderSummary& summary = getOrderSummary(song, orderNum);
+		auto eventItr = summary.speedEvents.begin();
+		for (; stepNum < summary.size; ++stepNum) {
+			// Update playback state
+			while (eventItr != summary.speedEvents.end() && eventItr->step < stepNum) ++eventItr;
+			if (eventItr != summary.speedEvents.end() && eventItr->step == stepNum) {
+				const SpeedEvent& event = *eventItr;
+				if (event.hasSpeedTempo) {
+					if (event.speedTempo < 0x20) {
+						if (speed != event.speedTempo) {
+							speed = event.speedTempo;
+							isTempo = true;
+							stepTicks = calculateStrictStepTicks(rate, tempo, speed);
+						}
+					}
+					else if (tempo != event.speedTempo) {
+						tempo = event.speedTempo;
+						isTempo = true;
+						stepTicks = calculateStrictStepTicks(rate, tempo, speed);
+					}
+				}
+				if (event.hasGroove && event.groove < static_cast<int>(mod.getGrooveCount())) {
+					groove = mod.getGroove(event.groove);
+					isTempo = false;
+					grooveIdx = 0;
+				}
+			}
+
+			// Add step ticks
+			if (isTempo) {
+				tickCnt += stepTicks;
+			}
+			else {
+				tickCnt += groove[grooveIdx];
+				++grooveIdx %= groove.size();
+			}
+		}
+
+		// Update order position
+		std::unordered_map<EffectType, int> jumpEffMap;
+		for (const Effect& eff : summary.lastStepPosEffs) jumpEffMap[eff.type] = eff.value;
+		++orderNum %= maxOrder;
+		stepNum = 0;
+		for (auto eff : jumpEffMap) {
+			switch (eff.first) {
+			case EffectType::PositionJump:
+				if (eff.second < maxOrder) {
+					orderNum = eff.second;
+				}
+				break;
+			case EffectType::SongEnd:
+				orderNum = 0;	// To break order loop
+				break;
+			case EffectType::PatternBreak:
+				if (eff.second < getPatternSize(song, orderNum)) {
+					stepNum = eff.second;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	// Calculate time by seconds
+	length_ = tickCnt / rate;
+	hasLength_ = true;
+	return length_;
+}
+
+void SongTimeline::totalStepCount(Module& mod, int songNum, size_t& introSize, size_t& loopSize)
+{
+	if (!hasStepCount_) {
+		Song& song = mod.getSong(songNum);
+		size_t totalStepCnt = 0;
+		std::unordered_map<int, size_t> stepCntLogMap;
+		int lastOrder = static_cast<int>(song.getOrderSize()) - 1;
+		int curOrder = 0;
+		bool isEnded = false;
+
+		for (int curStep = 0; !stepCntLogMap.count(curOrder) && !isEnded; ) {
+			// Count up
+			const OrderSummary& summary = getOrderSummary(song, curOrder);
+			stepCntLogMap[curOrder] = totalStepCnt;
+			totalStepCnt += static_cast<size_t>(summary.size - curStep);
+
+			// Check next order position
+			curOrder = (curOrder + 1) % (lastOrder + 1);
+			curStep = 0;
+			for (const Effect& eff : summary.lastStepPosEffs) {
+				switch (eff.type) {
+				case EffectType::PositionJump:
+					if (eff.value <= lastOrder) {
+						curOrder = eff.value;
+						curStep = 0;
+					}
+					break;
+				case EffectType::SongEnd:	// No loop
+					introSize_ = totalStepCnt;
+					loopSize_ = 0;
+					isEnded = true;
+					break;
+				case EffectType::PatternBreak:
+					if (eff.value < getPatternSize(song, curOrder)) {
+						curStep = eff.value;
+					}
+					break;
+				default:
+					break;
+				}
+				if (isEnded) break;
+			}
+		}
+
+		// Calculate counts
+		if (!isEnded) {
+			introSize_ = stepCntLogMap[curOrder];
+			loopSize_ = totalStepCnt - introSize_;
+		}
+		hasStepCount_ = true;
+	}
+
+	introSize = introSize_;
+	loopSize = loopSize_;
+}
+
+void SongTimeline::loopPosition(Module& mod, int songNum, int& order, int& step)
+{
+	if (!hasLoopPos_) {
+		Song& song = mod.getSong(songNum);
+		int endOrder = 0;
+		int endStep = 0;
+		std::unordered_set<int> orderStepMap;
+		int lastOrder = static_cast<int>(song.getOrderSize()) - 1;
+		bool isEnded = false;
+
+		for (int curOrder = 0; !orderStepMap.count(curOrder) && !isEnded; curOrder = endOrder) {
+			orderStepMap.insert(curOrder);	// Arrived flag
+			// Default next order
+			endOrder = (endOrder + 1) % (lastOrder + 1);
+			endStep = 0;
+
+			// Check jump effect
+			for (const Effect& eff : getOrderSummary(song, curOrder).lastStepPosEffs) {
+				switch (eff.type) {
+				case EffectType::PositionJump:
+					if (eff.value <= lastOrder) {
+						endOrder = eff.value;
+						endStep = 0;
+					}
+					break;
+				case EffectType::SongEnd:
+					endOrder = -1;
+					endStep = -1;
+					isEnded = true;
+					break;
+				case EffectType::PatternBreak:
+					if (curOrder == lastOrder && eff.value < getPatternSize(song, 0)) {
+						endOrder = 0;
+						endStep = eff.value;
+					}
+					else if (eff.value < getPatternSize(song, curOrder + 1)) {
+						endOrder = curOrder + 1;
+						endStep = eff.value;
+					}
+					break;
+				default:
+					break;
+				}
+				if (isEnded) break;
+			}
+		}
+
+		loopOrder_ = endOrder;
+		loopStep_ = endStep;
+		hasLoopPos_ = true;
+	}
+
+	order = loopOrder_;
+	step = loopStep_;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "effect.hpp"
+
+class Module;
+class Song;
+
+/// Per-order summary of a song flow used for the song length, the step counts and the loop point.
+/// Each order is scanned once, and kept until edits invalidate it.
+class SongTimeline
+{
+public:
+	SongTimeline();
+
+	/// Drop the summaries of the order and later ones, and all results.
+	void invalidate(int order = 0);
+	/// Drop the results which also depend on the module and song settings, such as tempo and grooves.
+	void invalidateResults() noexcept;
+
+	double approximateLengthBySecond(Module& mod, int songNum);
+	void totalStepCount(Module& mod, int songNum, size_t& introSize, size_t& loopSize);
+	/// Get the position played after the song reaches its end. It is (-1, -1) if the song does not loop.
+	void loopPosition(Module& mod, int songNum, int& order, int& step);
+
+private:
+	/// Speed, tempo and groove changes in a step, in which the last of each kind is used.
+	struct SpeedEvent
+	{
+		int step;
+		bool hasSpeedTempo, hasGroove;
+		int speedTempo, groove;
+	};
+	struct OrderSummary
+	{
+		bool isValid;
+		int size;
+		std::vector<Effect> lastStepPosEffs;	///< Position jump, song end and pattern break in scanning order
+		std::vector<SpeedEvent> speedEvents;	///< Sorted by step
+	};
+	std::vector<OrderSummary> orders_;
+
+	bool hasLength_, hasStepCount_, hasLoopPos_;
+	double length_;
+	size_t introSize_, loopSize_;
+	int loopOrder_, loopStep_;
+
+	const OrderSummary& getOrderSummary(Song& song, int order);
+	int getPatternSize(Song& song, int order);
+};
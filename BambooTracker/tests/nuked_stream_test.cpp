@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2023 Rerrah
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Checks that OPN2_GenerateStream renders the same FM, rhythm and ADPCM output
+// as the per-sample generation loop it replaced, across varying block sizes.
+// The output of the per-sample loop is also compared with a hash recorded
+// before block rendering was introduced.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "chip/nuked/ym3438.h"
+
+namespace
+{
+constexpr Bit32u CLOCK = 7987200;
+constexpr Bit32u DRAM_SIZE = 0x40000;
+constexpr int ITERATIONS = 3000;
+constexpr uint64_t EXPECTED_HASH = 0x032be8c88df4b9aeULL;
+
+void dummySetClock(void*, int) {}
+void dummyWrite(void*, int, int) {}
+int dummyRead(void*) { return 0; }
+void dummyReset(void*) {}
+
+const struct OPN2mod_psg_callbacks DUMMY_PSG = { dummySetClock, dummyWrite, dummyRead, dummyReset };
+
+/// Per-sample generation as done before OPN2_GenerateStream existed.
+void generateReference(ym3438_t* chip, sample* samples)
+{
+	Bit16s buffer[6];
+
+	samples[0] = 0;
+	samples[1] = 0;
+
+	for (int i = 0; i < 24; i++) {
+		OPN2_Clock(chip, buffer);
+
+		samples[0] += (buffer[0] * 11) >> 4;
+		samples[1] += (buffer[1] * 11) >> 4;
+		samples[0] += buffer[2];
+		samples[1] += buffer[3];
+		samples[0] += buffer[4];
+		samples[1] += buffer[5];
+
+		while (chip->writebuf[chip->writebuf_cur].time <= chip->writebuf_samplecnt) {
+			if (!(chip->writebuf[chip->writebuf_cur].port & 0x04)) break;
+			chip->writebuf[chip->writebuf_cur].port &= 0x03;
+			OPN2_Write(chip, chip->writebuf[chip->writebuf_cur].port,
+					   chip->writebuf[chip->writebuf_cur].data);
+			chip->writebuf_cur = (chip->writebuf_cur + 1) % OPN_WRITEBUF_SIZE;
+		}
+		chip->writebuf_samplecnt++;
+	}
+}
+
+class Lcg
+{
+public:
+	uint32_t next()
+	{
+		state_ = state_ * 1664525u + 1013904223u;
+		return state_ >> 8;
+	}
+
+	uint32_t next(uint32_t n) { return next() % n; }
+
+private:
+	uint32_t state_ = 0x2608;
+};
+
+struct Chip
+{
+	Chip() : state(new ym3438_t())
+	{
+		OPN2_Reset(state.get(), CLOCK, &DUMMY_PSG, nullptr, DRAM_SIZE);
+	}
+
+	~Chip() { OPN2_Destroy(state.get()); }
+
+	std::unique_ptr<ym3438_t> state;
+};
+
+class ChipPair
+{
+public:
+	ChipPair()
+	{
+		Lcg lcg;
+		for (auto chip : { stream_.state.get(), reference_.state.get() }) {
+			lcg = Lcg();
+			for (Bit32u i = 0; i < DRAM_SIZE; ++i)
+				chip->deltaT.memory[i] = static_cast<Bit8u>(lcg.next());
+		}
+	}
+
+	void write(int port, int address, int data)
+	{
+		for (auto chip : { stream_.state.get(), reference_.state.get() }) {
+			OPN2_WriteBuffered(chip, port << 1, static_cast<Bit8u>(address));
+			OPN2_WriteBuffered(chip, (port << 1) | 1, static_cast<Bit8u>(data));
+		}
+	}
+
+	/// Render both chips and return false if their outputs differ.
+	bool render(Bit32u count, std::vector<sample>& refOut)
+	{
+		streamL_.resize(count);
+		streamR_.resize(count);
+		OPN2_GenerateStream(stream_.state.get(), streamL_.data(), streamR_.data(), count);
+
+		bool same = true;
+		for (Bit32u i = 0; i < count; ++i) {
+			sample ref[2];
+			generateReference(reference_.state.get(), ref);
+			refOut.push_back(ref[0]);
+			refOut.push_back(ref[1]);
+			same &= (ref[0] == streamL_[i] && ref[1] == streamR_[i]);
+		}
+		return same;
+	}
+
+private:
+	Chip stream_, reference_;
+	std::vector<sample> streamL_, streamR_;
+};
+
+void setUpVoices(ChipPair& chips)
+{
+	chips.write(0, 0x29, 0x80);	// 6 FM channels
+	chips.write(0, 0x22, 0x0b);	// LFO
+	for (int port = 0; port < 2; ++port) {
+		for (int ch = 0; ch < 3; ++ch) {
+			for (int op = 0; op < 4; ++op) {
+				int offs = ch + op * 4;
+				chips.write(port, 0x30 + offs, 0x01 + op * 2 + port);
+				chips.write(port, 0x40 + offs, op == 3 ? 0x08 : 0x20 + op * 4);
+				chips.write(port, 0x50 + offs, 0x1f);
+				chips.write(port, 0x60 + offs, 0x88 + op);
+				chips.write(port, 0x70 + offs, 0x04);
+				chips.write(port, 0x80 + offs, 0x27);
+				chips.write(port, 0x90 + offs, ch == 2 ? 0x0a : 0x00);
+			}
+			chips.write(port, 0xb0 + ch, 0x30 + ch + port * 3);
+			chips.write(port, 0xb4 + ch, 0xc0 | 0x33);
+			chips.write(port, 0xa4 + ch, 0x22 + ch);
+			chips.write(port, 0xa0 + ch, 0x69 + ch * 16);
+		}
+	}
+
+	// Rhythm
+	chips.write(0, 0x11, 0x3f);
+	for (int i = 0; i < 6; ++i) chips.write(0, 0x18 + i, 0xdf);
+	chips.write(0, 0x10, 0x3f);
+
+	// ADPCM from DRAM
+	chips.write(1, 0x00, 0x01);	// Reset
+	chips.write(1, 0x01, 0xc2);	// L/R, 8-bit DRAM
+	chips.write(1, 0x02, 0x00);
+	chips.write(1, 0x03, 0x00);
+	chips.write(1, 0x04, 0xff);
+	chips.write(1, 0x05, 0x1f);
+	chips.write(1, 0x09, 0x00);
+	chips.write(1, 0x0a, 0x40);
+	chips.write(1, 0x0b, 0xff);
+	chips.write(1, 0x00, 0xb0);	// Start, repeat, external memory
+}
+
+void writeRandomly(ChipPair& chips, Lcg& lcg)
+{
+	static const int KEY_CHANNELS[] = { 0, 1, 2, 4, 5, 6 };
+
+	switch (lcg.next(6)) {
+	case 0:
+	case 1:
+		chips.write(0, 0x28, (lcg.next(16) << 4) | KEY_CHANNELS[lcg.next(6)]);
+		break;
+	case 2:
+	{
+		int ch = lcg.next(3);
+		int port = lcg.next(2);
+		chips.write(port, 0xa4 + ch, lcg.next(0x40));
+		chips.write(port, 0xa0 + ch, lcg.next(0x100));
+		break;
+	}
+	case 3:
+		chips.write(lcg.next(2), 0x30 + lcg.next(0x87), lcg.next(0x100));
+		break;
+	case 4:
+		chips.write(0, 0x10, lcg.next(2) ? lcg.next(0x40) : 0x80 | lcg.next(0x40));
+		break;
+	case 5:
+		chips.write(1, 0x09 + lcg.next(2), lcg.next(0x100));
+		break;
+	}
+}
+
+uint64_t fnv1a(const std::vector<sample>& samples)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (sample s : samples) {
+		auto u = static_cast<uint32_t>(s);
+		for (int i = 0; i < 4; ++i) {
+			hash ^= (u >> (i * 8)) & 0xff;
+			hash *= 0x100000001b3ULL;
+		}
+	}
+	return hash;
+}
+}
+
+int main()
+{
+	ChipPair chips;
+	std::vector<sample> refOut;
+	Lcg lcg;
+
+	setUpVoices(chips);
+
+	for (int i = 0; i < ITERATIONS; ++i) {
+		Bit32u count = 1 + lcg.next(lcg.next(4) ? 64 : 512);
+		if (!chips.render(count, refOut)) {
+			std::fprintf(stderr, "Block render differs from per-sample render at iteration %d\n", i);
+			return 1;
+		}
+		for (uint32_t n = lcg.next(5); n > 0; --n) writeRandomly(chips, lcg);
+	}
+
+	uint64_t hash = fnv1a(refOut);
+	if (hash != EXPECTED_HASH) {
+		std::fprintf(stderr, "Output hash %016llx does not match the recorded %016llx\n",
+					 static_cast<unsigned long long>(hash), static_cast<unsigned long long>(EXPECTED_HASH));
+		return 1;
+	}
+
+	std::printf("%zu samples match\n", refOut.size() / 2);
+	return 0;
+}
@@ -30,6 +30,8 @@
 #include <type_traits>
 #include <vector>
 #include <iterator>
+#include <cstddef>
+#include <functional>
 
 namespace utils
 {
@@ -111,6 +113,13 @@ inline auto findMapValue(const Map& map, const T& value)
 	return findIf(map, [&](typename Map::const_reference pair) { return pair.second == value; });
 }
 
+/// Mix the hash of \c value into \c seed (same mixing as boost::hash_combine).
+template <typename T>
+inline void hashCombine(std::size_t& seed, const T& value)
+{
+	seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 /**
  * @brief isInRange
  * @param value Value.
@@ -0,0 +1,174 @@
+# Generates BambooTracker/chip/mame/fmopn_tables.h
+#
+# The tables were built at run time by init_tables() and Init_ADPCMATable()
+# in fmopn.c. The algorithms below are the same, so the output must be
+# identical to what the C code produced.
+#
+# Usage: python3 scripts/gen_fmopn_tables.py > BambooTracker/chip/mame/fmopn_tables.h
+
+import math
+
+ENV_BITS = 10
+ENV_LEN = 1 << ENV_BITS
+ENV_STEP = 128.0 / ENV_LEN
+
+SIN_BITS = 10
+SIN_LEN = 1 << SIN_BITS
+
+TL_RES_LEN = 256
+TL_TAB_LEN = 13 * 2 * TL_RES_LEN
+
+# 7 bits meaningful (of F-NUMBER), 8 LFO output levels per one depth (out of 32), 8 LFO depths
+LFO_PM_OUTPUT = [
+    # FNUM BIT 4: 000 0001xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 1, 1, 1, 1],
+    # FNUM BIT 5: 000 0010xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 1, 1, 1, 1],
+    [0, 0, 1, 1, 2, 2, 2, 3],
+    # FNUM BIT 6: 000 0100xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 1],
+    [0, 0, 0, 0, 1, 1, 1, 1],
+    [0, 0, 1, 1, 2, 2, 2, 3],
+    [0, 0, 2, 3, 4, 4, 5, 6],
+    # FNUM BIT 7: 000 1000xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 0, 0, 1, 1],
+    [0, 0, 0, 0, 1, 1, 1, 1],
+    [0, 0, 0, 1, 1, 1, 1, 2],
+    [0, 0, 1, 1, 2, 2, 2, 3],
+    [0, 0, 2, 3, 4, 4, 5, 6],
+    [0, 0, 4, 6, 8, 8, 0xa, 0xc],
+    # FNUM BIT 8: 001 0000xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 1, 1, 1, 1],
+    [0, 0, 0, 1, 1, 1, 2, 2],
+    [0, 0, 1, 1, 2, 2, 3, 3],
+    [0, 0, 1, 2, 2, 2, 3, 4],
+    [0, 0, 2, 3, 4, 4, 5, 6],
+    [0, 0, 4, 6, 8, 8, 0xa, 0xc],
+    [0, 0, 8, 0xc, 0x10, 0x10, 0x14, 0x18],
+    # FNUM BIT 9: 010 0000xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 2, 2, 2, 2],
+    [0, 0, 0, 2, 2, 2, 4, 4],
+    [0, 0, 2, 2, 4, 4, 6, 6],
+    [0, 0, 2, 4, 4, 4, 6, 8],
+    [0, 0, 4, 6, 8, 8, 0xa, 0xc],
+    [0, 0, 8, 0xc, 0x10, 0x10, 0x14, 0x18],
+    [0, 0, 0x10, 0x18, 0x20, 0x20, 0x28, 0x30],
+    # FNUM BIT10: 100 0000xxxx
+    [0, 0, 0, 0, 0, 0, 0, 0],
+    [0, 0, 0, 0, 4, 4, 4, 4],
+    [0, 0, 0, 4, 4, 4, 8, 8],
+    [0, 0, 4, 4, 8, 8, 0xc, 0xc],
+    [0, 0, 4, 8, 8, 8, 0xc, 0x10],
+    [0, 0, 8, 0xc, 0x10, 0x10, 0x14, 0x18],
+    [0, 0, 0x10, 0x18, 0x20, 0x20, 0x28, 0x30],
+    [0, 0, 0x20, 0x30, 0x40, 0x40, 0x50, 0x60],
+]
+
+# usual ADPCM table (16 * 1.1^N)
+ADPCMA_STEPS = [
+    16, 17, 19, 21, 23, 25, 28,
+    31, 34, 37, 41, 45, 50, 55,
+    60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408,
+    449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552,
+]
+
+
+def round_half(n):
+    return (n >> 1) + 1 if n & 1 else n >> 1
+
+
+def build_tl_tab():
+    tab = [0] * TL_TAB_LEN
+    for x in range(TL_RES_LEN):
+        m = math.floor((1 << 16) / math.pow(2, (x + 1) * (ENV_STEP / 4.0) / 8.0))
+        n = round_half(int(m) >> 4) << 2
+        tab[x * 2 + 0] = n
+        tab[x * 2 + 1] = -n
+        for i in range(1, 13):
+            tab[x * 2 + 0 + i * 2 * TL_RES_LEN] = n >> i
+            tab[x * 2 + 1 + i * 2 * TL_RES_LEN] = -(n >> i)
+    return tab
+
+
+def build_sin_tab():
+    tab = [0] * SIN_LEN
+    for i in range(SIN_LEN):
+        m = math.sin(((i * 2) + 1) * math.pi / SIN_LEN)
+        if m > 0.0:
+            o = 8 * math.log(1.0 / m) / math.log(2.0)
+        else:
+            o = 8 * math.log(-1.0 / m) / math.log(2.0)
+        o = o / (ENV_STEP / 4)
+        n = round_half(int(2.0 * o))
+        tab[i] = n * 2 + (0 if m >= 0.0 else 1)
+    return tab
+
+
+def build_lfo_pm_table():
+    tab = [0] * (128 * 8 * 32)
+    for depth in range(8):
+        for fnum in range(128):
+            for step in range(8):
+                value = 0
+                for bit in range(7):
+                    if fnum & (1 << bit):
+                        value += LFO_PM_OUTPUT[bit * 8 + depth][step]
+                base = fnum * 32 * 8 + depth * 32
+                tab[base + step + 0] = value
+                tab[base + (step ^ 7) + 8] = value
+                tab[base + step + 16] = -value
+                tab[base + (step ^ 7) + 24] = -value
+    return tab
+
+
+def build_jedi_table():
+    tab = [0] * (49 * 16)
+    for step in range(49):
+        for nib in range(16):
+            value = (2 * (nib & 0x07) + 1) * ADPCMA_STEPS[step] // 8
+            tab[step * 16 + nib] = -value if nib & 0x08 else value
+    return tab
+
+
+def emit(ctype, name, size_expr, values, per_line=16):
+    print("static const %s %s[%s] = {" % (ctype, name, size_expr))
+    for i in range(0, len(values), per_line):
+        print("\t" + ",".join("%d" % v for v in values[i:i + per_line]) + ",")
+    print("};")
+    print()
+
+
+print("/* Generated by scripts/gen_fmopn_tables.py. Do not edit. */")
+print()
+print("/* Linear Power Table */")
+emit("signed int", "tl_tab", "%d" % TL_TAB_LEN, build_tl_tab())
+print("/* Logarithmic Sinus table */")
+emit("unsigned int", "sin_tab", "%d" % SIN_LEN, build_sin_tab())
+print("/* all 128 LFO PM waveforms: 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */")
+emit("INT32", "lfo_pm_table", "128*8*32", build_lfo_pm_table(), 32)
+print("/* ADPCM-A difference for each step and nibble */")
+emit("int", "jedi_table", "49*16", build_jedi_table())